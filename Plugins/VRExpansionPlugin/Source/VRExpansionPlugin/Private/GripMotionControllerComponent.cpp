@@ -32,11 +32,16 @@
 #endif // WITH_PHYSX
 
 #include "Features/IModularFeatures.h"
+#include "Async/Async.h"
 
 DEFINE_LOG_CATEGORY(LogVRMotionController);
 //For UE4 Profiler ~ Stat
 DECLARE_CYCLE_STAT(TEXT("TickGrip ~ TickingGrip"), STAT_TickGrip, STATGROUP_TickGrip);
 DECLARE_CYCLE_STAT(TEXT("GetGripWorldTransform ~ GettingTransform"), STAT_GetGripTransform, STATGROUP_TickGrip);
+DECLARE_CYCLE_STAT(TEXT("RebuildGripTickCache ~ RebuildingCache"), STAT_RebuildGripTickCache, STATGROUP_TickGrip);
+DECLARE_CYCLE_STAT(TEXT("LateUpdateSetup ~ SettingUpLateUpdates"), STAT_LateUpdateSetup, STATGROUP_TickGrip);
+DECLARE_CYCLE_STAT(TEXT("RebuildLateUpdateHierarchies ~ RebuildingLateUpdates"), STAT_RebuildLateUpdateHierarchies, STATGROUP_TickGrip);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Late Update Hierarchy Rebuilds"), STAT_LateUpdateHierarchyRebuilds, STATGROUP_TickGrip);
 
 // MAGIC NUMBERS
 // Constraint multipliers for angular, to avoid having to have two sets of stiffness/damping variables
@@ -89,9 +94,11 @@ UGripMotionControllerComponent::UGripMotionControllerComponent(const FObjectInit
 	//bReplicateControllerTransform = true;
 	ControllerNetUpdateRate = 100.0f; // 100 htz is default
 	ControllerNetUpdateCount = 0.0f;
+	ControllerTransformAckedKeyframe = VRPOSREP_INVALID_KEYFRAME;
 	bReplicateWithoutTracking = false;
 	bLerpingPosition = false;
 	bSmoothReplicatedMotion = false;
+	bUsePoseInterpolationBuffer = false;
 	bReppedOnce = false;
 	bOffsetByHMD = false;
 	bIsPostTeleport = false;
@@ -222,6 +229,22 @@ void UGripMotionControllerComponent::OnUnregister()
 	Super::OnUnregister();
 }
 
+void UGripMotionControllerComponent::OnChildAttached(USceneComponent* ChildComponent)
+{
+	Super::OnChildAttached(ChildComponent);
+
+	if (GripViewExtension.IsValid())
+		GripViewExtension->LateUpdate.MarkPrimitivesDirty();
+}
+
+void UGripMotionControllerComponent::OnChildDetached(USceneComponent* ChildComponent)
+{
+	Super::OnChildDetached(ChildComponent);
+
+	if (GripViewExtension.IsValid())
+		GripViewExtension->LateUpdate.MarkPrimitivesDirty();
+}
+
 void UGripMotionControllerComponent::BeginDestroy()
 {
 	Super::BeginDestroy();
@@ -239,6 +262,15 @@ void UGripMotionControllerComponent::BeginDestroy()
 	}
 }
 
+void UGripMotionControllerComponent::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UGripMotionControllerComponent* This = CastChecked<UGripMotionControllerComponent>(InThis);
+	This->GrippedObjectsTickCache.AddReferencedObjects(Collector);
+	This->LocallyGrippedObjectsTickCache.AddReferencedObjects(Collector);
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
 void UGripMotionControllerComponent::BeginPlay()
 {
 	Super::BeginPlay();
@@ -304,6 +336,7 @@ void UGripMotionControllerComponent::GetLifetimeReplicatedProps(TArray< class FL
 	DOREPLIFETIME(UGripMotionControllerComponent, ControllerNetUpdateRate);
 
 	DOREPLIFETIME_CONDITION(UGripMotionControllerComponent, LocallyGrippedObjects, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(UGripMotionControllerComponent, ControllerTransformAckedKeyframe, COND_OwnerOnly);
 //	DOREPLIFETIME(UGripMotionControllerComponent, bReplicateControllerTransform);
 }
 
@@ -319,6 +352,10 @@ void UGripMotionControllerComponent::PreReplication(IRepChangedPropertyTracker &
 
 void UGripMotionControllerComponent::Server_SendControllerTransform_Implementation(FBPVRComponentPosRep NewTransform)
 {
+	// Resolve delta compressed sends, if it references a keyframe that we never got then skip it
+	if (!ControllerTransformDeltaState.ResolveReceived(NewTransform, ControllerTransformAckedKeyframe))
+		return;
+
 	// Store new transform and trigger OnRep_Function
 	ReplicatedControllerTransform = NewTransform;
 
@@ -1824,6 +1861,8 @@ void UGripMotionControllerComponent::NotifyDropAndSocket_Implementation(const FB
 
 void UGripMotionControllerComponent::DropAndSocket_Implementation(const FBPActorGripInformation &NewDrop)
 {
+	InvalidateGripTickCache();
+
 	UGripMotionControllerComponent * HoldingController = nullptr;
 	bool bIsHeld = false;
 
@@ -2012,6 +2051,9 @@ void UGripMotionControllerComponent::DropAndSocket_Implementation(const FBPActor
 // No longer an RPC, now is called from RepNotify so that joining clients also correctly set up grips
 bool UGripMotionControllerComponent::NotifyGrip(FBPActorGripInformation &NewGrip, bool bIsReInit)
 {
+	// Grip was added or re-initialized, resolve the tick cache again next tick
+	InvalidateGripTickCache();
+
 	UPrimitiveComponent *root = NULL;
 	AActor *pActor = NULL;
 
@@ -2271,6 +2313,7 @@ void UGripMotionControllerComponent::NotifyDrop_Implementation(const FBPActorGri
 
 void UGripMotionControllerComponent::Drop_Implementation(const FBPActorGripInformation &NewDrop, bool bSimulate)
 {
+	InvalidateGripTickCache();
 
 	bool bSkipFullDrop = false;
 	bool bHadAnotherSelfGrip = false;
@@ -3246,19 +3289,29 @@ void UGripMotionControllerComponent::TickComponent(float DeltaTime, enum ELevelT
 					// Tracked doesn't matter, already set the relative location above in that case
 					ReplicatedControllerTransform.Position = this->RelativeLocation;
 					ReplicatedControllerTransform.Rotation = this->RelativeRotation;
+					// Remotes only read the stamp to place poses in their interpolation buffer
+					if (bUsePoseInterpolationBuffer)
+						ReplicatedControllerTransform.SetSendTime(FPlatformTime::Seconds());
+					else
+						ReplicatedControllerTransform.ClearSendTime();
 
 					// I would keep the torn off check here, except this can be checked on tick if they
 					// Set 100 htz updates, and in the TornOff case, it actually can't hurt any besides some small
 					// Perf difference.
 					if (GetNetMode() == NM_Client/* && !IsTornOff()*/)
 					{		
+						ControllerTransformDeltaState.PrepareForSend(ReplicatedControllerTransform, ControllerTransformAckedKeyframe, GetWorld()->GetTimeSeconds());
+
 						AVRBaseCharacter * OwningChar = Cast<AVRBaseCharacter>(GetOwner());
 						if (OverrideSendTransform != nullptr && OwningChar != nullptr)
 						{
 							(OwningChar->* (OverrideSendTransform))(ReplicatedControllerTransform);
 						}
 						else
+						{
+							ReplicatedControllerTransform.RecordSendStats();
 							Server_SendControllerTransform(ReplicatedControllerTransform);
+						}
 					}
 				}
 			}
@@ -3266,7 +3319,17 @@ void UGripMotionControllerComponent::TickComponent(float DeltaTime, enum ELevelT
 	}
 	else
 	{
-		if (bLerpingPosition)
+		if (bLerpingPosition && bUsePoseInterpolationBuffer)
+		{
+			FVector BufferedPosition;
+			FRotator BufferedRotation;
+
+			if (ReplicatedPoseBuffer.Sample(FPlatformTime::Seconds(), BufferedPosition, BufferedRotation))
+			{
+				SetRelativeLocationAndRotation(BufferedPosition, BufferedRotation);
+			}
+		}
+		else if (bLerpingPosition)
 		{
 			ControllerNetUpdateCount += DeltaTime;
 			float LerpVal = FMath::Clamp(ControllerNetUpdateCount / (1.0f / ControllerNetUpdateRate), 0.0f, 1.0f);
@@ -3353,6 +3416,143 @@ bool UGripMotionControllerComponent::GetGripWorldTransform(TArray<UVRGripScriptB
 	return bHasValidTransform;
 }
 
+namespace GripTickCacheStatics
+{
+	static const FName GripLogicScriptsName(TEXT("GripLogicScripts"));
+
+	// The grippables all keep their scripts in a GripLogicScripts array, find it so that it can be compared against directly
+	const TArray<UVRGripScriptBase*> * FindScriptSource(UObject * ScriptOwner, const TArray<UVRGripScriptBase*> & ResolvedScripts)
+	{
+		UArrayProperty * ArrayProp = FindField<UArrayProperty>(ScriptOwner->GetClass(), GripLogicScriptsName);
+		UObjectPropertyBase * InnerProp = ArrayProp ? Cast<UObjectPropertyBase>(ArrayProp->Inner) : nullptr;
+
+		if (!InnerProp || !InnerProp->PropertyClass || !InnerProp->PropertyClass->IsChildOf(UVRGripScriptBase::StaticClass()))
+			return nullptr;
+
+		const TArray<UVRGripScriptBase*> * Source = ArrayProp->ContainerPtrToValuePtr<TArray<UVRGripScriptBase*>>(ScriptOwner);
+
+		// Owners that override GetGripScripts to return something else can't be tracked this way
+		return (*Source == ResolvedScripts) ? Source : nullptr;
+	}
+}
+
+bool FGripTickCache::IsResolvedEntryValid(int32 Index) const
+{
+	const UPrimitiveComponent * root = Roots[Index];
+	const AActor * actor = Actors[Index];
+
+	// Cleared by the GC, destroyed, or an actor grip whose root has been swapped out
+	if (!root || !actor || root->IsPendingKill() || actor->IsPendingKill())
+		return false;
+
+	if (GrippedObjects[Index] == actor && actor->GetRootComponent() != root)
+		return false;
+
+	for (const UVRGripScriptBase * Script : GripScripts[Index])
+	{
+		if (Script && Script->IsPendingKill())
+			return false;
+	}
+
+	const TArray<UVRGripScriptBase*> * Source = ScriptSources[Index];
+	return !Source || *Source == GripScripts[Index];
+}
+
+void FGripTickCache::AddReferencedObjects(FReferenceCollector & Collector)
+{
+	Collector.AddReferencedObjects(GrippedObjects);
+	Collector.AddReferencedObjects(Roots);
+	Collector.AddReferencedObjects(Actors);
+
+	for (TArray<UVRGripScriptBase*> & Scripts : GripScripts)
+	{
+		Collector.AddReferencedObjects(Scripts);
+	}
+}
+
+void FGripTickCache::Rebuild(const TArray<FBPActorGripInformation> & GripArray)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RebuildGripTickCache);
+
+	const int32 NumGrips = GripArray.Num();
+
+	GripIDs.SetNumUninitialized(NumGrips, false);
+	GrippedObjects.SetNumUninitialized(NumGrips, false);
+	CollisionTypes.SetNumUninitialized(NumGrips, false);
+	InterfaceFlags.SetNumUninitialized(NumGrips, false);
+	Roots.SetNumUninitialized(NumGrips, false);
+	Actors.SetNumUninitialized(NumGrips, false);
+	GripScripts.SetNum(NumGrips, false);
+	ScriptSources.SetNumUninitialized(NumGrips, false);
+
+	for (int32 i = 0; i < NumGrips; ++i)
+	{
+		const FBPActorGripInformation & Grip = GripArray[i];
+
+		GripIDs[i] = Grip.GripID;
+		GrippedObjects[i] = Grip.GrippedObject;
+		CollisionTypes[i] = Grip.GripCollisionType;
+		InterfaceFlags[i] = 0;
+		Roots[i] = nullptr;
+		Actors[i] = nullptr;
+		GripScripts[i].Reset();
+		ScriptSources[i] = nullptr;
+
+		if (!Grip.GrippedObject || Grip.GrippedObject->IsPendingKill())
+			continue;
+
+		UPrimitiveComponent * root = nullptr;
+		AActor * actor = nullptr;
+
+		switch (Grip.GripTargetType)
+		{
+		case EGripTargetType::ActorGrip:
+		{
+			actor = Grip.GetGrippedActor();
+			if (actor)
+				root = Cast<UPrimitiveComponent>(actor->GetRootComponent());
+		}break;
+
+		case EGripTargetType::ComponentGrip:
+		{
+			root = Grip.GetGrippedComponent();
+			if (root)
+				actor = root->GetOwner();
+		}break;
+
+		default:break;
+		}
+
+		if (!root || !actor)
+			continue;
+
+		Roots[i] = root;
+		Actors[i] = actor;
+		InterfaceFlags[i] |= IsResolved;
+
+		if (root->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
+		{
+			InterfaceFlags[i] |= RootHasInterface;
+			IVRGripInterface::Execute_GetGripScripts(root, GripScripts[i]);
+			ScriptSources[i] = GripTickCacheStatics::FindScriptSource(root, GripScripts[i]);
+		}
+
+		// Actor grip interface is checked after component
+		if (actor->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
+		{
+			InterfaceFlags[i] |= ActorHasInterface;
+
+			if (!(InterfaceFlags[i] & RootHasInterface))
+			{
+				IVRGripInterface::Execute_GetGripScripts(actor, GripScripts[i]);
+				ScriptSources[i] = GripTickCacheStatics::FindScriptSource(actor, GripScripts[i]);
+			}
+		}
+	}
+
+	bIsDirty = false;
+}
+
 void UGripMotionControllerComponent::TickGrip(float DeltaTime)
 {
 	SCOPE_CYCLE_COUNTER(STAT_TickGrip);
@@ -3391,6 +3591,13 @@ void UGripMotionControllerComponent::HandleGripArray(TArray<FBPActorGripInformat
 	{
 		FTransform WorldTransform;
 
+		FGripTickCache & TickCache = bReplicatedArray ? GrippedObjectsTickCache : LocallyGrippedObjectsTickCache;
+
+		if (TickCache.bIsDirty || TickCache.GripIDs.Num() != GrippedObjectsArray.Num())
+		{
+			TickCache.Rebuild(GrippedObjectsArray);
+		}
+
 		for (int i = GrippedObjectsArray.Num() - 1; i >= 0; --i)
 		{
 			if (!HasGripMovementAuthority(GrippedObjectsArray[i]))
@@ -3414,48 +3621,22 @@ void UGripMotionControllerComponent::HandleGripArray(TArray<FBPActorGripInformat
 				if (Grip->GripCollisionType == EGripCollisionType::EventsOnly)
 					continue; // Earliest safe spot to continue at, we needed to check if the object is pending kill or invalid first
 
-				UPrimitiveComponent *root = NULL;
-				AActor *actor = NULL;
-
-				// Getting the correct variables depending on the grip target type
-				switch (Grip->GripTargetType)
+				// Grips can be added or dropped by events during this loop, so verify the cached entry before reading it
+				if (!TickCache.IsEntryValid(i, *Grip))
 				{
-					case EGripTargetType::ActorGrip:
-					//case EGripTargetType::InteractibleActorGrip:
-					{
-						actor = Grip->GetGrippedActor();
-						if(actor)
-							root = Cast<UPrimitiveComponent>(actor->GetRootComponent());
-					}break;
-
-					case EGripTargetType::ComponentGrip:
-					//case EGripTargetType::InteractibleComponentGrip :
-					{
-						root = Grip->GetGrippedComponent();
-						if(root)
-							actor = root->GetOwner();
-					}break;
-
-				default:break;
+					TickCache.Rebuild(GrippedObjectsArray);
 				}
 
+				UPrimitiveComponent *root = TickCache.Roots[i];
+				AActor *actor = TickCache.Actors[i];
+
 				// Last check to make sure the variables are valid
 				if (!root || !actor)
 					continue;
 
 				// Check if either implements the interface
-				bool bRootHasInterface = false;
-				bool bActorHasInterface = false;
-				
-				if (root->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
-				{
-					bRootHasInterface = true;
-				}
-				if (actor->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
-				{
-					// Actor grip interface is checked after component
-					bActorHasInterface = true;
-				}
+				const bool bRootHasInterface = (TickCache.InterfaceFlags[i] & FGripTickCache::RootHasInterface) != 0;
+				const bool bActorHasInterface = (TickCache.InterfaceFlags[i] & FGripTickCache::ActorHasInterface) != 0;
 
 				if (Grip->GripCollisionType == EGripCollisionType::CustomGrip)
 				{
@@ -3470,17 +3651,8 @@ void UGripMotionControllerComponent::HandleGripArray(TArray<FBPActorGripInformat
 
 				bool bRescalePhysicsGrips = false;
 				
-				TArray<UVRGripScriptBase*> GripScripts;
-
-				if (bRootHasInterface)
-				{
-					IVRGripInterface::Execute_GetGripScripts(root, GripScripts);
-				}
-				else if (bActorHasInterface)
-				{
-					IVRGripInterface::Execute_GetGripScripts(actor, GripScripts);
-				}
-
+				// Copied out by the rebuild, not re-queried each frame
+				TArray<UVRGripScriptBase*> & GripScripts = TickCache.GripScripts[i];
 
 				bool bForceADrop = false;
 
@@ -5004,6 +5176,8 @@ void UGripMotionControllerComponent::Server_NotifyLocalGripAddedOrChanged_Implem
 		}
 	}
 
+	LocallyGrippedObjectsTickCache.MarkDirty();
+
 	// Server has to call this themselves
 	//OnRep_LocallyGrippedObjects();
 }
@@ -5128,12 +5302,329 @@ void UGripMotionControllerComponent::GetControllerDeviceID(FXRDeviceId & DeviceI
 *
 */
 
+void FLateUpdateSlot::Finalize()
+{
+	if (Primitives.Num() < 2)
+		return;
+
+	Primitives.Sort();
+
+	int32 NumUnique = 1;
+	for (int32 i = 1; i < Primitives.Num(); ++i)
+	{
+		if (Primitives[i].SceneInfo != Primitives[NumUnique - 1].SceneInfo)
+			Primitives[NumUnique++] = Primitives[i];
+	}
+
+	Primitives.SetNum(NumUnique, false);
+}
+
+FLateUpdatePrimitiveInfo * FLateUpdateSlot::FindPrimitive(const FPrimitiveSceneInfo* SceneInfo)
+{
+	int32 Min = 0;
+	int32 Max = Primitives.Num();
+
+	while (Min < Max)
+	{
+		const int32 Mid = Min + (Max - Min) / 2;
+		if ((UPTRINT)Primitives[Mid].SceneInfo < (UPTRINT)SceneInfo)
+			Min = Mid + 1;
+		else
+			Max = Mid;
+	}
+
+	return (Min < Primitives.Num() && Primitives[Min].SceneInfo == SceneInfo) ? &Primitives[Min] : nullptr;
+}
+
+FLateUpdateFrameBuffer::FLateUpdateFrameBuffer()
+	: HeldSlot(INDEX_NONE)
+	, WriteSlot(0)
+	, WriteFrame(InvalidFrame)
+	, NextSequence(0)
+	, ReadSlot(0)
+{
+	for (int32 i = 0; i < NumSlots; ++i)
+	{
+		SlotFrames[i] = InvalidFrame;
+		SlotSequences[i] = 0;
+	}
+}
+
+bool FLateUpdateFrameBuffer::IsSlotSuperseded(int32 Slot) const
+{
+	if (SlotFrames[Slot] == InvalidFrame)
+		return true;
+
+	for (int32 i = 0; i < NumSlots; ++i)
+	{
+		if (i != Slot && SlotFrames[i] == SlotFrames[Slot] && SlotSequences[i] > SlotSequences[Slot])
+			return true;
+	}
+
+	return false;
+}
+
+FLateUpdateSlot & FLateUpdateFrameBuffer::BeginWrite(uint32 FrameNumber)
+{
+	WriteFrame = GetFrameTag(FrameNumber);
+
+	for (;;)
+	{
+		const int32 Held = FPlatformAtomics::AtomicRead(&HeldSlot);
+
+		// Slots that a later write of the same frame replaced go first, the newest slot of each frame stays readable until it is the oldest
+		int32 Oldest = INDEX_NONE;
+		for (int32 i = 0; i < NumSlots; ++i)
+		{
+			if (i == Held)
+				continue;
+
+			if (IsSlotSuperseded(i))
+			{
+				Oldest = i;
+				break;
+			}
+
+			if (Oldest == INDEX_NONE || SlotSequences[i] < SlotSequences[Oldest])
+				Oldest = i;
+		}
+
+		// Invalidate first and check the hold after, the reader holds first and checks the frame after. Both are full barriers so
+		// at least one of the two sees the other, either we skip the slot or the reader drops it again.
+		const int32 PreviousFrame = FPlatformAtomics::InterlockedExchange(&SlotFrames[Oldest], InvalidFrame);
+		if (FPlatformAtomics::AtomicRead(&HeldSlot) != Oldest)
+		{
+			WriteSlot = Oldest;
+			break;
+		}
+
+		FPlatformAtomics::InterlockedExchange(&SlotFrames[Oldest], PreviousFrame);
+	}
+
+	FLateUpdateSlot & Slot = Slots[WriteSlot];
+	Slot.Primitives.Reset();
+	Slot.bApplied = false;
+	return Slot;
+}
+
+void FLateUpdateFrameBuffer::Publish()
+{
+	// The exchanges are full barriers so the slot contents are visible before the reader can see the frame
+	FPlatformAtomics::InterlockedExchange(&SlotSequences[WriteSlot], ++NextSequence);
+	FPlatformAtomics::InterlockedExchange(&SlotFrames[WriteSlot], WriteFrame);
+}
+
+bool FLateUpdateFrameBuffer::AcquireFrame(uint32 FrameNumber)
+{
+	const int32 FrameTag = GetFrameTag(FrameNumber);
+
+	for (;;)
+	{
+		int32 Newest = INDEX_NONE;
+		int32 NewestSequence = 0;
+		for (int32 i = 0; i < NumSlots; ++i)
+		{
+			if (FPlatformAtomics::AtomicRead(&SlotFrames[i]) != FrameTag)
+				continue;
+
+			const int32 Sequence = FPlatformAtomics::AtomicRead(&SlotSequences[i]);
+			if (Newest == INDEX_NONE || Sequence > NewestSequence)
+			{
+				Newest = i;
+				NewestSequence = Sequence;
+			}
+		}
+
+		if (Newest == INDEX_NONE)
+		{
+			Release();
+			return false;
+		}
+
+		FPlatformAtomics::InterlockedExchange(&HeldSlot, Newest);
+
+		// The writer started on the slot before it could see our hold, look again
+		if (FPlatformAtomics::AtomicRead(&SlotFrames[Newest]) == FrameTag)
+		{
+			ReadSlot = Newest;
+			return true;
+		}
+	}
+}
+
+void FLateUpdateFrameBuffer::Release()
+{
+	FPlatformAtomics::InterlockedExchange(&HeldSlot, INDEX_NONE);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace LateUpdateFrameBufferStressTest
+{
+	static int32 GetNumPrimitives(int32 Frame, int32 Write)
+	{
+		return 8 + ((Frame * 3 + Write) % 57);
+	}
+
+	// Runs a writer and a reader thread the way the game and render threads run, the writer sets up every frame once or twice and stays
+	// at most one frame ahead of the reader, the reader renders every frame in order once the writer is done with it. Every frame has to
+	// be acquired, hold the frame that was asked for, come from the last write of that frame, be sorted and hold exactly what that write
+	// wrote. The scene infos are fake and never dereferenced.
+	static void RunStressTest(const TArray<FString> & Args)
+	{
+		const float Seconds = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 0.1f) : 2.0f;
+		const float WriterHz = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 0.0f) : 90.0f;
+		const float ReaderHz = Args.Num() > 2 ? FMath::Max(FCString::Atof(*Args[2]), 0.0f) : 72.0f;
+
+		FLateUpdateFrameBuffer Buffer;
+		FThreadSafeBool bStop(false);
+
+		// Last frame the writer finished setting up and the last frame the reader finished rendering
+		FThreadSafeCounter PublishedFrame;
+		FThreadSafeCounter RenderedFrame;
+
+		// Index of the last write of each recent frame, the writer is never far enough ahead to wrap around a frame the reader is on
+		TArray<int32> LastWrites;
+		LastWrites.SetNumZeroed(16);
+
+		int32 Publishes = 0;
+		double MaxPublishTime = 0.0;
+
+		int32 Rendered = 0;
+		int32 MissingFrames = 0;
+		int32 WrongFrames = 0;
+		int32 StaleWrites = 0;
+		int32 InvalidSlots = 0;
+
+		TFuture<void> Writer = Async(EAsyncExecution::Thread, [&]()
+		{
+			const float Interval = WriterHz > 0.0f ? 1.0f / WriterHz : 0.0f;
+			FRandomStream Stream(0x1A7E);
+
+			for (int32 Frame = 1; !bStop; ++Frame)
+			{
+				// The game thread can start a frame once the render thread finished the one before the last (one frame of thread lag)
+				while (!bStop && RenderedFrame.GetValue() < Frame - 2)
+				{
+					FPlatformProcess::Sleep(0.0f);
+				}
+
+				// Some frames set up more than once (more than one view family), the last one has to win
+				const int32 NumWrites = Stream.FRand() < 0.25f ? 2 : 1;
+				for (int32 Write = 0; Write < NumWrites; ++Write)
+				{
+					const int32 NumPrimitives = GetNumPrimitives(Frame, Write);
+
+					FLateUpdateSlot & Slot = Buffer.BeginWrite((uint32)Frame);
+					Slot.ParentToWorld.SetTranslation(FVector((float)(Frame & 0xFFFF), (float)Write, 0.0f));
+
+					// Added in reverse with some duplicates so that Finalize() has work to do
+					for (int32 i = NumPrimitives; i > 0; --i)
+					{
+						FPrimitiveSceneInfo * FakeSceneInfo = (FPrimitiveSceneInfo*)(UPTRINT)(i * 16);
+						Slot.Primitives.Emplace(FakeSceneInfo, Frame);
+
+						if (i % 8 == 0)
+							Slot.Primitives.Emplace(FakeSceneInfo, Frame);
+					}
+
+					Slot.Finalize();
+
+					const double StartTime = FPlatformTime::Seconds();
+					Buffer.Publish();
+					MaxPublishTime = FMath::Max(MaxPublishTime, FPlatformTime::Seconds() - StartTime);
+					++Publishes;
+				}
+
+				// Setting the counter is a barrier, the reader sees the last write index once it sees the frame
+				LastWrites[Frame % LastWrites.Num()] = NumWrites - 1;
+				PublishedFrame.Set(Frame);
+				FPlatformProcess::Sleep(Interval * Stream.FRandRange(0.5f, 1.5f));
+			}
+		});
+
+		TFuture<void> Reader = Async(EAsyncExecution::Thread, [&]()
+		{
+			const float Interval = ReaderHz > 0.0f ? 1.0f / ReaderHz : 0.0f;
+
+			for (int32 Frame = 1; !bStop; ++Frame)
+			{
+				// The render thread only gets to a frame after the game thread is done with it
+				while (!bStop && PublishedFrame.GetValue() < Frame)
+				{
+					FPlatformProcess::Sleep(0.0f);
+				}
+
+				if (bStop)
+					break;
+
+				if (Buffer.AcquireFrame((uint32)Frame))
+				{
+					const FLateUpdateSlot & Slot = Buffer.GetReadSlot();
+					const int32 SlotFrame = Slot.Primitives.Num() ? Slot.Primitives[0].Index : 0;
+					const int32 SlotWrite = (int32)Slot.ParentToWorld.GetTranslation().Y;
+
+					if (SlotFrame != Frame || Slot.ParentToWorld.GetTranslation().X != (float)(Frame & 0xFFFF))
+					{
+						++WrongFrames;
+					}
+					else
+					{
+						// Only the last write of a frame may be seen
+						if (SlotWrite != LastWrites[Frame % LastWrites.Num()])
+							++StaleWrites;
+
+						if (Slot.Primitives.Num() != GetNumPrimitives(Frame, SlotWrite))
+							++InvalidSlots;
+
+						bool bValid = true;
+						for (int32 i = 1; bValid && i < Slot.Primitives.Num(); ++i)
+						{
+							bValid = Slot.Primitives[i].Index == Frame && Slot.Primitives[i - 1] < Slot.Primitives[i];
+						}
+
+						if (!bValid)
+							++InvalidSlots;
+					}
+
+					Buffer.Release();
+				}
+				else
+				{
+					++MissingFrames;
+				}
+
+				++Rendered;
+				RenderedFrame.Set(Frame);
+				FPlatformProcess::Sleep(Interval);
+			}
+		});
+
+		FPlatformProcess::Sleep(Seconds);
+		bStop = true;
+		Writer.Wait();
+		Reader.Wait();
+
+		UE_LOG(LogVRMotionController, Log, TEXT("Late update frame buffer stress test: %.1fs, writer %.0fHz, reader %.0fHz, %d frames set up (%d publishes), %d frames rendered, max publish %.3fus"),
+			Seconds, WriterHz, ReaderHz, PublishedFrame.GetValue(), Publishes, Rendered, MaxPublishTime * 1000000.0);
+
+		if (MissingFrames || WrongFrames || StaleWrites || InvalidSlots)
+		{
+			UE_LOG(LogVRMotionController, Error, TEXT("Late update frame buffer stress test FAILED: %d frames without a slot, %d slots from the wrong frame, %d slots from an overwritten write, %d invalid slots"),
+				MissingFrames, WrongFrames, StaleWrites, InvalidSlots);
+		}
+	}
+
+	static FAutoConsoleCommandWithArgs StressTestCommand(
+		TEXT("vr.LateUpdate.StressTest"),
+		TEXT("Runs the late update frame buffer between two threads paced like the game and render threads and checks that every frame is rendered with the slot set up for it, 0Hz runs unpaced.\n")
+		TEXT("Usage: vr.LateUpdate.StressTest [Seconds=2] [WriterHz=90] [ReaderHz=72]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunStressTest));
+}
+#endif
+
 FExpandedLateUpdateManager::FExpandedLateUpdateManager()
-	: LateUpdateGameWriteIndex(0)
-	, LateUpdateRenderReadIndex(0)
+	: bPrimitivesDirty(true)
 {
-	SkipLateUpdate[0] = false;
-	SkipLateUpdate[1] = false;
 }
 
 void FExpandedLateUpdateManager::Setup(const FTransform& ParentToWorld, UGripMotionControllerComponent* Component, bool bSkipLateUpdate)
@@ -5142,33 +5633,105 @@ void FExpandedLateUpdateManager::Setup(const FTransform& ParentToWorld, UGripMot
 		return;
 
 	check(IsInGameThread());
+	SCOPE_CYCLE_COUNTER(STAT_LateUpdateSetup);
 
-	LateUpdateParentToWorld[LateUpdateGameWriteIndex] = ParentToWorld;
-	LateUpdatePrimitives[LateUpdateGameWriteIndex].Reset();
-	SkipLateUpdate[LateUpdateGameWriteIndex] = bSkipLateUpdate;
+	// Tagged with the frame so that the render thread applies it to the same frame that it was set up in
+	FLateUpdateSlot & WriteSlot = LateUpdateSlots.BeginWrite(GFrameNumber);
+	WriteSlot.ParentToWorld = ParentToWorld;
+	WriteSlot.bSkipLateUpdate = bSkipLateUpdate;
 
-	TArray<USceneComponent*> ComponentsThatSkipLateUpdate;
+	if (bPrimitivesDirty || !AreHierarchiesValid(Component))
+		RebuildHierarchies(Component);
 
 	//Add additional late updates registered to this controller that aren't children and aren't gripped
 	//This array is editable in blueprint and can be used for things like arms or the like.
-	for (UPrimitiveComponent* primComp : Component->AdditionalLateUpdateComponents)
+	for (const FLateUpdateHierarchy & Hierarchy : AdditionalHierarchies)
 	{
-		if (primComp)
-			GatherLateUpdatePrimitives(primComp);
+		AddHierarchy(Hierarchy);
 	}
 
+	AddGripArray(Component, Component->LocallyGrippedObjects, CachedLocallyGrippedObjects, Component->LocallyGrippedObjectsTickCache);
+	AddGripArray(Component, Component->GrippedObjects, CachedGrippedObjects, Component->GrippedObjectsTickCache);
 
-	ProcessGripArrayLateUpdatePrimitives(Component, Component->LocallyGrippedObjects, ComponentsThatSkipLateUpdate);
-	ProcessGripArrayLateUpdatePrimitives(Component, Component->GrippedObjects, ComponentsThatSkipLateUpdate);
+	AddHierarchy(ControllerHierarchy);
 
-	GatherLateUpdatePrimitives(Component, &ComponentsThatSkipLateUpdate);
+	WriteSlot.Finalize();
+	LateUpdateSlots.Publish();
+}
+
+bool FExpandedLateUpdateManager::AreHierarchiesValid(UGripMotionControllerComponent* Component) const
+{
+	if (CachedAdditionalComponents != Component->AdditionalLateUpdateComponents)
+		return false;
 
-	LateUpdateGameWriteIndex = (LateUpdateGameWriteIndex + 1) % 2;
+	if (!CachedLocallyGrippedObjects.IsValid(Component->LocallyGrippedObjects) || !CachedGrippedObjects.IsValid(Component->GrippedObjects))
+		return false;
+
+	if (!ControllerHierarchy.IsValid())
+		return false;
+
+	for (const FLateUpdateHierarchy & Hierarchy : AdditionalHierarchies)
+	{
+		if (!Hierarchy.IsValid())
+			return false;
+	}
+
+	return true;
+}
+
+void FExpandedLateUpdateManager::RebuildHierarchies(UGripMotionControllerComponent* Component)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RebuildLateUpdateHierarchies);
+	INC_DWORD_STAT(STAT_LateUpdateHierarchyRebuilds);
+
+	bPrimitivesDirty = false;
+
+	CachedAdditionalComponents = Component->AdditionalLateUpdateComponents;
+	AdditionalHierarchies.SetNum(CachedAdditionalComponents.Num());
+	for (int32 i = 0; i < CachedAdditionalComponents.Num(); ++i)
+	{
+		if (CachedAdditionalComponents[i])
+			AdditionalHierarchies[i].Gather(CachedAdditionalComponents[i]);
+		else
+			AdditionalHierarchies[i].Reset();
+	}
+
+	TArray<USceneComponent*> ComponentsThatSkipLateUpdate;
+	CachedLocallyGrippedObjects.Gather(Component->LocallyGrippedObjects, ComponentsThatSkipLateUpdate);
+	CachedGrippedObjects.Gather(Component->GrippedObjects, ComponentsThatSkipLateUpdate);
+
+	ControllerHierarchy.Gather(Component, &ComponentsThatSkipLateUpdate);
+}
+
+void FExpandedLateUpdateManager::AddHierarchy(const FLateUpdateHierarchy & Hierarchy)
+{
+	// Scene infos are read fresh every frame so recreated scene proxies are picked up without a rebuild
+	TArray<FLateUpdatePrimitiveInfo> & WritePrimitives = LateUpdateSlots.GetWriteSlot().Primitives;
+	for (const TWeakObjectPtr<UPrimitiveComponent> & WeakPrimitive : Hierarchy.Primitives)
+	{
+		UPrimitiveComponent * PrimitiveComponent = WeakPrimitive.Get();
+		if (PrimitiveComponent && PrimitiveComponent->SceneProxy)
+		{
+			if (FPrimitiveSceneInfo* PrimitiveSceneInfo = PrimitiveComponent->SceneProxy->GetPrimitiveSceneInfo())
+			{
+				WritePrimitives.Emplace(PrimitiveSceneInfo, PrimitiveSceneInfo->GetIndex());
+			}
+		}
+	}
+}
+
+void FExpandedLateUpdateManager::AddGripArray(UGripMotionControllerComponent* Component, const TArray<FBPActorGripInformation> & GripArray, const FLateUpdateGripArray & CachedArray, const FGripTickCache & TickCache)
+{
+	for (int32 i = 0; i < GripArray.Num(); ++i)
+	{
+		if (ShouldLateUpdateGrip(Component, GripArray[i], i, TickCache))
+			AddHierarchy(CachedArray.Hierarchies[i]);
+	}
 }
 
 bool FExpandedLateUpdateManager::GetSkipLateUpdate_RenderThread() const
 {
-	return SkipLateUpdate[LateUpdateRenderReadIndex];
+	return LateUpdateSlots.GetReadSlot().bSkipLateUpdate;
 }
 
 
@@ -5176,7 +5739,23 @@ void FExpandedLateUpdateManager::Apply_RenderThread(FSceneInterface* Scene, cons
 {
 	check(IsInRenderingThread());
 
-	if (!LateUpdatePrimitives[LateUpdateRenderReadIndex].Num())
+	// The slot that the game thread set up for the frame being rendered, without one there is nothing that belongs to this frame
+	if (!LateUpdateSlots.AcquireFrame(GFrameNumberRenderThread))
+	{
+		return;
+	}
+
+	FLateUpdateSlot & ReadSlot = LateUpdateSlots.GetReadSlot();
+
+	// An earlier view family of this frame already moved its primitives
+	if (ReadSlot.bApplied)
+	{
+		return;
+	}
+
+	ReadSlot.bApplied = true;
+
+	if (!ReadSlot.Primitives.Num())
 	{
 		return;
 	}
@@ -5186,18 +5765,18 @@ void FExpandedLateUpdateManager::Apply_RenderThread(FSceneInterface* Scene, cons
 		return;
 	}
 
-	const FTransform OldCameraTransform = OldRelativeTransform * LateUpdateParentToWorld[LateUpdateRenderReadIndex];
-	const FTransform NewCameraTransform = NewRelativeTransform * LateUpdateParentToWorld[LateUpdateRenderReadIndex];
+	const FTransform OldCameraTransform = OldRelativeTransform * ReadSlot.ParentToWorld;
+	const FTransform NewCameraTransform = NewRelativeTransform * ReadSlot.ParentToWorld;
 	const FMatrix LateUpdateTransform = (OldCameraTransform.Inverse() * NewCameraTransform).ToMatrixWithScale();
 
 	bool bIndicesHaveChanged = false;
 
 	// Apply delta to the cached scene proxies
 	// Also check whether any primitive indices have changed, in case the scene has been modified in the meantime.
-	for (auto PrimitivePair : LateUpdatePrimitives[LateUpdateRenderReadIndex])
+	for (FLateUpdatePrimitiveInfo & PrimitiveInfo : ReadSlot.Primitives)
 	{
-		FPrimitiveSceneInfo* RetrievedSceneInfo = Scene->GetPrimitiveSceneInfo(PrimitivePair.Value);
-		FPrimitiveSceneInfo* CachedSceneInfo = PrimitivePair.Key;
+		FPrimitiveSceneInfo* RetrievedSceneInfo = Scene->GetPrimitiveSceneInfo(PrimitiveInfo.Index);
+		FPrimitiveSceneInfo* CachedSceneInfo = PrimitiveInfo.SceneInfo;
 
 		// If the retrieved scene info is different than our cached scene info then the scene has changed in the meantime
 		// and we need to search through the entire scene to make sure it still exists.
@@ -5209,7 +5788,7 @@ void FExpandedLateUpdateManager::Apply_RenderThread(FSceneInterface* Scene, cons
 		else if (CachedSceneInfo->Proxy)
 		{
 			CachedSceneInfo->Proxy->ApplyLateUpdateTransform(LateUpdateTransform);
-			PrimitivePair.Value = -1; // Set the cached index to -1 to indicate that this primitive was already processed
+			PrimitiveInfo.Index = INDEX_NONE; // Set the cached index to INDEX_NONE to indicate that this primitive was already processed
 		}
 	}
 
@@ -5220,9 +5799,14 @@ void FExpandedLateUpdateManager::Apply_RenderThread(FSceneInterface* Scene, cons
 		FPrimitiveSceneInfo* RetrievedSceneInfo = Scene->GetPrimitiveSceneInfo(Index++);
 		while (RetrievedSceneInfo)
 		{
-			if (RetrievedSceneInfo->Proxy && LateUpdatePrimitives[LateUpdateRenderReadIndex].Contains(RetrievedSceneInfo) && LateUpdatePrimitives[LateUpdateRenderReadIndex][RetrievedSceneInfo] >= 0)
+			if (RetrievedSceneInfo->Proxy)
 			{
-				RetrievedSceneInfo->Proxy->ApplyLateUpdateTransform(LateUpdateTransform);
+				FLateUpdatePrimitiveInfo * PrimitiveInfo = ReadSlot.FindPrimitive(RetrievedSceneInfo);
+				if (PrimitiveInfo && PrimitiveInfo->Index != INDEX_NONE)
+				{
+					RetrievedSceneInfo->Proxy->ApplyLateUpdateTransform(LateUpdateTransform);
+					PrimitiveInfo->Index = INDEX_NONE;
+				}
 			}
 			RetrievedSceneInfo = Scene->GetPrimitiveSceneInfo(Index++);
 		}
@@ -5231,9 +5815,8 @@ void FExpandedLateUpdateManager::Apply_RenderThread(FSceneInterface* Scene, cons
 
 void FExpandedLateUpdateManager::PostRender_RenderThread()
 {
-	LateUpdatePrimitives[LateUpdateRenderReadIndex].Reset();
-	SkipLateUpdate[LateUpdateRenderReadIndex] = false;
-	LateUpdateRenderReadIndex = (LateUpdateRenderReadIndex + 1) % 2;
+	// The game thread resets the slot when it writes into it again, this only hands it back
+	LateUpdateSlots.Release();
 }
 
 void FExpandedLateUpdateManager::CacheSceneInfo(USceneComponent* Component)
@@ -5245,11 +5828,129 @@ void FExpandedLateUpdateManager::CacheSceneInfo(USceneComponent* Component)
 		FPrimitiveSceneInfo* PrimitiveSceneInfo = PrimitiveComponent->SceneProxy->GetPrimitiveSceneInfo();
 		if (PrimitiveSceneInfo)
 		{
-			LateUpdatePrimitives[LateUpdateGameWriteIndex].Emplace(PrimitiveSceneInfo, PrimitiveSceneInfo->GetIndex());
+			LateUpdateSlots.GetWriteSlot().Primitives.Emplace(PrimitiveSceneInfo, PrimitiveSceneInfo->GetIndex());
+		}
+	}
+}
+
+void FExpandedLateUpdateManager::FLateUpdateHierarchy::Gather(USceneComponent* Root, const TArray<USceneComponent*> *SkipComponentList)
+{
+	Reset();
+
+	if (!Root)
+		return;
+
+	// Same set as GatherLateUpdatePrimitives, the skip list only applies to the direct children of the root
+	TArray<USceneComponent*, TInlineAllocator<32>> Stack;
+	Stack.Add(Root);
+
+	while (Stack.Num())
+	{
+		USceneComponent * Component = Stack.Pop(false);
+		const TArray<USceneComponent*> & Children = Component->GetAttachChildren();
+
+		Components.Add(Component);
+		NumAttachChildren.Add(Children.Num());
+		AttachChildren.Append(Children);
+
+		if (UPrimitiveComponent * PrimitiveComponent = Cast<UPrimitiveComponent>(Component))
+			Primitives.Add(PrimitiveComponent);
+
+		for (USceneComponent * Child : Children)
+		{
+			if (!Child)
+				continue;
+
+			if (Component == Root && SkipComponentList && SkipComponentList->Contains(Child))
+				continue;
+
+			Stack.Add(Child);
+		}
+	}
+}
+
+bool FExpandedLateUpdateManager::FLateUpdateHierarchy::IsValid() const
+{
+	const USceneComponent * const * CachedChildren = AttachChildren.GetData();
+
+	for (int32 i = 0; i < Components.Num(); ++i)
+	{
+		const USceneComponent * Component = Components[i].Get();
+		if (!Component)
+			return false;
+
+		// A flat compare against the gathered children, no walk of the hierarchy
+		const TArray<USceneComponent*> & Children = Component->GetAttachChildren();
+		if (Children.Num() != NumAttachChildren[i] || FMemory::Memcmp(Children.GetData(), CachedChildren, Children.Num() * sizeof(USceneComponent*)) != 0)
+			return false;
+
+		CachedChildren += Children.Num();
+	}
+
+	return true;
+}
+
+void FExpandedLateUpdateManager::FLateUpdateGripArray::Gather(const TArray<FBPActorGripInformation> & GripArray, TArray<USceneComponent*> &SkipComponentList)
+{
+	const int32 NumGrips = GripArray.Num();
+	GripIDs.SetNum(NumGrips);
+	GrippedObjects.SetNum(NumGrips);
+	CollisionTypes.SetNum(NumGrips);
+	Hierarchies.SetNum(NumGrips);
+
+	for (int32 i = 0; i < NumGrips; ++i)
+	{
+		const FBPActorGripInformation & Grip = GripArray[i];
+		GripIDs[i] = Grip.GripID;
+		GrippedObjects[i] = Grip.GrippedObject;
+		CollisionTypes[i] = Grip.GripCollisionType;
+
+		USceneComponent * GripRoot = nullptr;
+		if (Grip.GrippedObject && Grip.GripCollisionType != EGripCollisionType::EventsOnly)
+		{
+			switch (Grip.GripTargetType)
+			{
+			case EGripTargetType::ActorGrip:
+			{
+				if (AActor * GrippedActor = Grip.GetGrippedActor())
+					GripRoot = GrippedActor->GetRootComponent();
+			}break;
+			case EGripTargetType::ComponentGrip:
+			{
+				GripRoot = Grip.GetGrippedComponent();
+			}break;
+			}
+
+			// Handle late updates even with attachment, we need to add it to a skip list for the primary gatherer to process
+			if (GripRoot && Grip.GripCollisionType == EGripCollisionType::AttachmentGrip)
+				SkipComponentList.Add(GripRoot);
 		}
+
+		if (GripRoot)
+			Hierarchies[i].Gather(GripRoot);
+		else
+			Hierarchies[i].Reset();
 	}
 }
 
+bool FExpandedLateUpdateManager::FLateUpdateGripArray::IsValid(const TArray<FBPActorGripInformation> & GripArray) const
+{
+	if (GripArray.Num() != GripIDs.Num())
+		return false;
+
+	for (int32 i = 0; i < GripArray.Num(); ++i)
+	{
+		const FBPActorGripInformation & Grip = GripArray[i];
+		if (GripIDs[i] != Grip.GripID || GrippedObjects[i] != Grip.GrippedObject || CollisionTypes[i] != Grip.GripCollisionType)
+			return false;
+
+		if (!Hierarchies[i].IsValid())
+			return false;
+	}
+
+	return true;
+}
+
 void FExpandedLateUpdateManager::GatherLateUpdatePrimitives(USceneComponent* ParentComponent, TArray<USceneComponent*> *SkipComponentList)
 {
 	CacheSceneInfo(ParentComponent);
@@ -5293,127 +5994,88 @@ void FExpandedLateUpdateManager::GatherLateUpdatePrimitives(USceneComponent* Par
 	}
 }
 
-void FExpandedLateUpdateManager::ProcessGripArrayLateUpdatePrimitives(UGripMotionControllerComponent * MotionControllerComponent, TArray<FBPActorGripInformation> & GripArray, TArray<USceneComponent*> &SkipComponentList)
+bool FExpandedLateUpdateManager::ShouldLateUpdateGrip(UGripMotionControllerComponent * MotionControllerComponent, const FBPActorGripInformation & Grip, int32 Index, const FGripTickCache & TickCache) const
 {
-	for (FBPActorGripInformation actor : GripArray)
-	{
-		// Skip actors that are colliding if turning off late updates during collision.
-		// Also skip turning off late updates for SweepWithPhysics, as it should always be locked to the hand
-		if (!actor.GrippedObject || actor.GripCollisionType == EGripCollisionType::EventsOnly)
-			continue;
-
-		// Handle late updates even with attachment, we need to add it to a skip list for the primary gatherer to process
-		if (actor.GripCollisionType == EGripCollisionType::AttachmentGrip)
-		{
-			switch (actor.GripTargetType)
-			{
-			case EGripTargetType::ActorGrip:
-			{
-				if (AActor * GrippedActor = actor.GetGrippedActor())
-				{
-					SkipComponentList.Add(GrippedActor->GetRootComponent());
-				}
-			}break;
-			case EGripTargetType::ComponentGrip:
-			{
-				if (UPrimitiveComponent* GrippedComponent = actor.GetGrippedComponent())
-				{
-					SkipComponentList.Add(GrippedComponent);
-				}
-			}break;
-			}
-			//continue;
-		}
+	// Skip actors that are colliding if turning off late updates during collision.
+	// Also skip turning off late updates for SweepWithPhysics, as it should always be locked to the hand
+	if (!Grip.GrippedObject || Grip.GripCollisionType == EGripCollisionType::EventsOnly)
+		return false;
 
-		// Don't allow late updates with server sided movement, there is no point
-		if (actor.GripMovementReplicationSetting == EGripMovementReplicationSettings::ForceServerSideMovement && !MotionControllerComponent->IsServer())
-			continue;
+	// Don't allow late updates with server sided movement, there is no point
+	if (Grip.GripMovementReplicationSetting == EGripMovementReplicationSettings::ForceServerSideMovement && !MotionControllerComponent->IsServer())
+		return false;
 
-		// Don't late update paused grips
-		if (actor.bIsPaused)
-			continue;
+	// Don't late update paused grips
+	if (Grip.bIsPaused)
+		return false;
 
-		switch (actor.GripLateUpdateSetting)
-		{
-		case EGripLateUpdateSettings::LateUpdatesAlwaysOff:
-		{
-			continue;
-		}break;
-		case EGripLateUpdateSettings::NotWhenColliding:
-		{
-			if (actor.bColliding && actor.GripCollisionType != EGripCollisionType::SweepWithPhysics && 
-				actor.GripCollisionType != EGripCollisionType::PhysicsOnly)
-				continue;
-		}break;
-		case EGripLateUpdateSettings::NotWhenDoubleGripping:
-		{
-			if (actor.SecondaryGripInfo.bHasSecondaryAttachment)
-				continue;
-		}break;
-		case EGripLateUpdateSettings::NotWhenCollidingOrDoubleGripping:
+	switch (Grip.GripLateUpdateSetting)
+	{
+	case EGripLateUpdateSettings::LateUpdatesAlwaysOff:
+	{
+		return false;
+	}break;
+	case EGripLateUpdateSettings::NotWhenColliding:
+	{
+		if (Grip.bColliding && Grip.GripCollisionType != EGripCollisionType::SweepWithPhysics &&
+			Grip.GripCollisionType != EGripCollisionType::PhysicsOnly)
+			return false;
+	}break;
+	case EGripLateUpdateSettings::NotWhenDoubleGripping:
+	{
+		if (Grip.SecondaryGripInfo.bHasSecondaryAttachment)
+			return false;
+	}break;
+	case EGripLateUpdateSettings::NotWhenCollidingOrDoubleGripping:
+	{
+		if (
+			(Grip.bColliding && Grip.GripCollisionType != EGripCollisionType::SweepWithPhysics && Grip.GripCollisionType != EGripCollisionType::PhysicsOnly) ||
+			(Grip.SecondaryGripInfo.bHasSecondaryAttachment)
+			)
 		{
-			if (
-				(actor.bColliding && actor.GripCollisionType != EGripCollisionType::SweepWithPhysics && actor.GripCollisionType != EGripCollisionType::PhysicsOnly) ||
-				(actor.SecondaryGripInfo.bHasSecondaryAttachment)
-				)
-			{
-				continue;
-			}
-		}break;
-		case EGripLateUpdateSettings::LateUpdatesAlwaysOn:
-		default:
-		{}break;
+			return false;
 		}
+	}break;
+	case EGripLateUpdateSettings::LateUpdatesAlwaysOn:
+	default:
+	{}break;
+	}
 
-		// Don't run late updates if we have a grip script that denies it
-		if (actor.GrippedObject->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
-		{
-			TArray<UVRGripScriptBase*> GripScripts;
-			if (IVRGripInterface::Execute_GetGripScripts(actor.GrippedObject, GripScripts))
-			{
-				bool bContinueOn = false;
-				for (UVRGripScriptBase* Script : GripScripts)
-				{
-					if (Script && Script->IsScriptActive() && Script->Wants_DenyLateUpdates())
-					{
-						bContinueOn = true;
-						break;
-					}
-				}
-
-				if (bContinueOn)
-					continue;
-			}
-		}
+	// Don't run late updates if we have a grip script that denies it
+	// The tick cache already resolved the scripts for this grip, it prefers the roots scripts so it is only used when those are the gripped objects own
+	TArray<UVRGripScriptBase*> ResolvedGripScripts;
+	const TArray<UVRGripScriptBase*> * GripScripts = nullptr;
 
-		// Get late update primitives
-		switch (actor.GripTargetType)
-		{
-		case EGripTargetType::ActorGrip:
-			//case EGripTargetType::InteractibleActorGrip:
-		{
-			AActor * pActor = actor.GetGrippedActor();
-			if (pActor)
-			{
-				if (USceneComponent * rootComponent = pActor->GetRootComponent())
-				{
-					GatherLateUpdatePrimitives(rootComponent);
-				}
-			}
+	bool bUseTickCache = false;
+	if (TickCache.IsEntryValid(Index, Grip) && TickCache.Roots[Index])
+	{
+		const uint8 Flags = TickCache.InterfaceFlags[Index];
+		if (Grip.GripTargetType == EGripTargetType::ComponentGrip)
+			bUseTickCache = (Flags & FGripTickCache::RootHasInterface) || !(Flags & FGripTickCache::ActorHasInterface);
+		else
+			bUseTickCache = !(Flags & FGripTickCache::RootHasInterface);
+	}
 
-		}break;
+	if (bUseTickCache)
+	{
+		GripScripts = &TickCache.GripScripts[Index];
+	}
+	else if (Grip.GrippedObject->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
+	{
+		if (IVRGripInterface::Execute_GetGripScripts(Grip.GrippedObject, ResolvedGripScripts))
+			GripScripts = &ResolvedGripScripts;
+	}
 
-		case EGripTargetType::ComponentGrip:
-			//case EGripTargetType::InteractibleComponentGrip:
+	if (GripScripts)
+	{
+		for (UVRGripScriptBase* Script : *GripScripts)
 		{
-			UPrimitiveComponent * cPrimComp = actor.GetGrippedComponent();
-			if (cPrimComp)
-			{
-				GatherLateUpdatePrimitives(cPrimComp);
-			}
-		}break;
+			if (Script && Script->IsScriptActive() && Script->Wants_DenyLateUpdates())
+				return false;
 		}
 	}
+
+	return true;
 }
 
 void UGripMotionControllerComponent::GetHandType(EControllerHand& Hand)
@@ -59,6 +59,16 @@ void AGrippableActor::PreReplication(IRepChangedPropertyTracker & ChangedPropert
 	DOREPLIFETIME_ACTIVE_OVERRIDE(AGrippableActor, GameplayTags, bRepGripSettingsAndGameplayTags);
 }
 
+float AGrippableActor::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	const float BasePriority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld(), false))
+		return ReplicationBudget->GetNetPriority(this, Viewer, ViewTarget, ViewPos, BasePriority);
+
+	return BasePriority;
+}
+
 bool AGrippableActor::ReplicateSubobjects(UActorChannel* Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags)
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
@@ -84,6 +94,17 @@ void AGrippableActor::BeginPlay()
 	// Call the base class 
 	Super::BeginPlay();
 
+	// Movement replication of grippables is budgeted per connection in networked games
+	if (GetNetMode() != ENetMode::NM_Standalone)
+	{
+		if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld()))
+			ReplicationBudget->RegisterActor(this, &VRGripInterfaceSettings, &ClientAuthReplicationData);
+	}
+
+	// Lets hands find this grippable without physics overlaps
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld()))
+		SpatialIndex->Register(this, GetRootComponent());
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -190,12 +211,23 @@ bool AGrippableActor::AddToClientReplicationBucket()
 	if (ShouldWeSkipAttachmentReplication(false))
 	{
 		// The subsystem automatically removes entries with the same function signature so its safe to just always add here
-		GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>()->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
+		if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this))
+			BucketSubsystem->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
+
 		ClientAuthReplicationData.bIsCurrentlyClientAuth = true;
+		ClientAuthReplicationData.RestPolls = 0;
 
 		if (UWorld * World = GetWorld())
 			ClientAuthReplicationData.TimeAtInitialThrow = World->GetTimeSeconds();
 
+		// Physics tells us when the body goes to sleep so we don't have to check it every poll
+		if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(GetRootComponent()))
+		{
+			ClientAuthReplicationData.EnableSleepEvents(PrimComp);
+			PrimComp->OnComponentSleep.AddUniqueDynamic(this, &AGrippableActor::OnClientAuthBodySleep);
+			PrimComp->OnComponentWake.AddUniqueDynamic(this, &AGrippableActor::OnClientAuthBodyWake);
+		}
+
 		return true;
 	}
 
@@ -206,7 +238,9 @@ bool AGrippableActor::RemoveFromClientReplicationBucket()
 {
 	if (ClientAuthReplicationData.bIsCurrentlyClientAuth)
 	{
-		GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>()->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+		if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this, false))
+			BucketSubsystem->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+
 		CeaseReplicationBlocking();
 		return true;
 	}
@@ -273,6 +307,13 @@ bool AGrippableActor::PollReplicationEvent()
 
 	if (!CurTransform.GetRotation().Equals(ClientAuthReplicationData.LastActorTransform.GetRotation()) || !CurTransform.GetLocation().Equals(ClientAuthReplicationData.LastActorTransform.GetLocation()))
 	{
+		// Over this frames upload budget, skip the update but keep polling. The transform isn't stored so the next poll still sends
+		if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(OurWorld, false))
+		{
+			if (!ReplicationBudget->AllowClientAuthUpdate(this))
+				return true;
+		}
+
 		ClientAuthReplicationData.LastActorTransform = CurTransform;
 
 		if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(RootComponent))
@@ -285,8 +326,11 @@ bool AGrippableActor::PollReplicationEvent()
 				{
 					Server_GetClientAuthReplication(ClientAuthMovementRep);
 
-					if (PrimComp->RigidBodyIsAwake())
-						return true;
+					// Velocity that has quantized away for a few polls in a row isn't worth sending, put the body to sleep and let the sleep event end the polling
+					if (ClientAuthReplicationData.ShouldForceSleep(ClientAuthMovementRep))
+						PrimComp->PutRigidBodyToSleep();
+
+					return true;
 				}
 			}
 		}
@@ -301,6 +345,17 @@ bool AGrippableActor::PollReplicationEvent()
 		ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
 	}
 
+	QueueCeaseReplicationBlocking();
+
+	return false;
+}
+
+void AGrippableActor::QueueCeaseReplicationBlocking()
+{
+	UWorld *OurWorld = GetWorld();
+	if (!OurWorld)
+		return;
+
 	AActor* TopOwner = GetOwner();
 
 	if (TopOwner != nullptr)
@@ -329,8 +384,47 @@ bool AGrippableActor::PollReplicationEvent()
 			}
 		}
 	}
+}
 
-	return false;
+void AGrippableActor::OnClientAuthBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	// Skeletal meshes report every body, only stop once the root body is asleep
+	if (!ClientAuthReplicationData.bIsCurrentlyClientAuth || !SleepingComponent || SleepingComponent->RigidBodyIsAwake())
+		return;
+
+	// Send the final resting state and stop polling, nothing runs per frame for us until the body wakes back up
+	if (ShouldWeSkipAttachmentReplication(false))
+	{
+		FRepMovementVR ClientAuthMovementRep;
+		if (ClientAuthMovementRep.GatherActorsMovement(this))
+			Server_GetClientAuthReplication(ClientAuthMovementRep);
+	}
+
+	if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this, false))
+		BucketSubsystem->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+
+	ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
+	QueueCeaseReplicationBlocking();
+}
+
+void AGrippableActor::OnClientAuthBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	UWorld * OurWorld = GetWorld();
+	if (!OurWorld || !ClientAuthReplicationData.bIsCurrentlyClientAuth || !ShouldWeSkipAttachmentReplication(false))
+		return;
+
+	// Same time out as the polling
+	if ((OurWorld->GetTimeSeconds() - ClientAuthReplicationData.TimeAtInitialThrow) > 10.0f)
+		return;
+
+	// Knocked awake again before the server took back over, resume sending
+	if (ClientAuthReplicationData.ResetReplicationHandle.IsValid())
+	{
+		OurWorld->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
+	}
+
+	if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this))
+		BucketSubsystem->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
 }
 
 void AGrippableActor::CeaseReplicationBlocking()
@@ -345,6 +439,14 @@ void AGrippableActor::CeaseReplicationBlocking()
 			OurWorld->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
 		}
 	}
+
+	// Done with the sleep events, idle bodies shouldn't cost us anything
+	if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(GetRootComponent()))
+	{
+		PrimComp->OnComponentSleep.RemoveDynamic(this, &AGrippableActor::OnClientAuthBodySleep);
+		PrimComp->OnComponentWake.RemoveDynamic(this, &AGrippableActor::OnClientAuthBodyWake);
+		ClientAuthReplicationData.RestoreSleepEvents(PrimComp);
+	}
 }
 
 void AGrippableActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -352,6 +454,12 @@ void AGrippableActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 	RemoveFromClientReplicationBucket();
 
+	if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld(), false))
+		ReplicationBudget->UnregisterActor(this);
+
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld(), false))
+		SpatialIndex->Unregister(this);
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
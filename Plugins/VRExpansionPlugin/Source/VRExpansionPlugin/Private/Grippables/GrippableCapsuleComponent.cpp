@@ -2,6 +2,7 @@
 
 #include "Grippables/GrippableCapsuleComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "Grippables/GrippableSpatialIndex.h"
 
   //=============================================================================
 UGrippableCapsuleComponent::UGrippableCapsuleComponent(const FObjectInitializer& ObjectInitializer)
@@ -78,6 +79,10 @@ void UGrippableCapsuleComponent::BeginPlay()
 	// Call the base class 
 	Super::BeginPlay();
 
+	// Lets hands find this grippable without physics overlaps
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld()))
+		SpatialIndex->Register(this, this);
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -92,6 +97,9 @@ void UGrippableCapsuleComponent::BeginPlay()
 
 void UGrippableCapsuleComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld(), false))
+		SpatialIndex->Unregister(this);
+
 	// Call the base class 
 	Super::EndPlay(EndPlayReason);
 
@@ -3,6 +3,17 @@
 #include "Grippables/GrippablePhysicsReplication.h"
 #include "UObject/ObjectMacros.h"
 #include "UObject/Interface.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "Grippables/GrippableActor.h"
+#include "Grippables/GrippableStaticMeshActor.h"
+#include "Grippables/GrippableSkeletalMeshActor.h"
+#include "Misc/BucketUpdateSubsystem.h"
+#include "Containers/Ticker.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClientAuthThrow, Log, All);
 
 // I cannot dynamic cast without RTTI so I am using a static var as a declarative in case the user removed our custom replicator
 // We don't want our casts to cause issues.
@@ -11,8 +22,51 @@ namespace VRPhysicsReplicationStatics
 	static bool bHasVRPhysicsReplication = false;
 }
 
+// CVars
+namespace VRPhysicsReplicationCvars
+{
+	static int32 UseOwnerPing = 1;
+	FAutoConsoleVariableRef CVarUseOwnerPing(
+		TEXT("vr.PhysicsReplication.UseOwnerPing"),
+		UseOwnerPing,
+		TEXT("When on, the server extrapolates replicated physics targets by the owning clients one way ping and the time since the target arrived.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+
+	static float PingExtrapolation = -1.0f;
+	FAutoConsoleVariableRef CVarPingExtrapolation(
+		TEXT("vr.PhysicsReplication.PingExtrapolation"),
+		PingExtrapolation,
+		TEXT("Overrides how much of the extrapolation time is applied to replicated physics targets on the server when 0 or higher.\n")
+		TEXT("Negative values (the default) use the PingExtrapolation of the project physics error correction settings."),
+		ECVF_Default);
+
+	static float MaxExtrapolationSeconds = 0.25f;
+	FAutoConsoleVariableRef CVarMaxExtrapolationSeconds(
+		TEXT("vr.PhysicsReplication.MaxExtrapolationSeconds"),
+		MaxExtrapolationSeconds,
+		TEXT("Limit in seconds on how far ahead the server extrapolates a replicated physics target."),
+		ECVF_Default);
+
+	static float RestVelocityQuantization = 1.0f;
+	FAutoConsoleVariableRef CVarRestVelocityQuantization(
+		TEXT("vr.ClientAuthThrow.RestVelocityQuantization"),
+		RestVelocityQuantization,
+		TEXT("Step (in cm/s and deg/s) that client auth thrown objects velocities are quantized to, once both round to zero the body counts as at rest."),
+		ECVF_Default);
+
+	static int32 RestPollsBeforeSleep = 3;
+	FAutoConsoleVariableRef CVarRestPollsBeforeSleep(
+		TEXT("vr.ClientAuthThrow.RestPollsBeforeSleep"),
+		RestPollsBeforeSleep,
+		TEXT("Polls in a row that a client auth thrown object has to be at rest before its body is put to sleep and it stops replicating.\n")
+		TEXT("0: Never, leave sleeping to physics"),
+		ECVF_Default);
+}
+
 FPhysicsReplicationVR::FPhysicsReplicationVR(FPhysScene* PhysScene) :
-	FPhysicsReplication(PhysScene)
+	FPhysicsReplication(PhysScene),
+	CVarSkipSkeletalRepOptimization(IConsoleManager::Get().FindConsoleVariable(TEXT("p.SkipSkeletalRepOptimization")))
 {
 	VRPhysicsReplicationStatics::bHasVRPhysicsReplication = true;
 }
@@ -20,4 +74,335 @@ FPhysicsReplicationVR::FPhysicsReplicationVR(FPhysScene* PhysScene) :
 bool FPhysicsReplicationVR::IsInitialized()
 {
 	return VRPhysicsReplicationStatics::bHasVRPhysicsReplication;
-}
\ No newline at end of file
+}
+
+void FPhysicsReplicationVR::OnTick(float DeltaSeconds, TMap<TWeakObjectPtr<UPrimitiveComponent>, FReplicatedPhysicsTarget>& ComponentsToTargets)
+{
+	UWorld* OwningWorld = GetOwningWorld();
+
+	// Skip all of the custom logic if we aren't the server
+	if (OwningWorld && OwningWorld->GetNetMode() == ENetMode::NM_Client)
+	{
+		return FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
+	}
+
+	// Ping only needs to be looked up once per owner per frame
+	OwnerPingCache.Reset();
+
+	// Targets can be removed (and others added in their place) outside of our tick, drop their cached bodies
+	for (auto CacheItr = CachedTargets.CreateIterator(); CacheItr; ++CacheItr)
+	{
+		if (!CacheItr.Key().IsValid() || !ComponentsToTargets.Contains(CacheItr.Key()))
+		{
+			CacheItr.RemoveCurrent();
+		}
+	}
+
+	FRigidBodyErrorCorrection PhysicErrorCorrection = UPhysicsSettings::Get()->PhysicErrorCorrection;
+	if (VRPhysicsReplicationCvars::PingExtrapolation >= 0.0f)
+	{
+		PhysicErrorCorrection.PingExtrapolation = VRPhysicsReplicationCvars::PingExtrapolation;
+	}
+
+	const float CurrentTimeSeconds = OwningWorld ? OwningWorld->GetTimeSeconds() : 0.0f;
+	const bool bUseOwnerPing = VRPhysicsReplicationCvars::UseOwnerPing != 0;
+	const float MaxExtrapolationSeconds = FMath::Max(VRPhysicsReplicationCvars::MaxExtrapolationSeconds, 0.0f);
+
+	//simulated skeletal mesh does its own polling of physics results so we don't need to sync it, it'll happen at the end of the physics sim
+	const bool bSkipSkeletalSync = CVarSkipSkeletalRepOptimization && CVarSkipSkeletalRepOptimization->GetInt() != 0;
+
+	for (auto Itr = ComponentsToTargets.CreateIterator(); Itr; ++Itr)
+	{
+		FReplicatedPhysicsTarget& PhysicsTarget = Itr.Value();
+		UPrimitiveComponent* PrimComp = Itr.Key().Get();
+		const float TargetAgeSeconds = CurrentTimeSeconds - PhysicsTarget.ArrivedTimeSeconds;
+		bool bRemoveItr = false;
+
+		// Its been more than half a second since the last update, lets cease using the target as a failsafe
+		// Clients will never update with that much latency, and if they somehow are, then they are dropping so many
+		// packets that it will be useless to use their data anyway
+		if (TargetAgeSeconds > 0.5f)
+		{
+			bRemoveItr = true;
+		}
+		else if (PrimComp)
+		{
+			FRigidBodyState& UpdatedState = PhysicsTarget.TargetState;
+			AActor* OwningActor = PrimComp->GetOwner();
+
+			// We will always be the server here, clients were already filtered out to the default logic
+			if (OwningActor && (UpdatedState.Flags & ERigidBodyFlags::NeedsUpdate))
+			{
+				FCachedPhysicsTarget& CachedTarget = CachedTargets.FindOrAdd(Itr.Key());
+
+				if (FBodyInstance* BI = GetTargetBodyInstance(PrimComp, PhysicsTarget, CachedTarget))
+				{
+					// The owning client generated the target one way ping before it arrived, and it has aged since.
+					// Extrapolate it to where the owning client has it now so that thrown objects land where they saw them.
+					float PingSecondsOneWay = 0.0f;
+					if (bUseOwnerPing)
+					{
+						PingSecondsOneWay = FMath::Clamp(GetOwnerPingSecondsOneWay(OwningActor) + TargetAgeSeconds, 0.0f, MaxExtrapolationSeconds);
+					}
+
+					const bool bRestoredState = ApplyRigidBodyState(DeltaSeconds, BI, PhysicsTarget, PhysicErrorCorrection, PingSecondsOneWay);
+
+					// Need to update the component to match new position.
+					if (!bSkipSkeletalSync || !CachedTarget.bIsSkeletal)
+					{
+						PrimComp->SyncComponentToRBPhysics();
+					}
+
+					// Added a sleeping check from the input state as well, we always want to cease activity on sleep
+					if (bRestoredState || ((UpdatedState.Flags & ERigidBodyFlags::Sleeping) != 0))
+					{
+						bRemoveItr = true;
+					}
+				}
+			}
+		}
+
+		if (bRemoveItr)
+		{
+			OnTargetRestored(Itr.Key().Get(), Itr.Value());
+			CachedTargets.Remove(Itr.Key());
+			Itr.RemoveCurrent();
+		}
+	}
+
+	//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Phys Rep Tick!"));
+	//FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
+}
+
+FBodyInstance * FPhysicsReplicationVR::GetTargetBodyInstance(UPrimitiveComponent * PrimComp, const FReplicatedPhysicsTarget & PhysicsTarget, FCachedPhysicsTarget & CachedTarget)
+{
+	if (CachedTarget.bIsResolved && CachedTarget.BoneName == PhysicsTarget.BoneName)
+	{
+		// Non skeletal components hold their body directly, the lookup is trivial
+		if (!CachedTarget.bIsSkeletal)
+		{
+			return PrimComp->GetBodyInstance(PhysicsTarget.BoneName);
+		}
+
+		// Skeletal bodies get recreated along with the physics state, make sure that the index still points to the same bone
+		USkeletalMeshComponent* SkeletalComp = static_cast<USkeletalMeshComponent*>(PrimComp);
+		if (SkeletalComp->Bodies.IsValidIndex(CachedTarget.BodyIndex))
+		{
+			FBodyInstance* BI = SkeletalComp->Bodies[CachedTarget.BodyIndex];
+			if (BI && BI->BodySetup.IsValid() && BI->BodySetup->BoneName == CachedTarget.ResolvedBoneName)
+			{
+				return BI;
+			}
+		}
+	}
+
+	CachedTarget.BoneName = PhysicsTarget.BoneName;
+	CachedTarget.ResolvedBoneName = NAME_None;
+	CachedTarget.BodyIndex = INDEX_NONE;
+	CachedTarget.bIsSkeletal = false;
+	CachedTarget.bIsResolved = false;
+
+	FBodyInstance* BI = PrimComp->GetBodyInstance(PhysicsTarget.BoneName);
+	if (!BI)
+		return nullptr;
+
+	if (USkeletalMeshComponent* SkeletalComp = Cast<USkeletalMeshComponent>(PrimComp))
+	{
+		CachedTarget.bIsSkeletal = true;
+		CachedTarget.BodyIndex = SkeletalComp->Bodies.Find(BI);
+
+		// Not one of the skeletal bodies, leave it unresolved so that it gets looked up every time
+		if (CachedTarget.BodyIndex == INDEX_NONE || !BI->BodySetup.IsValid())
+			return BI;
+
+		CachedTarget.ResolvedBoneName = BI->BodySetup->BoneName;
+	}
+
+	CachedTarget.bIsResolved = true;
+	return BI;
+}
+
+float FPhysicsReplicationVR::GetOwnerPingSecondsOneWay(AActor * OwningActor)
+{
+	UPlayer* OwningPlayer = OwningActor->GetNetOwningPlayer();
+	if (!OwningPlayer)
+		return 0.0f;
+
+	if (const float* CachedPing = OwnerPingCache.Find(OwningPlayer))
+		return *CachedPing;
+
+	// NOTE: We divide by 2 to approximate 1-way ping from 2-way ping.
+	// Our own local ping is always 0 as we are the server.
+	float PingSecondsOneWay = 0.0f;
+	if (APlayerController* PlayerController = OwningPlayer->GetPlayerController(GetOwningWorld()))
+	{
+		if (APlayerState* PlayerState = PlayerController->PlayerState)
+		{
+			PingSecondsOneWay = PlayerState->ExactPing * 0.5f * 0.001f;
+		}
+	}
+
+	OwnerPingCache.Add(OwningPlayer, PingSecondsOneWay);
+	return PingSecondsOneWay;
+}
+
+static void SetBodySleepEvents(FBodyInstance * BI, bool bEnable)
+{
+	if (!BI || BI->bGenerateWakeEvents == bEnable)
+		return;
+
+	BI->bGenerateWakeEvents = bEnable;
+
+	// The flag is only read when the physics actor is created, the actor has to be told directly as well
+	FPhysicsCommand::ExecuteWrite(BI->ActorHandle, [bEnable](const FPhysicsActorHandle & Actor)
+	{
+		FPhysicsInterface::SetSendsSleepNotifies_AssumesLocked(Actor, bEnable);
+	});
+}
+
+static void SetComponentSleepEvents(UPrimitiveComponent * PrimComp, bool bEnable)
+{
+	if (USkeletalMeshComponent * SkeletalComp = Cast<USkeletalMeshComponent>(PrimComp))
+	{
+		for (FBodyInstance * BI : SkeletalComp->Bodies)
+		{
+			SetBodySleepEvents(BI, bEnable);
+		}
+	}
+	else
+	{
+		SetBodySleepEvents(PrimComp->GetBodyInstance(), bEnable);
+	}
+}
+
+void FVRClientAuthReplicationData::EnableSleepEvents(UPrimitiveComponent * PrimComp)
+{
+	if (!PrimComp || bEnabledSleepEvents)
+		return;
+
+	const FBodyInstance * BI = PrimComp->GetBodyInstance();
+	if (BI && BI->bGenerateWakeEvents)
+		return; // Already sending them, leave them alone
+
+	SetComponentSleepEvents(PrimComp, true);
+	bEnabledSleepEvents = true;
+}
+
+void FVRClientAuthReplicationData::RestoreSleepEvents(UPrimitiveComponent * PrimComp)
+{
+	if (!bEnabledSleepEvents)
+		return;
+
+	if (PrimComp)
+	{
+		SetComponentSleepEvents(PrimComp, false);
+	}
+
+	bEnabledSleepEvents = false;
+}
+
+bool FVRClientAuthReplicationData::IsAtRest(const FRepMovement & Movement)
+{
+	const float HalfStep = FMath::Max(VRPhysicsReplicationCvars::RestVelocityQuantization, KINDA_SMALL_NUMBER) * 0.5f;
+	return Movement.LinearVelocity.GetAbsMax() < HalfStep && Movement.AngularVelocity.GetAbsMax() < HalfStep;
+}
+
+bool FVRClientAuthReplicationData::ShouldForceSleep(const FRepMovement & Movement)
+{
+	RestPolls = IsAtRest(Movement) ? RestPolls + 1 : 0;
+	return VRPhysicsReplicationCvars::RestPollsBeforeSleep > 0 && RestPolls >= VRPhysicsReplicationCvars::RestPollsBeforeSleep;
+}
+
+#if !UE_BUILD_SHIPPING
+namespace ClientAuthThrowSettleTest
+{
+	template<class T>
+	static int32 CountClientAuthActors(UWorld * World)
+	{
+		int32 Count = 0;
+		for (TActorIterator<T> It(World); It; ++It)
+		{
+			if (It->ClientAuthReplicationData.bIsCurrentlyClientAuth)
+				++Count;
+		}
+
+		return Count;
+	}
+
+	// Watches the worlds update buckets on a client, after a client auth throw starts polling it logs the entry count every TraceInterval
+	// seconds until it falls to zero and checks that no grippable is still marked as client authed (nothing left costing anything per frame).
+	static void RunSettleTest(const TArray<FString> & Args, UWorld * World)
+	{
+		if (!World || World->GetNetMode() != ENetMode::NM_Client)
+		{
+			UE_LOG(LogClientAuthThrow, Warning, TEXT("vr.ClientAuthThrow.SettleTest has to be run on a client, throw a client auth grippable after starting it."));
+			return;
+		}
+
+		const float Timeout = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 1.0f) : 30.0f;
+		const float TraceInterval = 0.25f;
+
+		TWeakObjectPtr<UWorld> WeakWorld(World);
+		const double StartTime = FPlatformTime::Seconds();
+		double ThrowTime = 0.0;
+		double NextTraceTime = 0.0;
+		int32 PeakEntries = 0;
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float DeltaTime) mutable
+		{
+			UWorld * TestWorld = WeakWorld.Get();
+			if (!TestWorld)
+				return false;
+
+			UBucketUpdateWorldSubsystem * Buckets = UBucketUpdateWorldSubsystem::Get(TestWorld, false);
+			const int32 NumEntries = Buckets ? Buckets->BucketContainer.GetNumEntries() : 0;
+			const double Now = FPlatformTime::Seconds();
+
+			if (ThrowTime == 0.0)
+			{
+				if (NumEntries > 0)
+				{
+					ThrowTime = Now;
+					UE_LOG(LogClientAuthThrow, Log, TEXT("Settle test: throw detected, %d bucket entries"), NumEntries);
+				}
+				else if (Now - StartTime > Timeout)
+				{
+					UE_LOG(LogClientAuthThrow, Warning, TEXT("Settle test: no client auth throw within %.0fs"), Timeout);
+					return false;
+				}
+
+				return true;
+			}
+
+			PeakEntries = FMath::Max(PeakEntries, NumEntries);
+
+			if (Now >= NextTraceTime)
+			{
+				UE_LOG(LogClientAuthThrow, Log, TEXT("Settle test: %.2fs, %d bucket entries"), Now - ThrowTime, NumEntries);
+				NextTraceTime = Now + TraceInterval;
+			}
+
+			if (NumEntries == 0)
+			{
+				const int32 StillClientAuth = CountClientAuthActors<AGrippableActor>(TestWorld) + CountClientAuthActors<AGrippableStaticMeshActor>(TestWorld) + CountClientAuthActors<AGrippableSkeletalMeshActor>(TestWorld);
+				UE_LOG(LogClientAuthThrow, Log, TEXT("Settle test: bucket entries fell to zero %.2fs after the throw (peak %d), %d grippables still client authed"), Now - ThrowTime, PeakEntries, StillClientAuth);
+				return false;
+			}
+
+			if (Now - ThrowTime > Timeout)
+			{
+				UE_LOG(LogClientAuthThrow, Warning, TEXT("Settle test: %d bucket entries left %.0fs after the throw"), NumEntries, Timeout);
+				return false;
+			}
+
+			return true;
+		}));
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs SettleTestCommand(
+		TEXT("vr.ClientAuthThrow.SettleTest"),
+		TEXT("Run on a client, then throw a client auth grippable. Logs the update bucket entry count until it falls to zero after the throw settles.\n")
+		TEXT("Usage: vr.ClientAuthThrow.SettleTest [Timeout=30]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunSettleTest));
+}
+#endif
@@ -0,0 +1,681 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Grippables/GrippableReplicationBudget.h"
+#include "VRBPDatatypes.h"
+#include "VRBaseCharacter.h"
+#include "Grippables/GrippablePhysicsReplication.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogGrippableReplicationBudget);
+
+DECLARE_CYCLE_STAT(TEXT("GrippableReplicationBudget ~ Gather"), STAT_GrippableReplicationBudgetGather, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("GrippableReplicationBudget ~ Rank"), STAT_GrippableReplicationBudgetRank, STATGROUP_Game);
+
+// CVars
+namespace GrippableReplicationBudgetCvars
+{
+	static int32 Enabled = 1;
+	FAutoConsoleVariableRef CVarEnabled(
+		TEXT("vr.ReplicationBudget.Enabled"),
+		Enabled,
+		TEXT("When on, grippable movement replication is prioritized against a per connection byte budget.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+
+	static float BytesPerSecondPerConnection = 10000.0f;
+	FAutoConsoleVariableRef CVarBytesPerSecondPerConnection(
+		TEXT("vr.ReplicationBudget.BytesPerSecondPerConnection"),
+		BytesPerSecondPerConnection,
+		TEXT("Bytes per second of grippable movement that the server sends to each connection before it deprioritizes the rest.\n")
+		TEXT("The default fits around ten props moving at a 30hz net tick, held and thrown props in a typical multiplayer scene, within the engines default 15000 MaxClientRate."),
+		ECVF_Default);
+
+	static float ClientBytesPerSecond = 3000.0f;
+	FAutoConsoleVariableRef CVarClientBytesPerSecond(
+		TEXT("vr.ReplicationBudget.ClientBytesPerSecond"),
+		ClientBytesPerSecond,
+		TEXT("Bytes per second of client auth throw updates that a client sends to the server."),
+		ECVF_Default);
+
+	static float EstimatedBytesPerUpdate = 32.0f;
+	FAutoConsoleVariableRef CVarEstimatedBytesPerUpdate(
+		TEXT("vr.ReplicationBudget.EstimatedBytesPerUpdate"),
+		EstimatedBytesPerUpdate,
+		TEXT("Estimated size in bytes of a single grippable movement update, including the bunch overhead.\n")
+		TEXT("A quantized FRepMovement with velocity is around 25 bytes."),
+		ECVF_Default);
+
+	static float SendRateWindowSeconds = 1.0f;
+	FAutoConsoleVariableRef CVarSendRateWindowSeconds(
+		TEXT("vr.ReplicationBudget.SendRateWindowSeconds"),
+		SendRateWindowSeconds,
+		TEXT("Length of the window that a grippables actual movement update rate is measured over."),
+		ECVF_Default);
+
+	static float DistanceFalloff = 1000.0f;
+	FAutoConsoleVariableRef CVarDistanceFalloff(
+		TEXT("vr.ReplicationBudget.DistanceFalloff"),
+		DistanceFalloff,
+		TEXT("Distance from the viewers HMD (in cm) at which a grippables distance weight has dropped to half."),
+		ECVF_Default);
+
+	static float ReferenceSpeed = 500.0f;
+	FAutoConsoleVariableRef CVarReferenceSpeed(
+		TEXT("vr.ReplicationBudget.ReferenceSpeed"),
+		ReferenceSpeed,
+		TEXT("Speed (in cm/s) at which a grippable gets the full velocity weight."),
+		ECVF_Default);
+
+	static float RecentThrowSeconds = 2.0f;
+	FAutoConsoleVariableRef CVarRecentThrowSeconds(
+		TEXT("vr.ReplicationBudget.RecentThrowSeconds"),
+		RecentThrowSeconds,
+		TEXT("How long after being released a grippable is still prioritized as thrown."),
+		ECVF_Default);
+
+	static float OverBudgetPriorityScale = 0.05f;
+	FAutoConsoleVariableRef CVarOverBudgetPriorityScale(
+		TEXT("vr.ReplicationBudget.OverBudgetPriorityScale"),
+		OverBudgetPriorityScale,
+		TEXT("Scale applied to the net priority of grippables that didn't fit in a connections budget."),
+		ECVF_Default);
+}
+
+namespace GrippableReplicationBudgetStatics
+{
+	static TMap<FObjectKey, TUniquePtr<FGrippableReplicationBudget>> WorldBudgets;
+	static FDelegateHandle OnWorldCleanupHandle;
+
+	// Viewers that haven't asked for a ranking in this many frames are dropped
+	static const uint64 StaleViewerFrames = 600;
+}
+
+FGrippableReplicationBudget::FGrippableReplicationBudget(UWorld * InWorld) :
+	World(InWorld),
+	GatheredFrame(0),
+	GatherSerial(1),
+	bCandidatesDirty(true)
+{
+}
+
+FGrippableReplicationBudget * FGrippableReplicationBudget::Get(UWorld * World, bool bCreateIfMissing)
+{
+	using namespace GrippableReplicationBudgetStatics;
+
+	if (!World)
+		return nullptr;
+
+	if (TUniquePtr<FGrippableReplicationBudget> * Budget = WorldBudgets.Find(FObjectKey(World)))
+		return Budget->Get();
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	if (!OnWorldCleanupHandle.IsValid())
+	{
+		OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([](UWorld * CleanedWorld, bool bSessionEnded, bool bCleanupResources)
+		{
+			WorldBudgets.Remove(FObjectKey(CleanedWorld));
+		});
+	}
+
+	TUniquePtr<FGrippableReplicationBudget> & NewBudget = WorldBudgets.Add(FObjectKey(World), MakeUnique<FGrippableReplicationBudget>(World));
+	return NewBudget.Get();
+}
+
+void FGrippableReplicationBudget::RegisterActor(AActor * Actor, const FBPInterfaceProperties * GripSettings, const FVRClientAuthReplicationData * ClientAuthData)
+{
+	if (!Actor || !GripSettings || !ClientAuthData)
+		return;
+
+	const FObjectKey Key(Actor);
+	const int32 * Index = ActorIndices.Find(Key);
+
+	if (!Index)
+	{
+		Index = &ActorIndices.Add(Key, Actors.AddDefaulted());
+	}
+
+	FRegisteredActor & Registered = Actors[*Index];
+	Registered.Key = Key;
+	Registered.Actor = Actor;
+	Registered.GripSettings = GripSettings;
+	Registered.ClientAuthData = ClientAuthData;
+	Registered.ReleaseTime = -FLT_MAX;
+	Registered.bWasHeld = GripSettings->bIsHeld;
+	Registered.bWasMoving = false;
+	Registered.LastRepLocation = Actor->ReplicatedMovement.Location;
+	Registered.LastRepRotation = Actor->ReplicatedMovement.Rotation;
+	Registered.MeasuredSendRate = -1.0f;
+	Registered.RateWindowStart = 0.0f;
+	Registered.RateWindowSends = 0;
+
+	bCandidatesDirty = true;
+}
+
+void FGrippableReplicationBudget::UnregisterActor(AActor * Actor)
+{
+	if (const int32 * Index = ActorIndices.Find(FObjectKey(Actor)))
+	{
+		RemoveActorAt(*Index);
+	}
+}
+
+void FGrippableReplicationBudget::RemoveActorAt(int32 Index)
+{
+	ActorIndices.Remove(Actors[Index].Key);
+	Actors.RemoveAtSwap(Index, 1, false);
+
+	if (Actors.IsValidIndex(Index))
+	{
+		ActorIndices.Add(Actors[Index].Key, Index);
+	}
+
+	bCandidatesDirty = true;
+}
+
+float FGrippableReplicationBudget::GetScore(const FGrippableReplicationCandidate & Candidate, const FVector & ViewPos)
+{
+	using namespace GrippableReplicationBudgetCvars;
+
+	const float Falloff = FMath::Max(DistanceFalloff, 1.0f);
+	const float DistanceWeight = 1.0f / (1.0f + FVector::DistSquared(Candidate.Location, ViewPos) / (Falloff * Falloff));
+	const float VelocityWeight = FMath::Min(Candidate.Speed / FMath::Max(ReferenceSpeed, 1.0f), 1.0f);
+
+	float Score = DistanceWeight * (0.25f + VelocityWeight);
+
+	// Held and thrown grippables are what players are watching, they always go ahead of loose props
+	if (Candidate.bIsHeld || Candidate.bRecentlyThrown)
+		Score += 2.0f;
+
+	return Score;
+}
+
+void FGrippableReplicationBudget::SpendBudget(const TArray<FGrippableReplicationCandidate> & Candidates, const FVector & ViewPos, float BytesPerSecondBudget, TArray<float> & Scores, TArray<int32> & SortedIndices, TBitArray<> & OutInBudget)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrippableReplicationBudgetRank);
+
+	const int32 NumCandidates = Candidates.Num();
+	Scores.SetNumUninitialized(NumCandidates, false);
+	SortedIndices.SetNumUninitialized(NumCandidates, false);
+
+	for (int32 i = 0; i < NumCandidates; ++i)
+	{
+		Scores[i] = GetScore(Candidates[i], ViewPos);
+		SortedIndices[i] = i;
+	}
+
+	SortedIndices.Sort([&Scores](int32 A, int32 B)
+	{
+		return Scores[A] > Scores[B];
+	});
+
+	OutInBudget.Init(false, NumCandidates);
+
+	float Spent = 0.0f;
+	for (int32 Index : SortedIndices)
+	{
+		const float Cost = Candidates[Index].BytesPerSecond;
+
+		// Nothing to send costs nothing, a cheaper lower priority grippable can still use what is left over
+		if (Cost <= 0.0f || Spent + Cost <= BytesPerSecondBudget)
+		{
+			Spent += FMath::Max(Cost, 0.0f);
+			OutInBudget[Index] = true;
+		}
+	}
+}
+
+void FGrippableReplicationBudget::GatherCandidates()
+{
+	if (!bCandidatesDirty && GatheredFrame == GFrameCounter)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GrippableReplicationBudgetGather);
+
+	using namespace GrippableReplicationBudgetCvars;
+
+	UWorld * OurWorld = World.Get();
+	const float CurrentTime = OurWorld ? OurWorld->GetTimeSeconds() : 0.0f;
+	const float RealTime = OurWorld ? OurWorld->GetRealTimeSeconds() : 0.0f;
+	const bool bIsClient = OurWorld && OurWorld->GetNetMode() == ENetMode::NM_Client;
+
+	// Movement can't go out more often than the server ticks its net driver
+	UNetDriver * NetDriver = OurWorld ? OurWorld->GetNetDriver() : nullptr;
+	const float NetTickRate = (NetDriver && NetDriver->NetServerMaxTickRate > 0) ? (float)NetDriver->NetServerMaxTickRate : FLT_MAX;
+
+	// Clean out anything that went away without unregistering
+	for (int32 i = Actors.Num() - 1; i >= 0; --i)
+	{
+		if (!Actors[i].Actor.IsValid())
+		{
+			RemoveActorAt(i);
+		}
+	}
+
+	Candidates.SetNum(Actors.Num(), false);
+
+	for (int32 i = 0; i < Actors.Num(); ++i)
+	{
+		FRegisteredActor & Registered = Actors[i];
+		AActor * Actor = Registered.Actor.Get();
+		FGrippableReplicationCandidate & Candidate = Candidates[i];
+
+		const bool bIsHeld = Registered.GripSettings->bIsHeld;
+		if (Registered.bWasHeld && !bIsHeld)
+		{
+			Registered.ReleaseTime = CurrentTime;
+		}
+		Registered.bWasHeld = bIsHeld;
+
+		Candidate.Location = Actor->GetActorLocation();
+		Candidate.Speed = Actor->GetVelocity().Size();
+		Candidate.bIsHeld = bIsHeld;
+		Candidate.bRecentlyThrown = (CurrentTime - Registered.ReleaseTime) < RecentThrowSeconds;
+
+		UPrimitiveComponent * RootPrim = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+		const bool bIsMoving = bIsHeld || Candidate.Speed > 1.0f || (RootPrim && RootPrim->IsSimulatingPhysics() && RootPrim->RigidBodyIsAwake());
+
+		if (!bIsMoving)
+		{
+			Candidate.BytesPerSecond = 0.0f;
+		}
+		else if (bIsClient)
+		{
+			Candidate.BytesPerSecond = Registered.ClientAuthData->bIsCurrentlyClientAuth ? EstimatedBytesPerUpdate * Registered.ClientAuthData->UpdateRate : 0.0f;
+		}
+		else if (Actor->bReplicateMovement)
+		{
+			Candidate.BytesPerSecond = EstimatedBytesPerUpdate * GetServerSendRate(Registered, Actor, NetTickRate, RealTime, !Registered.bWasMoving);
+		}
+		else
+		{
+			Candidate.BytesPerSecond = 0.0f;
+		}
+
+		Registered.bWasMoving = bIsMoving;
+	}
+
+	for (auto Itr = ViewerBudgets.CreateIterator(); Itr; ++Itr)
+	{
+		if (Itr.Value().LastUsedFrame + GrippableReplicationBudgetStatics::StaleViewerFrames < GFrameCounter)
+		{
+			Itr.RemoveCurrent();
+		}
+	}
+
+	GatheredFrame = GFrameCounter;
+	bCandidatesDirty = false;
+	++GatherSerial;
+}
+
+float FGrippableReplicationBudget::GetServerSendRate(FRegisteredActor & Registered, AActor * Actor, float NetTickRate, float RealTime, bool bStartedMoving)
+{
+	using namespace GrippableReplicationBudgetCvars;
+
+	const float MaxSendRate = FMath::Min(Actor->NetUpdateFrequency, NetTickRate);
+
+	// The replicated movement is gathered once per net update, every change in it is an update that goes out to the relevant connections
+	const FRepMovement & RepMovement = Actor->ReplicatedMovement;
+	if (!RepMovement.Location.Equals(Registered.LastRepLocation, 0.0f) || !RepMovement.Rotation.Equals(Registered.LastRepRotation, 0.0f))
+	{
+		Registered.LastRepLocation = RepMovement.Location;
+		Registered.LastRepRotation = RepMovement.Rotation;
+		++Registered.RateWindowSends;
+	}
+
+	// A window that covers time at rest would under price a grippable that just started moving, start over instead
+	if (bStartedMoving)
+	{
+		Registered.MeasuredSendRate = -1.0f;
+		Registered.RateWindowStart = RealTime;
+		Registered.RateWindowSends = 0;
+	}
+	else if (RealTime - Registered.RateWindowStart >= FMath::Max(SendRateWindowSeconds, 0.1f))
+	{
+		Registered.MeasuredSendRate = Registered.RateWindowSends / (RealTime - Registered.RateWindowStart);
+		Registered.RateWindowStart = RealTime;
+		Registered.RateWindowSends = 0;
+	}
+
+	return Registered.MeasuredSendRate < 0.0f ? MaxSendRate : FMath::Min(Registered.MeasuredSendRate, MaxSendRate);
+}
+
+const TBitArray<> & FGrippableReplicationBudget::RankForViewer(const FObjectKey & ViewerKey, const FVector & ViewPos, float BytesPerSecondBudget)
+{
+	FViewerBudget & ViewerBudget = ViewerBudgets.FindOrAdd(ViewerKey);
+	ViewerBudget.LastUsedFrame = GFrameCounter;
+
+	// One ranking per viewer per frame, every grippable asking for this viewer afterwards shares it
+	if (ViewerBudget.RankedSerial != GatherSerial)
+	{
+		SpendBudget(Candidates, ViewPos, BytesPerSecondBudget, ScoreScratch, SortScratch, ViewerBudget.InBudget);
+		ViewerBudget.RankedSerial = GatherSerial;
+	}
+
+	return ViewerBudget.InBudget;
+}
+
+float FGrippableReplicationBudget::GetNetPriority(AActor * Actor, AActor * Viewer, AActor * ViewTarget, const FVector & ViewPos, float BasePriority)
+{
+	using namespace GrippableReplicationBudgetCvars;
+
+	if (!Enabled || !ActorIndices.Contains(FObjectKey(Actor)))
+		return BasePriority;
+
+	GatherCandidates();
+
+	const int32 * Index = ActorIndices.Find(FObjectKey(Actor));
+	if (!Index)
+		return BasePriority;
+
+	// Rank against the HMD when the connection is viewing a VR character
+	FVector HeadLocation = ViewPos;
+	if (AVRBaseCharacter * VRCharacter = Cast<AVRBaseCharacter>(ViewTarget))
+	{
+		HeadLocation = VRCharacter->GetVRHeadLocation();
+	}
+
+	const TBitArray<> & InBudget = RankForViewer(FObjectKey(Viewer), HeadLocation, BytesPerSecondPerConnection);
+
+	if (InBudget[*Index])
+	{
+		return BasePriority * (1.0f + GetScore(Candidates[*Index], HeadLocation));
+	}
+
+	return BasePriority * OverBudgetPriorityScale;
+}
+
+bool FGrippableReplicationBudget::AllowClientAuthUpdate(AActor * Actor)
+{
+	using namespace GrippableReplicationBudgetCvars;
+
+	if (!Enabled || !ActorIndices.Contains(FObjectKey(Actor)))
+		return true;
+
+	GatherCandidates();
+
+	const int32 * Index = ActorIndices.Find(FObjectKey(Actor));
+	UWorld * OurWorld = World.Get();
+	if (!Index || !OurWorld)
+		return true;
+
+	FVector ViewPos = FVector::ZeroVector;
+	APlayerController * PlayerController = OurWorld->GetFirstPlayerController();
+	if (PlayerController)
+	{
+		if (AVRBaseCharacter * VRCharacter = Cast<AVRBaseCharacter>(PlayerController->GetPawn()))
+		{
+			ViewPos = VRCharacter->GetVRHeadLocation();
+		}
+		else
+		{
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewPos, ViewRotation);
+		}
+	}
+
+	return RankForViewer(FObjectKey(PlayerController), ViewPos, ClientBytesPerSecond)[*Index];
+}
+
+#if !UE_BUILD_SHIPPING
+namespace GrippableReplicationBudgetSoak
+{
+	struct FSoakProp
+	{
+		FVector Location;
+		FVector Velocity;
+		float ReleaseTime;
+		float RestTime;
+	};
+
+	struct FSentState
+	{
+		FVector Location;
+		FVector Velocity;
+		float Time;
+	};
+
+	struct FSoakResult
+	{
+		double Bytes;
+		double ErrorSum;
+		double WeightedErrorSum;
+		double WeightSum;
+		float MaxNearError;
+		int64 Samples;
+
+		FSoakResult() :
+			Bytes(0.0),
+			ErrorSum(0.0),
+			WeightedErrorSum(0.0),
+			WeightSum(0.0),
+			MaxNearError(0.0f),
+			Samples(0)
+		{}
+	};
+
+	static void LogResult(const TCHAR * Name, const FSoakResult & Result, float Seconds, int32 NumViewers)
+	{
+		UE_LOG(LogGrippableReplicationBudget, Log, TEXT("  %s: %.0f B/s per connection, mean error %.2fcm, view weighted error %.2fcm, max error near a viewer %.2fcm"),
+			Name, Result.Bytes / (Seconds * NumViewers), Result.ErrorSum / FMath::Max<int64>(Result.Samples, 1), Result.WeightedErrorSum / FMath::Max(Result.WeightSum, SMALL_NUMBER), Result.MaxNearError);
+	}
+
+	// Simulates loose, thrown and held props seen by several connections at the net tick rate. Each connection only receives the props
+	// that its budget selects and extrapolates the rest from the last state it received. Compares the priority budget against spending the
+	// same budget on randomly picked props.
+	static void RunSoakTest(const TArray<FString> & Args)
+	{
+		using namespace GrippableReplicationBudgetCvars;
+
+		const int32 NumProps = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500;
+		const int32 NumViewers = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 8;
+		const float Seconds = Args.Num() > 2 ? FMath::Max(FCString::Atof(*Args[2]), 1.0f) : 30.0f;
+		const float BytesPerSecond = Args.Num() > 3 ? FMath::Max(FCString::Atof(*Args[3]), 0.0f) : BytesPerSecondPerConnection;
+
+		const float NetTickRate = 30.0f;
+		const float DeltaTime = 1.0f / NetTickRate;
+		const float WorldExtent = 5000.0f;
+		const float ThrowsPerSecond = 4.0f;
+		const float Gravity = -980.0f;
+		const float NearViewerDistance = 500.0f;
+		const int32 NumSteps = FMath::CeilToInt(Seconds * NetTickRate);
+
+		FRandomStream Stream(0x50A4);
+
+		TArray<FSoakProp> Props;
+		Props.SetNum(NumProps);
+		for (FSoakProp & Prop : Props)
+		{
+			Prop.Location = FVector(Stream.FRandRange(-WorldExtent, WorldExtent), Stream.FRandRange(-WorldExtent, WorldExtent), 0.0f);
+			Prop.Velocity = FVector::ZeroVector;
+			Prop.ReleaseTime = -FLT_MAX;
+			Prop.RestTime = -FLT_MAX;
+		}
+
+		TArray<FVector> Viewers;
+		for (int32 i = 0; i < NumViewers; ++i)
+		{
+			Viewers.Add(FVector(Stream.FRandRange(-WorldExtent, WorldExtent), Stream.FRandRange(-WorldExtent, WorldExtent), 170.0f));
+		}
+
+		// What every connection last received for every prop, for both strategies
+		TArray<FSentState> PrioritySent;
+		TArray<FSentState> RandomSent;
+		PrioritySent.SetNum(NumProps * NumViewers);
+		for (int32 i = 0; i < PrioritySent.Num(); ++i)
+		{
+			PrioritySent[i].Location = Props[i % NumProps].Location;
+			PrioritySent[i].Velocity = FVector::ZeroVector;
+			PrioritySent[i].Time = 0.0f;
+		}
+		RandomSent = PrioritySent;
+
+		FSoakResult PriorityResult;
+		FSoakResult RandomResult;
+		double UnbudgetedBytes = 0.0;
+
+		TArray<FGrippableReplicationCandidate> Candidates;
+		Candidates.SetNum(NumProps);
+		TArray<float> Scores;
+		TArray<int32> SortedIndices;
+		TArray<int32> RandomOrder;
+		TBitArray<> InBudget;
+		TBitArray<> RandomInBudget;
+
+		auto Measure = [&](FSoakResult & Result, const TArray<FSentState> & Sent, int32 ViewerIndex, float Time)
+		{
+			for (int32 PropIndex = 0; PropIndex < NumProps; ++PropIndex)
+			{
+				const FSentState & State = Sent[ViewerIndex * NumProps + PropIndex];
+				const FVector Predicted = State.Location + State.Velocity * (Time - State.Time);
+				const float Error = FVector::Dist(Predicted, Props[PropIndex].Location);
+				const float Distance = FVector::Dist(Props[PropIndex].Location, Viewers[ViewerIndex]);
+				const float Weight = 1.0f / (1.0f + FMath::Square(Distance / FMath::Max(DistanceFalloff, 1.0f)));
+
+				Result.ErrorSum += Error;
+				Result.WeightedErrorSum += Error * Weight;
+				Result.WeightSum += Weight;
+				++Result.Samples;
+
+				if (Distance < NearViewerDistance)
+					Result.MaxNearError = FMath::Max(Result.MaxNearError, Error);
+			}
+		};
+
+		const double StartTime = FPlatformTime::Seconds();
+		float Time = 0.0f;
+
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			Time += DeltaTime;
+
+			// Every viewer holds one prop and waves it around in front of them
+			for (int32 ViewerIndex = 0; ViewerIndex < NumViewers && ViewerIndex < NumProps; ++ViewerIndex)
+			{
+				FSoakProp & Held = Props[ViewerIndex];
+				const FVector NewLocation = Viewers[ViewerIndex] + FVector(FMath::Cos(Time * 3.0f) * 50.0f, FMath::Sin(Time * 3.0f) * 50.0f, -40.0f);
+				Held.Velocity = (NewLocation - Held.Location) / DeltaTime;
+				Held.Location = NewLocation;
+			}
+
+			if (Stream.FRand() < ThrowsPerSecond * DeltaTime && NumProps > NumViewers)
+			{
+				FSoakProp & Thrown = Props[Stream.RandRange(NumViewers, NumProps - 1)];
+				Thrown.Velocity = Stream.GetUnitVector() * Stream.FRandRange(300.0f, 1500.0f);
+				Thrown.Velocity.Z = FMath::Abs(Thrown.Velocity.Z);
+				Thrown.ReleaseTime = Time;
+			}
+
+			for (int32 PropIndex = NumViewers; PropIndex < NumProps; ++PropIndex)
+			{
+				FSoakProp & Prop = Props[PropIndex];
+				if (Prop.Velocity.IsZero())
+					continue;
+
+				Prop.Velocity.Z += Gravity * DeltaTime;
+				Prop.Location += Prop.Velocity * DeltaTime;
+
+				if (Prop.Location.Z < 0.0f)
+				{
+					Prop.Location.Z = 0.0f;
+					Prop.Velocity *= FVector(0.7f, 0.7f, -0.4f);
+
+					if (Prop.Velocity.SizeSquared() < FMath::Square(20.0f))
+					{
+						Prop.Velocity = FVector::ZeroVector;
+						Prop.RestTime = Time;
+					}
+				}
+			}
+
+			for (int32 PropIndex = 0; PropIndex < NumProps; ++PropIndex)
+			{
+				const FSoakProp & Prop = Props[PropIndex];
+				FGrippableReplicationCandidate & Candidate = Candidates[PropIndex];
+				Candidate.Location = Prop.Location;
+				Candidate.Speed = Prop.Velocity.Size();
+				Candidate.bIsHeld = PropIndex < NumViewers;
+				Candidate.bRecentlyThrown = (Time - Prop.ReleaseTime) < RecentThrowSeconds;
+
+				// Props that just came to rest still have their final state to send
+				const bool bIsMoving = Candidate.bIsHeld || !Prop.Velocity.IsZero() || (Time - Prop.RestTime) < 0.5f;
+				Candidate.BytesPerSecond = bIsMoving ? EstimatedBytesPerUpdate * NetTickRate : 0.0f;
+
+				if (bIsMoving)
+					UnbudgetedBytes += EstimatedBytesPerUpdate * NumViewers;
+			}
+
+			for (int32 ViewerIndex = 0; ViewerIndex < NumViewers; ++ViewerIndex)
+			{
+				FGrippableReplicationBudget::SpendBudget(Candidates, Viewers[ViewerIndex], BytesPerSecond, Scores, SortedIndices, InBudget);
+
+				// Same budget spent on props in a random order
+				RandomOrder.SetNumUninitialized(NumProps, false);
+				for (int32 i = 0; i < NumProps; ++i)
+				{
+					RandomOrder[i] = i;
+				}
+				for (int32 i = NumProps - 1; i > 0; --i)
+				{
+					RandomOrder.Swap(i, Stream.RandRange(0, i));
+				}
+
+				RandomInBudget.Init(false, NumProps);
+				float RandomSpent = 0.0f;
+				for (int32 PropIndex : RandomOrder)
+				{
+					const float Cost = Candidates[PropIndex].BytesPerSecond;
+					if (Cost <= 0.0f || RandomSpent + Cost <= BytesPerSecond)
+					{
+						RandomSpent += Cost;
+						RandomInBudget[PropIndex] = true;
+					}
+				}
+
+				for (int32 PropIndex = 0; PropIndex < NumProps; ++PropIndex)
+				{
+					if (Candidates[PropIndex].BytesPerSecond <= 0.0f)
+						continue;
+
+					const FSentState NewState = { Props[PropIndex].Location, Props[PropIndex].Velocity, Time };
+
+					if (InBudget[PropIndex])
+					{
+						PrioritySent[ViewerIndex * NumProps + PropIndex] = NewState;
+						PriorityResult.Bytes += EstimatedBytesPerUpdate;
+					}
+
+					if (RandomInBudget[PropIndex])
+					{
+						RandomSent[ViewerIndex * NumProps + PropIndex] = NewState;
+						RandomResult.Bytes += EstimatedBytesPerUpdate;
+					}
+				}
+
+				Measure(PriorityResult, PrioritySent, ViewerIndex, Time);
+				Measure(RandomResult, RandomSent, ViewerIndex, Time);
+			}
+		}
+
+		const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+		const float SimulatedSeconds = NumSteps * DeltaTime;
+
+		UE_LOG(LogGrippableReplicationBudget, Log, TEXT("Replication budget soak: %d props, %d connections, %.0fs at %.0fhz, budget %.0f B/s per connection (%.2fms to run)"),
+			NumProps, NumViewers, SimulatedSeconds, NetTickRate, BytesPerSecond, ElapsedTime * 1000.0);
+		UE_LOG(LogGrippableReplicationBudget, Log, TEXT("  Unbudgeted: %.0f B/s per connection"), UnbudgetedBytes / (SimulatedSeconds * NumViewers));
+		LogResult(TEXT("Priority"), PriorityResult, SimulatedSeconds, NumViewers);
+		LogResult(TEXT("Random"), RandomResult, SimulatedSeconds, NumViewers);
+	}
+
+	static FAutoConsoleCommandWithArgs SoakCommand(
+		TEXT("vr.ReplicationBudget.Soak"),
+		TEXT("Simulates props replicating to several connections under the grippable replication budget and reports bandwidth used against extrapolation error.\n")
+		TEXT("Usage: vr.ReplicationBudget.Soak [Props=500] [Connections=8] [Seconds=30] [BytesPerSecond=vr.ReplicationBudget.BytesPerSecondPerConnection]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunSoakTest));
+}
+#endif
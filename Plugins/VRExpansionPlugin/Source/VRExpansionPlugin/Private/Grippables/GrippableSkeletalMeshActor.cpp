@@ -81,6 +81,16 @@ void AGrippableSkeletalMeshActor::PreReplication(IRepChangedPropertyTracker & Ch
 	DOREPLIFETIME_ACTIVE_OVERRIDE(AGrippableSkeletalMeshActor, GameplayTags, bRepGripSettingsAndGameplayTags);
 }
 
+float AGrippableSkeletalMeshActor::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	const float BasePriority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld(), false))
+		return ReplicationBudget->GetNetPriority(this, Viewer, ViewTarget, ViewPos, BasePriority);
+
+	return BasePriority;
+}
+
 bool AGrippableSkeletalMeshActor::ReplicateSubobjects(UActorChannel* Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags)
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
@@ -111,6 +121,17 @@ void AGrippableSkeletalMeshActor::BeginPlay()
 	// Call the base class 
 	Super::BeginPlay();
 
+	// Movement replication of grippables is budgeted per connection in networked games
+	if (GetNetMode() != ENetMode::NM_Standalone)
+	{
+		if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld()))
+			ReplicationBudget->RegisterActor(this, &VRGripInterfaceSettings, &ClientAuthReplicationData);
+	}
+
+	// Lets hands find this grippable without physics overlaps
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld()))
+		SpatialIndex->Register(this, GetRootComponent());
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -216,12 +237,23 @@ bool AGrippableSkeletalMeshActor::AddToClientReplicationBucket()
 	if (ShouldWeSkipAttachmentReplication(false))
 	{
 		// The subsystem automatically removes entries with the same function signature so its safe to just always add here
-		GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>()->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
+		if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this))
+			BucketSubsystem->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
+
 		ClientAuthReplicationData.bIsCurrentlyClientAuth = true;
+		ClientAuthReplicationData.RestPolls = 0;
 
 		if (UWorld * World = GetWorld())
 			ClientAuthReplicationData.TimeAtInitialThrow = World->GetTimeSeconds();
 
+		// Physics tells us when the body goes to sleep so we don't have to check it every poll
+		if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(GetRootComponent()))
+		{
+			ClientAuthReplicationData.EnableSleepEvents(PrimComp);
+			PrimComp->OnComponentSleep.AddUniqueDynamic(this, &AGrippableSkeletalMeshActor::OnClientAuthBodySleep);
+			PrimComp->OnComponentWake.AddUniqueDynamic(this, &AGrippableSkeletalMeshActor::OnClientAuthBodyWake);
+		}
+
 		return true;
 	}
 
@@ -232,7 +264,9 @@ bool AGrippableSkeletalMeshActor::RemoveFromClientReplicationBucket()
 {
 	if (ClientAuthReplicationData.bIsCurrentlyClientAuth)
 	{
-		GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>()->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+		if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this, false))
+			BucketSubsystem->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+
 		CeaseReplicationBlocking();
 		return true;
 	}
@@ -299,6 +333,13 @@ bool AGrippableSkeletalMeshActor::PollReplicationEvent()
 
 	if (!CurTransform.GetRotation().Equals(ClientAuthReplicationData.LastActorTransform.GetRotation()) || !CurTransform.GetLocation().Equals(ClientAuthReplicationData.LastActorTransform.GetLocation()))
 	{
+		// Over this frames upload budget, skip the update but keep polling. The transform isn't stored so the next poll still sends
+		if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(OurWorld, false))
+		{
+			if (!ReplicationBudget->AllowClientAuthUpdate(this))
+				return true;
+		}
+
 		ClientAuthReplicationData.LastActorTransform = CurTransform;
 
 		if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(RootComponent))
@@ -311,8 +352,11 @@ bool AGrippableSkeletalMeshActor::PollReplicationEvent()
 				{
 					Server_GetClientAuthReplication(ClientAuthMovementRep);
 
-					if (PrimComp->RigidBodyIsAwake())
-						return true;
+					// Velocity that has quantized away for a few polls in a row isn't worth sending, put the body to sleep and let the sleep event end the polling
+					if (ClientAuthReplicationData.ShouldForceSleep(ClientAuthMovementRep))
+						PrimComp->PutRigidBodyToSleep();
+
+					return true;
 				}
 			}
 		}
@@ -327,6 +371,17 @@ bool AGrippableSkeletalMeshActor::PollReplicationEvent()
 		ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
 	}
 
+	QueueCeaseReplicationBlocking();
+
+	return false;
+}
+
+void AGrippableSkeletalMeshActor::QueueCeaseReplicationBlocking()
+{
+	UWorld *OurWorld = GetWorld();
+	if (!OurWorld)
+		return;
+
 	AActor* TopOwner = GetOwner();
 
 	if (TopOwner != nullptr)
@@ -355,8 +410,47 @@ bool AGrippableSkeletalMeshActor::PollReplicationEvent()
 			}
 		}
 	}
+}
 
-	return false;
+void AGrippableSkeletalMeshActor::OnClientAuthBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	// Skeletal meshes report every body, only stop once the root body is asleep
+	if (!ClientAuthReplicationData.bIsCurrentlyClientAuth || !SleepingComponent || SleepingComponent->RigidBodyIsAwake())
+		return;
+
+	// Send the final resting state and stop polling, nothing runs per frame for us until the body wakes back up
+	if (ShouldWeSkipAttachmentReplication(false))
+	{
+		FRepMovementVR ClientAuthMovementRep;
+		if (ClientAuthMovementRep.GatherActorsMovement(this))
+			Server_GetClientAuthReplication(ClientAuthMovementRep);
+	}
+
+	if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this, false))
+		BucketSubsystem->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+
+	ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
+	QueueCeaseReplicationBlocking();
+}
+
+void AGrippableSkeletalMeshActor::OnClientAuthBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	UWorld * OurWorld = GetWorld();
+	if (!OurWorld || !ClientAuthReplicationData.bIsCurrentlyClientAuth || !ShouldWeSkipAttachmentReplication(false))
+		return;
+
+	// Same time out as the polling
+	if ((OurWorld->GetTimeSeconds() - ClientAuthReplicationData.TimeAtInitialThrow) > 10.0f)
+		return;
+
+	// Knocked awake again before the server took back over, resume sending
+	if (ClientAuthReplicationData.ResetReplicationHandle.IsValid())
+	{
+		OurWorld->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
+	}
+
+	if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this))
+		BucketSubsystem->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
 }
 
 void AGrippableSkeletalMeshActor::CeaseReplicationBlocking()
@@ -371,12 +465,26 @@ void AGrippableSkeletalMeshActor::CeaseReplicationBlocking()
 			OurWorld->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
 		}
 	}
+
+	// Done with the sleep events, idle bodies shouldn't cost us anything
+	if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(GetRootComponent()))
+	{
+		PrimComp->OnComponentSleep.RemoveDynamic(this, &AGrippableSkeletalMeshActor::OnClientAuthBodySleep);
+		PrimComp->OnComponentWake.RemoveDynamic(this, &AGrippableSkeletalMeshActor::OnClientAuthBodyWake);
+		ClientAuthReplicationData.RestoreSleepEvents(PrimComp);
+	}
 }
 
 void AGrippableSkeletalMeshActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	RemoveFromClientReplicationBucket();
 
+	if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld(), false))
+		ReplicationBudget->UnregisterActor(this);
+
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld(), false))
+		SpatialIndex->Unregister(this);
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -0,0 +1,537 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Grippables/GrippableSpatialIndex.h"
+#include "VRGripInterface.h"
+#include "VRBaseCharacter.h"
+#include "GripMotionControllerComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogGrippableSpatialIndex);
+
+DECLARE_CYCLE_STAT(TEXT("GrippableSpatialIndex ~ Query"), STAT_GrippableSpatialIndexQuery, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("GrippableSpatialIndex ~ Move"), STAT_GrippableSpatialIndexMove, STATGROUP_Game);
+
+// CVars
+namespace GrippableSpatialIndexCvars
+{
+	static float CellSize = 100.0f;
+	FAutoConsoleVariableRef CVarCellSize(
+		TEXT("vr.GrippableQuery.CellSize"),
+		CellSize,
+		TEXT("Size (in cm) of the cells of the grippable query hash, grippables with a larger radius are checked by every query."),
+		ECVF_Default);
+}
+
+namespace GrippableSpatialIndexStatics
+{
+	static TMap<FObjectKey, TUniquePtr<FGrippableSpatialIndex>> WorldIndices;
+	static FDelegateHandle OnWorldCleanupHandle;
+
+	static float GetCellSizeSetting()
+	{
+		return FMath::Max(GrippableSpatialIndexCvars::CellSize, 1.0f);
+	}
+}
+
+FGrippableSpatialHash::FGrippableSpatialHash(float InCellSize) :
+	CellSize(InCellSize),
+	InvCellSize(1.0f / InCellSize),
+	FirstFreeEntry(INDEX_NONE),
+	NumUsedEntries(0)
+{
+}
+
+FIntVector FGrippableSpatialHash::GetCell(const FVector & Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize), FMath::FloorToInt(Location.Z * InvCellSize));
+}
+
+int32 FGrippableSpatialHash::Add(const FVector & Location, float Radius)
+{
+	int32 Id = FirstFreeEntry;
+
+	if (Id != INDEX_NONE)
+	{
+		FirstFreeEntry = Entries[Id].NextFree;
+	}
+	else
+	{
+		Id = Entries.AddDefaulted();
+	}
+
+	FEntry & Entry = Entries[Id];
+	Entry.Location = Location;
+	Entry.Radius = Radius;
+	Entry.NextFree = INDEX_NONE;
+	Entry.bInUse = true;
+	++NumUsedEntries;
+
+	Link(Id);
+	return Id;
+}
+
+void FGrippableSpatialHash::Update(int32 Id, const FVector & Location, float Radius)
+{
+	if (!Entries.IsValidIndex(Id) || !Entries[Id].bInUse)
+		return;
+
+	FEntry & Entry = Entries[Id];
+	const bool bOversized = Radius > CellSize;
+
+	// Only moving to another cell touches the hash
+	if (bOversized != Entry.bOversized || (!bOversized && GetCell(Location) != Entry.Cell))
+	{
+		Unlink(Id);
+		Entry.Location = Location;
+		Entry.Radius = Radius;
+		Link(Id);
+	}
+	else
+	{
+		Entry.Location = Location;
+		Entry.Radius = Radius;
+	}
+}
+
+void FGrippableSpatialHash::Remove(int32 Id)
+{
+	if (!Entries.IsValidIndex(Id) || !Entries[Id].bInUse)
+		return;
+
+	Unlink(Id);
+
+	FEntry & Entry = Entries[Id];
+	Entry.bInUse = false;
+	Entry.NextFree = FirstFreeEntry;
+	FirstFreeEntry = Id;
+	--NumUsedEntries;
+}
+
+void FGrippableSpatialHash::SetCellSize(float InCellSize)
+{
+	if (InCellSize == CellSize || InCellSize <= 0.0f)
+		return;
+
+	CellSize = InCellSize;
+	InvCellSize = 1.0f / InCellSize;
+
+	Cells.Reset();
+	Oversized.Reset();
+
+	for (int32 Id = 0; Id < Entries.Num(); ++Id)
+	{
+		if (Entries[Id].bInUse)
+			Link(Id);
+	}
+}
+
+void FGrippableSpatialHash::Link(int32 Id)
+{
+	FEntry & Entry = Entries[Id];
+	Entry.bOversized = Entry.Radius > CellSize;
+
+	if (Entry.bOversized)
+	{
+		Entry.SlotInCell = Oversized.Add(Id);
+	}
+	else
+	{
+		Entry.Cell = GetCell(Entry.Location);
+		Entry.SlotInCell = Cells.FindOrAdd(Entry.Cell).Add(Id);
+	}
+}
+
+void FGrippableSpatialHash::Unlink(int32 Id)
+{
+	FEntry & Entry = Entries[Id];
+	TArray<int32> & Slots = Entry.bOversized ? Oversized : Cells.FindChecked(Entry.Cell);
+
+	Slots.RemoveAtSwap(Entry.SlotInCell, 1, false);
+
+	if (Slots.IsValidIndex(Entry.SlotInCell))
+		Entries[Slots[Entry.SlotInCell]].SlotInCell = Entry.SlotInCell;
+
+	// Thrown grippables leave a trail of cells behind them, don't keep the empty ones around
+	if (!Entry.bOversized && Slots.Num() == 0)
+		Cells.Remove(Entry.Cell);
+
+	Entry.SlotInCell = INDEX_NONE;
+}
+
+void FGrippableSpatialHash::TestEntry(int32 Id, const FVector & Location, float Radius, TArray<FGrippableSpatialHit> & OutHits) const
+{
+	const FEntry & Entry = Entries[Id];
+	const float Reach = Radius + Entry.Radius;
+	const float DistSquared = FVector::DistSquared(Location, Entry.Location);
+
+	if (DistSquared <= Reach * Reach)
+	{
+		OutHits.Add(FGrippableSpatialHit(Id, FMath::Max(FMath::Sqrt(DistSquared) - Entry.Radius, 0.0f)));
+	}
+}
+
+void FGrippableSpatialHash::Query(const FVector & Location, float Radius, TArray<FGrippableSpatialHit> & OutHits) const
+{
+	// Everything in a cell has its center in it and is at most a cell size in radius
+	const FVector Reach(Radius + CellSize);
+	const FIntVector MinCell = GetCell(Location - Reach);
+	const FIntVector MaxCell = GetCell(Location + Reach);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				if (const TArray<int32> * Slots = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					for (int32 Id : *Slots)
+					{
+						TestEntry(Id, Location, Radius, OutHits);
+					}
+				}
+			}
+		}
+	}
+
+	for (int32 Id : Oversized)
+	{
+		TestEntry(Id, Location, Radius, OutHits);
+	}
+}
+
+FGrippableSpatialIndex::FGrippableSpatialIndex(UWorld * InWorld) :
+	World(InWorld),
+	Hash(GrippableSpatialIndexStatics::GetCellSizeSetting())
+{
+}
+
+FGrippableSpatialIndex::~FGrippableSpatialIndex()
+{
+	// Components can outlive the index during world cleanup
+	for (FTrackedGrippable & Entry : Tracked)
+	{
+		if (USceneComponent * Component = Entry.Component.Get())
+			Component->TransformUpdated.Remove(Entry.TransformUpdatedHandle);
+	}
+}
+
+FGrippableSpatialIndex * FGrippableSpatialIndex::Get(UWorld * World, bool bCreateIfMissing)
+{
+	using namespace GrippableSpatialIndexStatics;
+
+	if (!World)
+		return nullptr;
+
+	if (TUniquePtr<FGrippableSpatialIndex> * Index = WorldIndices.Find(FObjectKey(World)))
+		return Index->Get();
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	if (!OnWorldCleanupHandle.IsValid())
+	{
+		OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([](UWorld * CleanedWorld, bool bSessionEnded, bool bCleanupResources)
+		{
+			WorldIndices.Remove(FObjectKey(CleanedWorld));
+		});
+	}
+
+	TUniquePtr<FGrippableSpatialIndex> & NewIndex = WorldIndices.Add(FObjectKey(World), MakeUnique<FGrippableSpatialIndex>(World));
+	return NewIndex.Get();
+}
+
+float FGrippableSpatialIndex::GetComponentRadius(USceneComponent * Component)
+{
+	return Component->Bounds.SphereRadius + FVector::Dist(Component->Bounds.Origin, Component->GetComponentLocation());
+}
+
+float FGrippableSpatialIndex::GetActorRadius(AActor * Actor)
+{
+	FVector Origin;
+	FVector Extent;
+	Actor->GetActorBounds(false, Origin, Extent);
+
+	return Extent.Size() + FVector::Dist(Origin, Actor->GetActorLocation());
+}
+
+void FGrippableSpatialIndex::Register(UObject * Grippable, USceneComponent * TrackedComponent)
+{
+	if (!Grippable || !TrackedComponent || !Grippable->GetClass()->ImplementsInterface(UVRGripInterface::StaticClass()))
+		return;
+
+	Unregister(Grippable);
+
+	AActor * GrippableActor = Cast<AActor>(Grippable);
+	const float ActorRadius = GrippableActor ? GetActorRadius(GrippableActor) : 0.0f;
+	const int32 Id = Hash.Add(TrackedComponent->GetComponentLocation(), GrippableActor ? ActorRadius : GetComponentRadius(TrackedComponent));
+
+	if (Tracked.Num() <= Id)
+		Tracked.SetNum(Id + 1);
+
+	FTrackedGrippable & Entry = Tracked[Id];
+	Entry.Grippable = Grippable;
+	Entry.Component = TrackedComponent;
+	Entry.GrippableKey = FObjectKey(Grippable);
+	Entry.ComponentKey = FObjectKey(TrackedComponent);
+	Entry.ActorRadius = ActorRadius;
+	Entry.bIsActor = GrippableActor != nullptr;
+	Entry.TransformUpdatedHandle = TrackedComponent->TransformUpdated.AddRaw(this, &FGrippableSpatialIndex::OnTransformUpdated);
+
+	GrippableIds.Add(Entry.GrippableKey, Id);
+	ComponentIds.Add(Entry.ComponentKey, Id);
+}
+
+void FGrippableSpatialIndex::Unregister(UObject * Grippable)
+{
+	if (const int32 * Id = GrippableIds.Find(FObjectKey(Grippable)))
+	{
+		RemoveTracked(*Id);
+	}
+}
+
+void FGrippableSpatialIndex::RemoveTracked(int32 Id)
+{
+	FTrackedGrippable & Entry = Tracked[Id];
+
+	if (USceneComponent * Component = Entry.Component.Get())
+		Component->TransformUpdated.Remove(Entry.TransformUpdatedHandle);
+
+	GrippableIds.Remove(Entry.GrippableKey);
+	ComponentIds.Remove(Entry.ComponentKey, Id);
+	Hash.Remove(Id);
+
+	Entry = FTrackedGrippable();
+}
+
+void FGrippableSpatialIndex::OnTransformUpdated(USceneComponent * UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrippableSpatialIndexMove);
+
+	for (TMultiMap<FObjectKey, int32>::TConstKeyIterator Itr = ComponentIds.CreateConstKeyIterator(FObjectKey(UpdatedComponent)); Itr; ++Itr)
+	{
+		const FTrackedGrippable & Entry = Tracked[Itr.Value()];
+		Hash.Update(Itr.Value(), UpdatedComponent->GetComponentLocation(), Entry.bIsActor ? Entry.ActorRadius : GetComponentRadius(UpdatedComponent));
+	}
+}
+
+bool FGrippableSpatialIndex::PassesFilters(UObject * Grippable, bool bIncludeHeld)
+{
+	if (IVRGripInterface::Execute_DenyGripping(Grippable))
+		return false;
+
+	if (!bIncludeHeld)
+	{
+		TArray<FBPGripPair> HoldingControllers;
+		bool bIsHeld = false;
+		IVRGripInterface::Execute_IsHeld(Grippable, HoldingControllers, bIsHeld);
+
+		if (bIsHeld)
+			return false;
+	}
+
+	return true;
+}
+
+void FGrippableSpatialIndex::RunQuery(const FGrippableQuery & Query, TArray<FGrippableQueryCandidate> & OutCandidates)
+{
+	OutCandidates.Reset();
+
+	HitScratch.Reset();
+	Hash.Query(Query.Location, Query.Radius, HitScratch);
+
+	HitScratch.Sort([](const FGrippableSpatialHit & A, const FGrippableSpatialHit & B)
+	{
+		return A.Distance < B.Distance;
+	});
+
+	// The interface calls only run on the closest hits until enough of them pass
+	for (const FGrippableSpatialHit & Hit : HitScratch)
+	{
+		const FTrackedGrippable & Entry = Tracked[Hit.Id];
+		UObject * Grippable = Entry.Grippable.Get();
+		USceneComponent * Component = Entry.Component.Get();
+
+		if (!Grippable || !Component || Grippable->IsPendingKill() || !PassesFilters(Grippable, Query.bIncludeHeld))
+			continue;
+
+		FGrippableQueryCandidate & Candidate = OutCandidates.AddDefaulted_GetRef();
+		Candidate.Grippable = Grippable;
+		Candidate.Component = Component;
+		Candidate.Distance = Hit.Distance;
+
+		if (Query.MaxResults > 0 && OutCandidates.Num() >= Query.MaxResults)
+			break;
+	}
+}
+
+void FGrippableSpatialIndex::QueryNearest(const TArray<FGrippableQuery> & Queries, TArray<TArray<FGrippableQueryCandidate>> & OutCandidates)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GrippableSpatialIndexQuery);
+
+	Hash.SetCellSize(GrippableSpatialIndexStatics::GetCellSizeSetting());
+
+	OutCandidates.SetNum(Queries.Num());
+
+	for (int32 i = 0; i < Queries.Num(); ++i)
+	{
+		RunQuery(Queries[i], OutCandidates[i]);
+	}
+}
+
+void FGrippableSpatialIndex::QueryPlayerHands(float Radius, int32 MaxResults, bool bIncludeHeld, TArray<FGrippableHandCandidates> & OutHands)
+{
+	OutHands.Reset();
+
+	UWorld * OurWorld = World.Get();
+	if (!OurWorld)
+		return;
+
+	QueryScratch.Reset();
+
+	for (FConstPlayerControllerIterator Iterator = OurWorld->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		APlayerController * PlayerController = Iterator->Get();
+		AVRBaseCharacter * Character = PlayerController ? Cast<AVRBaseCharacter>(PlayerController->GetPawn()) : nullptr;
+
+		if (!Character)
+			continue;
+
+		UGripMotionControllerComponent * Hands[] = { Character->LeftMotionController, Character->RightMotionController };
+		for (UGripMotionControllerComponent * Hand : Hands)
+		{
+			if (!Hand)
+				continue;
+
+			QueryScratch.Add(FGrippableQuery(Hand->GetComponentLocation(), Radius, MaxResults, bIncludeHeld));
+			OutHands.AddDefaulted_GetRef().Controller = Hand;
+		}
+	}
+
+	TArray<TArray<FGrippableQueryCandidate>> Results;
+	QueryNearest(QueryScratch, Results);
+
+	for (int32 i = 0; i < OutHands.Num(); ++i)
+	{
+		OutHands[i].Candidates = MoveTemp(Results[i]);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace GrippableSpatialIndexBenchmark
+{
+	// Moves a set of synthetic grippables around and queries two hands per player each frame, timing the hash against a linear scan
+	// over every grippable and checking that both find the same ones
+	static void RunBenchmark(const TArray<FString> & Args)
+	{
+		const int32 NumGrippables = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2000;
+		const int32 NumPlayers = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 8;
+		const int32 NumFrames = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 300;
+		const float QueryRadius = 30.0f;
+		const float WorldExtent = 2000.0f;
+
+		FRandomStream Stream(0x6A1D);
+		FGrippableSpatialHash Hash(GrippableSpatialIndexStatics::GetCellSizeSetting());
+
+		TArray<FVector> Locations;
+		TArray<FVector> Velocities;
+		TArray<float> Radii;
+		TArray<int32> Ids;
+
+		for (int32 i = 0; i < NumGrippables; ++i)
+		{
+			Locations.Add(FVector(Stream.FRandRange(-WorldExtent, WorldExtent), Stream.FRandRange(-WorldExtent, WorldExtent), Stream.FRandRange(0.0f, 300.0f)));
+
+			// One in ten is moving, and an occasional large one ends up on the oversized list
+			Velocities.Add((i % 10) == 0 ? Stream.GetUnitVector() * Stream.FRandRange(50.0f, 600.0f) : FVector::ZeroVector);
+			Radii.Add((i % 200) == 0 ? Stream.FRandRange(150.0f, 300.0f) : Stream.FRandRange(2.0f, 25.0f));
+			Ids.Add(Hash.Add(Locations[i], Radii[i]));
+		}
+
+		// Players stand around the grippables so that most hands have a few in range
+		TArray<FVector> PlayerLocations;
+		for (int32 i = 0; i < NumPlayers; ++i)
+		{
+			PlayerLocations.Add(Locations[Stream.RandRange(0, NumGrippables - 1)] + FVector(0.0f, 0.0f, 20.0f));
+		}
+
+		TArray<FGrippableSpatialHit> HashHits;
+		TArray<int32> HashIds;
+		TArray<int32> LinearIds;
+
+		double MoveTime = 0.0;
+		double HashTime = 0.0;
+		double LinearTime = 0.0;
+		int32 NumHits = 0;
+		int32 Mismatches = 0;
+		const float DeltaTime = 1.0f / 90.0f;
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < NumGrippables; ++i)
+			{
+				if (Velocities[i].IsZero())
+					continue;
+
+				Locations[i] += Velocities[i] * DeltaTime;
+				if (FMath::Abs(Locations[i].X) > WorldExtent || FMath::Abs(Locations[i].Y) > WorldExtent)
+					Velocities[i] = -Velocities[i];
+
+				Hash.Update(Ids[i], Locations[i], Radii[i]);
+			}
+			MoveTime += FPlatformTime::Seconds() - StartTime;
+
+			for (int32 Player = 0; Player < NumPlayers; ++Player)
+			{
+				for (int32 HandIndex = 0; HandIndex < 2; ++HandIndex)
+				{
+					const FVector HandLocation = PlayerLocations[Player] + FVector(0.0f, HandIndex ? 25.0f : -25.0f, 0.0f) + Stream.GetUnitVector() * 10.0f;
+
+					StartTime = FPlatformTime::Seconds();
+					HashHits.Reset();
+					Hash.Query(HandLocation, QueryRadius, HashHits);
+					HashTime += FPlatformTime::Seconds() - StartTime;
+
+					StartTime = FPlatformTime::Seconds();
+					LinearIds.Reset();
+					for (int32 i = 0; i < NumGrippables; ++i)
+					{
+						if (FVector::DistSquared(HandLocation, Locations[i]) <= FMath::Square(QueryRadius + Radii[i]))
+							LinearIds.Add(Ids[i]);
+					}
+					LinearTime += FPlatformTime::Seconds() - StartTime;
+
+					HashIds.Reset();
+					for (const FGrippableSpatialHit & Hit : HashHits)
+					{
+						HashIds.Add(Hit.Id);
+					}
+
+					HashIds.Sort();
+					LinearIds.Sort();
+
+					if (HashIds != LinearIds)
+						++Mismatches;
+
+					NumHits += HashIds.Num();
+				}
+			}
+		}
+
+		const int32 NumQueries = NumFrames * NumPlayers * 2;
+		UE_LOG(LogGrippableSpatialIndex, Log, TEXT("Grippable query benchmark: %d grippables, %d players, %d frames, cell size %.0fcm"),
+			NumGrippables, NumPlayers, NumFrames, Hash.GetCellSize());
+		UE_LOG(LogGrippableSpatialIndex, Log, TEXT("  Hash: %.3fms per frame (%.3fms moving), linear scan: %.3fms per frame, %.2f grippables per hand, %d mismatches"),
+			(MoveTime + HashTime) * 1000.0 / NumFrames, MoveTime * 1000.0 / NumFrames, LinearTime * 1000.0 / NumFrames, (float)NumHits / NumQueries, Mismatches);
+	}
+
+	static FAutoConsoleCommandWithArgs BenchmarkCommand(
+		TEXT("vr.GrippableQuery.Benchmark"),
+		TEXT("Times the grippable query hash against a linear scan with moving grippables and checks that they agree.\n")
+		TEXT("Usage: vr.GrippableQuery.Benchmark [Grippables=2000] [Players=8] [Frames=300]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
+#endif
@@ -2,6 +2,7 @@
 
 #include "Grippables/GrippableSphereComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "Grippables/GrippableSpatialIndex.h"
 
   //=============================================================================
 UGrippableSphereComponent::UGrippableSphereComponent(const FObjectInitializer& ObjectInitializer)
@@ -77,6 +78,10 @@ void UGrippableSphereComponent::BeginPlay()
 	// Call the base class 
 	Super::BeginPlay();
 
+	// Lets hands find this grippable without physics overlaps
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld()))
+		SpatialIndex->Register(this, this);
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -91,6 +96,9 @@ void UGrippableSphereComponent::BeginPlay()
 
 void UGrippableSphereComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld(), false))
+		SpatialIndex->Unregister(this);
+
 	// Call the base class 
 	Super::EndPlay(EndPlayReason);
 
@@ -103,6 +103,16 @@ void AGrippableStaticMeshActor::PreReplication(IRepChangedPropertyTracker & Chan
 	DOREPLIFETIME_ACTIVE_OVERRIDE(AGrippableStaticMeshActor, GameplayTags, bRepGripSettingsAndGameplayTags);
 }
 
+float AGrippableStaticMeshActor::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	const float BasePriority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld(), false))
+		return ReplicationBudget->GetNetPriority(this, Viewer, ViewTarget, ViewPos, BasePriority);
+
+	return BasePriority;
+}
+
 bool AGrippableStaticMeshActor::ReplicateSubobjects(UActorChannel* Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags)
 {
 	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
@@ -128,6 +138,17 @@ void AGrippableStaticMeshActor::BeginPlay()
 	// Call the base class 
 	Super::BeginPlay();
 
+	// Movement replication of grippables is budgeted per connection in networked games
+	if (GetNetMode() != ENetMode::NM_Standalone)
+	{
+		if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld()))
+			ReplicationBudget->RegisterActor(this, &VRGripInterfaceSettings, &ClientAuthReplicationData);
+	}
+
+	// Lets hands find this grippable without physics overlaps
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld()))
+		SpatialIndex->Register(this, GetRootComponent());
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -233,12 +254,23 @@ bool AGrippableStaticMeshActor::AddToClientReplicationBucket()
 	if (ShouldWeSkipAttachmentReplication(false))
 	{
 		// The subsystem automatically removes entries with the same function signature so its safe to just always add here
-		GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>()->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
+		if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this))
+			BucketSubsystem->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
+
 		ClientAuthReplicationData.bIsCurrentlyClientAuth = true;
+		ClientAuthReplicationData.RestPolls = 0;
 
 		if (UWorld * World = GetWorld())
 			ClientAuthReplicationData.TimeAtInitialThrow = World->GetTimeSeconds();
 
+		// Physics tells us when the body goes to sleep so we don't have to check it every poll
+		if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(GetRootComponent()))
+		{
+			ClientAuthReplicationData.EnableSleepEvents(PrimComp);
+			PrimComp->OnComponentSleep.AddUniqueDynamic(this, &AGrippableStaticMeshActor::OnClientAuthBodySleep);
+			PrimComp->OnComponentWake.AddUniqueDynamic(this, &AGrippableStaticMeshActor::OnClientAuthBodyWake);
+		}
+
 		return true;
 	}
 
@@ -249,7 +281,9 @@ bool AGrippableStaticMeshActor::RemoveFromClientReplicationBucket()
 {
 	if (ClientAuthReplicationData.bIsCurrentlyClientAuth)
 	{
-		GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>()->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+		if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this, false))
+			BucketSubsystem->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+
 		CeaseReplicationBlocking();
 		return true;
 	}
@@ -311,6 +345,13 @@ bool AGrippableStaticMeshActor::PollReplicationEvent()
 
 	if (!CurTransform.GetRotation().Equals(ClientAuthReplicationData.LastActorTransform.GetRotation()) || !CurTransform.GetLocation().Equals(ClientAuthReplicationData.LastActorTransform.GetLocation()))
 	{
+		// Over this frames upload budget, skip the update but keep polling. The transform isn't stored so the next poll still sends
+		if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(OurWorld, false))
+		{
+			if (!ReplicationBudget->AllowClientAuthUpdate(this))
+				return true;
+		}
+
 		ClientAuthReplicationData.LastActorTransform = CurTransform;
 
 		if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(RootComponent))
@@ -323,8 +364,11 @@ bool AGrippableStaticMeshActor::PollReplicationEvent()
 				{
 					Server_GetClientAuthReplication(ClientAuthMovementRep);
 
-					if (PrimComp->RigidBodyIsAwake())
-						return true;
+					// Velocity that has quantized away for a few polls in a row isn't worth sending, put the body to sleep and let the sleep event end the polling
+					if (ClientAuthReplicationData.ShouldForceSleep(ClientAuthMovementRep))
+						PrimComp->PutRigidBodyToSleep();
+
+					return true;
 				}
 			}
 		}
@@ -339,6 +383,17 @@ bool AGrippableStaticMeshActor::PollReplicationEvent()
 		ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
 	}
 
+	QueueCeaseReplicationBlocking();
+
+	return false; // Tell the bucket subsystem to remove us from consideration
+}
+
+void AGrippableStaticMeshActor::QueueCeaseReplicationBlocking()
+{
+	UWorld *OurWorld = GetWorld();
+	if (!OurWorld)
+		return;
+
 	AActor* TopOwner = GetOwner();
 
 	if (TopOwner != nullptr)
@@ -367,8 +422,47 @@ bool AGrippableStaticMeshActor::PollReplicationEvent()
 			}
 		}
 	}
+}
 
-	return false; // Tell the bucket subsystem to remove us from consideration
+void AGrippableStaticMeshActor::OnClientAuthBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	// Skeletal meshes report every body, only stop once the root body is asleep
+	if (!ClientAuthReplicationData.bIsCurrentlyClientAuth || !SleepingComponent || SleepingComponent->RigidBodyIsAwake())
+		return;
+
+	// Send the final resting state and stop polling, nothing runs per frame for us until the body wakes back up
+	if (ShouldWeSkipAttachmentReplication(false))
+	{
+		FRepMovementVR ClientAuthMovementRep;
+		if (ClientAuthMovementRep.GatherActorsMovement(this))
+			Server_GetClientAuthReplication(ClientAuthMovementRep);
+	}
+
+	if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this, false))
+		BucketSubsystem->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+
+	ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
+	QueueCeaseReplicationBlocking();
+}
+
+void AGrippableStaticMeshActor::OnClientAuthBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	UWorld * OurWorld = GetWorld();
+	if (!OurWorld || !ClientAuthReplicationData.bIsCurrentlyClientAuth || !ShouldWeSkipAttachmentReplication(false))
+		return;
+
+	// Same time out as the polling
+	if ((OurWorld->GetTimeSeconds() - ClientAuthReplicationData.TimeAtInitialThrow) > 10.0f)
+		return;
+
+	// Knocked awake again before the server took back over, resume sending
+	if (ClientAuthReplicationData.ResetReplicationHandle.IsValid())
+	{
+		OurWorld->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
+	}
+
+	if (UBucketUpdateWorldSubsystem * BucketSubsystem = UBucketUpdateWorldSubsystem::Get(this))
+		BucketSubsystem->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName(TEXT("PollReplicationEvent")));
 }
 
 void AGrippableStaticMeshActor::CeaseReplicationBlocking()
@@ -383,12 +477,26 @@ void AGrippableStaticMeshActor::CeaseReplicationBlocking()
 			OurWorld->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
 		}
 	}
+
+	// Done with the sleep events, idle bodies shouldn't cost us anything
+	if (UPrimitiveComponent * PrimComp = Cast<UPrimitiveComponent>(GetRootComponent()))
+	{
+		PrimComp->OnComponentSleep.RemoveDynamic(this, &AGrippableStaticMeshActor::OnClientAuthBodySleep);
+		PrimComp->OnComponentWake.RemoveDynamic(this, &AGrippableStaticMeshActor::OnClientAuthBodyWake);
+		ClientAuthReplicationData.RestoreSleepEvents(PrimComp);
+	}
 }
 
 void AGrippableStaticMeshActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	RemoveFromClientReplicationBucket();
 
+	if (FGrippableReplicationBudget * ReplicationBudget = FGrippableReplicationBudget::Get(GetWorld(), false))
+		ReplicationBudget->UnregisterActor(this);
+
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(GetWorld(), false))
+		SpatialIndex->Unregister(this);
+
 	// Call all grip scripts begin play events so they can perform any needed logic
 	for (UVRGripScriptBase* Script : GripLogicScripts)
 	{
@@ -1,6 +1,7 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "Interactibles/VRButtonComponent.h"
+#include "Interactibles/VRInteractibleTickManager.h"
 #include "GameFramework/Character.h"
 
   //=============================================================================
@@ -76,6 +77,17 @@ void UVRButtonComponent::BeginPlay()
 	OnComponentEndOverlap.AddUniqueDynamic(this, &UVRButtonComponent::OnOverlapEnd);
 }
 
+void UVRButtonComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	const bool bSharedTick = FVRInteractibleTickManager::SetAwake(this, bEnabled);
+	Super::SetComponentTickEnabled(bEnabled && !bSharedTick);
+}
+
+bool UVRButtonComponent::IsComponentTickEnabled() const
+{
+	return Super::IsComponentTickEnabled() || FVRInteractibleTickManager::IsAwake(this);
+}
+
 void UVRButtonComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	// Call supers tick (though I don't think any of the base classes to this actually implement it)
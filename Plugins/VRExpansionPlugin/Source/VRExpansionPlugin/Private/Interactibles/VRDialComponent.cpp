@@ -1,6 +1,7 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "Interactibles/VRDialComponent.h"
+#include "Interactibles/VRInteractibleTickManager.h"
 #include "Net/UnrealNetwork.h"
 
   //=============================================================================
@@ -88,6 +89,17 @@ void UVRDialComponent::BeginPlay()
 	bOriginalReplicatesMovement = bReplicateMovement;
 }
 
+void UVRDialComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	const bool bSharedTick = FVRInteractibleTickManager::SetAwake(this, bEnabled);
+	Super::SetComponentTickEnabled(bEnabled && !bSharedTick);
+}
+
+bool UVRDialComponent::IsComponentTickEnabled() const
+{
+	return Super::IsComponentTickEnabled() || FVRInteractibleTickManager::IsAwake(this);
+}
+
 void UVRDialComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	if (bIsLerping)
@@ -0,0 +1,445 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Interactibles/VRInteractibleTickManager.h"
+#include "Interactibles/VRButtonComponent.h"
+#include "Interactibles/VRDialComponent.h"
+#include "Interactibles/VRLeverComponent.h"
+#include "Interactibles/VRSliderComponent.h"
+#include "Interactibles/VRMountComponent.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogVRInteractibleTickManager);
+
+DECLARE_CYCLE_STAT(TEXT("InteractibleTickManager ~ Tick"), STAT_InteractibleTickManagerTick, STATGROUP_Game);
+
+// CVars
+namespace VRInteractibleTickManagerCvars
+{
+	static int32 SharedTick = 1;
+	FAutoConsoleVariableRef CVarSharedTick(
+		TEXT("vr.Interactibles.SharedTick"),
+		SharedTick,
+		TEXT("When on, awake interactibles are ticked by one shared tick function per world instead of their own.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+}
+
+namespace VRInteractibleTickManagerStatics
+{
+	static TMap<FObjectKey, TUniquePtr<FVRInteractibleTickManager>> WorldManagers;
+	static FDelegateHandle OnWorldCleanupHandle;
+}
+
+void FVRInteractibleTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager)
+		Manager->Tick(DeltaTime, TickType);
+}
+
+FString FVRInteractibleTickFunction::DiagnosticMessage()
+{
+	return TEXT("FVRInteractibleTickFunction");
+}
+
+FVRInteractibleTickManager::FVRInteractibleTickManager(UWorld * InWorld) :
+	World(InWorld),
+	bNeedsCompact(false),
+	bNeedsSort(false)
+{
+	// Same group as the interactibles own tick functions
+	TickFunction.Manager = this;
+	TickFunction.TickGroup = TG_DuringPhysics;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = false;
+	TickFunction.SetTickFunctionEnable(false);
+
+	if (InWorld && InWorld->PersistentLevel)
+		TickFunction.RegisterTickFunction(InWorld->PersistentLevel);
+}
+
+FVRInteractibleTickManager::~FVRInteractibleTickManager()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+		TickFunction.UnRegisterTickFunction();
+}
+
+FVRInteractibleTickManager * FVRInteractibleTickManager::Get(UWorld * World, bool bCreateIfMissing)
+{
+	using namespace VRInteractibleTickManagerStatics;
+
+	if (!World)
+		return nullptr;
+
+	if (TUniquePtr<FVRInteractibleTickManager> * Manager = WorldManagers.Find(FObjectKey(World)))
+		return Manager->Get();
+
+	if (!bCreateIfMissing || World->bIsTearingDown)
+		return nullptr;
+
+	if (!OnWorldCleanupHandle.IsValid())
+	{
+		OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([](UWorld * CleanedWorld, bool bSessionEnded, bool bCleanupResources)
+		{
+			WorldManagers.Remove(FObjectKey(CleanedWorld));
+		});
+	}
+
+	TUniquePtr<FVRInteractibleTickManager> & NewManager = WorldManagers.Add(FObjectKey(World), MakeUnique<FVRInteractibleTickManager>(World));
+	return NewManager.Get();
+}
+
+bool FVRInteractibleTickManager::SetAwake(UActorComponent * Component, bool bAwake)
+{
+	UWorld * World = Component ? Component->GetWorld() : nullptr;
+	if (!World)
+		return false;
+
+	if (!bAwake)
+	{
+		if (FVRInteractibleTickManager * Manager = Get(World, false))
+			Manager->Sleep(Component);
+
+		return false;
+	}
+
+	// Components that haven't begun play yet keep their own tick function, it won't run before BeginPlay either
+	if (!VRInteractibleTickManagerCvars::SharedTick || !World->IsGameWorld() || !Component->IsRegistered() || !Component->HasBegunPlay() || !CanShareTick(Component))
+		return false;
+
+	FVRInteractibleTickManager * Manager = Get(World);
+	if (!Manager)
+		return false;
+
+	Manager->Wake(Component);
+	return true;
+}
+
+bool FVRInteractibleTickManager::IsAwake(const UActorComponent * Component)
+{
+	UWorld * World = Component ? Component->GetWorld() : nullptr;
+	FVRInteractibleTickManager * Manager = World ? Get(World, false) : nullptr;
+	return Manager && Manager->IsComponentAwake(Component);
+}
+
+bool FVRInteractibleTickManager::CanShareTick(UActorComponent * Component)
+{
+	FActorComponentTickFunction & ComponentTick = Component->PrimaryComponentTick;
+	return ComponentTick.TickGroup == TG_DuringPhysics && !ComponentTick.bTickEvenWhenPaused && !ComponentTick.GetPrerequisites().Num();
+}
+
+void FVRInteractibleTickManager::Wake(UActorComponent * Component)
+{
+	if (!Component)
+		return;
+
+	const FObjectKey Key(Component);
+	if (AwakeIndices.Contains(Key))
+		return;
+
+	FAwakeInteractible NewEntry;
+	NewEntry.Component = Component;
+	NewEntry.Key = Key;
+	NewEntry.Class = Component->GetClass();
+	NewEntry.TimeSinceTick = 0.f;
+	NewEntry.bAwake = true;
+
+	AwakeIndices.Add(Key, Awake.Add(NewEntry));
+	bNeedsSort = true;
+
+	if (!TickFunction.IsTickFunctionEnabled())
+		TickFunction.SetTickFunctionEnable(true);
+}
+
+void FVRInteractibleTickManager::Sleep(UActorComponent * Component)
+{
+	int32 Index = INDEX_NONE;
+	if (AwakeIndices.RemoveAndCopyValue(FObjectKey(Component), Index))
+	{
+		// Entries stay in place until the next compact so that sleeping during the tick loop is safe
+		Awake[Index].bAwake = false;
+		bNeedsCompact = true;
+	}
+}
+
+bool FVRInteractibleTickManager::IsComponentAwake(const UActorComponent * Component) const
+{
+	return AwakeIndices.Contains(FObjectKey(Component));
+}
+
+void FVRInteractibleTickManager::FallBackToOwnTick(int32 Index, UActorComponent * Component)
+{
+	AwakeIndices.Remove(Awake[Index].Key);
+	Awake[Index].bAwake = false;
+	bNeedsCompact = true;
+
+	// Goes around the interactibles SetComponentTickEnabled override, which would route it straight back here
+	Component->PrimaryComponentTick.SetTickFunctionEnable(true);
+}
+
+void FVRInteractibleTickManager::Compact()
+{
+	if (!bNeedsCompact && !bNeedsSort)
+		return;
+
+	if (bNeedsCompact)
+	{
+		Awake.RemoveAll([](const FAwakeInteractible & Entry)
+		{
+			return !Entry.bAwake;
+		});
+	}
+
+	if (bNeedsSort)
+	{
+		Awake.StableSort([](const FAwakeInteractible & A, const FAwakeInteractible & B)
+		{
+			return (UPTRINT)A.Class < (UPTRINT)B.Class;
+		});
+	}
+
+	AwakeIndices.Reset();
+	for (int32 i = 0; i < Awake.Num(); ++i)
+	{
+		AwakeIndices.Add(Awake[i].Key, i);
+	}
+
+	bNeedsCompact = false;
+	bNeedsSort = false;
+}
+
+void FVRInteractibleTickManager::Tick(float DeltaTime, ELevelTick TickType)
+{
+	SCOPE_CYCLE_COUNTER(STAT_InteractibleTickManagerTick);
+
+	Compact();
+
+	// Interactibles woken during the loop are appended and tick from the next frame on, the same as a newly enabled tick function
+	const int32 NumToTick = Awake.Num();
+	for (int32 i = 0; i < NumToTick; ++i)
+	{
+		if (!Awake[i].bAwake)
+			continue;
+
+		UActorComponent * Component = Awake[i].Component.Get();
+		if (!Component || Component->IsPendingKill())
+		{
+			AwakeIndices.Remove(Awake[i].Key);
+			Awake[i].bAwake = false;
+			bNeedsCompact = true;
+			continue;
+		}
+
+		// Unregistered (possibly to be registered again) or gained prerequisites while awake, it is still awake so let it tick itself
+		if (!Component->IsRegistered() || !Component->HasBegunPlay() || !CanShareTick(Component))
+		{
+			FallBackToOwnTick(i, Component);
+			continue;
+		}
+
+		// Same as the engine, an interval tick gets the whole time since its last tick
+		Awake[i].TimeSinceTick += DeltaTime;
+		if (Awake[i].TimeSinceTick < Component->PrimaryComponentTick.TickInterval)
+			continue;
+
+		const float TickDeltaTime = Awake[i].TimeSinceTick;
+		Awake[i].TimeSinceTick = 0.f;
+
+		AActor * Owner = Component->GetOwner();
+		const float ComponentDeltaTime = Owner ? TickDeltaTime * Owner->CustomTimeDilation : TickDeltaTime;
+		Component->TickComponent(ComponentDeltaTime, TickType, &Component->PrimaryComponentTick);
+	}
+
+	Compact();
+
+	if (!Awake.Num())
+		TickFunction.SetTickFunctionEnable(false);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace VRInteractibleTickManagerBenchmark
+{
+	enum class EPhase : uint8
+	{
+		Baseline,
+		Idle,
+		AwakeShared,
+		AwakeOwnTick,
+		Count
+	};
+
+	struct FBenchmarkState
+	{
+		TWeakObjectPtr<UWorld> World;
+		TWeakObjectPtr<AActor> Actor;
+		TArray<TWeakObjectPtr<UActorComponent>> Interactibles;
+		int32 NumInteractibles;
+		int32 NumFrames;
+		int32 FramesLeft;
+		EPhase Phase;
+		int32 OriginalSharedTick;
+		double TickStartTime;
+		double PhaseTime[(int32)EPhase::Count];
+		int32 IdleAwakeInManager;
+		int32 IdleOwnTicksEnabled;
+		FDelegateHandle PreActorTickHandle;
+		FDelegateHandle PostActorTickHandle;
+	};
+
+	static void CreateInteractibles(FBenchmarkState & State)
+	{
+		AActor * Actor = State.Actor.Get();
+		if (!Actor)
+			return;
+
+		const TSubclassOf<UActorComponent> Classes[] = { UVRButtonComponent::StaticClass(), UVRDialComponent::StaticClass(), UVRLeverComponent::StaticClass(), UVRSliderComponent::StaticClass(), UVRMountComponent::StaticClass() };
+
+		for (int32 i = 0; i < State.NumInteractibles; ++i)
+		{
+			USceneComponent * Interactible = NewObject<USceneComponent>(Actor, Classes[i % ARRAY_COUNT(Classes)].Get());
+			Interactible->SetupAttachment(Actor->GetRootComponent());
+			Interactible->SetRelativeLocation(FVector((i % 25) * 20.0f, (i / 25) * 20.0f, 0.0f));
+			Interactible->RegisterComponent();
+			State.Interactibles.Add(Interactible);
+		}
+	}
+
+	static void SetAllAwake(FBenchmarkState & State, bool bAwake)
+	{
+		for (const TWeakObjectPtr<UActorComponent> & Interactible : State.Interactibles)
+		{
+			if (Interactible.IsValid())
+				Interactible->SetComponentTickEnabled(bAwake);
+		}
+	}
+
+	static void Finish(FBenchmarkState & State)
+	{
+		FWorldDelegates::OnWorldPreActorTick.Remove(State.PreActorTickHandle);
+		FWorldDelegates::OnWorldPostActorTick.Remove(State.PostActorTickHandle);
+		VRInteractibleTickManagerCvars::SharedTick = State.OriginalSharedTick;
+
+		if (AActor * Actor = State.Actor.Get())
+			Actor->Destroy();
+
+		const double Frames = (double)State.NumFrames;
+		UE_LOG(LogVRInteractibleTickManager, Log, TEXT("Interactible tick benchmark: %d interactibles, actor tick time averaged over %d frames per phase"), State.NumInteractibles, State.NumFrames);
+		UE_LOG(LogVRInteractibleTickManager, Log, TEXT("  No interactibles: %.3fms"), State.PhaseTime[(int32)EPhase::Baseline] * 1000.0 / Frames);
+		UE_LOG(LogVRInteractibleTickManager, Log, TEXT("  Idle: %.3fms, %d awake in the manager, %d own tick functions enabled"),
+			State.PhaseTime[(int32)EPhase::Idle] * 1000.0 / Frames, State.IdleAwakeInManager, State.IdleOwnTicksEnabled);
+		UE_LOG(LogVRInteractibleTickManager, Log, TEXT("  Woken every frame, shared tick: %.3fms"), State.PhaseTime[(int32)EPhase::AwakeShared] * 1000.0 / Frames);
+		UE_LOG(LogVRInteractibleTickManager, Log, TEXT("  Woken every frame, own tick functions: %.3fms"), State.PhaseTime[(int32)EPhase::AwakeOwnTick] * 1000.0 / Frames);
+	}
+
+	static void NextPhase(FBenchmarkState & State)
+	{
+		switch (State.Phase)
+		{
+		case EPhase::Baseline:
+		{
+			CreateInteractibles(State);
+			State.Phase = EPhase::Idle;
+		}break;
+		case EPhase::Idle:
+		{
+			FVRInteractibleTickManager * Manager = FVRInteractibleTickManager::Get(State.World.Get(), false);
+			State.IdleAwakeInManager = Manager ? Manager->NumAwake() : 0;
+			State.IdleOwnTicksEnabled = 0;
+			for (const TWeakObjectPtr<UActorComponent> & Interactible : State.Interactibles)
+			{
+				if (Interactible.IsValid() && Interactible->PrimaryComponentTick.IsTickFunctionEnabled())
+					++State.IdleOwnTicksEnabled;
+			}
+
+			VRInteractibleTickManagerCvars::SharedTick = 1;
+			State.Phase = EPhase::AwakeShared;
+		}break;
+		case EPhase::AwakeShared:
+		{
+			SetAllAwake(State, false);
+			VRInteractibleTickManagerCvars::SharedTick = 0;
+			State.Phase = EPhase::AwakeOwnTick;
+		}break;
+		default:
+		{
+			SetAllAwake(State, false);
+			State.Phase = EPhase::Count;
+		}break;
+		}
+
+		State.FramesLeft = State.NumFrames;
+	}
+
+	// Spawns interactibles of every type under one actor and times the worlds actor tick with them idle, woken into the shared tick
+	// and woken into their own tick functions
+	static void RunBenchmark(const TArray<FString> & Args, UWorld * World)
+	{
+		if (!World || !World->IsGameWorld())
+			return;
+
+		TSharedRef<FBenchmarkState> State = MakeShareable(new FBenchmarkState());
+		State->World = World;
+		State->NumInteractibles = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500;
+		State->NumFrames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 120;
+		State->FramesLeft = State->NumFrames;
+		State->Phase = EPhase::Baseline;
+		State->OriginalSharedTick = VRInteractibleTickManagerCvars::SharedTick;
+		State->TickStartTime = 0.0;
+		State->IdleAwakeInManager = 0;
+		State->IdleOwnTicksEnabled = 0;
+		for (double & PhaseTime : State->PhaseTime)
+		{
+			PhaseTime = 0.0;
+		}
+
+		// Far away from anything that could overlap the buttons
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AActor * Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(FVector(0.0f, 0.0f, -100000.0f)), SpawnParams);
+		if (!Actor)
+			return;
+
+		USceneComponent * Root = NewObject<USceneComponent>(Actor);
+		Actor->SetRootComponent(Root);
+		Root->RegisterComponent();
+		State->Actor = Actor;
+
+		TWeakObjectPtr<UWorld> WeakWorld(World);
+		State->PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddLambda([WeakWorld, State](UWorld * TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld != WeakWorld.Get())
+				return;
+
+			if (State->Phase == EPhase::AwakeShared || State->Phase == EPhase::AwakeOwnTick)
+				SetAllAwake(*State, true);
+
+			State->TickStartTime = FPlatformTime::Seconds();
+		});
+
+		State->PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([WeakWorld, State](UWorld * TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld != WeakWorld.Get() || State->Phase == EPhase::Count)
+				return;
+
+			State->PhaseTime[(int32)State->Phase] += FPlatformTime::Seconds() - State->TickStartTime;
+
+			if (--State->FramesLeft > 0)
+				return;
+
+			NextPhase(*State);
+
+			if (State->Phase == EPhase::Count)
+				Finish(*State);
+		});
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("vr.Interactibles.Benchmark"),
+		TEXT("Times the actor tick with idle interactibles and with all of them awake in the shared tick and in their own tick functions.\n")
+		TEXT("Usage: vr.Interactibles.Benchmark [Interactibles=500] [Frames=120]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmark));
+}
+#endif
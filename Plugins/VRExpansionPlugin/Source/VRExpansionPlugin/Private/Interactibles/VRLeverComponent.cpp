@@ -1,6 +1,7 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "Interactibles/VRLeverComponent.h"
+#include "Interactibles/VRInteractibleTickManager.h"
 #include "Net/UnrealNetwork.h"
 
   //=============================================================================
@@ -115,6 +116,17 @@ void UVRLeverComponent::BeginPlay()
 	bOriginalReplicatesMovement = bReplicateMovement;
 }
 
+void UVRLeverComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	const bool bSharedTick = FVRInteractibleTickManager::SetAwake(this, bEnabled);
+	Super::SetComponentTickEnabled(bEnabled && !bSharedTick);
+}
+
+bool UVRLeverComponent::IsComponentTickEnabled() const
+{
+	return Super::IsComponentTickEnabled() || FVRInteractibleTickManager::IsAwake(this);
+}
+
 void UVRLeverComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	// Call supers tick (though I don't think any of the base classes to this actually implement it)
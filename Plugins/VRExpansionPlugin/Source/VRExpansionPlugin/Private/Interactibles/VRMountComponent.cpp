@@ -1,6 +1,7 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "Interactibles/VRMountComponent.h"
+#include "Interactibles/VRInteractibleTickManager.h"
 #include "Net/UnrealNetwork.h"
 
 //=============================================================================
@@ -79,6 +80,17 @@ void UVRMountComponent::BeginPlay()
 	Super::BeginPlay();
 }
 
+void UVRMountComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	const bool bSharedTick = FVRInteractibleTickManager::SetAwake(this, bEnabled);
+	Super::SetComponentTickEnabled(bEnabled && !bSharedTick);
+}
+
+bool UVRMountComponent::IsComponentTickEnabled() const
+{
+	return Super::IsComponentTickEnabled() || FVRInteractibleTickManager::IsAwake(this);
+}
+
 void UVRMountComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	// Call supers tick (though I don't think any of the base classes to this actually implement it)
@@ -1,8 +1,185 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "Interactibles/VRSliderComponent.h"
+#include "Interactibles/VRInteractibleTickManager.h"
 #include "Net/UnrealNetwork.h"
 
+namespace VRSliderSplineLookupSettings
+{
+	// Distance between the samples of a spline lookup table and the most samples one can have
+	static const float TargetSampleDistance = 5.0f;
+	static const int32 MaxSamples = 4096;
+
+	// Samples past the closest one that a seeded lookup checks before it stops searching in that direction
+	static const int32 SearchWindow = 8;
+
+	static const int32 RefineIterations = 4;
+}
+
+bool FVRSliderSplineLookup::IsBuiltFor(const USplineComponent * InSpline) const
+{
+	if (!InSpline || Spline.Get() != InSpline)
+		return false;
+
+	const TArray<FInterpCurvePoint<FVector>> & Points = InSpline->SplineCurves.Position.Points;
+	return Points.Num() == NumPoints && InSpline->IsClosedLoop() == bClosedLoop && InSpline->GetSplineLength() == SplineLength &&
+		(!Points.Num() || (Points[0].OutVal == FirstPoint && Points.Last().OutVal == LastPoint));
+}
+
+void FVRSliderSplineLookup::Build(USplineComponent * InSpline)
+{
+	Reset();
+
+	if (!InSpline)
+		return;
+
+	const FSplineCurves & Curves = InSpline->SplineCurves;
+
+	Spline = InSpline;
+	SplineLength = InSpline->GetSplineLength();
+	NumPoints = Curves.Position.Points.Num();
+	bClosedLoop = InSpline->IsClosedLoop();
+	if (NumPoints)
+	{
+		FirstPoint = Curves.Position.Points[0].OutVal;
+		LastPoint = Curves.Position.Points.Last().OutVal;
+	}
+
+	// Lookups fall back to the splines own search without a table
+	if (NumPoints < 2 || SplineLength <= KINDA_SMALL_NUMBER)
+		return;
+
+	const int32 NumSamples = FMath::Clamp(FMath::CeilToInt(SplineLength / VRSliderSplineLookupSettings::TargetSampleDistance) + 1, 2, VRSliderSplineLookupSettings::MaxSamples);
+	SampleDistance = SplineLength / (NumSamples - 1);
+
+	Locations.SetNumUninitialized(NumSamples);
+	Keys.SetNumUninitialized(NumSamples);
+
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		Keys[i] = Curves.ReparamTable.Eval(i * SampleDistance, 0.0f);
+		Locations[i] = Curves.Position.Eval(Keys[i], FVector::ZeroVector);
+	}
+}
+
+void FVRSliderSplineLookup::Reset()
+{
+	Locations.Reset();
+	Keys.Reset();
+	SampleDistance = 0.0f;
+	Spline.Reset();
+	SplineLength = 0.0f;
+	NumPoints = 0;
+	FirstPoint = FVector::ZeroVector;
+	LastPoint = FVector::ZeroVector;
+	bClosedLoop = false;
+	LastSample = INDEX_NONE;
+}
+
+float FVRSliderSplineLookup::FindInputKeyClosestToWorldLocation(const USplineComponent * InSpline, const FVector & WorldLocation)
+{
+	// Same space that the spline searches in
+	const FVector LocalLocation = InSpline->GetComponentTransform().InverseTransformPosition(WorldLocation);
+	const int32 NumSamples = Locations.Num();
+
+	// In a closed loop the last sample is the first one again at the loop key, it is left out of the search and walks wrap around the seam
+	const int32 NumSearchSamples = bClosedLoop ? NumSamples - 1 : NumSamples;
+	const float LoopKey = Keys.Last();
+
+	int32 BestSample = 0;
+	float BestDistSq = MAX_flt;
+
+	if (LastSample != INDEX_NONE && LastSample < NumSearchSamples)
+	{
+		// Walk both ways from the last closest sample, a few samples past the closest one so that small bumps in the spline don't stop it early
+		BestSample = LastSample;
+		BestDistSq = FVector::DistSquared(LocalLocation, Locations[BestSample]);
+
+		for (int32 Direction = -1; Direction <= 1; Direction += 2)
+		{
+			int32 Misses = 0;
+			for (int32 Step = 1; Step < NumSearchSamples && Misses <= VRSliderSplineLookupSettings::SearchWindow; ++Step)
+			{
+				int32 i = LastSample + (Direction * Step);
+				if (bClosedLoop)
+					i = (i + NumSearchSamples) % NumSearchSamples;
+				else if (i < 0 || i >= NumSearchSamples)
+					break;
+
+				const float DistSq = FVector::DistSquared(LocalLocation, Locations[i]);
+				if (DistSq < BestDistSq)
+				{
+					BestSample = i;
+					BestDistSq = DistSq;
+					Misses = 0;
+				}
+				else
+				{
+					++Misses;
+				}
+			}
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < NumSearchSamples; ++i)
+		{
+			const float DistSq = FVector::DistSquared(LocalLocation, Locations[i]);
+			if (DistSq < BestDistSq)
+			{
+				BestSample = i;
+				BestDistSq = DistSq;
+			}
+		}
+	}
+
+	LastSample = BestSample;
+
+	// Refine between the neighbouring samples with newton steps on the distance to the spline
+	// Across the seam of a closed loop the range runs below key 0, those keys are wrapped back before evaluating
+	const FInterpCurveVector & Position = InSpline->SplineCurves.Position;
+	float MinKey = Keys[FMath::Max(BestSample - 1, 0)];
+	const float MaxKey = Keys[FMath::Min(BestSample + 1, NumSamples - 1)];
+	if (bClosedLoop && BestSample == 0)
+		MinKey = Keys[NumSamples - 2] - LoopKey;
+
+	auto WrapKey = [&](float InKey)
+	{
+		return (bClosedLoop && InKey < 0.0f) ? InKey + LoopKey : InKey;
+	};
+
+	float Key = Keys[BestSample];
+	for (int32 Iteration = 0; Iteration < VRSliderSplineLookupSettings::RefineIterations; ++Iteration)
+	{
+		const float EvalKey = WrapKey(Key);
+		const FVector Delta = Position.Eval(EvalKey, FVector::ZeroVector) - LocalLocation;
+		const FVector Tangent = Position.EvalDerivative(EvalKey, FVector::ZeroVector);
+		const float Slope = (Tangent | Tangent) + (Delta | Position.EvalSecondDerivative(EvalKey, FVector::ZeroVector));
+
+		if (FMath::IsNearlyZero(Slope))
+			break;
+
+		Key = FMath::Clamp(Key - ((Delta | Tangent) / Slope), MinKey, MaxKey);
+	}
+
+	Key = WrapKey(Key);
+
+	if (FVector::DistSquared(Position.Eval(Key, FVector::ZeroVector), LocalLocation) > BestDistSq)
+		Key = Keys[BestSample];
+
+	return Key;
+}
+
+float FVRSliderSplineLookup::GetInputKeyAtDistance(float Distance) const
+{
+	if (!Keys.Num())
+		return 0.0f;
+
+	const float SampleAlpha = FMath::Clamp(Distance / SampleDistance, 0.0f, (float)(Keys.Num() - 1));
+	const int32 Sample = FMath::Min(FMath::FloorToInt(SampleAlpha), Keys.Num() - 2);
+	return FMath::Lerp(Keys[Sample], Keys[Sample + 1], SampleAlpha - Sample);
+}
+
   //=============================================================================
 UVRSliderComponent::UVRSliderComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -118,6 +295,17 @@ void UVRSliderComponent::BeginPlay()
 	bOriginalReplicatesMovement = bReplicateMovement;
 }
 
+void UVRSliderComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	const bool bSharedTick = FVRInteractibleTickManager::SetAwake(this, bEnabled);
+	Super::SetComponentTickEnabled(bEnabled && !bSharedTick);
+}
+
+bool UVRSliderComponent::IsComponentTickEnabled() const
+{
+	return Super::IsComponentTickEnabled() || FVRInteractibleTickManager::IsAwake(this);
+}
+
 void UVRSliderComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	// Call supers tick (though I don't think any of the base classes to this actually implement it)
@@ -197,7 +385,7 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 	if (SplineComponentToFollow != nullptr)
 	{
 		FVector WorldCalculatedLocation = CurrentRelativeTransform.TransformPosition(CalculatedLocation);
-		float ClosestKey = SplineComponentToFollow->FindInputKeyClosestToWorldLocation(WorldCalculatedLocation);
+		float ClosestKey = FindSplineInputKeyClosestToWorldLocation(WorldCalculatedLocation);
 
 		if (bSliderUsesSnapPoints)
 		{
@@ -206,9 +394,11 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 
 			SplineProgress = UVRInteractibleFunctionLibrary::Interactible_GetThresholdSnappedValue(SplineProgress, SnapIncrement, SnapThreshold);
 
-			const int32 NumPoints = SplineComponentToFollow->SplineCurves.Position.Points.Num();
-
-			if (SplineComponentToFollow->SplineCurves.Position.Points.Num() > 1)
+			if (SplineLookup.Keys.Num())
+			{
+				ClosestKey = SplineLookup.GetInputKeyAtDistance(SplineProgress * SplineLength);
+			}
+			else if (SplineComponentToFollow->SplineCurves.Position.Points.Num() > 1)
 			{
 				ClosestKey = SplineComponentToFollow->SplineCurves.ReparamTable.Eval(SplineProgress * SplineLength, 0.0f);
 			}
@@ -242,7 +432,8 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 			}
 			else if (bLerpToNewKey)
 			{
-				trans = SplineComponentToFollow->FindTransformClosestToWorldLocation(WorldCalculatedLocation, ESplineCoordinateSpace::World, true);
+				// ClosestKey is already the closest key to WorldCalculatedLocation
+				trans = SplineComponentToFollow->GetTransformAtSplineInputKey(ClosestKey, ESplineCoordinateSpace::World, true);
 				bChangedLocation = true;
 			}
 
@@ -264,7 +455,7 @@ void UVRSliderComponent::TickGrip_Implementation(UGripMotionControllerComponent
 			}
 			else if (bLerpToNewKey)
 			{
-				WorldLocation = SplineComponentToFollow->FindLocationClosestToWorldLocation(WorldCalculatedLocation, ESplineCoordinateSpace::World);
+				WorldLocation = SplineComponentToFollow->GetLocationAtSplineInputKey(ClosestKey, ESplineCoordinateSpace::World);
 				bChangedLocation = true;
 			}
 
@@ -353,6 +544,7 @@ void UVRSliderComponent::OnGrip_Implementation(UGripMotionControllerComponent *
 	InitialDropLocation = ReversedRelativeTransform.GetTranslation();
 	LastInputKey = -1.0f;
 	LerpedKey = 0.0f;
+	SplineLookup.ResetSeed();
 	bHitEventThreshold = false;
 	LastSliderProgressState = -1.0f;
 	LastSliderProgress = CurrentSliderProgress;
@@ -603,9 +795,21 @@ void UVRSliderComponent::GetLerpedKey(float &ClosestKey, float DeltaTime)
 	}
 }
 
+float UVRSliderComponent::FindSplineInputKeyClosestToWorldLocation(const FVector & WorldLocation)
+{
+	if (!SplineLookup.IsBuiltFor(SplineComponentToFollow))
+		SplineLookup.Build(SplineComponentToFollow);
+
+	if (!SplineLookup.Keys.Num())
+		return SplineComponentToFollow->FindInputKeyClosestToWorldLocation(WorldLocation);
+
+	return SplineLookup.FindInputKeyClosestToWorldLocation(SplineComponentToFollow, WorldLocation);
+}
+
 void UVRSliderComponent::SetSplineComponentToFollow(USplineComponent * SplineToFollow)
 {
 	SplineComponentToFollow = SplineToFollow;
+	SplineLookup.Reset();
 	
 	if (SplineToFollow != nullptr)
 		ResetToParentSplineLocation();
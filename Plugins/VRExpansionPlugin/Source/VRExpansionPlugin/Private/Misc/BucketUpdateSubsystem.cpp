@@ -1,33 +1,55 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 
 #include "Misc/BucketUpdateSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Components/SceneComponent.h"
+#include "UObject/Package.h"
 
-	bool UBucketUpdateSubsystem::AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName)
+DEFINE_LOG_CATEGORY_STATIC(LogBucketUpdateSubsystem, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("BucketUpdateSubsystem ~ UpdateBuckets"), STAT_UpdateBuckets, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("BucketUpdateSubsystem ~ Callbacks"), STAT_BucketCallbacks, STATGROUP_Game);
+
+// Weight of the newest update in the averaged stats
+static const float BucketStatsSmoothing = 0.1f;
+
+	bool FBucketUpdateSubsystemBase::AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle * OutHandle)
 	{
+		if (OutHandle)
+			OutHandle->Invalidate();
+
 		if (!InObject || UpdateHTZ < 1)
 			return false;
 
-		return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName);
+		return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName, OutHandle);
 	}
 
-	bool UBucketUpdateSubsystem::K2_AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName)
+	bool FBucketUpdateSubsystemBase::AddObjectEventToBucket(FDynamicBucketUpdateTickSignature & Delegate, int32 UpdateHTZ, FUpdateBucketHandle * OutHandle)
 	{
-		if (!InObject || UpdateHTZ < 1)
+		if (OutHandle)
+			OutHandle->Invalidate();
+
+		if (!Delegate.IsBound() || UpdateHTZ < 1)
 			return false;
 
-		return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName);
+		return BucketContainer.AddBucketObject(UpdateHTZ, Delegate, OutHandle);
 	}
 
-
-	bool UBucketUpdateSubsystem::K2_AddObjectEventToBucket(FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ)
+	bool FBucketUpdateSubsystemBase::RemoveBucketEntry(FUpdateBucketHandle & Handle)
 	{
-		if (!Delegate.IsBound())
-			return false;
+		const bool bRemoved = BucketContainer.RemoveBucketEntry(Handle);
+		Handle.Invalidate();
+		return bRemoved;
+	}
 
-		return BucketContainer.AddBucketObject(UpdateHTZ, Delegate);
+	bool FBucketUpdateSubsystemBase::IsBucketEntryValid(const FUpdateBucketHandle & Handle) const
+	{
+		return BucketContainer.IsBucketEntryValid(Handle);
 	}
 
-	bool UBucketUpdateSubsystem::RemoveObjectFromBucketByFunctionName(UObject* InObject, FName FunctionName)
+	bool FBucketUpdateSubsystemBase::RemoveObjectFromBucketByFunctionName(UObject* InObject, FName FunctionName)
 	{
 		if (!InObject)
 			return false;
@@ -35,7 +57,7 @@
 		return BucketContainer.RemoveBucketObject(InObject, FunctionName);
 	}
 
-	bool UBucketUpdateSubsystem::RemoveObjectFromBucketByEvent(FDynamicBucketUpdateTickSignature Delegate)
+	bool FBucketUpdateSubsystemBase::RemoveObjectFromBucketByEvent(FDynamicBucketUpdateTickSignature & Delegate)
 	{
 		if (!Delegate.IsBound())
 			return false;
@@ -43,7 +65,7 @@
 		return BucketContainer.RemoveBucketObject(Delegate);
 	}
 
-	bool UBucketUpdateSubsystem::RemoveObjectFromAllBuckets(UObject* InObject)
+	bool FBucketUpdateSubsystemBase::RemoveObjectFromAllBuckets(UObject* InObject)
 	{
 		if (!InObject)
 			return false;
@@ -51,7 +73,7 @@
 		return BucketContainer.RemoveObjectFromAllBuckets(InObject);
 	}
 
-	bool UBucketUpdateSubsystem::IsObjectFunctionInBucket(UObject* InObject, FName FunctionName)
+	bool FBucketUpdateSubsystemBase::IsObjectFunctionInBucket(UObject* InObject, FName FunctionName)
 	{
 		if (!InObject)
 			return false;
@@ -59,9 +81,64 @@
 		return BucketContainer.IsObjectFunctionInBucket(InObject, FunctionName);
 	}
 
+	bool UBucketUpdateSubsystem::K2_AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName)
+	{
+		return AddObjectToBucket(UpdateHTZ, InObject, FunctionName);
+	}
+
+	bool UBucketUpdateSubsystem::K2_AddObjectEventToBucket(FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ)
+	{
+		return AddObjectEventToBucket(Delegate, UpdateHTZ);
+	}
+
+	bool UBucketUpdateSubsystem::K2_AddObjectToBucketWithHandle(int32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle & OutHandle)
+	{
+		return AddObjectToBucket(UpdateHTZ, InObject, FunctionName, &OutHandle);
+	}
+
+	bool UBucketUpdateSubsystem::K2_AddObjectEventToBucketWithHandle(FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ, FUpdateBucketHandle & OutHandle)
+	{
+		return AddObjectEventToBucket(Delegate, UpdateHTZ, &OutHandle);
+	}
+
+	bool UBucketUpdateSubsystem::RemoveBucketEntry(FUpdateBucketHandle & Handle)
+	{
+		return FBucketUpdateSubsystemBase::RemoveBucketEntry(Handle);
+	}
+
+	bool UBucketUpdateSubsystem::IsBucketEntryValid(const FUpdateBucketHandle & Handle)
+	{
+		return FBucketUpdateSubsystemBase::IsBucketEntryValid(Handle);
+	}
+
+	bool UBucketUpdateSubsystem::RemoveObjectFromBucketByFunctionName(UObject* InObject, FName FunctionName)
+	{
+		return FBucketUpdateSubsystemBase::RemoveObjectFromBucketByFunctionName(InObject, FunctionName);
+	}
+
+	bool UBucketUpdateSubsystem::RemoveObjectFromBucketByEvent(FDynamicBucketUpdateTickSignature Delegate)
+	{
+		return FBucketUpdateSubsystemBase::RemoveObjectFromBucketByEvent(Delegate);
+	}
+
+	bool UBucketUpdateSubsystem::RemoveObjectFromAllBuckets(UObject* InObject)
+	{
+		return FBucketUpdateSubsystemBase::RemoveObjectFromAllBuckets(InObject);
+	}
+
+	bool UBucketUpdateSubsystem::IsObjectFunctionInBucket(UObject* InObject, FName FunctionName)
+	{
+		return FBucketUpdateSubsystemBase::IsObjectFunctionInBucket(InObject, FunctionName);
+	}
+
 	bool UBucketUpdateSubsystem::IsActive()
 	{
-		return BucketContainer.bNeedsUpdate;
+		return FBucketUpdateSubsystemBase::IsActive();
+	}
+
+	void UBucketUpdateSubsystem::GetBucketStats(TArray<FUpdateBucketStats> & OutStats)
+	{
+		FBucketUpdateSubsystemBase::GetBucketStats(OutStats);
 	}
 
 	void UBucketUpdateSubsystem::Tick(float DeltaTime)
@@ -101,6 +178,180 @@
 	{
 		RETURN_QUICK_DECLARE_CYCLE_STAT(UVRGripScriptBase, STATGROUP_Tickables);
 	}
+
+	UBucketUpdateWorldSubsystem * UBucketUpdateSubsystem::GetWorldSubsystem(UWorld * InWorld, bool bCreateIfMissing)
+	{
+		if (!InWorld)
+			return nullptr;
+
+		// Only ever a handful of worlds around, a linear search is fine
+		for (UBucketUpdateWorldSubsystem * WorldSubsystem : WorldSubsystems)
+		{
+			if (WorldSubsystem && WorldSubsystem->GetOuter() == InWorld)
+				return WorldSubsystem;
+		}
+
+		if (!bCreateIfMissing || InWorld->bIsTearingDown)
+			return nullptr;
+
+		UBucketUpdateWorldSubsystem * NewSubsystem = NewObject<UBucketUpdateWorldSubsystem>(InWorld);
+		WorldSubsystems.Add(NewSubsystem);
+		return NewSubsystem;
+	}
+
+	void UBucketUpdateSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+	{
+		Super::Initialize(Collection);
+		OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UBucketUpdateSubsystem::OnWorldCleanup);
+	}
+
+	void UBucketUpdateSubsystem::Deinitialize()
+	{
+		FWorldDelegates::OnWorldCleanup.Remove(OnWorldCleanupHandle);
+		OnWorldCleanupHandle.Reset();
+
+		for (UBucketUpdateWorldSubsystem * WorldSubsystem : WorldSubsystems)
+		{
+			if (WorldSubsystem)
+				WorldSubsystem->MarkPendingKill();
+		}
+		WorldSubsystems.Empty();
+
+		Super::Deinitialize();
+	}
+
+	void UBucketUpdateSubsystem::OnWorldCleanup(UWorld * World, bool bSessionEnded, bool bCleanupResources)
+	{
+		// Drop our reference so that we don't keep the world around
+		for (int32 i = WorldSubsystems.Num() - 1; i >= 0; --i)
+		{
+			UBucketUpdateWorldSubsystem * WorldSubsystem = WorldSubsystems[i];
+			if (!WorldSubsystem || WorldSubsystem->GetOuter() == World)
+			{
+				if (WorldSubsystem)
+					WorldSubsystem->MarkPendingKill();
+
+				WorldSubsystems.RemoveAtSwap(i, 1, false);
+			}
+		}
+	}
+
+	UBucketUpdateWorldSubsystem * UBucketUpdateWorldSubsystem::Get(const UObject * WorldContextObject, bool bCreateIfMissing)
+	{
+		if (!GEngine || !WorldContextObject)
+			return nullptr;
+
+		UWorld * World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+		UBucketUpdateSubsystem * Subsystem = GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>();
+
+		if (!World || !Subsystem)
+			return nullptr;
+
+		return Subsystem->GetWorldSubsystem(World, bCreateIfMissing);
+	}
+
+	UBucketUpdateWorldSubsystem * UBucketUpdateWorldSubsystem::K2_Get(UObject * WorldContextObject)
+	{
+		return Get(WorldContextObject);
+	}
+
+	bool UBucketUpdateWorldSubsystem::K2_AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName)
+	{
+		return AddObjectToBucket(UpdateHTZ, InObject, FunctionName);
+	}
+
+	bool UBucketUpdateWorldSubsystem::K2_AddObjectEventToBucket(FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ)
+	{
+		return AddObjectEventToBucket(Delegate, UpdateHTZ);
+	}
+
+	bool UBucketUpdateWorldSubsystem::K2_AddObjectToBucketWithHandle(int32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle & OutHandle)
+	{
+		return AddObjectToBucket(UpdateHTZ, InObject, FunctionName, &OutHandle);
+	}
+
+	bool UBucketUpdateWorldSubsystem::K2_AddObjectEventToBucketWithHandle(FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ, FUpdateBucketHandle & OutHandle)
+	{
+		return AddObjectEventToBucket(Delegate, UpdateHTZ, &OutHandle);
+	}
+
+	bool UBucketUpdateWorldSubsystem::RemoveBucketEntry(FUpdateBucketHandle & Handle)
+	{
+		return FBucketUpdateSubsystemBase::RemoveBucketEntry(Handle);
+	}
+
+	bool UBucketUpdateWorldSubsystem::IsBucketEntryValid(const FUpdateBucketHandle & Handle)
+	{
+		return FBucketUpdateSubsystemBase::IsBucketEntryValid(Handle);
+	}
+
+	bool UBucketUpdateWorldSubsystem::RemoveObjectFromBucketByFunctionName(UObject* InObject, FName FunctionName)
+	{
+		return FBucketUpdateSubsystemBase::RemoveObjectFromBucketByFunctionName(InObject, FunctionName);
+	}
+
+	bool UBucketUpdateWorldSubsystem::RemoveObjectFromBucketByEvent(FDynamicBucketUpdateTickSignature Delegate)
+	{
+		return FBucketUpdateSubsystemBase::RemoveObjectFromBucketByEvent(Delegate);
+	}
+
+	bool UBucketUpdateWorldSubsystem::RemoveObjectFromAllBuckets(UObject* InObject)
+	{
+		return FBucketUpdateSubsystemBase::RemoveObjectFromAllBuckets(InObject);
+	}
+
+	bool UBucketUpdateWorldSubsystem::IsObjectFunctionInBucket(UObject* InObject, FName FunctionName)
+	{
+		return FBucketUpdateSubsystemBase::IsObjectFunctionInBucket(InObject, FunctionName);
+	}
+
+	bool UBucketUpdateWorldSubsystem::IsActive()
+	{
+		return FBucketUpdateSubsystemBase::IsActive();
+	}
+
+	void UBucketUpdateWorldSubsystem::GetBucketStats(TArray<FUpdateBucketStats> & OutStats)
+	{
+		FBucketUpdateSubsystemBase::GetBucketStats(OutStats);
+	}
+
+	void UBucketUpdateWorldSubsystem::Tick(float DeltaTime)
+	{
+		BucketContainer.UpdateBuckets(DeltaTime);
+	}
+
+	bool UBucketUpdateWorldSubsystem::IsTickable() const
+	{
+		return BucketContainer.bNeedsUpdate && !IsPendingKill();
+	}
+
+	UWorld* UBucketUpdateWorldSubsystem::GetTickableGameObjectWorld() const
+	{
+		return GetTypedOuter<UWorld>();
+	}
+
+	bool UBucketUpdateWorldSubsystem::IsTickableInEditor() const
+	{
+		return false;
+	}
+
+	bool UBucketUpdateWorldSubsystem::IsTickableWhenPaused() const
+	{
+		return false;
+	}
+
+	ETickableTickType UBucketUpdateWorldSubsystem::GetTickableTickType() const
+	{
+		if (IsTemplate(RF_ClassDefaultObject))
+			return ETickableTickType::Never;
+
+		return ETickableTickType::Conditional;
+	}
+
+	TStatId UBucketUpdateWorldSubsystem::GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(UBucketUpdateWorldSubsystem, STATGROUP_Tickables);
+	}
 	
 	bool FUpdateBucketDrop::ExecuteBoundCallback()
 	{
@@ -155,134 +406,214 @@
 		}
 	}
 	
-	bool FUpdateBucket::Update(float DeltaTime)
+	void FUpdateBucketContainer::UpdateBuckets(float DeltaTime)
 	{
-		//#TODO: Need to consider batching / spreading out load if there are a lot of updating objects in the bucket
-		if (Callbacks.Num() < 1)
-			return false;
+		SCOPE_CYCLE_COUNTER(STAT_UpdateBuckets);
 
-		// Check for if this bucket is ready to fire events
-		nUpdateCount += DeltaTime;
-		if (nUpdateCount >= nUpdateRate)
+		// Callbacks can add buckets, so the map can't be iterated while they run
+		TArray<uint32, TInlineAllocator<8>> BucketKeys;
+		ReplicationBuckets.GetKeys(BucketKeys);
+
+		for (const uint32 Key : BucketKeys)
 		{
-			nUpdateCount = 0.0f;
-			for (int i = Callbacks.Num() - 1; i >= 0; --i)
+			if (!UpdateBucket(Key, DeltaTime))
 			{
-				if (Callbacks[i].ExecuteBoundCallback())
-				{
-					// If this returns true then we keep it in the queue
-					continue;
-				}
-
-				// Remove the callback, it is complete or invalid
-				Callbacks.RemoveAt(i);
+				// Remove unused buckets so that they don't get ticked
+				ReplicationBuckets.Remove(Key);
 			}
 		}
 
-		return Callbacks.Num() > 0;
+		if (ReplicationBuckets.Num() < 1)
+			bNeedsUpdate = false;
 	}
-	
-	void FUpdateBucketContainer::UpdateBuckets(float DeltaTime)
+
+	bool FUpdateBucketContainer::UpdateBucket(uint32 BucketKey, float DeltaTime)
 	{
-		TArray<uint32> BucketsToRemove;
-		for(auto& Bucket : ReplicationBuckets)
-		{		
-			if (!Bucket.Value.Update(DeltaTime))
+		FUpdateBucket * Bucket = ReplicationBuckets.Find(BucketKey);
+		if (!Bucket || Bucket->EntryIndices.Num() < 1)
+			return false;
+
+		// Every callback is owed one call per period, so the bucket as a whole owes Num / period calls per second.
+		// Capped at one round so that a hitch doesn't turn in to several rounds in a row to catch up.
+		const int32 NumCallbacks = Bucket->EntryIndices.Num();
+		Bucket->PendingCalls = FMath::Min(Bucket->PendingCalls + (NumCallbacks * DeltaTime) / Bucket->nUpdateRate, (float)NumCallbacks);
+
+		const int32 CallsThisFrame = FMath::FloorToInt(Bucket->PendingCalls);
+		Bucket->PendingCalls -= CallsThisFrame;
+
+		const double StartTime = FPlatformTime::Seconds();
+		int32 CallsMade = 0;
+
+		for (; CallsMade < CallsThisFrame && Bucket->EntryIndices.Num() > 0; ++CallsMade)
+		{
+			if (Bucket->NextCallback >= Bucket->EntryIndices.Num())
+				Bucket->NextCallback = 0;
+
+			// Counts as having had its turn before it runs, so that anything the callback removes keeps the order of the rest
+			const int32 EntryIndex = Bucket->EntryIndices[Bucket->NextCallback++];
+			const int32 Serial = Entries[EntryIndex].Serial;
+			const bool bKeepEntry = Entries[EntryIndex].Drop.ExecuteBoundCallback();
+
+			// The callback can add or remove entries (including its own) and buckets, so look everything up again
+			Bucket = ReplicationBuckets.Find(BucketKey);
+			if (!Bucket)
+				return false;
+
+			// If this returns true then we keep it in the queue, otherwise it is complete or invalid
+			if (!bKeepEntry && Entries[EntryIndex].Serial == Serial && Entries[EntryIndex].BucketKey == BucketKey)
 			{
-				// Add Bucket to list to remove at end of update
-				BucketsToRemove.Add(Bucket.Key);
+				RemoveEntry(EntryIndex);
 			}
 		}
 
-		// Remove unused buckets so that they don't get ticked
-		for (const uint32 Key : BucketsToRemove)
-		{
-			ReplicationBuckets.Remove(Key);
-		}
+		const float FrameTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		FUpdateBucketStats & Stats = Bucket->Stats;
+		Stats.NumEntries = Bucket->EntryIndices.Num();
+		Stats.LastFrameCalls = CallsMade;
+		Stats.LastFrameTimeMs = FrameTimeMs;
+		Stats.AverageCallsPerFrame = FMath::Lerp(Stats.AverageCallsPerFrame, (float)CallsMade, BucketStatsSmoothing);
+		Stats.AverageFrameTimeMs = FMath::Lerp(Stats.AverageFrameTimeMs, FrameTimeMs, BucketStatsSmoothing);
+		INC_DWORD_STAT_BY(STAT_BucketCallbacks, CallsMade);
 
-		if (ReplicationBuckets.Num() < 1)
-			bNeedsUpdate = false;
+		return Bucket->EntryIndices.Num() > 0;
 	}
 
-	bool FUpdateBucketContainer::AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName)
+	bool FUpdateBucketContainer::AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle * OutHandle)
 	{
+		if (OutHandle)
+			OutHandle->Invalidate();
+
 		if (!InObject || InObject->FindFunction(FunctionName) == nullptr || UpdateHTZ < 1)
 			return false;
 
-		// First verify that this object isn't already contained in a bucket, if it is then erase it so that we can replace it below
-		RemoveBucketObject(InObject, FunctionName);
+		const FUpdateBucketHandle Handle = AddEntry(UpdateHTZ, FUpdateBucketDrop(InObject, FunctionName), FObjectKey(InObject), FunctionName, false);
 
-		if (ReplicationBuckets.Contains(UpdateHTZ))
-		{
-			ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdateBucketDrop(InObject, FunctionName));
-		}
-		else
-		{
-			FUpdateBucket & newBucket = ReplicationBuckets.Add(UpdateHTZ, FUpdateBucket(UpdateHTZ));
-			ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdateBucketDrop(InObject, FunctionName));
-		}
+		if (OutHandle)
+			*OutHandle = Handle;
 
-		if (ReplicationBuckets.Num() > 0)
-			bNeedsUpdate = true;
-
-		return true;
+		return Handle.IsSet();
 	}
 
-
-	bool FUpdateBucketContainer::AddBucketObject(uint32 UpdateHTZ, FDynamicBucketUpdateTickSignature &Delegate)
+	bool FUpdateBucketContainer::AddBucketObject(uint32 UpdateHTZ, FDynamicBucketUpdateTickSignature &Delegate, FUpdateBucketHandle * OutHandle)
 	{
+		if (OutHandle)
+			OutHandle->Invalidate();
+
 		if (!Delegate.IsBound() || UpdateHTZ < 1)
 			return false;
 
+		const FUpdateBucketHandle Handle = AddEntry(UpdateHTZ, FUpdateBucketDrop(Delegate), FObjectKey(Delegate.GetUObject()), Delegate.GetFunctionName(), true);
+
+		if (OutHandle)
+			*OutHandle = Handle;
+
+		return Handle.IsSet();
+	}
+
+	FUpdateBucketHandle FUpdateBucketContainer::AddEntry(uint32 UpdateHTZ, FUpdateBucketDrop && Drop, const FObjectKey & Object, FName FunctionName, bool bIsDynamic)
+	{
 		// First verify that this object isn't already contained in a bucket, if it is then erase it so that we can replace it below
-		RemoveBucketObject(Delegate);
+		const int32 ExistingEntry = FindEntry(Object, FunctionName, bIsDynamic);
+		if (ExistingEntry != INDEX_NONE)
+		{
+			RemoveEntry(ExistingEntry);
+		}
 
-		if (ReplicationBuckets.Contains(UpdateHTZ))
+		int32 EntryIndex = FirstFreeEntry;
+		if (EntryIndex != INDEX_NONE)
 		{
-			ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdateBucketDrop(Delegate));
+			FirstFreeEntry = Entries[EntryIndex].NextFree;
 		}
 		else
 		{
-			FUpdateBucket & newBucket = ReplicationBuckets.Add(UpdateHTZ, FUpdateBucket(UpdateHTZ));
-			ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdateBucketDrop(Delegate));
+			EntryIndex = Entries.AddDefaulted();
 		}
 
-		if (ReplicationBuckets.Num() > 0)
-			bNeedsUpdate = true;
+		FUpdateBucket * Bucket = ReplicationBuckets.Find(UpdateHTZ);
+		if (!Bucket)
+		{
+			Bucket = &ReplicationBuckets.Add(UpdateHTZ, FUpdateBucket(UpdateHTZ));
+		}
 
-		return true;
+		FUpdateBucketEntry & Entry = Entries[EntryIndex];
+		Entry.Drop = MoveTemp(Drop);
+		Entry.Object = Object;
+		Entry.FunctionName = FunctionName;
+		Entry.bIsDynamic = bIsDynamic;
+		Entry.BucketKey = UpdateHTZ;
+		Entry.SlotInBucket = Bucket->EntryIndices.Add(EntryIndex);
+		Entry.Serial = NextSerial;
+		Entry.NextFree = INDEX_NONE;
+
+		// Zero is reserved for free entries
+		NextSerial = NextSerial == MAX_int32 ? 1 : NextSerial + 1;
+		++NumUsedEntries;
+
+		(bIsDynamic ? DynamicEntryLookup : NativeEntryLookup).Add(FUpdateBucketEntryKey(Object, FunctionName), EntryIndex);
+		ObjectEntryLookup.Add(Object, EntryIndex);
+
+		bNeedsUpdate = true;
+		return FUpdateBucketHandle(EntryIndex, Entry.Serial);
 	}
 
-	bool FUpdateBucketContainer::RemoveBucketObject(UObject * ObjectToRemove, FName FunctionName)
+	void FUpdateBucketContainer::RemoveEntry(int32 EntryIndex)
 	{
-		if (!ObjectToRemove || ObjectToRemove->FindFunction(FunctionName) == nullptr)
-			return false;
+		FUpdateBucketEntry & Entry = Entries[EntryIndex];
 
-		// Store if we ended up removing it
-		bool bRemovedObject = false;
-
-		TArray<uint32> BucketsToRemove;
-		for (auto& Bucket : ReplicationBuckets)
+		if (FUpdateBucket * Bucket = ReplicationBuckets.Find(Entry.BucketKey))
 		{
-			for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-			{
-				if (Bucket.Value.Callbacks[i].IsBoundToObjectFunction(ObjectToRemove, FunctionName))
-				{
-					Bucket.Value.Callbacks.RemoveAt(i);
-					bRemovedObject = true;
+			TArray<int32> & Slots = Bucket->EntryIndices;
+			int32 Slot = Entry.SlotInBucket;
 
-					// Leave the loop, this is called in add as well so we should never get duplicate entries
-					break;
-				}
+			// Swap remove that keeps the turn order, slots before NextCallback have had their turn this round and the rest haven't.
+			// If the removed slot has had its turn, the last entry that has had its turn moves in to it and the gap moves up to there.
+			if (Slot < Bucket->NextCallback)
+			{
+				const int32 LastTakenSlot = --Bucket->NextCallback;
+				Slots[Slot] = Slots[LastTakenSlot];
+				Entries[Slots[Slot]].SlotInBucket = Slot;
+				Slot = LastTakenSlot;
 			}
 
-			if (bRemovedObject)
+			const int32 LastSlot = Slots.Num() - 1;
+			if (Slot != LastSlot)
 			{
-				break;
+				Slots[Slot] = Slots[LastSlot];
+				Entries[Slots[Slot]].SlotInBucket = Slot;
 			}
+
+			Slots.Pop(false);
 		}
 
-		return bRemovedObject;
+		(Entry.bIsDynamic ? DynamicEntryLookup : NativeEntryLookup).Remove(FUpdateBucketEntryKey(Entry.Object, Entry.FunctionName));
+		ObjectEntryLookup.RemoveSingle(Entry.Object, EntryIndex);
+
+		// Unbinds the delegates
+		Entry.Drop = FUpdateBucketDrop();
+		Entry.SlotInBucket = INDEX_NONE;
+		Entry.Serial = 0;
+		Entry.NextFree = FirstFreeEntry;
+		FirstFreeEntry = EntryIndex;
+		--NumUsedEntries;
+	}
+
+	int32 FUpdateBucketContainer::FindEntry(const FObjectKey & Object, FName FunctionName, bool bIsDynamic) const
+	{
+		const int32 * EntryIndex = (bIsDynamic ? DynamicEntryLookup : NativeEntryLookup).Find(FUpdateBucketEntryKey(Object, FunctionName));
+		return EntryIndex ? *EntryIndex : INDEX_NONE;
+	}
+
+	bool FUpdateBucketContainer::RemoveBucketObject(UObject * ObjectToRemove, FName FunctionName)
+	{
+		if (!ObjectToRemove)
+			return false;
+
+		const int32 EntryIndex = FindEntry(FObjectKey(ObjectToRemove), FunctionName, false);
+		if (EntryIndex == INDEX_NONE)
+			return false;
+
+		RemoveEntry(EntryIndex);
+		return true;
 	}
 
 	bool FUpdateBucketContainer::RemoveBucketObject(FDynamicBucketUpdateTickSignature &DynEvent)
@@ -290,31 +621,21 @@
 		if (!DynEvent.IsBound())
 			return false;
 
-		// Store if we ended up removing it
-		bool bRemovedObject = false;
-
-		TArray<uint32> BucketsToRemove;
-		for (auto& Bucket : ReplicationBuckets)
-		{
-			for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-			{
-				if (Bucket.Value.Callbacks[i].IsBoundToObjectDelegate(DynEvent))
-				{
-					Bucket.Value.Callbacks.RemoveAt(i);
-					bRemovedObject = true;
+		const int32 EntryIndex = FindEntry(FObjectKey(DynEvent.GetUObject()), DynEvent.GetFunctionName(), true);
+		if (EntryIndex == INDEX_NONE)
+			return false;
 
-					// Leave the loop, this is called in add as well so we should never get duplicate entries
-					break;
-				}
-			}
+		RemoveEntry(EntryIndex);
+		return true;
+	}
 
-			if (bRemovedObject)
-			{
-				break;
-			}
-		}
+	bool FUpdateBucketContainer::RemoveBucketEntry(const FUpdateBucketHandle & Handle)
+	{
+		if (!IsBucketEntryValid(Handle))
+			return false;
 
-		return bRemovedObject;
+		RemoveEntry(Handle.Index);
+		return true;
 	}
 
 	bool FUpdateBucketContainer::RemoveObjectFromAllBuckets(UObject * ObjectToRemove)
@@ -322,59 +643,33 @@
 		if (!ObjectToRemove)
 			return false;
 
-		// Store if we ended up removing it
-		bool bRemovedObject = false;
+		const FObjectKey Object(ObjectToRemove);
+
+		TArray<int32, TInlineAllocator<4>> EntriesToRemove;
+		ObjectEntryLookup.MultiFind(Object, EntriesToRemove);
 
-		TArray<uint32> BucketsToRemove;
-		for (auto& Bucket : ReplicationBuckets)
+		for (const int32 EntryIndex : EntriesToRemove)
 		{
-			for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-			{
-				if (Bucket.Value.Callbacks[i].IsBoundToObject(ObjectToRemove))
-				{
-					Bucket.Value.Callbacks.RemoveAt(i);
-					bRemovedObject = true;
-				}
-			}
+			RemoveEntry(EntryIndex);
 		}
 
-		return bRemovedObject;
+		return EntriesToRemove.Num() > 0;
 	}
 
 	bool FUpdateBucketContainer::IsObjectInBucket(UObject * ObjectToRemove)
 	{
 		if (!ObjectToRemove)
 			return false;
-		for (auto& Bucket : ReplicationBuckets)
-		{
-			for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-			{
-				if (Bucket.Value.Callbacks[i].IsBoundToObject(ObjectToRemove))
-				{
-					return true;
-				}
-			}
-		}
 
-		return false;
+		return ObjectEntryLookup.Contains(FObjectKey(ObjectToRemove));
 	}
 
 	bool FUpdateBucketContainer::IsObjectFunctionInBucket(UObject * ObjectToRemove, FName FunctionName)
 	{
 		if (!ObjectToRemove)
 			return false;
-		for (auto& Bucket : ReplicationBuckets)
-		{
-			for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-			{
-				if (Bucket.Value.Callbacks[i].IsBoundToObjectFunction(ObjectToRemove, FunctionName))
-				{
-					return true;
-				}
-			}
-		}
 
-		return false;
+		return FindEntry(FObjectKey(ObjectToRemove), FunctionName, false) != INDEX_NONE;
 	}
 
 	bool FUpdateBucketContainer::IsObjectDelegateInBucket(FDynamicBucketUpdateTickSignature &DynEvent)
@@ -382,16 +677,154 @@
 		if (!DynEvent.IsBound())
 			return false;
 
-		for (auto& Bucket : ReplicationBuckets)
+		return FindEntry(FObjectKey(DynEvent.GetUObject()), DynEvent.GetFunctionName(), true) != INDEX_NONE;
+	}
+
+	bool FUpdateBucketContainer::IsBucketEntryValid(const FUpdateBucketHandle & Handle) const
+	{
+		return Entries.IsValidIndex(Handle.Index) && Handle.Serial != 0 && Entries[Handle.Index].Serial == Handle.Serial;
+	}
+
+	void FUpdateBucketContainer::GetBucketStats(TArray<FUpdateBucketStats> & OutStats) const
+	{
+		OutStats.Reset(ReplicationBuckets.Num());
+
+		for (const auto& Bucket : ReplicationBuckets)
 		{
-			for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
+			FUpdateBucketStats & BucketStats = OutStats[OutStats.Add(Bucket.Value.Stats)];
+			BucketStats.UpdateHTZ = Bucket.Key;
+			BucketStats.NumEntries = Bucket.Value.EntryIndices.Num();
+		}
+	}
+
+#if !UE_BUILD_SHIPPING
+	static FAutoConsoleCommand BucketStatsCommand(
+		TEXT("vr.BucketUpdate.Stats"),
+		TEXT("Logs the entries, calls per frame and time spent of every active update bucket, for the engine and for each world."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			UBucketUpdateSubsystem * Subsystem = GEngine ? GEngine->GetEngineSubsystem<UBucketUpdateSubsystem>() : nullptr;
+			if (!Subsystem)
+				return;
+
+			auto LogStats = [](const FString & Owner, const TArray<FUpdateBucketStats> & Stats)
 			{
-				if (Bucket.Value.Callbacks[i].IsBoundToObjectDelegate(DynEvent))
+				UE_LOG(LogBucketUpdateSubsystem, Log, TEXT("%s: %d active update buckets"), *Owner, Stats.Num());
+				for (const FUpdateBucketStats & BucketStats : Stats)
 				{
-					return true;
+					UE_LOG(LogBucketUpdateSubsystem, Log, TEXT("  %dhtz: %d entries, %d calls last frame (%.2f avg), %.3fms last frame (%.3fms avg)"),
+						BucketStats.UpdateHTZ, BucketStats.NumEntries, BucketStats.LastFrameCalls, BucketStats.AverageCallsPerFrame, BucketStats.LastFrameTimeMs, BucketStats.AverageFrameTimeMs);
 				}
+			};
+
+			TArray<FUpdateBucketStats> Stats;
+			Subsystem->GetBucketStats(Stats);
+			LogStats(TEXT("Engine"), Stats);
+
+			for (UBucketUpdateWorldSubsystem * WorldSubsystem : Subsystem->GetWorldSubsystems())
+			{
+				if (!WorldSubsystem)
+					continue;
+
+				Stats.Reset();
+				WorldSubsystem->GetBucketStats(Stats);
+				LogStats(WorldSubsystem->GetOuter()->GetPathName(), Stats);
+			}
+		}));
+
+	namespace BucketUpdateBenchmark
+	{
+		// Random add / remove cycles against a container that already holds NumObjects entries, then checks that the lookups
+		// agree with what was added
+		static void RunBenchmark(const TArray<FString> & Args)
+		{
+			const int32 Cycles = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+			const int32 NumObjects = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+			const uint32 Rates[] = { 10, 30, 60, 100 };
+
+			// Any UFUNCTION will do, nothing gets updated
+			const FName FunctionName = GET_FUNCTION_NAME_CHECKED(USceneComponent, K2_GetComponentLocation);
+
+			TArray<USceneComponent*> Objects;
+			for (int32 i = 0; i < NumObjects; ++i)
+			{
+				Objects.Add(NewObject<USceneComponent>(GetTransientPackage()));
+			}
+
+			FUpdateBucketContainer Container;
+			TArray<FUpdateBucketHandle> Handles;
+			Handles.SetNum(NumObjects);
+
+			FRandomStream Stream(0x5EED);
+			for (int32 i = 0; i < NumObjects; ++i)
+			{
+				Container.AddBucketObject(Rates[Stream.RandHelper(ARRAY_COUNT(Rates))], Objects[i], FunctionName, &Handles[i]);
+			}
+
+			double AddTime = 0.0;
+			double RemoveTime = 0.0;
+			double HandleRemoveTime = 0.0;
+			int32 Errors = 0;
+
+			for (int32 Cycle = 0; Cycle < Cycles; ++Cycle)
+			{
+				const int32 Index = Stream.RandHelper(NumObjects);
+				const bool bByHandle = (Cycle & 1) != 0;
+
+				double StartTime = FPlatformTime::Seconds();
+				const bool bRemoved = bByHandle ? Container.RemoveBucketEntry(Handles[Index]) : Container.RemoveBucketObject(Objects[Index], FunctionName);
+				(bByHandle ? HandleRemoveTime : RemoveTime) += FPlatformTime::Seconds() - StartTime;
+
+				if (!bRemoved || Container.IsObjectFunctionInBucket(Objects[Index], FunctionName) || Container.IsBucketEntryValid(Handles[Index]))
+					++Errors;
+
+				StartTime = FPlatformTime::Seconds();
+				Container.AddBucketObject(Rates[Stream.RandHelper(ARRAY_COUNT(Rates))], Objects[Index], FunctionName, &Handles[Index]);
+				AddTime += FPlatformTime::Seconds() - StartTime;
+
+				if (!Container.IsBucketEntryValid(Handles[Index]))
+					++Errors;
+			}
+
+			// Every object has exactly one entry, in exactly one bucket
+			int32 EntriesInBuckets = 0;
+			for (const auto & Bucket : Container.ReplicationBuckets)
+			{
+				EntriesInBuckets += Bucket.Value.EntryIndices.Num();
+			}
+
+			for (int32 i = 0; i < NumObjects; ++i)
+			{
+				if (!Container.IsObjectFunctionInBucket(Objects[i], FunctionName) || !Container.IsBucketEntryValid(Handles[i]))
+					++Errors;
+			}
+
+			if (EntriesInBuckets != NumObjects || Container.GetNumEntries() != NumObjects)
+				++Errors;
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (USceneComponent * Object : Objects)
+			{
+				Container.RemoveObjectFromAllBuckets(Object);
+			}
+			const double RemoveAllTime = FPlatformTime::Seconds() - StartTime;
+
+			if (Container.GetNumEntries() != 0)
+				++Errors;
+
+			UE_LOG(LogBucketUpdateSubsystem, Log, TEXT("Bucket benchmark: %d cycles with %d entries, add %.3fus, remove by function %.3fus, remove by handle %.3fus, remove all %.3fus (per call), %d errors"),
+				Cycles, NumObjects, AddTime * 1000000.0 / Cycles, RemoveTime * 2000000.0 / Cycles, HandleRemoveTime * 2000000.0 / Cycles, RemoveAllTime * 1000000.0 / NumObjects, Errors);
+
+			for (USceneComponent * Object : Objects)
+			{
+				Object->MarkPendingKill();
 			}
 		}
 
-		return false;
-	}
\ No newline at end of file
+		static FAutoConsoleCommandWithArgs BenchmarkCommand(
+			TEXT("vr.BucketUpdate.Benchmark"),
+			TEXT("Times random add / remove cycles on an update bucket container already holding a number of entries and checks the lookups after.\n")
+			TEXT("Usage: vr.BucketUpdate.Benchmark [Cycles=10000] [Entries=1000]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+	}
+#endif
@@ -11,6 +11,11 @@
 #include "AIModule/Classes/Perception/AISightTargetInterface.h"
 #include "AIModule/Classes/Perception/AISenseConfig_Sight.h"
 #include "AIModule/Classes/Perception/AIPerceptionSystem.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "VRCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "UObject/UObjectIterator.h"
 
 #if WITH_GAMEPLAY_DEBUGGER
 #include "GameplayDebugger/Public/GameplayDebuggerTypes.h"
@@ -36,7 +41,30 @@ DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Remove By Listener"), STAT_AI_
 DECLARE_CYCLE_STAT(TEXT("Perception Sense: Sight, Remove To Target"), STAT_AI_Sense_Sight_RemoveToTarget, STATGROUP_AI);
 
 
+#if !UE_BUILD_SHIPPING
+namespace AISenseSightVRBenchmark
+{
+	// Time that UAISense_Sight_VR::Update takes while the benchmark is running
+	struct FUpdateTiming
+	{
+		TWeakObjectPtr<UWorld> World;
+		double TotalTime;
+		double MaxTime;
+		int32 NumUpdates;
+
+		FUpdateTiming() :
+			TotalTime(0.0),
+			MaxTime(0.0),
+			NumUpdates(0)
+		{}
+	};
+
+	static FUpdateTiming* ActiveTiming = nullptr;
+}
+#endif
+
 static const int32 DefaultMaxTracesPerTick = 6;
+static const int32 DefaultMaxAsyncTracesPerTick = 48;
 static const int32 DefaultMinQueriesPerTimeSliceCheck = 40;
 
 //----------------------------------------------------------------------//
@@ -53,6 +81,68 @@ FORCEINLINE_DEBUGGABLE bool CheckIsTargetInSightPie(const FPerceptionListener& L
 	return false;
 }
 
+FORCEINLINE_DEBUGGABLE bool IsLineOfSightClear(const AActor* TargetActor, const FHitResult* BlockingHit)
+{
+	const AActor* HitResultActor = BlockingHit ? BlockingHit->Actor.Get() : nullptr;
+	return BlockingHit == nullptr || (HitResultActor && HitResultActor->IsOwnedBy(TargetActor));
+}
+
+// Fills in the locations of the points to trace to and returns their EVRSightTargetPoint bits, TargetLocation is the body point
+static uint8 GetSightPoints(const UAISense_Sight_VR::FDigestedSightProperties& DigestedProps, const AActor* TargetActor, const FVector& TargetLocation, FVector (&OutLocations)[EVRSightTargetPoint::Count])
+{
+	const uint8 BodyBit = 1 << EVRSightTargetPoint::Body;
+	OutLocations[EVRSightTargetPoint::Body] = TargetLocation;
+
+	const AVRBaseCharacter * VRChar = Cast<const AVRBaseCharacter>(TargetActor);
+	if (VRChar == nullptr)
+	{
+		return BodyBit;
+	}
+
+	uint8 PointMask = DigestedProps.VRSightPointMask & BodyBit;
+
+	if (DigestedProps.VRSightPointMask & (1 << EVRSightTargetPoint::Head))
+	{
+		OutLocations[EVRSightTargetPoint::Head] = VRChar->GetVRHeadLocation();
+		PointMask |= 1 << EVRSightTargetPoint::Head;
+	}
+
+	if ((DigestedProps.VRSightPointMask & (1 << EVRSightTargetPoint::LeftHand)) && VRChar->LeftMotionController)
+	{
+		OutLocations[EVRSightTargetPoint::LeftHand] = VRChar->LeftMotionController->GetComponentLocation();
+		PointMask |= 1 << EVRSightTargetPoint::LeftHand;
+	}
+
+	if ((DigestedProps.VRSightPointMask & (1 << EVRSightTargetPoint::RightHand)) && VRChar->RightMotionController)
+	{
+		OutLocations[EVRSightTargetPoint::RightHand] = VRChar->RightMotionController->GetComponentLocation();
+		PointMask |= 1 << EVRSightTargetPoint::RightHand;
+	}
+
+	return PointMask != 0 ? PointMask : BodyBit;
+}
+
+// Orders the points in the mask for tracing, FirstPoint (the last visible one) goes first if it is in there
+static int32 GetSightPointOrder(uint8 PointMask, uint8 FirstPoint, uint8 (&OutOrder)[EVRSightTargetPoint::Count])
+{
+	int32 NumPoints = 0;
+
+	if (FirstPoint < EVRSightTargetPoint::Count && (PointMask & (1 << FirstPoint)))
+	{
+		OutOrder[NumPoints++] = FirstPoint;
+	}
+
+	for (uint8 Point = 0; Point < EVRSightTargetPoint::Count; ++Point)
+	{
+		if (Point != FirstPoint && (PointMask & (1 << Point)))
+		{
+			OutOrder[NumPoints++] = Point;
+		}
+	}
+
+	return NumPoints;
+}
+
 //----------------------------------------------------------------------//
 // FAISightTargetVR
 //----------------------------------------------------------------------//
@@ -82,10 +172,14 @@ UAISense_Sight_VR::FDigestedSightProperties::FDigestedSightProperties(const UAIS
 	AffiliationFlags = SenseConfig.DetectionByAffiliation.GetAsFlags();
 	// keep the special value of FAISystem::InvalidRange (-1.f) if it's set.
 	AutoSuccessRangeSqFromLastSeenLocation = (SenseConfig.AutoSuccessRangeFromLastSeenLocation == FAISystem::InvalidRange) ? FAISystem::InvalidRange : FMath::Square(SenseConfig.AutoSuccessRangeFromLastSeenLocation);
+
+	VRSightPointMask = (SenseConfig.bTraceToVRBody ? (1 << EVRSightTargetPoint::Body) : 0)
+		| (SenseConfig.bTraceToVRHead ? (1 << EVRSightTargetPoint::Head) : 0)
+		| (SenseConfig.bTraceToVRHands ? ((1 << EVRSightTargetPoint::LeftHand) | (1 << EVRSightTargetPoint::RightHand)) : 0);
 }
 
 UAISense_Sight_VR::FDigestedSightProperties::FDigestedSightProperties()
-	: PeripheralVisionAngleCos(0.f), SightRadiusSq(-1.f), AutoSuccessRangeSqFromLastSeenLocation(FAISystem::InvalidRange), LoseSightRadiusSq(-1.f), AffiliationFlags(-1)
+	: PeripheralVisionAngleCos(0.f), SightRadiusSq(-1.f), AutoSuccessRangeSqFromLastSeenLocation(FAISystem::InvalidRange), LoseSightRadiusSq(-1.f), AffiliationFlags(-1), VRSightPointMask(1 << EVRSightTargetPoint::Body)
 {}
 
 //----------------------------------------------------------------------//
@@ -96,6 +190,8 @@ UAISense_Sight_VR::UAISense_Sight_VR(const FObjectInitializer& ObjectInitializer
 	, MaxTracesPerTick(DefaultMaxTracesPerTick)
 	, MinQueriesPerTimeSliceCheck(DefaultMinQueriesPerTimeSliceCheck)
 	, MaxTimeSlicePerTick(0.005) // 5ms
+	, bUseAsyncTraces(true)
+	, MaxAsyncTracesPerTick(DefaultMaxAsyncTracesPerTick)
 	, HighImportanceQueryDistanceThreshold(300.f)
 	, MaxQueryImportance(60.f)
 	, SightLimitQueryImportance(10.f)
@@ -146,11 +242,168 @@ bool UAISense_Sight_VR::ShouldAutomaticallySeeTarget(const FDigestedSightPropert
 	return false;
 }
 
+void UAISense_Sight_VR::RegisterLineOfSightResult(FPerceptionListener& Listener, FAISightQueryVR& SightQuery, AActor* TargetActor, const FVector& SeenLocation, bool bVisible)
+{
+	if (bVisible)
+	{
+		Listener.RegisterStimulus(TargetActor, FAIStimulus(*this, 1.f, SeenLocation, Listener.CachedLocation));
+		SightQuery.bLastResult = true;
+		SightQuery.LastSeenLocation = SeenLocation;
+	}
+	// communicate failure only if we've seen give actor before
+	else if (SightQuery.bLastResult == true)
+	{
+		Listener.RegisterStimulus(TargetActor, FAIStimulus(*this, 0.f, SeenLocation, Listener.CachedLocation, FAIStimulus::SensingFailed));
+		SightQuery.bLastResult = false;
+		SightQuery.LastSeenLocation = FAISystem::InvalidLocation;
+	}
+
+	if (SightQuery.bLastResult == false)
+	{
+		SIGHT_LOG_LOCATIONVR(Listener.Listener.IsValid() ? Listener.Listener->GetOwner() : nullptr, SeenLocation, 25.f, FColor::Red, TEXT(""));
+	}
+}
+
+bool UAISense_Sight_VR::ConsumeAsyncTrace(UWorld* World, AIPerception::FListenerMap& ListenersMap, FAISightQueryVR& SightQuery, int32& AsyncTracesCount)
+{
+	// All of the in flight traces were issued together, if one isn't done then none are
+	for (const FTraceHandle& Handle : SightQuery.TraceHandles)
+	{
+		if (Handle.IsValid())
+		{
+			FTraceDatum TraceData;
+			if (!World->QueryTraceData(Handle, TraceData) && World->IsTraceHandleValid(Handle, false))
+			{
+				return false;
+			}
+
+			break;
+		}
+	}
+
+	FPerceptionListener* Listener = ListenersMap.Find(SightQuery.ObserverId);
+	FAISightTargetVR* Target = ObservedTargets.Find(SightQuery.TargetId);
+	AActor* TargetActor = Target ? Target->Target.Get() : nullptr;
+
+	// Invalid listeners and targets are cleaned up the next time the query is processed
+	if (Listener == nullptr || !Listener->Listener.IsValid() || TargetActor == nullptr)
+	{
+		SightQuery.ClearTraces();
+		return true;
+	}
+
+	int32 VisiblePoint = INDEX_NONE;
+	bool bLostTrace = false;
+
+	for (int32 Point = 0; Point < EVRSightTargetPoint::Count; ++Point)
+	{
+		FTraceHandle& Handle = SightQuery.TraceHandles[Point];
+		if (!Handle.IsValid())
+			continue;
+
+		FTraceDatum TraceData;
+		if (World->QueryTraceData(Handle, TraceData))
+		{
+			const FHitResult* BlockingHit = nullptr;
+			for (const FHitResult& Hit : TraceData.OutHits)
+			{
+				if (Hit.bBlockingHit)
+				{
+					BlockingHit = &Hit;
+					break;
+				}
+			}
+
+			if (VisiblePoint == INDEX_NONE && IsLineOfSightClear(TargetActor, BlockingHit))
+			{
+				VisiblePoint = Point;
+			}
+		}
+		else
+		{
+			// Dropped (a missed frame)
+			bLostTrace = true;
+		}
+
+		Handle = FTraceHandle();
+	}
+
+	if (VisiblePoint != INDEX_NONE)
+	{
+		SightQuery.ClearTraces();
+		RegisterLineOfSightResult(*Listener, SightQuery, TargetActor, SightQuery.TraceTargetLocations[VisiblePoint], true);
+		SightQuery.LastVisiblePoint = (uint8)VisiblePoint;
+		return true;
+	}
+
+	// Lost traces are traced again the next time the query is processed
+	if (bLostTrace)
+	{
+		SightQuery.ClearTraces();
+		return true;
+	}
+
+	const AVRBaseCharacter * VRChar = Cast<const AVRBaseCharacter>(TargetActor);
+	const FVector TargetLocation = VRChar != nullptr ? VRChar->GetVRLocation_Inline() : TargetActor->GetActorLocation();
+
+	// The point that was visible last time is blocked, try the rest of the target before giving up on it
+	const FDigestedSightProperties* PropDigest = DigestedProperties.Find(SightQuery.ObserverId);
+	if (PropDigest)
+	{
+		FVector PointLocations[EVRSightTargetPoint::Count];
+		const uint8 PointMask = GetSightPoints(*PropDigest, TargetActor, TargetLocation, PointLocations);
+
+		if (!SightQuery.bTracingOtherPoints)
+		{
+			uint8 PointOrder[EVRSightTargetPoint::Count];
+			const int32 NumPoints = GetSightPointOrder(PointMask, SightQuery.LastVisiblePoint, PointOrder);
+
+			for (int32 OrderIndex = 1; OrderIndex < NumPoints; ++OrderIndex)
+			{
+				SightQuery.PendingPointMask |= 1 << PointOrder[OrderIndex];
+			}
+
+			SightQuery.bTracingOtherPoints = true;
+		}
+
+		// Points can go away in between (a destroyed motion controller)
+		SightQuery.PendingPointMask &= PointMask;
+
+		if (SightQuery.PendingPointMask != 0)
+		{
+			UAIPerceptionComponent* ListenerPtr = Listener->Listener.Get();
+			const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AILineOfSight), true, ListenerPtr->GetBodyActor());
+
+			// The follow up traces count against the same cap as the first ones, the points that don't fit wait for the next update
+			for (uint8 Point = 0; Point < EVRSightTargetPoint::Count && AsyncTracesCount < MaxAsyncTracesPerTick; ++Point)
+			{
+				if (!(SightQuery.PendingPointMask & (1 << Point)))
+					continue;
+
+				SightQuery.TraceHandles[Point] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Listener->CachedLocation, PointLocations[Point], DefaultSightCollisionChannel, QueryParams);
+				SightQuery.TraceTargetLocations[Point] = PointLocations[Point];
+				SightQuery.PendingPointMask &= ~(1 << Point);
+				++AsyncTracesCount;
+			}
+
+			return false;
+		}
+	}
+
+	SightQuery.ClearTraces();
+	RegisterLineOfSightResult(*Listener, SightQuery, TargetActor, TargetLocation, false);
+	return true;
+}
+
 float UAISense_Sight_VR::Update()
 {
 	SCOPE_CYCLE_COUNTER(STAT_AI_Sense_Sight);
 
-	const UWorld* World = GEngine->GetWorldFromContextObject(GetPerceptionSystem()->GetOuter(), EGetWorldErrorMode::LogAndReturnNull);
+#if !UE_BUILD_SHIPPING
+	const double UpdateStartTime = FPlatformTime::Seconds();
+#endif
+
+	UWorld* World = GEngine->GetWorldFromContextObject(GetPerceptionSystem()->GetOuter(), EGetWorldErrorMode::LogAndReturnNull);
 
 	if (World == NULL)
 	{
@@ -158,6 +411,7 @@ float UAISense_Sight_VR::Update()
 	}
 
 	int32 TracesCount = 0;
+	int32 AsyncTracesCount = 0;
 	int32 NumQueriesProcessed = 0;
 	double TimeSliceEnd = FPlatformTime::Seconds() + MaxTimeSlicePerTick;
 	bool bHitTimeSliceLimit = false;
@@ -189,7 +443,27 @@ float UAISense_Sight_VR::Update()
 			// do not break here since that would bypass queue aging
 		}
 
-		if (TracesCount < MaxTracesPerTick && bHitTimeSliceLimit == false)
+		// Results of last updates async traces, queries with a trace in flight keep their place in the queue until it lands
+		if (SightQuery->HasPendingTraces())
+		{
+			if (ConsumeAsyncTrace(World, ListenersMap, *SightQuery, AsyncTracesCount))
+			{
+				SightQuery->RecalcScore();
+			}
+			else if (!SightQuery->HasTracesInFlight())
+			{
+				// None of its follow up traces fit in this updates budget, age it so that it moves up the queue for the next one
+				SightQuery->Age += 1.f;
+				SightQuery->RecalcScore();
+			}
+
+			continue;
+		}
+
+		const FAISightTargetVR* TargetPtr = ObservedTargets.Find(SightQuery->TargetId);
+		const bool bAsyncTrace = bUseAsyncTraces && TargetPtr && TargetPtr->SightTargetInterface == NULL;
+
+		if ((bAsyncTrace ? AsyncTracesCount < MaxAsyncTracesPerTick : TracesCount < MaxTracesPerTick) && bHitTimeSliceLimit == false)
 		{
 			FPerceptionListener& Listener = ListenersMap[SightQuery->ObserverId];
 
@@ -252,37 +526,51 @@ float UAISense_Sight_VR::Update()
 					}
 					else
 					{
-						// we need to do tests ourselves
-						FHitResult HitResult;
-						const bool bHit = World->LineTraceSingleByChannel(HitResult, Listener.CachedLocation, TargetLocation
-							, DefaultSightCollisionChannel
-							, FCollisionQueryParams(SCENE_QUERY_STAT(AILineOfSight), true, ListenerPtr->GetBodyActor()));
-
-						++TracesCount;
-
-						auto HitResultActorIsOwnedByTargetActor = [&HitResult, TargetActor]()
-						{
-							AActor* HitResultActor = HitResult.Actor.Get();
-							return (HitResultActor ? HitResultActor->IsOwnedBy(TargetActor) : false);
-						};
+						FVector PointLocations[EVRSightTargetPoint::Count];
+						uint8 PointOrder[EVRSightTargetPoint::Count];
+						const int32 NumPoints = GetSightPointOrder(GetSightPoints(PropDigest, TargetActor, TargetLocation, PointLocations), SightQuery->LastVisiblePoint, PointOrder);
+						const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AILineOfSight), true, ListenerPtr->GetBodyActor());
 
-						if (bHit == false || HitResultActorIsOwnedByTargetActor())
+						if (bAsyncTrace)
 						{
-							Listener.RegisterStimulus(TargetActor, FAIStimulus(*this, 1.f, TargetLocation, Listener.CachedLocation));
-							SightQuery->bLastResult = true;
-							SightQuery->LastSeenLocation = TargetLocation;
-						}
-						// communicate failure only if we've seen give actor before
-						else if (SightQuery->bLastResult == true)
-						{
-							Listener.RegisterStimulus(TargetActor, FAIStimulus(*this, 0.f, TargetLocation, Listener.CachedLocation, FAIStimulus::SensingFailed));
-							SightQuery->bLastResult = false;
-							SightQuery->LastSeenLocation = FAISystem::InvalidLocation;
+							// only the point that was visible last time, the result is registered by ConsumeAsyncTrace on the next update
+							// which also traces the rest of the points if this one turns out to be blocked
+							const uint8 Point = PointOrder[0];
+							SightQuery->TraceHandles[Point] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Listener.CachedLocation, PointLocations[Point], DefaultSightCollisionChannel, QueryParams);
+							SightQuery->TraceTargetLocations[Point] = PointLocations[Point];
+							SightQuery->bTracingOtherPoints = false;
+
+							++AsyncTracesCount;
 						}
-
-						if (SightQuery->bLastResult == false)
+						else
 						{
-							SIGHT_LOG_LOCATIONVR(ListenerPtr->GetOwner(), TargetLocation, 25.f, FColor::Red, TEXT(""));
+							// we need to do tests ourselves, starting with the point that was visible last time and stopping at the first visible one
+							int32 VisiblePoint = INDEX_NONE;
+							FHitResult HitResult;
+
+							for (int32 OrderIndex = 0; OrderIndex < NumPoints; ++OrderIndex)
+							{
+								const uint8 Point = PointOrder[OrderIndex];
+								const bool bHit = World->LineTraceSingleByChannel(HitResult, Listener.CachedLocation, PointLocations[Point], DefaultSightCollisionChannel, QueryParams);
+
+								++TracesCount;
+
+								if (IsLineOfSightClear(TargetActor, bHit ? &HitResult : nullptr))
+								{
+									VisiblePoint = Point;
+									break;
+								}
+							}
+
+							if (VisiblePoint != INDEX_NONE)
+							{
+								SightQuery->LastVisiblePoint = (uint8)VisiblePoint;
+								RegisterLineOfSightResult(Listener, *SightQuery, TargetActor, PointLocations[VisiblePoint], true);
+							}
+							else
+							{
+								RegisterLineOfSightResult(Listener, *SightQuery, TargetActor, TargetLocation, false);
+							}
 						}
 					}
 				}
@@ -355,6 +643,16 @@ float UAISense_Sight_VR::Update()
 		SortQueries();
 	}
 
+#if !UE_BUILD_SHIPPING
+	if (AISenseSightVRBenchmark::ActiveTiming && AISenseSightVRBenchmark::ActiveTiming->World == World)
+	{
+		const double UpdateTime = FPlatformTime::Seconds() - UpdateStartTime;
+		AISenseSightVRBenchmark::ActiveTiming->TotalTime += UpdateTime;
+		AISenseSightVRBenchmark::ActiveTiming->MaxTime = FMath::Max(AISenseSightVRBenchmark::ActiveTiming->MaxTime, UpdateTime);
+		++AISenseSightVRBenchmark::ActiveTiming->NumUpdates;
+	}
+#endif
+
 	//return SightQueryQueue.Num() > 0 ? 1.f/6 : FLT_MAX;
 	return 0.f;
 }
@@ -696,6 +994,9 @@ UAISenseConfig_Sight_VR::UAISenseConfig_Sight_VR(const FObjectInitializer& Objec
 	LoseSightRadius = 3500.f;
 	PeripheralVisionAngleDegrees = 90;
 	DetectionByAffiliation.bDetectEnemies = true;
+	bTraceToVRBody = true;
+	bTraceToVRHead = true;
+	bTraceToVRHands = true;
 	Implementation = UAISense_Sight_VR::StaticClass();
 }
 
@@ -752,4 +1053,306 @@ void UAISenseConfig_Sight_VR::DescribeSelfToGameplayDebugger(const UAIPerception
 		DebuggerCategory->AddShape(FGameplayDebuggerShape::MakeSegment(BodyLocation, BodyLocation + (BodyFacing.RotateAngleAxis(-PeripheralVisionAngleDegrees, FVector::UpVector) * SightPieLength), SightRangeColor));
 	}
 }
-#endif // WITH_GAMEPLAY_DEBUGGER
\ No newline at end of file
+#endif // WITH_GAMEPLAY_DEBUGGER
+#if !UE_BUILD_SHIPPING
+namespace AISenseSightVRBenchmark
+{
+	struct FPhaseResult
+	{
+		FUpdateTiming Timing;
+
+		// Last line of sight result of every benchmark listener / target pair at the end of the phase
+		TMap<uint64, bool> Visible;
+		int32 NumVisible;
+
+		FPhaseResult() :
+			NumVisible(0)
+		{}
+	};
+
+	enum class EBenchmarkPhase : uint8
+	{
+		Registering,
+		Async,
+		Sync
+	};
+
+	struct FBenchmarkState
+	{
+		TWeakObjectPtr<UWorld> World;
+		TWeakObjectPtr<UAISense_Sight_VR> Sense;
+		TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+		TArray<TWeakObjectPtr<UAIPerceptionComponent>> Listeners;
+		TArray<TWeakObjectPtr<AVRBaseCharacter>> Targets;
+		bool bOriginalUseAsyncTraces;
+		EBenchmarkPhase Phase;
+		int32 PhaseFrame;
+		int32 FramesPerPhase;
+		FPhaseResult AsyncResult;
+		FPhaseResult SyncResult;
+		FDelegateHandle PostActorTickHandle;
+	};
+
+	static uint64 GetPairKey(const FPerceptionListenerID& ListenerId, FAISightTargetVR::FTargetId TargetId)
+	{
+		return ((uint64)(uint32)ListenerId.Index << 32) | TargetId;
+	}
+
+	static void GetBenchmarkPairs(const FBenchmarkState& State, TSet<uint64>& OutPairs)
+	{
+		for (const TWeakObjectPtr<UAIPerceptionComponent>& Listener : State.Listeners)
+		{
+			for (const TWeakObjectPtr<AVRBaseCharacter>& Target : State.Targets)
+			{
+				if (Listener.IsValid() && Target.IsValid())
+					OutPairs.Add(GetPairKey(Listener->GetListenerId(), Target->GetUniqueID()));
+			}
+		}
+	}
+
+	// Starts the phase from a clean slate so that both trace modes have to find every target themselves
+	static void BeginPhase(FBenchmarkState& State, EBenchmarkPhase Phase, FPhaseResult& Result)
+	{
+		UAISense_Sight_VR* Sense = State.Sense.Get();
+		Sense->SetUseAsyncTraces(Phase == EBenchmarkPhase::Async);
+
+		TSet<uint64> Pairs;
+		GetBenchmarkPairs(State, Pairs);
+
+		for (FAISightQueryVR& SightQuery : Sense->SightQueryQueue)
+		{
+			if (Pairs.Contains(GetPairKey(SightQuery.ObserverId, SightQuery.TargetId)))
+				SightQuery.ForgetPreviousResult();
+		}
+
+		State.Phase = Phase;
+		State.PhaseFrame = 0;
+		ActiveTiming = &Result.Timing;
+		ActiveTiming->World = State.World;
+	}
+
+	static void EndPhase(FBenchmarkState& State, FPhaseResult& Result)
+	{
+		ActiveTiming = nullptr;
+
+		TSet<uint64> Pairs;
+		GetBenchmarkPairs(State, Pairs);
+
+		for (const FAISightQueryVR& SightQuery : State.Sense->SightQueryQueue)
+		{
+			const uint64 PairKey = GetPairKey(SightQuery.ObserverId, SightQuery.TargetId);
+			if (Pairs.Contains(PairKey))
+			{
+				Result.Visible.Add(PairKey, SightQuery.bLastResult);
+				Result.NumVisible += SightQuery.bLastResult ? 1 : 0;
+			}
+		}
+	}
+
+	static void LogPhase(const TCHAR* Name, const FPhaseResult& Result)
+	{
+		UE_LOG(LogAIPerceptionVR, Log, TEXT("  %s: %.3fms per update (max %.3fms) over %d updates, %d of %d pairs visible"),
+			Name, Result.Timing.TotalTime * 1000.0 / FMath::Max(Result.Timing.NumUpdates, 1), Result.Timing.MaxTime * 1000.0, Result.Timing.NumUpdates, Result.NumVisible, Result.Visible.Num());
+	}
+
+	static void Finish(FBenchmarkState& State)
+	{
+		ActiveTiming = nullptr;
+		FWorldDelegates::OnWorldPostActorTick.Remove(State.PostActorTickHandle);
+
+		if (UAISense_Sight_VR* Sense = State.Sense.Get())
+			Sense->SetUseAsyncTraces(State.bOriginalUseAsyncTraces);
+
+		for (const TWeakObjectPtr<AActor>& Actor : State.SpawnedActors)
+		{
+			if (Actor.IsValid())
+				Actor->Destroy();
+		}
+	}
+
+	static void Tick(UWorld* World, TSharedRef<FBenchmarkState> State)
+	{
+		UAISense_Sight_VR* Sense = State->Sense.Get();
+		if (!Sense)
+		{
+			UE_LOG(LogAIPerceptionVR, Error, TEXT("Sight benchmark FAILED: the sight sense went away while running"));
+			Finish(*State);
+			return;
+		}
+
+		++State->PhaseFrame;
+
+		switch (State->Phase)
+		{
+		case EBenchmarkPhase::Registering:
+		{
+			// Give the perception system a tick to register the new listeners and pawns on its own, anything it didn't is registered here
+			if (State->PhaseFrame == 2)
+			{
+				for (const TWeakObjectPtr<AVRBaseCharacter>& Target : State->Targets)
+				{
+					if (Target.IsValid() && !Sense->ObservedTargets.Contains(Target->GetUniqueID()))
+						Sense->RegisterSource(*Target.Get());
+				}
+			}
+			else if (State->PhaseFrame > 2)
+			{
+				BeginPhase(*State, EBenchmarkPhase::Async, State->AsyncResult);
+			}
+		}break;
+
+		case EBenchmarkPhase::Async:
+		{
+			if (State->PhaseFrame >= State->FramesPerPhase)
+			{
+				EndPhase(*State, State->AsyncResult);
+				BeginPhase(*State, EBenchmarkPhase::Sync, State->SyncResult);
+			}
+		}break;
+
+		case EBenchmarkPhase::Sync:
+		{
+			if (State->PhaseFrame < State->FramesPerPhase)
+				break;
+
+			EndPhase(*State, State->SyncResult);
+
+			int32 Mismatches = 0;
+			int32 MissingPairs = 0;
+			for (const TPair<uint64, bool>& AsyncPair : State->AsyncResult.Visible)
+			{
+				const bool* SyncVisible = State->SyncResult.Visible.Find(AsyncPair.Key);
+				if (!SyncVisible)
+					++MissingPairs;
+				else if (*SyncVisible != AsyncPair.Value)
+					++Mismatches;
+			}
+
+			const int32 ExpectedPairs = State->Listeners.Num() * State->Targets.Num();
+			UE_LOG(LogAIPerceptionVR, Log, TEXT("Sight benchmark: %d listeners x %d VR targets, %d frames per trace mode, %d queries in the sense"),
+				State->Listeners.Num(), State->Targets.Num(), State->FramesPerPhase, Sense->SightQueryQueue.Num());
+			LogPhase(TEXT("Async"), State->AsyncResult);
+			LogPhase(TEXT("Synchronous"), State->SyncResult);
+
+			if (State->AsyncResult.Visible.Num() != ExpectedPairs || MissingPairs > 0)
+			{
+				UE_LOG(LogAIPerceptionVR, Error, TEXT("Sight benchmark FAILED: expected %d sight queries, found %d async and %d synchronous"),
+					ExpectedPairs, State->AsyncResult.Visible.Num(), State->SyncResult.Visible.Num());
+			}
+
+			if (Mismatches > 0)
+			{
+				UE_LOG(LogAIPerceptionVR, Error, TEXT("Sight benchmark FAILED: %d pairs disagreed between the async and synchronous line of sight results"), Mismatches);
+			}
+
+			Finish(*State);
+		}break;
+		}
+	}
+
+	// Spawns perception listeners and VR characters around the first player, then runs the real sight sense with async and with synchronous
+	// traces and compares the time each of its updates takes (issuing the traces and consuming the last updates results) and what they saw
+	static void RunBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World || ActiveTiming)
+			return;
+
+		const int32 NumListeners = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 32;
+		const int32 NumTargets = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 16;
+		const int32 NumFrames = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 60;
+
+		FVector Center = FVector::ZeroVector;
+		APlayerController* PlayerController = World->GetFirstPlayerController();
+		if (PlayerController && PlayerController->GetPawn())
+			Center = PlayerController->GetPawn()->GetActorLocation();
+
+		TSharedRef<FBenchmarkState> State = MakeShareable(new FBenchmarkState());
+		State->World = World;
+		State->Phase = EBenchmarkPhase::Registering;
+		State->PhaseFrame = 0;
+		State->FramesPerPhase = NumFrames;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		FRandomStream Stream(0x516E);
+		for (int32 i = 0; i < NumListeners; ++i)
+		{
+			const FVector Offset = FRotator(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f).Vector() * Stream.FRandRange(300.0f, 2500.0f);
+			const FVector Location = Center + Offset + FVector(0.0f, 0.0f, 150.0f);
+
+			AActor* ListenerActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+			if (!ListenerActor)
+				continue;
+
+			State->SpawnedActors.Add(ListenerActor);
+
+			USceneComponent* Root = NewObject<USceneComponent>(ListenerActor);
+			ListenerActor->SetRootComponent(Root);
+			Root->RegisterComponent();
+			ListenerActor->SetActorLocationAndRotation(Location, (-Offset).Rotation());
+
+			UAISenseConfig_Sight_VR* SightConfig = NewObject<UAISenseConfig_Sight_VR>(ListenerActor);
+			SightConfig->SightRadius = 5000.0f;
+			SightConfig->LoseSightRadius = 5500.0f;
+			SightConfig->DetectionByAffiliation.bDetectEnemies = true;
+			SightConfig->DetectionByAffiliation.bDetectNeutrals = true;
+			SightConfig->DetectionByAffiliation.bDetectFriendlies = true;
+
+			UAIPerceptionComponent* Perception = NewObject<UAIPerceptionComponent>(ListenerActor);
+			Perception->ConfigureSense(*SightConfig);
+			Perception->RegisterComponent();
+			State->Listeners.Add(Perception);
+		}
+
+		for (int32 i = 0; i < NumTargets; ++i)
+		{
+			const FVector Offset = FRotator(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f).Vector() * Stream.FRandRange(0.0f, 800.0f);
+			AVRCharacter* Target = World->SpawnActor<AVRCharacter>(AVRCharacter::StaticClass(), FTransform(Center + Offset + FVector(0.0f, 0.0f, 100.0f)), SpawnParams);
+			if (!Target)
+				continue;
+
+			// Keep them where they were placed so both trace modes see the same scene
+			if (UCharacterMovementComponent* Movement = Target->GetCharacterMovement())
+			{
+				Movement->DisableMovement();
+				Movement->SetComponentTickEnabled(false);
+			}
+
+			State->SpawnedActors.Add(Target);
+			State->Targets.Add(Target);
+		}
+
+		for (TObjectIterator<UAISense_Sight_VR> It; It; ++It)
+		{
+			if (!It->IsTemplate() && It->GetWorld() == World)
+			{
+				State->Sense = *It;
+				break;
+			}
+		}
+
+		if (!State->Sense.IsValid())
+		{
+			UE_LOG(LogAIPerceptionVR, Error, TEXT("Sight benchmark FAILED: no VR sight sense is running in the world, is the AI system enabled?"));
+			Finish(*State);
+			return;
+		}
+
+		State->bOriginalUseAsyncTraces = State->Sense->GetUseAsyncTraces();
+
+		TWeakObjectPtr<UWorld> WeakWorld(World);
+		State->PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([WeakWorld, State](UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld == WeakWorld.Get())
+				Tick(TickedWorld, State);
+		});
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("vr.AISightVR.Benchmark"),
+		TEXT("Spawns AI listeners and VR characters around the first player and times the VR sight sense updates with async and with synchronous line of sight traces.\n")
+		TEXT("Usage: vr.AISightVR.Benchmark [Listeners=32] [Targets=16] [FramesPerMode=60]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmark));
+}
+#endif
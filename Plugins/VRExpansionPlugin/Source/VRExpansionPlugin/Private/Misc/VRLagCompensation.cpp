@@ -0,0 +1,510 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/VRLagCompensation.h"
+#include "VRBaseCharacter.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogVRLagCompensation);
+
+DECLARE_CYCLE_STAT(TEXT("LagCompensatedTraces"), STAT_VRLagCompensatedTraces, STATGROUP_VRLagCompensation);
+DECLARE_CYCLE_STAT(TEXT("LagCompensatedTraces ~ Rewind"), STAT_VRLagCompensatedRewind, STATGROUP_VRLagCompensation);
+
+// ** Rewind history ** //
+
+void FVRRewindFrame::Blend(const FVRRewindFrame & From, const FVRRewindFrame & To, float Alpha, FVRRewindFrame & OutFrame)
+{
+	OutFrame.ServerTime = FMath::Lerp(From.ServerTime, To.ServerTime, Alpha);
+	OutFrame.CapsuleLocation = FMath::Lerp(From.CapsuleLocation, To.CapsuleLocation, Alpha);
+	OutFrame.CapsuleRotation = FQuat::Slerp(From.CapsuleRotation, To.CapsuleRotation, Alpha);
+	OutFrame.CapsuleRadius = FMath::Lerp(From.CapsuleRadius, To.CapsuleRadius, Alpha);
+	OutFrame.CapsuleHalfHeight = FMath::Lerp(From.CapsuleHalfHeight, To.CapsuleHalfHeight, Alpha);
+	OutFrame.HeadTransform.Blend(From.HeadTransform, To.HeadTransform, Alpha);
+	OutFrame.LeftHandTransform.Blend(From.LeftHandTransform, To.LeftHandTransform, Alpha);
+	OutFrame.RightHandTransform.Blend(From.RightHandTransform, To.RightHandTransform, Alpha);
+}
+
+void FVRRewindHistory::Init(int32 Capacity)
+{
+	Frames.Empty(Capacity);
+	Frames.SetNum(FMath::Max(Capacity, 2));
+	NewestIndex = INDEX_NONE;
+	NumFrames = 0;
+}
+
+void FVRRewindHistory::Empty()
+{
+	Frames.Empty();
+	NewestIndex = INDEX_NONE;
+	NumFrames = 0;
+}
+
+void FVRRewindHistory::Record(const FVRRewindFrame & Frame)
+{
+	if (!Frames.Num())
+		return;
+
+	// Multiple records in the same server frame just overwrite the newest
+	if (NumFrames > 0 && Frame.ServerTime <= GetFrame(0).ServerTime)
+	{
+		Frames[NewestIndex] = Frame;
+		return;
+	}
+
+	NewestIndex = (NewestIndex + 1) % Frames.Num();
+	NumFrames = FMath::Min(NumFrames + 1, Frames.Num());
+	Frames[NewestIndex] = Frame;
+}
+
+bool FVRRewindHistory::GetFrameAtTime(float ServerTime, FVRRewindFrame & OutFrame) const
+{
+	if (NumFrames < 1)
+		return false;
+
+	if (ServerTime >= GetFrame(0).ServerTime)
+	{
+		OutFrame = GetFrame(0);
+		return true;
+	}
+
+	// Most rewinds are short, walk back from the newest
+	for (int32 Age = 0; Age < NumFrames - 1; ++Age)
+	{
+		const FVRRewindFrame & To = GetFrame(Age);
+		const FVRRewindFrame & From = GetFrame(Age + 1);
+
+		if (From.ServerTime <= ServerTime)
+		{
+			const float Alpha = FMath::Clamp((ServerTime - From.ServerTime) / FMath::Max(To.ServerTime - From.ServerTime, KINDA_SMALL_NUMBER), 0.0f, 1.0f);
+			FVRRewindFrame::Blend(From, To, Alpha, OutFrame);
+			return true;
+		}
+	}
+
+	OutFrame = GetFrame(NumFrames - 1);
+	return true;
+}
+
+// ** Client time stamp offset ** //
+
+void FVRClientTimeStampOffset::AddVerifiedTimeStamp(float ClientTimeStamp, float ServerTime, float ResetThreshold)
+{
+	const float SampleOffset = ServerTime - ClientTimeStamp;
+
+	if (!bIsValid || ClientTimeStamp < NewestTimeStamp - ResetThreshold)
+	{
+		Offset = SampleOffset;
+		NewestTimeStamp = ClientTimeStamp;
+		bIsValid = true;
+		return;
+	}
+
+	// Drops straight to less delayed moves and only slowly relaxes upwards, follows clock drift and route changes
+	// without letting the jitter of individual moves move the estimate
+	Offset = FMath::Min(SampleOffset, Offset + (SampleOffset - Offset) * 0.02f);
+	NewestTimeStamp = FMath::Max(NewestTimeStamp, ClientTimeStamp);
+}
+
+float FVRClientTimeStampOffset::GetServerTime(float ClientTimeStamp, float OneWayLatency, float CurrentTime) const
+{
+	if (!bIsValid)
+		return CurrentTime - OneWayLatency;
+
+	return FMath::Min(ClientTimeStamp + Offset - OneWayLatency, CurrentTime);
+}
+
+// ** Lag compensated traces ** //
+
+namespace VRLagCompensation
+{
+	// A character after rewinding, with a bounding sphere around all of its shapes for early outs
+	struct FRewoundCharacter
+	{
+		AVRBaseCharacter * Character;
+		FVRRewindFrame Frame;
+		FVector CapsuleBottom;
+		FVector CapsuleTop;
+		float HeadRadius;
+		float HandRadius;
+		FVector BoundsCenter;
+		float BoundsRadiusSquared;
+	};
+
+	typedef TArray<FRewoundCharacter, TInlineAllocator<16>> FRewoundCharacterArray;
+
+	// Dir must be normalized, OutT is the distance along it
+	static bool SegmentSphere(const FVector & Start, const FVector & Dir, float Length, const FVector & Center, float Radius, float & OutT)
+	{
+		const FVector M = Start - Center;
+		const float B = FVector::DotProduct(M, Dir);
+		const float C = M.SizeSquared() - FMath::Square(Radius);
+
+		// Outside of it and pointing away
+		if (C > 0.0f && B > 0.0f)
+			return false;
+
+		const float Disc = B * B - C;
+		if (Disc < 0.0f)
+			return false;
+
+		OutT = FMath::Max(0.0f, -B - FMath::Sqrt(Disc));
+		return OutT <= Length;
+	}
+
+	static bool SegmentCapsule(const FVector & Start, const FVector & Dir, float Length, const FVector & CapA, const FVector & CapB, float Radius, float & OutT)
+	{
+		// Starting inside counts as a hit at the start
+		if (FMath::PointDistToSegmentSquared(Start, CapA, CapB) <= FMath::Square(Radius))
+		{
+			OutT = 0.0f;
+			return true;
+		}
+
+		float BestT = MAX_flt;
+		float T;
+
+		// End caps
+		if (SegmentSphere(Start, Dir, Length, CapA, Radius, T))
+			BestT = T;
+
+		if (SegmentSphere(Start, Dir, Length, CapB, Radius, T))
+			BestT = FMath::Min(BestT, T);
+
+		// Cylinder wall, only counts between the caps
+		const FVector Axis = CapB - CapA;
+		const FVector M = Start - CapA;
+		const float DD = Axis.SizeSquared();
+		const float MD = FVector::DotProduct(M, Axis);
+		const float ND = FVector::DotProduct(Dir, Axis);
+		const float MN = FVector::DotProduct(M, Dir);
+
+		const float A = DD - ND * ND;
+		if (A > KINDA_SMALL_NUMBER)
+		{
+			const float B = DD * MN - MD * ND;
+			const float C = DD * (M.SizeSquared() - FMath::Square(Radius)) - MD * MD;
+			const float Disc = B * B - A * C;
+
+			if (Disc >= 0.0f)
+			{
+				T = (-B - FMath::Sqrt(Disc)) / A;
+				const float Along = MD + T * ND;
+
+				if (T >= 0.0f && T <= Length && Along >= 0.0f && Along <= DD)
+					BestT = FMath::Min(BestT, T);
+			}
+		}
+
+		if (BestT <= Length)
+		{
+			OutT = BestT;
+			return true;
+		}
+
+		return false;
+	}
+
+	// What the instigator was looking at when it was at FireServerTime, the server state took the one way latency to reach
+	// it and then sat in its remote smoothing for InterpolationDelay
+	static float GetRewindServerTime(float FireServerTime, float OneWayLatency, float InterpolationDelay, float CurrentTime, float MaxRewindTime)
+	{
+		return FMath::Max(FireServerTime - OneWayLatency - InterpolationDelay, CurrentTime - MaxRewindTime);
+	}
+
+	static void RewindCharacters(UWorld * World, AVRBaseCharacter * Instigator, float ServerTime, FRewoundCharacterArray & OutRewound)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VRLagCompensatedRewind);
+
+		for (TActorIterator<AVRBaseCharacter> It(World); It; ++It)
+		{
+			AVRBaseCharacter * Character = *It;
+			if (Character == Instigator || Character->IsPendingKill() || !Character->RewindHistory.Num())
+				continue;
+
+			FRewoundCharacter & Rewound = OutRewound.AddDefaulted_GetRef();
+			Rewound.Character = Character;
+			Character->RewindHistory.GetFrameAtTime(ServerTime, Rewound.Frame);
+
+			const FVRRewindFrame & Frame = Rewound.Frame;
+			const FVector Up = Frame.CapsuleRotation.GetUpVector();
+			const float CylinderHalfHeight = FMath::Max(Frame.CapsuleHalfHeight - Frame.CapsuleRadius, 0.0f);
+			Rewound.CapsuleBottom = Frame.CapsuleLocation - Up * CylinderHalfHeight;
+			Rewound.CapsuleTop = Frame.CapsuleLocation + Up * CylinderHalfHeight;
+			Rewound.HeadRadius = Character->RewindHeadRadius;
+			Rewound.HandRadius = Character->RewindHandRadius;
+
+			float BoundsRadius = FMath::Max(Frame.CapsuleHalfHeight, Frame.CapsuleRadius);
+			BoundsRadius = FMath::Max(BoundsRadius, FVector::Dist(Frame.CapsuleLocation, Frame.HeadTransform.GetLocation()) + Rewound.HeadRadius);
+			BoundsRadius = FMath::Max(BoundsRadius, FVector::Dist(Frame.CapsuleLocation, Frame.LeftHandTransform.GetLocation()) + Rewound.HandRadius);
+			BoundsRadius = FMath::Max(BoundsRadius, FVector::Dist(Frame.CapsuleLocation, Frame.RightHandTransform.GetLocation()) + Rewound.HandRadius);
+
+			Rewound.BoundsCenter = Frame.CapsuleLocation;
+			Rewound.BoundsRadiusSquared = FMath::Square(BoundsRadius);
+		}
+	}
+
+	static void RunTraces(UWorld * World, AVRBaseCharacter * Instigator, float ServerTime, const TArray<FVRRewindTraceRequest> & Traces, TArray<FVRRewindTraceResult> & OutResults, ECollisionChannel WorldTraceChannel, bool bTraceWorld)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VRLagCompensatedTraces);
+
+		OutResults.Reset(Traces.Num());
+		OutResults.AddDefaulted(Traces.Num());
+
+		if (!World || !Traces.Num())
+			return;
+
+		FRewoundCharacterArray Rewound;
+		RewindCharacters(World, Instigator, ServerTime, Rewound);
+
+		// The characters current collision shouldn't block the world trace, the rewound shapes replace it
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(VRLagCompensatedTrace), false, Instigator);
+		for (const FRewoundCharacter & Character : Rewound)
+		{
+			QueryParams.AddIgnoredActor(Character.Character);
+		}
+
+		for (int32 i = 0; i < Traces.Num(); ++i)
+		{
+			const FVRRewindTraceRequest & Trace = Traces[i];
+			FVRRewindTraceResult & Result = OutResults[i];
+
+			FVector Dir = Trace.End - Trace.Start;
+			float Length = Dir.Size();
+
+			if (Length <= KINDA_SMALL_NUMBER)
+				continue;
+
+			Dir /= Length;
+
+			if (bTraceWorld && World->LineTraceSingleByChannel(Result.WorldHit, Trace.Start, Trace.End, WorldTraceChannel, QueryParams))
+			{
+				Result.HitZone = EVRRewindHitZone::World;
+				Result.Location = Result.WorldHit.ImpactPoint;
+				Result.Distance = Result.WorldHit.Distance;
+
+				// Anything past the world hit is blocked
+				Length = Result.Distance;
+			}
+
+			for (const FRewoundCharacter & Character : Rewound)
+			{
+				if (FMath::PointDistToSegmentSquared(Character.BoundsCenter, Trace.Start, Trace.Start + Dir * Length) > Character.BoundsRadiusSquared)
+					continue;
+
+				float T;
+				EVRRewindHitZone HitZone = EVRRewindHitZone::None;
+
+				if (SegmentSphere(Trace.Start, Dir, Length, Character.Frame.HeadTransform.GetLocation(), Character.HeadRadius, T))
+				{
+					HitZone = EVRRewindHitZone::Head;
+					Length = T;
+				}
+
+				if (SegmentSphere(Trace.Start, Dir, Length, Character.Frame.LeftHandTransform.GetLocation(), Character.HandRadius, T) && T < Length)
+				{
+					HitZone = EVRRewindHitZone::LeftHand;
+					Length = T;
+				}
+
+				if (SegmentSphere(Trace.Start, Dir, Length, Character.Frame.RightHandTransform.GetLocation(), Character.HandRadius, T) && T < Length)
+				{
+					HitZone = EVRRewindHitZone::RightHand;
+					Length = T;
+				}
+
+				if (SegmentCapsule(Trace.Start, Dir, Length, Character.CapsuleBottom, Character.CapsuleTop, Character.Frame.CapsuleRadius, T) && T < Length)
+				{
+					HitZone = EVRRewindHitZone::Body;
+					Length = T;
+				}
+
+				if (HitZone != EVRRewindHitZone::None)
+				{
+					Result.HitZone = HitZone;
+					Result.HitCharacter = Character.Character;
+					Result.Location = Trace.Start + Dir * Length;
+					Result.Distance = Length;
+					Result.WorldHit = FHitResult();
+				}
+			}
+		}
+	}
+
+	// Swaps a synthetic history in to Target where it moves sideways at a known speed, simulates a shooter with a known
+	// latency and clock offset, and checks that the shot lands on where the shooter saw the target and not where it is now
+	static bool CheckMovingTarget(UWorld * World, AVRBaseCharacter * Shooter, AVRBaseCharacter * Target)
+	{
+		const float CurrentTime = World->GetTimeSeconds();
+		const float OneWayLatency = 0.05f;
+		const float InterpolationDelay = 0.1f;
+		const float ClientClockOffset = 123.25f;
+
+		FVRRewindFrame Current;
+		Target->RewindHistory.GetFrameAtTime(CurrentTime, Current);
+
+		const FVector Up = Current.CapsuleRotation.GetUpVector();
+		const FVector MotionDir = Current.CapsuleRotation.GetForwardVector();
+		const FVector SideDir = FVector::CrossProduct(Up, MotionDir);
+		const float Speed = FMath::Max(1000.0f, Current.CapsuleRadius * 20.0f);
+
+		// Client moves at 90hz over the last second, each taking the one way latency plus up to 20ms of jitter to arrive
+		FRandomStream Stream(90);
+		FVRClientTimeStampOffset TimeStampOffset;
+		for (int32 i = 0; i < 90; ++i)
+		{
+			const float SendTime = CurrentTime - 1.0f - OneWayLatency + i / 90.0f;
+			TimeStampOffset.AddVerifiedTimeStamp(SendTime + ClientClockOffset, SendTime + OneWayLatency + Stream.FRand() * 0.02f, 120.0f);
+		}
+
+		// The shot arrives now, it was fired one way latency ago while the client was showing the target as it was
+		// one way latency plus the interpolation delay before that
+		const float FireTime = CurrentTime - OneWayLatency;
+		const float SeenTime = FireTime - OneWayLatency - InterpolationDelay;
+		const float RewindTime = GetRewindServerTime(TimeStampOffset.GetServerTime(FireTime + ClientClockOffset, OneWayLatency, CurrentTime), OneWayLatency, InterpolationDelay, CurrentTime, 1.0f);
+
+		// Head and hands are held well above the capsule so that only the body is in the way
+		FVRRewindHistory MovingHistory;
+		MovingHistory.Init(128);
+		for (int32 i = 119; i >= 0; --i)
+		{
+			FVRRewindFrame Frame = Current;
+			Frame.ServerTime = CurrentTime - i / 120.0f;
+			Frame.CapsuleLocation = Current.CapsuleLocation + MotionDir * Speed * (Frame.ServerTime - CurrentTime);
+			Frame.HeadTransform.SetLocation(Frame.CapsuleLocation + Up * (Frame.CapsuleHalfHeight + 200.0f));
+			Frame.LeftHandTransform.SetLocation(Frame.CapsuleLocation + Up * (Frame.CapsuleHalfHeight + 300.0f));
+			Frame.RightHandTransform.SetLocation(Frame.CapsuleLocation + Up * (Frame.CapsuleHalfHeight + 300.0f));
+			MovingHistory.Record(Frame);
+		}
+
+		const FVector SeenLocation = Current.CapsuleLocation + MotionDir * Speed * (SeenTime - CurrentTime);
+		const float TraceHalfLength = Current.CapsuleRadius * 2.0f + 10.0f;
+
+		TArray<FVRRewindTraceRequest> Traces;
+		Traces.Add(FVRRewindTraceRequest(SeenLocation + SideDir * TraceHalfLength, SeenLocation - SideDir * TraceHalfLength));
+		Traces.Add(FVRRewindTraceRequest(Current.CapsuleLocation + SideDir * TraceHalfLength, Current.CapsuleLocation - SideDir * TraceHalfLength));
+
+		TArray<FVRRewindTraceResult> Results;
+		Swap(Target->RewindHistory, MovingHistory);
+		RunTraces(World, Shooter, RewindTime, Traces, Results, ECC_Visibility, false);
+		Swap(Target->RewindHistory, MovingHistory);
+
+		const bool bHitSeen = Results[0].HitCharacter == Target && FMath::Abs(FVector::DotProduct(Results[0].Location - SeenLocation, MotionDir)) <= Current.CapsuleRadius + 1.0f;
+		const bool bMissedCurrent = Results[1].HitCharacter != Target;
+
+		if (!bHitSeen || !bMissedCurrent)
+		{
+			UE_LOG(LogVRLagCompensation, Error, TEXT("Lag compensation moving target check FAILED: rewound to %.3fs for a target seen at %.3fs, hit where it was seen %d, missed where it is now %d"),
+				CurrentTime - RewindTime, CurrentTime - SeenTime, bHitSeen ? 1 : 0, bMissedCurrent ? 1 : 0);
+			return false;
+		}
+
+		UE_LOG(LogVRLagCompensation, Log, TEXT("Lag compensation moving target check passed: target at %.0fcm/s rewound %.3fs (seen %.3fs ago)"),
+			Speed, CurrentTime - RewindTime, CurrentTime - SeenTime);
+		return true;
+	}
+
+	// Fires NumTraces rewound traces from random characters at random other characters and logs the time taken
+	static void RunBenchmark(const TArray<FString> & Args, UWorld * World)
+	{
+		if (!World)
+			return;
+
+		const int32 NumTraces = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+		const float RewindTime = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.1f;
+
+		TArray<AVRBaseCharacter*> Characters;
+		for (TActorIterator<AVRBaseCharacter> It(World); It; ++It)
+		{
+			if (It->RewindHistory.Num())
+				Characters.Add(*It);
+		}
+
+		if (Characters.Num() < 2)
+		{
+			UE_LOG(LogVRLagCompensation, Warning, TEXT("Lag compensation benchmark needs at least two characters recording rewind history (bRecordRewindHistory, server only)"));
+			return;
+		}
+
+		CheckMovingTarget(World, Characters[0], Characters[1]);
+
+		FRandomStream Stream(NumTraces);
+		const float ServerTime = World->GetTimeSeconds() - RewindTime;
+
+		// One batch per instigator, the same as a server would issue them
+		TArray<FVRRewindTraceRequest> Traces;
+		TArray<FVRRewindTraceResult> Results;
+		int32 NumHits = 0;
+		double TotalTime = 0.0;
+
+		for (int32 CharIndex = 0; CharIndex < Characters.Num(); ++CharIndex)
+		{
+			AVRBaseCharacter * Instigator = Characters[CharIndex];
+			const int32 BatchSize = NumTraces / Characters.Num() + (CharIndex < NumTraces % Characters.Num() ? 1 : 0);
+
+			Traces.Reset(BatchSize);
+			for (int32 i = 0; i < BatchSize; ++i)
+			{
+				AVRBaseCharacter * Target = Characters[(CharIndex + 1 + Stream.RandHelper(Characters.Num() - 1)) % Characters.Num()];
+				const FVector Start = Instigator->GetVRHeadLocation();
+				const FVector End = Start + ((Target->GetVRLocation() + Stream.GetUnitVector() * 30.0f) - Start).GetSafeNormal() * 10000.0f;
+				Traces.Add(FVRRewindTraceRequest(Start, End));
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			RunTraces(World, Instigator, ServerTime, Traces, Results, ECC_Visibility, true);
+			TotalTime += FPlatformTime::Seconds() - StartTime;
+
+			for (const FVRRewindTraceResult & Result : Results)
+			{
+				if (Result.HitCharacter)
+					++NumHits;
+			}
+		}
+
+		UE_LOG(LogVRLagCompensation, Log, TEXT("Lag compensation benchmark: %d traces against %d characters rewound %.3fs took %.3fms (%.3fus per trace), %d character hits"),
+			NumTraces, Characters.Num(), RewindTime, TotalTime * 1000.0, (TotalTime * 1000000.0) / NumTraces, NumHits);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("vr.LagCompensation.Benchmark"),
+		TEXT("Checks that a moving target is hit where a lagged shooter saw it, then runs rewound traces against the VR characters recording rewind history and logs the time taken.\n")
+		TEXT("Usage: vr.LagCompensation.Benchmark [NumTraces=1000] [RewindSeconds=0.1]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmark));
+}
+
+void UVRLagCompensationLibrary::LagCompensatedTraces(UObject* WorldContextObject, AVRBaseCharacter * Instigator, float ClientTimeStamp, float InterpolationDelay, const TArray<FVRRewindTraceRequest> & Traces, TArray<FVRRewindTraceResult> & OutResults, TEnumAsByte<ECollisionChannel> WorldTraceChannel, bool bTraceWorld)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (!World)
+	{
+		OutResults.Reset();
+		return;
+	}
+
+	const float CurrentTime = World->GetTimeSeconds();
+	float ServerTime = CurrentTime;
+
+	if (Instigator)
+	{
+		float FireServerTime = CurrentTime;
+		float OneWayLatency = 0.0f;
+
+		if (Instigator->VRMovementReference)
+		{
+			OneWayLatency = Instigator->VRMovementReference->GetClientOneWayLatency();
+			FireServerTime = Instigator->VRMovementReference->GetServerTimeForClientTimeStamp(ClientTimeStamp);
+		}
+
+		ServerTime = VRLagCompensation::GetRewindServerTime(FireServerTime, OneWayLatency, InterpolationDelay, CurrentTime, Instigator->MaxRewindTime);
+	}
+
+	VRLagCompensation::RunTraces(World, Instigator, ServerTime, Traces, OutResults, WorldTraceChannel, bTraceWorld);
+}
+
+void UVRLagCompensationLibrary::LagCompensatedTracesAtTime(UObject* WorldContextObject, AVRBaseCharacter * Instigator, float ServerTime, const TArray<FVRRewindTraceRequest> & Traces, TArray<FVRRewindTraceResult> & OutResults, TEnumAsByte<ECollisionChannel> WorldTraceChannel, bool bTraceWorld)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	VRLagCompensation::RunTraces(World, Instigator, ServerTime, Traces, OutResults, WorldTraceChannel, bTraceWorld);
+}
@@ -2,10 +2,174 @@
 
 #include "Misc/VRLogComponent.h"
 #include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVRLogComponent, Log, All);
 
 /* Top of File */
 #define LOCTEXT_NAMESPACE "VRLogComponent" 
 
+// Arena space per stored line, lines longer than the average just mean fewer of them are kept
+static const int32 VRLogArenaCharsPerLine = 128;
+
+FVROutputLogHistory::FVROutputLogHistory()
+	: MaxLineLength(130)
+	, OldestEntry(0)
+	, NumEntries(0)
+	, TextHead(0)
+	, MaxStoredMessages(0)
+{
+	bIsDirty = false;
+	SetMaxStoredMessages(1000);
+	GLog->AddOutputDevice(this);
+	GLog->SerializeBacklog(this);
+}
+
+FVROutputLogHistory::~FVROutputLogHistory()
+{
+	// At shutdown, GLog may already be null
+	if (GLog != NULL)
+	{
+		GLog->RemoveOutputDevice(this);
+	}
+}
+
+void FVROutputLogHistory::SetMaxStoredMessages(int32 NewMaxStoredMessages)
+{
+	NewMaxStoredMessages = FMath::Max(NewMaxStoredMessages, 1);
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (NewMaxStoredMessages == MaxStoredMessages)
+		return;
+
+	TArray<FEntry> OldEntries = MoveTemp(Entries);
+	TArray<TCHAR> OldTextArena = MoveTemp(TextArena);
+	const int32 OldOldestEntry = OldestEntry;
+	const int32 OldNumEntries = NumEntries;
+
+	MaxStoredMessages = NewMaxStoredMessages;
+	Entries.SetNumUninitialized(MaxStoredMessages);
+	TextArena.SetNumUninitialized(MaxStoredMessages * VRLogArenaCharsPerLine);
+	OldestEntry = 0;
+	NumEntries = 0;
+	TextHead = 0;
+
+	// Re-add oldest to newest, anything that doesn't fit falls off the front like it would when logging
+	for (int32 i = 0; i < OldNumEntries; ++i)
+	{
+		const FEntry & Entry = OldEntries[(OldOldestEntry + i) % OldEntries.Num()];
+		AddLine_Locked(&OldTextArena[Entry.TextStart % OldTextArena.Num()], Entry.TextLength, Entry.Verbosity, Entry.Category, Entry.bFirstLineInMessage);
+	}
+
+	bIsDirty = true;
+}
+
+int32 FVROutputLogHistory::Num() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return NumEntries;
+}
+
+void FVROutputLogHistory::CopyRecentLines(int32 SkipCount, int32 MaxLines, TArray<FVRLogLine> & OutLines) const
+{
+	OutLines.Reset();
+
+	FScopeLock Lock(&CriticalSection);
+
+	const int32 ArenaSize = TextArena.Num();
+	const int32 Count = FMath::Clamp(NumEntries - SkipCount, 0, MaxLines);
+	OutLines.SetNum(Count);
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		const FEntry & Entry = Entries[(OldestEntry + NumEntries - 1 - SkipCount - i) % Entries.Num()];
+		FVRLogLine & Line = OutLines[i];
+		Line.Text = FString(Entry.TextLength, &TextArena[Entry.TextStart % ArenaSize]);
+		Line.Verbosity = Entry.Verbosity;
+		Line.Category = Entry.Category;
+		Line.bFirstLineInMessage = Entry.bFirstLineInMessage;
+	}
+}
+
+void FVROutputLogHistory::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+	OldestEntry = 0;
+	NumEntries = 0;
+	TextHead = 0;
+	bIsDirty = true;
+}
+
+void FVROutputLogHistory::Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category)
+{
+	// Skip Color Events
+	if (Verbosity == ELogVerbosity::SetColor)
+		return;
+
+	FScopeLock Lock(&CriticalSection);
+
+	// handle multiline strings by breaking them apart by line, empty lines are skipped
+	bool bIsFirstLineInMessage = true;
+	const TCHAR* LineStart = V;
+	for (const TCHAR* Char = V; ; ++Char)
+	{
+		if (*Char == TEXT('\0') || *Char == TEXT('\r') || *Char == TEXT('\n'))
+		{
+			if (Char > LineStart)
+			{
+				AddLine_Locked(LineStart, (int32)(Char - LineStart), Verbosity, Category, bIsFirstLineInMessage);
+				bIsFirstLineInMessage = false;
+			}
+
+			if (*Char == TEXT('\0'))
+				break;
+
+			LineStart = Char + 1;
+		}
+	}
+
+	if (!bIsFirstLineInMessage)
+		bIsDirty = true;
+}
+
+void FVROutputLogHistory::AddLine_Locked(const TCHAR* Text, int32 Length, ELogVerbosity::Type Verbosity, const FName& Category, bool bFirstLineInMessage)
+{
+	const int32 ArenaSize = TextArena.Num();
+	Length = FMath::Min(Length, ArenaSize / 4);
+
+	if (Length <= 0)
+		return;
+
+	// Text is kept contiguous, skip to the start of the arena if it would run off of the end
+	int64 TextStart = TextHead;
+	const int32 ArenaOffset = (int32)(TextStart % ArenaSize);
+	if (ArenaOffset + Length > ArenaSize)
+		TextStart += ArenaSize - ArenaOffset;
+
+	const int64 TextEnd = TextStart + Length;
+
+	// Drop the oldest lines, either the ring is full or their text is about to be written over
+	while (NumEntries > 0 && (NumEntries == Entries.Num() || Entries[OldestEntry].TextStart < TextEnd - ArenaSize))
+	{
+		OldestEntry = (OldestEntry + 1) % Entries.Num();
+		--NumEntries;
+	}
+
+	FMemory::Memcpy(&TextArena[TextStart % ArenaSize], Text, Length * sizeof(TCHAR));
+
+	FEntry & Entry = Entries[(OldestEntry + NumEntries) % Entries.Num()];
+	Entry.TextStart = TextStart;
+	Entry.TextLength = Length;
+	Entry.Verbosity = Verbosity;
+	Entry.Category = Category;
+	Entry.bFirstLineInMessage = bFirstLineInMessage;
+
+	++NumEntries;
+	TextHead = TextEnd;
+}
+
   //=============================================================================
 UVRLogComponent::UVRLogComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -163,18 +327,30 @@ void UVRLogComponent::DrawOutputLog(bool bUpperHalf, UCanvas* Canvas, float Scro
 
 	FCanvasTextItem ConsoleText(FVector2D(0, 0 + Height - 5 - yl), FText::FromString(TEXT("")), Font, FColor::Emerald);
 
-	const TArray< TSharedPtr<FVRLogMessage> > LoggedMessages = OutputLogHistory.GetMessages();
-	
+	// Every stored line takes at least one row on screen, so this many is always enough to fill it
+	const int32 MaxVisibleLines = FMath::CeilToInt(Height / yl) + 1;
+	const int32 NumStoredLines = OutputLogHistory.Num();
+
 	int32 ScrollPos = 0;
 
-	if(ScrollOffset > 0 && LoggedMessages.Num() > 1)
-		ScrollPos = FMath::Clamp(FMath::RoundToInt(LoggedMessages.Num() * ScrollOffset ) , 0, LoggedMessages.Num() - 1);
+	if(ScrollOffset > 0 && NumStoredLines > 1)
+		ScrollPos = FMath::Clamp(FMath::RoundToInt(NumStoredLines * ScrollOffset ) , 0, NumStoredLines - 1);
+
+	TArray<FVRLogLine> LoggedLines;
+	OutputLogHistory.CopyRecentLines(ScrollPos, MaxVisibleLines, LoggedLines);
+
+	// Forget timestamps, I don't care about them and we have limited texture space to draw too
+	static const ELogTimes::Type LogTimestampMode = ELogTimes::None;
+	const int32 HardWrapLen = FMath::Max(OutputLogHistory.MaxLineLength, 1);
+	TArray<FString> WrappedLines;
 
 	float Xpos = 0.0f;
 	float Ypos = 0.0f;
-	for (int i = LoggedMessages.Num() - (1 + ScrollPos); i >= 0 && Ypos <= Height - yl; i--)//auto &Message : LoggedMessages)
+	for (int i = 0; i < LoggedLines.Num() && Ypos <= Height - yl; i++)
 	{
-		switch (LoggedMessages[i]->Verbosity)
+		const FVRLogLine & Line = LoggedLines[i];
+
+		switch (Line.Verbosity)
 		{
 
 		case ELogVerbosity::Error:
@@ -185,9 +361,30 @@ void UVRLogComponent::DrawOutputLog(bool bUpperHalf, UCanvas* Canvas, float Scro
 		default: ConsoleText.SetColor(FLinearColor(0.8f,0.8f,0.8f));
 		}
 
-		Ypos += yl;
-		ConsoleText.Text = FText::Format(NSLOCTEXT("VRLogComponent", "ConsoleFormat", "{0}"), FText::FromString(*LoggedMessages[i]->Message));
-		Canvas->DrawItem(ConsoleText, 0, Height - Ypos);
+		// Hard-wrap lines to avoid them being too long, only done for the lines that are on screen
+		const FString LineText = Line.Text.ConvertTabsToSpaces(4);
+		const FString MessagePrefix = Line.bFirstLineInMessage ? FOutputDeviceHelper::FormatLogLine(Line.Verbosity, Line.Category, nullptr, LogTimestampMode) : FString();
+
+		WrappedLines.Reset();
+		for (int32 CurrentStartIndex = 0; CurrentStartIndex < LineText.Len();)
+		{
+			const int32 HardWrapLineLen = FMath::Min(FMath::Max(HardWrapLen - (CurrentStartIndex == 0 ? MessagePrefix.Len() : 0), 1), LineText.Len() - CurrentStartIndex);
+
+			if (CurrentStartIndex == 0)
+				WrappedLines.Add(MessagePrefix + LineText.Mid(CurrentStartIndex, HardWrapLineLen));
+			else
+				WrappedLines.Add(LineText.Mid(CurrentStartIndex, HardWrapLineLen));
+
+			CurrentStartIndex += HardWrapLineLen;
+		}
+
+		// Drawing bottom up
+		for (int w = WrappedLines.Num() - 1; w >= 0 && Ypos <= Height - yl; w--)
+		{
+			Ypos += yl;
+			ConsoleText.Text = FText::Format(NSLOCTEXT("VRLogComponent", "ConsoleFormat", "{0}"), FText::FromString(WrappedLines[w]));
+			Canvas->DrawItem(ConsoleText, 0, Height - Ypos);
+		}
 	}
 
 	OutputLogHistory.bIsDirty = false;
@@ -195,5 +392,93 @@ void UVRLogComponent::DrawOutputLog(bool bUpperHalf, UCanvas* Canvas, float Scro
 
 
 
+#if !UE_BUILD_SHIPPING
+namespace VRLogStressTest
+{
+	static void RunStressTest(const TArray<FString> & Args)
+	{
+		const int32 ThreadCount = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 16;
+		const int32 LinesPerThread = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10000;
+		const int32 Capacity = 10000;
+		const FName StressCategory(TEXT("VRLogStress"));
+
+		// Also hooked in to GLog like the components one, so real log lines can land in between, those are skipped when checking
+		FVROutputLogHistory History;
+		History.SetMaxStoredMessages(Capacity);
+		History.Empty();
+		FOutputDevice * Device = &History;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		ParallelFor(ThreadCount, [&](int32 ThreadIndex)
+		{
+			TCHAR Message[128];
+			for (int32 i = 0; i < LinesPerThread; ++i)
+			{
+				// Every 8th message is two lines to go through the splitting as well
+				if (i % 8 == 0)
+					FCString::Sprintf(Message, TEXT("VRLogStress %d %d\nVRLogStress %d %d"), ThreadIndex, i, ThreadIndex, i);
+				else
+					FCString::Sprintf(Message, TEXT("VRLogStress %d %d"), ThreadIndex, i);
+
+				Device->Serialize(Message, ELogVerbosity::Log, StressCategory);
+			}
+		});
+
+		const double Time = FPlatformTime::Seconds() - StartTime;
+
+		// Every thread's lines have to come out whole and in the order that thread logged them
+		TArray<FVRLogLine> Lines;
+		History.CopyRecentLines(0, Capacity, Lines);
+
+		TArray<int32> LastIndex;
+		LastIndex.Init(MAX_int32, ThreadCount);
+		int32 StressLines = 0;
+		int32 Errors = 0;
+
+		for (const FVRLogLine & Line : Lines)
+		{
+			if (Line.Category != StressCategory)
+				continue;
+
+			++StressLines;
+			int32 ThreadIndex = INDEX_NONE;
+			int32 Index = INDEX_NONE;
+			TArray<FString> Tokens;
+			Line.Text.ParseIntoArray(Tokens, TEXT(" "));
+
+			if (Tokens.Num() == 3 && Tokens[0] == TEXT("VRLogStress"))
+			{
+				ThreadIndex = FCString::Atoi(*Tokens[1]);
+				Index = FCString::Atoi(*Tokens[2]);
+			}
+
+			// Lines are newest first
+			if (!LastIndex.IsValidIndex(ThreadIndex) || Index < 0 || Index > LastIndex[ThreadIndex])
+			{
+				++Errors;
+				continue;
+			}
+
+			LastIndex[ThreadIndex] = Index;
+		}
+
+		// Nothing should have been dropped before the ring was full
+		const int32 TotalLines = ThreadCount * LinesPerThread + ThreadCount * ((LinesPerThread + 7) / 8);
+		if (Lines.Num() < FMath::Min(TotalLines, Capacity))
+			++Errors;
+
+		UE_LOG(LogVRLogComponent, Log, TEXT("VRLog stress test: %d threads logged %d lines in %.2fms (%.0f lines per second), %d of %d kept, %d errors"),
+			ThreadCount, TotalLines, Time * 1000.0, Time > 0.0 ? TotalLines / Time : 0.0, StressLines, Capacity, Errors);
+	}
+
+	static FAutoConsoleCommandWithArgs StressTestCommand(
+		TEXT("vr.LogComponent.StressTest"),
+		TEXT("Logs in to an output log history from many threads at once and checks that every threads lines come out whole and in order.\n")
+		TEXT("Usage: vr.LogComponent.StressTest [Threads=16] [LinesPerThread=10000]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunStressTest));
+}
+#endif
+
 #undef LOCTEXT_NAMESPACE 
 /* Bottom of File */
\ No newline at end of file
@@ -22,6 +22,7 @@ UReplicatedVRCameraComponent::UReplicatedVRCameraComponent(const FObjectInitiali
 	//bReplicateTransform = true;
 	NetUpdateRate = 100.0f; // 100 htz is default
 	NetUpdateCount = 0.0f;
+	CameraTransformAckedKeyframe = VRPOSREP_INVALID_KEYFRAME;
 
 	bUsePawnControlRotation = false;
 	bAutoSetLockToHmd = true;
@@ -29,6 +30,7 @@ UReplicatedVRCameraComponent::UReplicatedVRCameraComponent(const FObjectInitiali
 
 	bSetPositionDuringTick = false;
 	bSmoothReplicatedMotion = false;
+	bUsePoseInterpolationBuffer = false;
 	bLerpingPosition = false;
 	bReppedOnce = false;
 
@@ -52,6 +54,7 @@ void UReplicatedVRCameraComponent::GetLifetimeReplicatedProps(TArray< class FLif
 	// Skipping the owner with this as the owner will use the location directly
 	DOREPLIFETIME_CONDITION(UReplicatedVRCameraComponent, ReplicatedCameraTransform, COND_SkipOwner);
 	DOREPLIFETIME(UReplicatedVRCameraComponent, NetUpdateRate);
+	DOREPLIFETIME_CONDITION(UReplicatedVRCameraComponent, CameraTransformAckedKeyframe, COND_OwnerOnly);
 	//DOREPLIFETIME(UReplicatedVRCameraComponent, bReplicateTransform);
 }
 
@@ -68,6 +71,10 @@ void UReplicatedVRCameraComponent::GetLifetimeReplicatedProps(TArray< class FLif
 
 void UReplicatedVRCameraComponent::Server_SendCameraTransform_Implementation(FBPVRComponentPosRep NewTransform)
 {
+	// Resolve delta compressed sends, if it references a keyframe that we never got then skip it
+	if (!CameraTransformDeltaState.ResolveReceived(NewTransform, CameraTransformAckedKeyframe))
+		return;
+
 	// Store new transform and trigger OnRep_Function
 	ReplicatedCameraTransform = NewTransform;
 
@@ -145,10 +152,17 @@ void UReplicatedVRCameraComponent::TickComponent(float DeltaTime, enum ELevelTic
 					NetUpdateCount = 0.0f;
 					ReplicatedCameraTransform.Position = this->RelativeLocation;
 					ReplicatedCameraTransform.Rotation = this->RelativeRotation;
+					// Remotes only read the stamp to place poses in their interpolation buffer
+					if (bUsePoseInterpolationBuffer)
+						ReplicatedCameraTransform.SetSendTime(FPlatformTime::Seconds());
+					else
+						ReplicatedCameraTransform.ClearSendTime();
 
 
 					if (GetNetMode() == NM_Client)
 					{
+						CameraTransformDeltaState.PrepareForSend(ReplicatedCameraTransform, CameraTransformAckedKeyframe, GetWorld()->GetTimeSeconds());
+
 						AVRBaseCharacter * OwningChar = Cast<AVRBaseCharacter>(GetOwner());
 						if (OverrideSendTransform != nullptr && OwningChar != nullptr)
 						{
@@ -158,6 +172,7 @@ void UReplicatedVRCameraComponent::TickComponent(float DeltaTime, enum ELevelTic
 						{
 							// Don't bother with any of this if not replicating transform
 							//if (bHasAuthority && bReplicateTransform)
+							ReplicatedCameraTransform.RecordSendStats();
 							Server_SendCameraTransform(ReplicatedCameraTransform);
 						}
 					}
@@ -167,7 +182,17 @@ void UReplicatedVRCameraComponent::TickComponent(float DeltaTime, enum ELevelTic
 	}
 	else
 	{
-		if (bLerpingPosition)
+		if (bLerpingPosition && bUsePoseInterpolationBuffer)
+		{
+			FVector BufferedPosition;
+			FRotator BufferedRotation;
+
+			if (ReplicatedPoseBuffer.Sample(FPlatformTime::Seconds(), BufferedPosition, BufferedRotation))
+			{
+				SetRelativeLocationAndRotation(BufferedPosition, BufferedRotation);
+			}
+		}
+		else if (bLerpingPosition)
 		{
 			NetUpdateCount += DeltaTime;
 			float LerpVal = FMath::Clamp(NetUpdateCount / (1.0f / NetUpdateRate), 0.0f, 1.0f);
@@ -1432,6 +1432,7 @@ void UVRSimpleCharacterMovementComponent::ReplicateMoveToServer(float DeltaTime,
 			SCOPE_CYCLE_COUNTER(STAT_CharacterMovementCallServerMoveVRSimple);
 			//CallServerMove(NewMove.Get(), OldMove.Get());
 			CallServerMove(NewMove, OldMove.Get());
+			RecordServerMoveSent();
 		}
 	}
 
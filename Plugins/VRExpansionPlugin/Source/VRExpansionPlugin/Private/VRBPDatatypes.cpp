@@ -1,6 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "VRBPDataTypes.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
 
 namespace VRDataTypeCVARs
 {
@@ -91,6 +93,497 @@ bool FTransform_NetQuantize::NetSerialize(FArchive& Ar, class UPackageMap* Map,
 	return bOutSuccess;
 }
 
+DEFINE_STAT(STAT_VRPoseRPCsSent);
+DEFINE_STAT(STAT_VRPoseBytesSent);
+
+void FBPVRComponentPosRep::RecordSendStats() const
+{
+#if STATS
+	if (FThreadStats::IsCollectingData())
+	{
+		FBPVRComponentPosRep MeasuredRep = *this;
+		FBitWriter Writer(256, true);
+		bool bSuccess = true;
+		MeasuredRep.NetSerialize(Writer, nullptr, bSuccess);
+
+		INC_DWORD_STAT(STAT_VRPoseRPCsSent);
+		INC_DWORD_STAT_BY(STAT_VRPoseBytesSent, (Writer.GetNumBits() + 7) >> 3);
+	}
+#endif
+}
+
+bool FBPVRComponentPosRep::NetSerializeDelta(FArchive& Ar)
+{
+	bool bOutSuccess = true;
+
+	uint8 bKeyframe = bIsKeyframe ? 1 : 0;
+	Ar.SerializeBits(&bKeyframe, 1);
+	bIsKeyframe = bKeyframe != 0;
+
+	Ar.SerializeBits(&KeyframeID, VRPOSREP_KEYFRAME_ID_BITS);
+
+	// Packed vectors are already variable length, small deltas serialize with only a few bits per component
+	FVector SerializedPosition = FVector::ZeroVector;
+	FQuat SerializedRotation = FQuat::Identity;
+
+	if (Ar.IsSaving())
+	{
+		SerializedPosition = bIsKeyframe ? Position : Position - DeltaBaseline;
+		SerializedRotation = Rotation.Quaternion();
+	}
+
+	switch (QuantizationLevel)
+	{
+	case EVRVectorQuantization::RoundTwoDecimals: bOutSuccess &= SerializePackedVector<100, 22/*30*/>(SerializedPosition, Ar); break;
+	case EVRVectorQuantization::RoundOneDecimal: bOutSuccess &= SerializePackedVector<10, 18/*24*/>(SerializedPosition, Ar); break;
+	}
+
+	// Rotations aren't delta'd, smallest three is already cheaper than the euler shorts at a similar precision
+	// 9 bits is 29 total vs 30 for the 10 bit euler, 15 bits is 47 vs 48 for the shorts.
+	switch (RotationQuantizationLevel)
+	{
+	case EVRRotationQuantization::RoundTo10Bits: bOutSuccess &= FTransform_NetQuantize::SerializeQuat_SmallestThree<9>(Ar, SerializedRotation); break;
+	case EVRRotationQuantization::RoundToShort: bOutSuccess &= FTransform_NetQuantize::SerializeQuat_SmallestThree<15>(Ar, SerializedRotation); break;
+	}
+
+	if (Ar.IsLoading())
+	{
+		// Left relative to the keyframe, FBPVRPosRepDeltaState::ResolveReceived adds the keyframe back in
+		Position = SerializedPosition;
+		Rotation = SerializedRotation.Rotator();
+	}
+
+	return bOutSuccess;
+}
+
+void FBPVRPosRepDeltaState::PrepareForSend(FBPVRComponentPosRep & Rep, uint8 AckedKeyframeID, float CurrentTime)
+{
+	Rep.bIsKeyframe = false;
+
+	if (!Rep.bDeltaCompressToServer)
+	{
+		Rep.bIsDeltaFrame = false;
+		return;
+	}
+
+	const bool bHasBaseline = AckedKeyframeID < VRPOSREP_MAX_KEYFRAMES && bKeyframeValid[AckedKeyframeID];
+
+	// Slots aren't reissued while an acknowledgement can still name them, so the acknowledged ID maps to the keyframe it was sent for
+	if (bHasBaseline)
+		AckedKeyframeSequence = FMath::Max(AckedKeyframeSequence, KeyframeSequences[AckedKeyframeID]);
+
+	const bool bWantsKeyframe = !bHasBaseline || FVector::DistSquared(Rep.Position, KeyframePositions[AckedKeyframeID]) > FMath::Square(MaxKeyframeDistance);
+
+	// A slot is free once the server has acknowledged a newer keyframe than the one in it, this never frees the acknowledged one
+	// itself or any that are still in flight. With every slot taken the sends stay on the acknowledged keyframe until one frees up.
+	int32 FreeKeyframeID = INDEX_NONE;
+	if (bWantsKeyframe && (CurrentTime - LastKeyframeTime) >= KeyframeInterval)
+	{
+		for (int32 i = 0; i < VRPOSREP_MAX_KEYFRAMES && FreeKeyframeID == INDEX_NONE; ++i)
+		{
+			const int32 ID = (NextKeyframeID + i) % VRPOSREP_MAX_KEYFRAMES;
+			if (!bKeyframeValid[ID] || KeyframeSequences[ID] < AckedKeyframeSequence)
+				FreeKeyframeID = ID;
+		}
+	}
+
+	if (FreeKeyframeID != INDEX_NONE)
+	{
+		// Store what the server will actually end up with after quantization so that both sides share the same baseline
+		KeyframePositions[FreeKeyframeID] = GetNetQuantizedPosition(Rep.Position, Rep.QuantizationLevel);
+		bKeyframeValid[FreeKeyframeID] = true;
+		KeyframeSequences[FreeKeyframeID] = NextKeyframeSequence++;
+
+		Rep.bIsDeltaFrame = true;
+		Rep.bIsKeyframe = true;
+		Rep.KeyframeID = (uint8)FreeKeyframeID;
+
+		NextKeyframeID = (FreeKeyframeID + 1) % VRPOSREP_MAX_KEYFRAMES;
+		LastKeyframeTime = CurrentTime;
+	}
+	else if (bHasBaseline)
+	{
+		// Keep sending against the acknowledged keyframe until the newer one is acknowledged
+		Rep.bIsDeltaFrame = true;
+		Rep.KeyframeID = AckedKeyframeID;
+		Rep.DeltaBaseline = KeyframePositions[AckedKeyframeID];
+	}
+	else
+	{
+		// Nothing acknowledged yet and a keyframe is in flight, send a full snapshot
+		Rep.bIsDeltaFrame = false;
+	}
+}
+
+bool FBPVRPosRepDeltaState::ResolveReceived(FBPVRComponentPosRep & Rep, uint8 & OutAckedKeyframeID)
+{
+	if (!Rep.bIsDeltaFrame)
+		return true;
+
+	if (Rep.KeyframeID >= VRPOSREP_MAX_KEYFRAMES)
+		return false;
+
+	if (Rep.bIsKeyframe)
+	{
+		KeyframePositions[Rep.KeyframeID] = Rep.Position;
+		bKeyframeValid[Rep.KeyframeID] = true;
+		OutAckedKeyframeID = Rep.KeyframeID;
+	}
+	else
+	{
+		// The keyframe it was based on never arrived, drop it, the next keyframe will fix us up
+		if (!bKeyframeValid[Rep.KeyframeID])
+			return false;
+
+		Rep.Position += KeyframePositions[Rep.KeyframeID];
+	}
+
+	// Now a full pose, anything serializing it from here on (replication to other clients) sends a snapshot
+	Rep.bIsDeltaFrame = false;
+	Rep.bIsKeyframe = false;
+
+	return true;
+}
+
+FVector FBPVRPosRepDeltaState::GetNetQuantizedPosition(const FVector & Position, EVRVectorQuantization QuantizationLevel)
+{
+	// Round trips through the same packing that NetSerializeDelta uses so that the result is bit exact with the receiver
+	FVector QuantizedPosition = Position;
+	FBitWriter Writer(128, true);
+
+	switch (QuantizationLevel)
+	{
+	case EVRVectorQuantization::RoundTwoDecimals: SerializePackedVector<100, 22>(QuantizedPosition, Writer); break;
+	case EVRVectorQuantization::RoundOneDecimal: SerializePackedVector<10, 18>(QuantizedPosition, Writer); break;
+	}
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+
+	switch (QuantizationLevel)
+	{
+	case EVRVectorQuantization::RoundTwoDecimals: SerializePackedVector<100, 22>(QuantizedPosition, Reader); break;
+	case EVRVectorQuantization::RoundOneDecimal: SerializePackedVector<10, 18>(QuantizedPosition, Reader); break;
+	}
+
+	return QuantizedPosition;
+}
+
+// ** Pose Interpolation Buffer ** //
+
+double FBPVRPoseInterpolationBuffer::UnwrapSendTime(uint16 SendTimeStamp, double CurrentTime) const
+{
+	const double WrapTime = 65.536;
+
+	// Short gaps (and poses that were reordered in flight) are within half a wrap of the newest stamp
+	const double StampDelta = (int16)(uint16)(SendTimeStamp - NewestSendTimeStamp) / 1000.0;
+
+	// The sender only sends when the pose changes, so it can go quiet for longer than a wrap
+	const double Wraps = FMath::RoundToDouble(((CurrentTime - LastArrivalTime) - StampDelta) / WrapTime);
+
+	return NewestSenderTime + StampDelta + FMath::Max(Wraps, 0.0) * WrapTime;
+}
+
+void FBPVRPoseInterpolationBuffer::AddSample(const FVector & Position, const FRotator & Rotation, uint16 SendTimeStamp, double CurrentTime)
+{
+	const double SenderTime = NumSamples > 0 ? UnwrapSendTime(SendTimeStamp, CurrentTime) : 0.0;
+
+	// Smoothed minimum of the one way offset, drops straight to faster arrivals and only slowly relaxes upwards
+	// so that it follows clock drift and route changes without letting jitter move the playout clock
+	const double ArrivalOffset = CurrentTime - SenderTime;
+	if (NumSamples < 1)
+		ClockOffset = ArrivalOffset;
+	else
+		ClockOffset = FMath::Min(ArrivalOffset, ClockOffset + (ArrivalOffset - ClockOffset) * 0.02);
+
+	// Find where it goes, reordered poses are inserted behind newer ones
+	int32 InsertAge = 0;
+	while (InsertAge < NumSamples && GetSample(InsertAge).SenderTime > SenderTime)
+	{
+		++InsertAge;
+	}
+
+	// Already have this pose, or it is older than everything that we are holding on to
+	if (NumSamples > 0 && ((InsertAge < NumSamples && FMath::IsNearlyEqual(GetSample(InsertAge).SenderTime, SenderTime, 0.0005)) || (InsertAge >= NumSamples && NumSamples == VRPOSEBUFFER_MAX_SAMPLES)))
+		return;
+
+	if (InsertAge == 0)
+	{
+		NewestSenderTime = SenderTime;
+		NewestSendTimeStamp = SendTimeStamp;
+		LastArrivalTime = CurrentTime;
+	}
+
+	// Make room at the front and shift the newer samples up by one, the oldest drops off if the buffer is full
+	NewestIndex = (NewestIndex + 1) % VRPOSEBUFFER_MAX_SAMPLES;
+	NumSamples = FMath::Min(NumSamples + 1, VRPOSEBUFFER_MAX_SAMPLES);
+
+	for (int32 Age = 0; Age < InsertAge; ++Age)
+	{
+		GetSample(Age) = GetSample(Age + 1);
+	}
+
+	FBPVRPoseBufferSample & NewSample = GetSample(InsertAge);
+	NewSample.Position = Position;
+	NewSample.Rotation = Rotation.Quaternion();
+	NewSample.SenderTime = SenderTime;
+
+	// Make sure that the rotation slerps the short way from the previous sample, and into the next one
+	if (InsertAge + 1 < NumSamples)
+		NewSample.Rotation.EnforceShortestArcWith(GetSample(InsertAge + 1).Rotation);
+
+	for (int32 Age = InsertAge - 1; Age >= 0; --Age)
+	{
+		GetSample(Age).Rotation.EnforceShortestArcWith(GetSample(Age + 1).Rotation);
+	}
+}
+
+bool FBPVRPoseInterpolationBuffer::Sample(double CurrentTime, FVector & OutPosition, FRotator & OutRotation)
+{
+	if (NumSamples < 1)
+		return false;
+
+	// Playout time on the senders timeline
+	const double PlayoutTime = CurrentTime - ClockOffset - PlayoutDelay;
+	const FBPVRPoseBufferSample & Newest = GetSample(0);
+
+	BufferDepth = 0;
+	for (int32 Age = 0; Age < NumSamples && GetSample(Age).SenderTime > PlayoutTime; ++Age)
+	{
+		++BufferDepth;
+	}
+
+	if (PlayoutTime <= Newest.SenderTime)
+	{
+		bIsExtrapolating = false;
+		LastPlayoutTime = PlayoutTime;
+
+		// Walk back to the pair that brackets the playout time
+		for (int32 Age = 0; Age < NumSamples - 1; ++Age)
+		{
+			const FBPVRPoseBufferSample & To = GetSample(Age);
+			const FBPVRPoseBufferSample & From = GetSample(Age + 1);
+
+			if (From.SenderTime <= PlayoutTime)
+			{
+				const float Alpha = (float)FMath::Clamp((PlayoutTime - From.SenderTime) / (To.SenderTime - From.SenderTime), 0.0, 1.0);
+				OutPosition = FMath::Lerp(From.Position, To.Position, Alpha);
+				OutRotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha).Rotator();
+				return true;
+			}
+		}
+
+		// Playout is behind everything we still have (buffer overran or just started), hold the oldest
+		const FBPVRPoseBufferSample & Oldest = GetSample(NumSamples - 1);
+		OutPosition = Oldest.Position;
+		OutRotation = Oldest.Rotation.Rotator();
+		return true;
+	}
+
+	// The next pose is late, extrapolate the newest motion
+	if (!bIsExtrapolating)
+	{
+		bIsExtrapolating = true;
+		++LatePackets;
+		LastPlayoutTime = Newest.SenderTime;
+	}
+
+	ExtrapolationTime += (float)(PlayoutTime - LastPlayoutTime);
+	LastPlayoutTime = PlayoutTime;
+
+	OutPosition = Newest.Position;
+	OutRotation = Newest.Rotation.Rotator();
+
+	if (NumSamples < 2)
+		return true;
+
+	const FBPVRPoseBufferSample & Previous = GetSample(1);
+	const float SampleDelta = (float)(Newest.SenderTime - Previous.SenderTime);
+
+	if (SampleDelta <= KINDA_SMALL_NUMBER)
+		return true;
+
+	// Distance covered by a velocity that decays exponentially, converges to 1 / Damping instead of growing without bound
+	const float TimePastNewest = FMath::Min((float)(PlayoutTime - Newest.SenderTime), MaxExtrapolationTime);
+	const float DampedTime = ExtrapolationDamping > KINDA_SMALL_NUMBER ?
+		(1.0f - FMath::Exp(-ExtrapolationDamping * TimePastNewest)) / ExtrapolationDamping :
+		TimePastNewest;
+
+	const float Ratio = DampedTime / SampleDelta;
+
+	OutPosition = Newest.Position + (Newest.Position - Previous.Position) * Ratio;
+
+	FVector DeltaAxis;
+	float DeltaAngle;
+	(Newest.Rotation * Previous.Rotation.Inverse()).ToAxisAndAngle(DeltaAxis, DeltaAngle);
+	DeltaAngle = FMath::UnwindRadians(DeltaAngle);
+	OutRotation = (FQuat(DeltaAxis, DeltaAngle * Ratio) * Newest.Rotation).Rotator();
+
+	return true;
+}
+
+#if !UE_BUILD_SHIPPING
+DEFINE_LOG_CATEGORY_STATIC(LogVRPoseRep, Log, All);
+
+namespace VRPoseRepDeltaTest
+{
+	struct FPendingAck
+	{
+		float ArrivalTime;
+		uint8 KeyframeID;
+	};
+
+	static int32 GetSerializedBits(FBPVRComponentPosRep Rep)
+	{
+		FBitWriter Writer(256, true);
+		bool bSuccess = true;
+		Rep.NetSerialize(Writer, nullptr, bSuccess);
+		return Writer.GetNumBits();
+	}
+
+	// Drives a client and a server delta state with a simulated tracked hand, round tripping every send through NetSerialize.
+	// Checks that both sides hold bit exact keyframe baselines for every delta and that resolved poses stay within the quantization error,
+	// also with acknowledgement delays longer than it takes to issue VRPOSREP_MAX_KEYFRAMES keyframes,
+	// then reports the bandwidth against sending the same poses as full snapshots.
+	static void RunTest(const TArray<FString> & Args)
+	{
+		const float Seconds = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 0.1f) : 10.0f;
+		const float SendHz = Args.Num() > 1 ? FMath::Clamp(FCString::Atof(*Args[1]), 1.0f, 1000.0f) : 100.0f;
+		const float PacketLoss = Args.Num() > 2 ? FMath::Clamp(FCString::Atof(*Args[2]), 0.0f, 0.9f) : 0.0f;
+		const float AckDelay = Args.Num() > 3 ? FMath::Max(FCString::Atof(*Args[3]), 0.0f) / 1000.0f : 0.1f;
+
+		FRandomStream Stream(0x5EED);
+
+		FBPVRPosRepDeltaState ClientState;
+		FBPVRPosRepDeltaState ServerState;
+		uint8 ClientAckedKeyframe = VRPOSREP_INVALID_KEYFRAME;
+		uint8 ServerAckedKeyframe = VRPOSREP_INVALID_KEYFRAME;
+		TArray<FPendingAck> PendingAcks;
+
+		FBPVRComponentPosRep Rep;
+		Rep.bDeltaCompressToServer = true;
+
+		const float MaxAxisError = (Rep.QuantizationLevel == EVRVectorQuantization::RoundTwoDecimals ? 0.005f : 0.05f) + KINDA_SMALL_NUMBER;
+		const int32 NumSends = FMath::CeilToInt(Seconds * SendHz);
+
+		int64 DeltaBits = 0;
+		int64 FullBits = 0;
+		int32 NumKeyframes = 0;
+		int32 NumDeltas = 0;
+		int32 NumSnapshots = 0;
+		int32 NumLost = 0;
+		int32 NumDropped = 0;
+		int32 BaselineMismatches = 0;
+		int32 PoseErrors = 0;
+		int32 SerializeFailures = 0;
+		float MaxPositionError = 0.0f;
+
+		for (int32 i = 0; i < NumSends; ++i)
+		{
+			const float Time = i / SendHz;
+
+			// Acknowledgements come back through a replicated property, delayed but not lost
+			while (PendingAcks.Num() && PendingAcks[0].ArrivalTime <= Time)
+			{
+				ClientAckedKeyframe = PendingAcks[0].KeyframeID;
+				PendingAcks.RemoveAt(0, 1, false);
+			}
+
+			// A hand sweeping around at roughly a meter a second with some tracking jitter
+			Rep.Position = FVector(FMath::Sin(Time * 2.1f) * 40.0f, FMath::Cos(Time * 1.3f) * 30.0f, 100.0f + FMath::Sin(Time * 3.7f) * 20.0f) + Stream.GetUnitVector() * 0.05f;
+			Rep.Rotation = FRotator(FMath::Sin(Time) * 60.0f, FMath::Fmod(Time * 45.0f, 360.0f) - 180.0f, FMath::Cos(Time * 0.7f) * 30.0f);
+
+			// Every other send goes without a stamp so that both serialization paths are covered
+			if (i & 1)
+				Rep.ClearSendTime();
+			else
+				Rep.SetSendTime(Time);
+
+			ClientState.PrepareForSend(Rep, ClientAckedKeyframe, Time);
+
+			if (Rep.bIsKeyframe)
+				++NumKeyframes;
+			else if (Rep.bIsDeltaFrame)
+				++NumDeltas;
+			else
+				++NumSnapshots;
+
+			FBPVRComponentPosRep FullRep = Rep;
+			FullRep.bIsDeltaFrame = false;
+			FullBits += GetSerializedBits(FullRep);
+
+			FBPVRComponentPosRep SentRep = Rep;
+			FBitWriter Writer(256, true);
+			bool bSuccess = true;
+			SentRep.NetSerialize(Writer, nullptr, bSuccess);
+			DeltaBits += Writer.GetNumBits();
+
+			if (PacketLoss > 0.0f && Stream.FRand() < PacketLoss)
+			{
+				++NumLost;
+				continue;
+			}
+
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FBPVRComponentPosRep ReceivedRep;
+			ReceivedRep.NetSerialize(Reader, nullptr, bSuccess);
+
+			if (!bSuccess || Reader.IsError())
+			{
+				++SerializeFailures;
+				continue;
+			}
+
+			if (!ServerState.ResolveReceived(ReceivedRep, ServerAckedKeyframe))
+			{
+				++NumDropped;
+				continue;
+			}
+
+			if (Rep.bIsDeltaFrame)
+			{
+				// Both sides have to hold the exact same baseline or every delta built on it is off
+				const uint8 ID = Rep.KeyframeID;
+				if (FMemory::Memcmp(&ServerState.KeyframePositions[ID], &ClientState.KeyframePositions[ID], sizeof(FVector)) != 0)
+					++BaselineMismatches;
+
+				if (Rep.bIsKeyframe)
+					PendingAcks.Add({ Time + AckDelay, ID });
+			}
+
+			const float PositionError = (ReceivedRep.Position - Rep.Position).GetAbs().GetMax();
+			MaxPositionError = FMath::Max(MaxPositionError, PositionError);
+
+			if (PositionError > MaxAxisError || !ReceivedRep.Rotation.Quaternion().Equals(Rep.Rotation.Quaternion(), 0.01f) || ReceivedRep.bHasSendTimeStamp != Rep.bHasSendTimeStamp || ReceivedRep.SendTimeStamp != Rep.SendTimeStamp)
+				++PoseErrors;
+		}
+
+		const double DeltaBytesPerSecond = (DeltaBits / 8.0) / Seconds;
+		const double FullBytesPerSecond = (FullBits / 8.0) / Seconds;
+
+		UE_LOG(LogVRPoseRep, Log, TEXT("Pose delta test: %d sends at %.0fhz, %d keyframes, %d deltas, %d snapshots, %d lost, %d dropped for a missing keyframe"),
+			NumSends, SendHz, NumKeyframes, NumDeltas, NumSnapshots, NumLost, NumDropped);
+		UE_LOG(LogVRPoseRep, Log, TEXT("Pose delta test: %.1f bytes/sec delta compressed vs %.1f bytes/sec full sends (%.1f%%), max position error %.4f"),
+			DeltaBytesPerSecond, FullBytesPerSecond, FullBytesPerSecond > 0.0 ? DeltaBytesPerSecond * 100.0 / FullBytesPerSecond : 0.0, MaxPositionError);
+
+		if (BaselineMismatches || PoseErrors || SerializeFailures)
+		{
+			UE_LOG(LogVRPoseRep, Error, TEXT("Pose delta test FAILED: %d keyframe baseline mismatches, %d poses outside of the quantization error, %d serialization failures"),
+				BaselineMismatches, PoseErrors, SerializeFailures);
+		}
+		else
+		{
+			UE_LOG(LogVRPoseRep, Log, TEXT("Pose delta test passed"));
+		}
+	}
+
+	static FAutoConsoleCommandWithArgs TestCommand(
+		TEXT("vr.PoseRep.DeltaTest"),
+		TEXT("Round trips simulated keyframe and delta pose sends, checks that they resolve bit exact and reports bytes/sec against full sends.\n")
+		TEXT("Usage: vr.PoseRep.DeltaTest [Seconds=10] [SendHz=100] [PacketLoss=0.0] [AckDelayMs=100]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunTest));
+}
+#endif
+
 // ** Euro Low Pass Filter ** //
 
 void FBPEuroLowPassFilter::ResetSmoothingFilter()
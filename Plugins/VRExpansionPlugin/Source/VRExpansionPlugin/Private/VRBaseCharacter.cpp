@@ -3,6 +3,7 @@
 #include "VRBaseCharacter.h"
 #include "NavigationSystem.h"
 #include "VRPathFollowingComponent.h"
+#include "Serialization/BitWriter.h"
 //#include "Runtime/Engine/Private/EnginePrivate.h"
 
 DEFINE_LOG_CATEGORY(LogBaseVRCharacter);
@@ -39,7 +40,7 @@ AVRBaseCharacter::AVRBaseCharacter(const FObjectInitializer& ObjectInitializer)
 	{
 		VRReplicatedCamera->bOffsetByHMD = false;
 		VRReplicatedCamera->SetupAttachment(NetSmoother);
-		VRReplicatedCamera->OverrideSendTransform = &AVRBaseCharacter::Server_SendTransformCamera;
+		VRReplicatedCamera->OverrideSendTransform = &AVRBaseCharacter::SendTransformCamera;
 	}
 
 	VRMovementReference = NULL;
@@ -67,7 +68,7 @@ AVRBaseCharacter::AVRBaseCharacter(const FObjectInitializer& ObjectInitializer)
 		LeftMotionController->bOffsetByHMD = false;
 		// Keep the controllers ticking after movement
 		LeftMotionController->AddTickPrerequisiteComponent(GetCharacterMovement());
-		LeftMotionController->OverrideSendTransform = &AVRBaseCharacter::Server_SendTransformLeftController;
+		LeftMotionController->OverrideSendTransform = &AVRBaseCharacter::SendTransformLeftController;
 	}
 
 	RightMotionController = CreateDefaultSubobject<UGripMotionControllerComponent>(AVRBaseCharacter::RightMotionControllerComponentName);
@@ -80,7 +81,7 @@ AVRBaseCharacter::AVRBaseCharacter(const FObjectInitializer& ObjectInitializer)
 		RightMotionController->bOffsetByHMD = false;
 		// Keep the controllers ticking after movement
 		RightMotionController->AddTickPrerequisiteComponent(GetCharacterMovement());
-		RightMotionController->OverrideSendTransform = &AVRBaseCharacter::Server_SendTransformRightController;
+		RightMotionController->OverrideSendTransform = &AVRBaseCharacter::SendTransformRightController;
 	}
 
 	OffsetComponentToWorld = FTransform(FQuat(0.0f, 0.0f, 0.0f, 1.0f), FVector::ZeroVector, FVector(1.0f));
@@ -98,6 +99,236 @@ AVRBaseCharacter::AVRBaseCharacter(const FObjectInitializer& ObjectInitializer)
 	VRReplicateCapsuleHeight = false;
 
 	bUseExperimentalUnseatModeFix = true;
+
+	bCombinePoseSends = false;
+	CombinedPoseNetUpdateRate = 100.0f;
+	CombinedPoseNetUpdateCount = 0.0f;
+
+	// Post physics so that every tracked component has already queued its pose for the frame
+	CombinedPoseSendTickFunction.bCanEverTick = true;
+	CombinedPoseSendTickFunction.bStartWithTickEnabled = true;
+	CombinedPoseSendTickFunction.bTickEvenWhenPaused = true;
+	CombinedPoseSendTickFunction.TickGroup = TG_PostPhysics;
+
+	bRecordRewindHistory = false;
+	RewindHistoryFrames = 64;
+	MaxRewindTime = 0.5f;
+	RewindHeadRadius = 12.0f;
+	RewindHandRadius = 8.0f;
+
+	RewindHistoryTickFunction.bCanEverTick = true;
+	RewindHistoryTickFunction.bStartWithTickEnabled = true;
+	RewindHistoryTickFunction.TickGroup = TG_PostPhysics;
+}
+
+void AVRBaseCharacter::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		UpdateCombinedPoseSendTick();
+
+		if (bRecordRewindHistory && !IsTemplate())
+		{
+			RewindHistoryTickFunction.Target = this;
+			RewindHistoryTickFunction.SetTickFunctionEnable(RewindHistoryTickFunction.bStartWithTickEnabled);
+			RewindHistoryTickFunction.RegisterTickFunction(GetLevel());
+		}
+	}
+	else
+	{
+		if (CombinedPoseSendTickFunction.IsTickFunctionRegistered())
+		{
+			CombinedPoseSendTickFunction.UnRegisterTickFunction();
+		}
+
+		if (RewindHistoryTickFunction.IsTickFunctionRegistered())
+		{
+			RewindHistoryTickFunction.UnRegisterTickFunction();
+		}
+	}
+}
+
+void AVRBaseCharacter::UpdateCombinedPoseSendTick()
+{
+	// Only the owning client sends its poses, the server and simulated proxies never need the tick
+	const bool bWantsTick = bCombinePoseSends && !IsTemplate() && GetNetMode() == NM_Client && IsLocallyControlled();
+
+	if (bWantsTick && !CombinedPoseSendTickFunction.IsTickFunctionRegistered())
+	{
+		CombinedPoseSendTickFunction.Target = this;
+		CombinedPoseSendTickFunction.SetTickFunctionEnable(CombinedPoseSendTickFunction.bStartWithTickEnabled);
+		CombinedPoseSendTickFunction.RegisterTickFunction(GetLevel());
+	}
+	else if (!bWantsTick && CombinedPoseSendTickFunction.IsTickFunctionRegistered())
+	{
+		CombinedPoseSendTickFunction.UnRegisterTickFunction();
+		PendingCombinedPoses.PoseFlags = 0;
+	}
+}
+
+void AVRBaseCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+
+	// Before begin play the tick functions haven't registered yet, they check this themselves when they do
+	if (HasActorBegunPlay())
+		UpdateCombinedPoseSendTick();
+}
+
+void FVRCombinedPoseSendTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill())
+	{
+		Target->SendCombinedPoses(DeltaTime);
+	}
+}
+
+FString FVRCombinedPoseSendTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[SendCombinedPoses]") : TEXT("nullptr[SendCombinedPoses]");
+}
+
+void FVRRewindHistoryTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill())
+	{
+		Target->RecordRewindFrame();
+	}
+}
+
+FString FVRRewindHistoryTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[RecordRewindFrame]") : TEXT("nullptr[RecordRewindFrame]");
+}
+
+void AVRBaseCharacter::RecordRewindFrame()
+{
+	// Roles aren't final when the tick function registers, so clients just never record
+	if (!HasAuthority())
+		return;
+
+	if (!RewindHistory.IsInitialized())
+		RewindHistory.Init(RewindHistoryFrames);
+
+	FVRRewindFrame Frame;
+	Frame.ServerTime = GetWorld()->GetTimeSeconds();
+
+	// The offset transform is the capsules actual location, the root sits at the tracking origin
+	Frame.CapsuleLocation = OffsetComponentToWorld.GetLocation();
+	Frame.CapsuleRotation = OffsetComponentToWorld.GetRotation();
+
+	if (UCapsuleComponent * Capsule = GetCapsuleComponent())
+	{
+		Frame.CapsuleRadius = Capsule->GetScaledCapsuleRadius();
+		Frame.CapsuleHalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+	}
+	else
+	{
+		Frame.CapsuleRadius = 0.0f;
+		Frame.CapsuleHalfHeight = 0.0f;
+	}
+
+	Frame.HeadTransform = VRReplicatedCamera ? VRReplicatedCamera->GetComponentTransform() : OffsetComponentToWorld;
+	Frame.LeftHandTransform = LeftMotionController ? LeftMotionController->GetComponentTransform() : Frame.HeadTransform;
+	Frame.RightHandTransform = RightMotionController ? RightMotionController->GetComponentTransform() : Frame.HeadTransform;
+
+	RewindHistory.Record(Frame);
+}
+
+void FVRCombinedPoseRep::RecordSendStats() const
+{
+#if STATS
+	if (FThreadStats::IsCollectingData())
+	{
+		FVRCombinedPoseRep MeasuredRep = *this;
+		FBitWriter Writer(1024, true);
+		bool bSuccess = true;
+		MeasuredRep.NetSerialize(Writer, nullptr, bSuccess);
+
+		INC_DWORD_STAT(STAT_VRPoseRPCsSent);
+		INC_DWORD_STAT_BY(STAT_VRPoseBytesSent, (Writer.GetNumBits() + 7) >> 3);
+	}
+#endif
+}
+
+void AVRBaseCharacter::SendCombinedPoses(float DeltaTime)
+{
+	if (GetNetMode() != NM_Client)
+		return;
+
+	const float SendInterval = 1.0f / CombinedPoseNetUpdateRate;
+	CombinedPoseNetUpdateCount += DeltaTime;
+
+	if (PendingCombinedPoses.PoseFlags != 0 && CombinedPoseNetUpdateCount >= SendInterval)
+	{
+		// Keep the remainder so that the average rate holds, but don't let a hitch or an idle stretch turn into a burst of sends
+		CombinedPoseNetUpdateCount -= SendInterval;
+		if (CombinedPoseNetUpdateCount >= SendInterval)
+			CombinedPoseNetUpdateCount = 0.0f;
+
+		FlushCombinedPoses();
+	}
+}
+
+void AVRBaseCharacter::FlushCombinedPoses()
+{
+	if (PendingCombinedPoses.PoseFlags == 0)
+		return;
+
+	PendingCombinedPoses.RecordSendStats();
+	Server_SendCombinedPose(PendingCombinedPoses);
+	PendingCombinedPoses.PoseFlags = 0;
+}
+
+void AVRBaseCharacter::QueueCombinedPose(FBPVRComponentPosRep & PendingPose, uint8 PoseFlag, const FBPVRComponentPosRep & NewTransform)
+{
+	// A keyframe that is replaced before it goes out is lost for good, and the server would drop every delta that references it
+	if ((PendingCombinedPoses.PoseFlags & PoseFlag) && PendingPose.bIsDeltaFrame && PendingPose.bIsKeyframe)
+		FlushCombinedPoses();
+
+	PendingPose = NewTransform;
+	PendingCombinedPoses.PoseFlags |= PoseFlag;
+}
+
+void AVRBaseCharacter::SendTransformCamera(FBPVRComponentPosRep NewTransform)
+{
+	if (CombinedPoseSendTickFunction.IsTickFunctionRegistered())
+	{
+		QueueCombinedPose(PendingCombinedPoses.CameraTransform, FVRCombinedPoseRep::HasCamera, NewTransform);
+	}
+	else
+	{
+		NewTransform.RecordSendStats();
+		Server_SendTransformCamera(NewTransform);
+	}
+}
+
+void AVRBaseCharacter::SendTransformLeftController(FBPVRComponentPosRep NewTransform)
+{
+	if (CombinedPoseSendTickFunction.IsTickFunctionRegistered())
+	{
+		QueueCombinedPose(PendingCombinedPoses.LeftControllerTransform, FVRCombinedPoseRep::HasLeftController, NewTransform);
+	}
+	else
+	{
+		NewTransform.RecordSendStats();
+		Server_SendTransformLeftController(NewTransform);
+	}
+}
+
+void AVRBaseCharacter::SendTransformRightController(FBPVRComponentPosRep NewTransform)
+{
+	if (CombinedPoseSendTickFunction.IsTickFunctionRegistered())
+	{
+		QueueCombinedPose(PendingCombinedPoses.RightControllerTransform, FVRCombinedPoseRep::HasRightController, NewTransform);
+	}
+	else
+	{
+		NewTransform.RecordSendStats();
+		Server_SendTransformRightController(NewTransform);
+	}
 }
 
 void AVRBaseCharacter::OnRep_PlayerState()
@@ -214,6 +445,24 @@ bool AVRBaseCharacter::Server_SendTransformRightController_Validate(FBPVRCompone
 	return true;
 	// Optionally check to make sure that player is inside of their bounds and deny it if they aren't?
 }
+
+void AVRBaseCharacter::Server_SendCombinedPose_Implementation(FVRCombinedPoseRep NewPoses)
+{
+	if ((NewPoses.PoseFlags & FVRCombinedPoseRep::HasCamera) && VRReplicatedCamera)
+		VRReplicatedCamera->Server_SendCameraTransform_Implementation(NewPoses.CameraTransform);
+
+	if ((NewPoses.PoseFlags & FVRCombinedPoseRep::HasLeftController) && LeftMotionController)
+		LeftMotionController->Server_SendControllerTransform_Implementation(NewPoses.LeftControllerTransform);
+
+	if ((NewPoses.PoseFlags & FVRCombinedPoseRep::HasRightController) && RightMotionController)
+		RightMotionController->Server_SendControllerTransform_Implementation(NewPoses.RightControllerTransform);
+}
+
+bool AVRBaseCharacter::Server_SendCombinedPose_Validate(FVRCombinedPoseRep NewPoses)
+{
+	return true;
+	// Optionally check to make sure that player is inside of their bounds and deny it if they aren't?
+}
 FVector AVRBaseCharacter::GetTeleportLocation(FVector OriginalLocation)
 {	
 	return OriginalLocation;
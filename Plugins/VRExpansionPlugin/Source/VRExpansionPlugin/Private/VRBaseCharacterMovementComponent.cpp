@@ -11,6 +11,55 @@
 #include "VRRootComponent.h"
 #include "VRPlayerController.h"
 #include "GameFramework/PhysicsVolume.h"
+#include "GameFramework/PlayerState.h"
+
+DEFINE_LOG_CATEGORY(LogVRBaseCharacterMovement);
+
+namespace VRBaseCharacterMovementCvars
+{
+	static int32 TolerantMoveCombining = 1;
+	FAutoConsoleVariableRef CVarTolerantMoveCombining(
+		TEXT("vr.VRMovement.TolerantMoveCombining"),
+		TolerantMoveCombining,
+		TEXT("How VR saved moves with differing HMD deltas (LFDiff) are combined before being sent to the server.\n")
+		TEXT("0: Only combine moves with an identical capsule height and HMD delta direction\n")
+		TEXT("1: Compare at the replicated precision and within the combine tolerances (default)"),
+		ECVF_Default);
+
+	static float CombineCapsuleHeightTolerance = 1.0f;
+	FAutoConsoleVariableRef CVarCombineCapsuleHeightTolerance(
+		TEXT("vr.VRMovement.CombineCapsuleHeightTolerance"),
+		CombineCapsuleHeightTolerance,
+		TEXT("Largest replicated capsule half height difference that still allows two moves to be combined, the newer height is used for the combined move."),
+		ECVF_Default);
+
+	static float CombineHMDDeltaTolerance = 0.5f;
+	FAutoConsoleVariableRef CVarCombineHMDDeltaTolerance(
+		TEXT("vr.VRMovement.CombineHMDDeltaTolerance"),
+		CombineHMDDeltaTolerance,
+		TEXT("HMD deltas shorter than this are treated as tracking noise and don't stop moves from combining when their direction changes."),
+		ECVF_Default);
+
+	static int32 NetMoveStats = 0;
+	FAutoConsoleVariableRef CVarNetMoveStats(
+		TEXT("vr.VRMovement.NetMoveStats"),
+		NetMoveStats,
+		TEXT("If enabled locally controlled VR characters log the server moves they send, combine and get corrected every second."),
+		ECVF_Default);
+}
+
+namespace VRBaseCharacterMovementStatics
+{
+	// Match FVector_NetQuantize100 (2 decimal place of precision), what the server ends up seeing of LFDiff
+	FORCEINLINE FVector QuantizeLFDiff(const FVector & LFDiff)
+	{
+		return FVector(
+			FMath::RoundToFloat(LFDiff.X * 100.f) / 100.f,
+			FMath::RoundToFloat(LFDiff.Y * 100.f) / 100.f,
+			FMath::RoundToFloat(LFDiff.Z * 100.f) / 100.f
+		);
+	}
+}
 
 UVRBaseCharacterMovementComponent::UVRBaseCharacterMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -184,7 +233,40 @@ bool UVRBaseCharacterMovementComponent::VerifyClientTimeStamp(float TimeStamp, F
 	if (MovementMode == MOVE_Custom && CustomMovementMode == (uint8)EVRCustomMovementMode::VRMOVE_Seated)
 		return false;
 
-	return Super::VerifyClientTimeStamp(TimeStamp, ServerData);
+	if (!Super::VerifyClientTimeStamp(TimeStamp, ServerData))
+		return false;
+
+	ClientTimeStampOffset.AddVerifiedTimeStamp(TimeStamp, GetWorld()->GetTimeSeconds(), MinTimeBetweenTimeStampResets * 0.5f);
+
+	return true;
+}
+
+float UVRBaseCharacterMovementComponent::GetServerTimeForClientTimeStamp(float ClientTimeStamp) const
+{
+	const float CurrentTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+	return ClientTimeStampOffset.GetServerTime(ClientTimeStamp, GetClientOneWayLatency(), CurrentTime);
+}
+
+float UVRBaseCharacterMovementComponent::GetClientOneWayLatency() const
+{
+	if (CharacterOwner)
+	{
+		if (APlayerState * PlayerState = CharacterOwner->GetPlayerState())
+			return FMath::Clamp(PlayerState->ExactPing * 0.5f * 0.001f, 0.0f, 1.0f);
+	}
+
+	return 0.0f;
+}
+
+float UVRBaseCharacterMovementComponent::GetCurrentClientTimeStamp() const
+{
+	if (HasPredictionData_Client())
+	{
+		FNetworkPredictionData_Client_Character * ClientData = GetPredictionData_Client_Character();
+		return ClientData ? ClientData->CurrentTimeStamp : 0.0f;
+	}
+
+	return 0.0f;
 }
 
 void UVRBaseCharacterMovementComponent::StartPushBackNotification(FHitResult HitResult)
@@ -1140,6 +1222,74 @@ void UVRBaseCharacterMovementComponent::PerformMovement(float DeltaSeconds)
 	}
 }
 
+bool FSavedMove_VRBaseCharacter::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* Character, float MaxDelta) const
+{
+	FSavedMove_VRBaseCharacter * nMove = (FSavedMove_VRBaseCharacter *)NewMove.Get();
+
+
+	if (!nMove || (VRReplicatedMovementMode != nMove->VRReplicatedMovementMode))
+		return false;
+
+	if (ConditionalValues.MoveActionArray.MoveActions.Num() > 0 || nMove->ConditionalValues.MoveActionArray.MoveActions.Num() > 0)
+		return false;
+
+	if (!ConditionalValues.CustomVRInputVector.IsZero() || !nMove->ConditionalValues.CustomVRInputVector.IsZero())
+		return false;
+
+	if (!ConditionalValues.RequestedVelocity.IsZero() || !nMove->ConditionalValues.RequestedVelocity.IsZero())
+		return false;
+
+	if (VRBaseCharacterMovementCvars::TolerantMoveCombining > 0)
+	{
+		// HMD motion never repeats exactly, so compare what actually goes over the wire
+		const FVector QuantizedLFDiff = VRBaseCharacterMovementStatics::QuantizeLFDiff(LFDiff);
+		const FVector QuantizedNewLFDiff = VRBaseCharacterMovementStatics::QuantizeLFDiff(nMove->LFDiff);
+
+		// The combined move is sent with the newer capsule height, only refuse if it drifted too far from this one
+		if (FMath::Abs(QuantizedLFDiff.Z - QuantizedNewLFDiff.Z) > FMath::Max(VRBaseCharacterMovementCvars::CombineCapsuleHeightTolerance, 0.0f) + KINDA_SMALL_NUMBER)
+			return false;
+
+		// Direction changes only matter once both deltas are above the tracking noise
+		const float MinDirectionalDeltaSq = FMath::Square(FMath::Max(VRBaseCharacterMovementCvars::CombineHMDDeltaTolerance, 0.01f));
+		if (QuantizedLFDiff.SizeSquared2D() >= MinDirectionalDeltaSq && QuantizedNewLFDiff.SizeSquared2D() >= MinDirectionalDeltaSq &&
+			!FVector::Coincident(QuantizedLFDiff.GetSafeNormal2D(), QuantizedNewLFDiff.GetSafeNormal2D(), AccelDotThresholdCombine))
+			return false;
+	}
+	else
+	{
+		// Hate this but we really can't combine if I am sending a new capsule height
+		if (!FMath::IsNearlyEqual(LFDiff.Z, nMove->LFDiff.Z))
+			return false;
+
+		if (!LFDiff.IsZero() && !nMove->LFDiff.IsZero() && !FVector::Coincident(LFDiff.GetSafeNormal2D(), nMove->LFDiff.GetSafeNormal2D(), AccelDotThresholdCombine))
+			return false;
+	}
+
+	return FSavedMove_Character::CanCombineWith(NewMove, Character, MaxDelta);
+}
+
+bool FSavedMove_VRBaseCharacter::IsImportantMove(const FSavedMovePtr& LastAckedMove) const
+{
+	// Auto important if toggled climbing
+	if (VRReplicatedMovementMode != EVRConjoinedMovementModes::C_MOVE_MAX)//_None)
+		return true;
+
+	if (!ConditionalValues.CustomVRInputVector.IsZero())	
+		return true;
+
+	if (!ConditionalValues.RequestedVelocity.IsZero())
+		return true;
+
+	if (ConditionalValues.MoveActionArray.MoveActions.Num() > 0)
+		return true;
+
+	// LFDiff is left out on purpose, it is non zero nearly every frame and the old move resend (ServerMoveVROld) doesn't carry it.
+	// The capsule height in LFDiff.Z is absolute and goes out with every new move anyway, so a lost one corrects itself.
+
+	// Else check parent class
+	return FSavedMove_Character::IsImportantMove(LastAckedMove);
+}
+
 void FSavedMove_VRBaseCharacter::SetInitialPosition(ACharacter* C)
 {
 	// See if we can get the VR capsule location
@@ -1206,10 +1356,16 @@ void FSavedMove_VRBaseCharacter::CombineWith(const FSavedMove_Character* OldMove
 	//FSavedMove_VRBaseCharacter * BaseSavedMove = (FSavedMove_VRBaseCharacter *)NewMove.Get();
 	FSavedMove_VRBaseCharacter * BaseSavedMovePending = (FSavedMove_VRBaseCharacter *)OldMove;
 
+	// The combined move is replayed from the pending moves start location, so it has to cover the HMD delta of both moves.
+	// SetInitialPosition() below reads LFDiff back out of the movement component, the capsule height in LFDiff.Z is absolute and the newer one is kept.
 	if (/*BaseSavedMove && */BaseSavedMovePending)
 	{
-		LFDiff.X += BaseSavedMovePending->LFDiff.X;
-		LFDiff.Y += BaseSavedMovePending->LFDiff.Y;
+		if (UVRBaseCharacterMovementComponent * BaseCharMove = Cast<UVRBaseCharacterMovementComponent>(CharMovement))
+		{
+			BaseCharMove->AdditionalVRInputVector.X += BaseSavedMovePending->LFDiff.X;
+			BaseCharMove->AdditionalVRInputVector.Y += BaseSavedMovePending->LFDiff.Y;
+			BaseCharMove->RecordServerMoveCombined();
+		}
 	}
 
 	// Roll back jump force counters. SetInitialPosition() below will copy them to the saved move.
@@ -1593,6 +1749,69 @@ void UVRBaseCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
 	Super::UpdateFromCompressedFlags(Flags);
 }
 
+void UVRBaseCharacterMovementComponent::RecordServerMoveSent()
+{
+	if (!VRBaseCharacterMovementCvars::NetMoveStats)
+	{
+		NetMoveStats.WindowStartTime = -1.0f;
+		return;
+	}
+
+	NetMoveStats.MovesSent++;
+	UpdateNetMoveStats();
+}
+
+void UVRBaseCharacterMovementComponent::RecordServerMoveCombined()
+{
+	if (!VRBaseCharacterMovementCvars::NetMoveStats)
+		return;
+
+	NetMoveStats.MovesCombined++;
+}
+
+void UVRBaseCharacterMovementComponent::RecordServerCorrection()
+{
+	if (!VRBaseCharacterMovementCvars::NetMoveStats)
+		return;
+
+	NetMoveStats.Corrections++;
+	NetMoveStats.TotalCorrections++;
+}
+
+void UVRBaseCharacterMovementComponent::UpdateNetMoveStats()
+{
+	UWorld * World = GetWorld();
+	if (!World)
+		return;
+
+	const float CurrentTime = World->GetRealTimeSeconds();
+
+	// First move after the cvar got set, start a fresh window
+	if (NetMoveStats.WindowStartTime < 0.0f)
+	{
+		NetMoveStats = FVRNetMoveStats();
+		NetMoveStats.WindowStartTime = CurrentTime;
+		return;
+	}
+
+	const float WindowLength = CurrentTime - NetMoveStats.WindowStartTime;
+	if (WindowLength < 1.0f)
+		return;
+
+	UE_LOG(LogVRBaseCharacterMovement, Log, TEXT("%s: %.1f server moves/s, %.1f combined/s, %.1f corrections/s (%d total), tolerant combining %s"),
+		*GetNameSafe(CharacterOwner),
+		NetMoveStats.MovesSent / WindowLength,
+		NetMoveStats.MovesCombined / WindowLength,
+		NetMoveStats.Corrections / WindowLength,
+		NetMoveStats.TotalCorrections,
+		VRBaseCharacterMovementCvars::TolerantMoveCombining > 0 ? TEXT("on") : TEXT("off"));
+
+	NetMoveStats.MovesSent = 0;
+	NetMoveStats.MovesCombined = 0;
+	NetMoveStats.Corrections = 0;
+	NetMoveStats.WindowStartTime = CurrentTime;
+}
+
 FVector UVRBaseCharacterMovementComponent::RoundDirectMovement(FVector InMovement) const
 {
 	// Match FVector_NetQuantize100 (2 decimal place of precision).
@@ -386,7 +386,8 @@ void FSavedMove_VRCharacter::SetInitialPosition(ACharacter* C)
 		{
 			VRCapsuleLocation = VRC->VRRootReference->curCameraLoc;
 			VRCapsuleRotation = UVRExpansionFunctionLibrary::GetHMDPureYaw_I(VRC->VRRootReference->curCameraRot);
-			LFDiff = VRC->VRRootReference->DifferenceFromLastFrame;
+			// Read from the movement component so that a combined move carries the HMD delta of the move it absorbed
+			LFDiff = CharMove ? CharMove->AdditionalVRInputVector : VRC->VRRootReference->DifferenceFromLastFrame;
 		}
 		else
 		{
@@ -1530,6 +1531,7 @@ void UVRCharacterMovementComponent::ReplicateMoveToServer(float DeltaTime, const
 		{
 			SCOPE_CYCLE_COUNTER(STAT_CharacterMovementCallServerMove);
 			CallServerMove(NewMove, OldMove.Get());
+			RecordServerMoveSent();
 		}
 	}
 
@@ -4075,6 +4077,8 @@ void UVRCharacterMovementComponent::ClientAdjustPositionVR_Implementation
 	FNetworkPredictionData_Client_Character* ClientData = GetPredictionData_Client_Character();
 	check(ClientData);
 
+	RecordServerCorrection();
+
 	// Make sure the base actor exists on this client.
 	const bool bUnresolvedBase = bHasBase && (NewBase == NULL);
 	if (bUnresolvedBase)
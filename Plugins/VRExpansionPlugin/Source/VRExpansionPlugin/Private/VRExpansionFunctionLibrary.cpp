@@ -4,6 +4,16 @@
 #include "Engine/Engine.h"
 #include "IXRTrackingSystem.h"
 #include "IHeadMountedDisplay.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshSocket.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "Engine/World.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/Package.h"
+#include "HAL/IConsoleManager.h"
 
 #if WITH_EDITOR
 #include "Editor/UnrealEd/Classes/Editor/EditorEngine.h"
@@ -37,22 +47,179 @@ bool UVRExpansionFunctionLibrary::GetIsActorMovable(AActor * ActorToCheck)
 	return false;
 }
 
-void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName(FName SlotType, AActor * Actor, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform)
+namespace VRGripSlotCache
 {
-	bHadSlotInRange = false;
-	SlotWorldTransform = FTransform::Identity;
+	// Sockets of one slot type on one mesh
+	struct FSlotTable
+	{
+		TArray<FName> Names;
 
-	if (!Actor)
-		return;
+		// Component space socket locations, only filled in when the sockets can't move relative to the component (static meshes)
+		TArray<float> X;
+		TArray<float> Y;
+		TArray<float> Z;
+		bool bHasLocations;
 
-	MaxRange = FMath::Square(MaxRange);
+		FSlotTable() :
+			bHasLocations(false)
+		{}
+	};
 
-	if (USceneComponent *rootComp = Actor->GetRootComponent())
+	struct FMeshSlots
+	{
+		// Hash of the sockets the tables were built with, the tables are rebuilt if a socket gets added, removed, renamed or moved
+		uint32 SocketHash;
+
+		// Frame the hash was last checked on, lookups in the same frame trust the tables without walking the sockets again
+		uint64 SocketHashFrame;
+
+		TMap<FName, FSlotTable> SlotTypes;
+
+		FMeshSlots() :
+			SocketHash(0),
+			SocketHashFrame(0)
+		{}
+	};
+
+	static TMap<FObjectKey, FMeshSlots> MeshSlots;
+	static FDelegateHandle OnWorldCleanupHandle;
+
+	// Only what ends up in the tables is hashed, the socket names and where they sit on the mesh
+	static uint32 HashSocket(uint32 Hash, FName SocketName, FName BoneName, const FVector & RelativeLocation)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(SocketName));
+		Hash = HashCombine(Hash, GetTypeHash(BoneName));
+		return HashCombine(Hash, GetTypeHash(RelativeLocation));
+	}
+
+	// Returns the mesh that provides the sockets of the component, null if the component can't be cached
+	// Switching meshes on a component is caught by the mesh being the key, this is cheap enough to run on every lookup
+	static UObject * GetSocketSource(USceneComponent * Component, bool & bOutStaticLocations)
+	{
+		if (UStaticMeshComponent * StaticMeshComp = Cast<UStaticMeshComponent>(Component))
+		{
+			bOutStaticLocations = true;
+			return StaticMeshComp->GetStaticMesh();
+		}
+		else if (USkinnedMeshComponent * SkinnedComp = Cast<USkinnedMeshComponent>(Component))
+		{
+			// Bone sockets follow the animation, only the names can be cached
+			bOutStaticLocations = false;
+			return SkinnedComp->SkeletalMesh;
+		}
+
+		return nullptr;
+	}
+
+	// Hashes everything that GetAllSocketNames returns for the mesh, walks every socket (and bone), so only run once per frame and mesh
+	static uint32 GetSocketHash(UObject * SocketSource)
+	{
+		uint32 Hash = 0;
+
+		if (UStaticMesh * StaticMesh = Cast<UStaticMesh>(SocketSource))
+		{
+			for (const UStaticMeshSocket * Socket : StaticMesh->Sockets)
+			{
+				if (Socket)
+					Hash = HashSocket(Hash, Socket->SocketName, NAME_None, Socket->RelativeLocation);
+			}
+
+			return HashCombine(Hash, StaticMesh->Sockets.Num());
+		}
+		else if (USkeletalMesh * SkeletalMesh = Cast<USkeletalMesh>(SocketSource))
+		{
+			const TArray<USkeletalMeshSocket*> Sockets = SkeletalMesh->GetActiveSocketList();
+			for (const USkeletalMeshSocket * Socket : Sockets)
+			{
+				if (Socket)
+					Hash = HashSocket(Hash, Socket->SocketName, Socket->BoneName, Socket->RelativeLocation);
+			}
+
+			const int32 NumBones = SkeletalMesh->RefSkeleton.GetNum();
+			for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(SkeletalMesh->RefSkeleton.GetBoneName(BoneIndex)));
+			}
+
+			return HashCombine(Hash, Sockets.Num() + NumBones);
+		}
+
+		return Hash;
+	}
+
+	// Gets the sockets of the slot type for the components mesh, building them the first time the mesh is asked for the type
+	static const FSlotTable * FindSlotTable(USceneComponent * Component, FName SlotType)
 	{
-		FVector RelativeWorldLocation = rootComp->GetComponentTransform().InverseTransformPosition(WorldLocation);
+		bool bStaticLocations = false;
+		UObject * SocketSource = GetSocketSource(Component, bStaticLocations);
+
+		if (!SocketSource)
+			return nullptr;
+
+		// Meshes get unloaded with their levels, drop everything when a world goes away instead of keeping entries for dead meshes around
+		if (!OnWorldCleanupHandle.IsValid())
+		{
+			OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([](UWorld * World, bool bSessionEnded, bool bCleanupResources)
+			{
+				MeshSlots.Empty();
+			});
+		}
+
+		FMeshSlots * Mesh = MeshSlots.Find(FObjectKey(SocketSource));
+		if (!Mesh)
+		{
+			Mesh = &MeshSlots.Add(FObjectKey(SocketSource));
+			Mesh->SocketHash = GetSocketHash(SocketSource);
+			Mesh->SocketHashFrame = GFrameCounter;
+		}
+		else if (Mesh->SocketHashFrame != GFrameCounter)
+		{
+			// Sockets only change through edits or the rare runtime add, checking once a frame keeps every other lookup free of the walk
+			Mesh->SocketHashFrame = GFrameCounter;
+
+			const uint32 SocketHash = GetSocketHash(SocketSource);
+			if (Mesh->SocketHash != SocketHash)
+			{
+				Mesh->SlotTypes.Reset();
+				Mesh->SocketHash = SocketHash;
+			}
+		}
+
+		if (const FSlotTable * ExistingTable = Mesh->SlotTypes.Find(SlotType))
+			return ExistingTable;
+
+		FSlotTable & Table = Mesh->SlotTypes.Add(SlotType);
+		Table.bHasLocations = bStaticLocations;
+
+		const FString GripIdentifier = SlotType.ToString();
+		for (const FName & SocketName : Component->GetAllSocketNames())
+		{
+			if (!SocketName.ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
+				continue;
+
+			Table.Names.Add(SocketName);
+
+			if (bStaticLocations)
+			{
+				const FVector SocketLocation = Component->GetSocketTransform(SocketName, ERelativeTransformSpace::RTS_Component).GetLocation();
+				Table.X.Add(SocketLocation.X);
+				Table.Y.Add(SocketLocation.Y);
+				Table.Z.Add(SocketLocation.Z);
+			}
+		}
+
+		return &Table;
+	}
+
+	// Original string scan, used for components without a mesh that we can cache
+	static void FindClosestSlotUncached(FName SlotType, USceneComponent * Component, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform)
+	{
+		FVector RelativeWorldLocation = Component->GetComponentTransform().InverseTransformPosition(WorldLocation);
+		MaxRange = FMath::Square(MaxRange);
+
 		float ClosestSlotDistance = -0.1f;
 
-		TArray<FName> SocketNames = rootComp->GetAllSocketNames();
+		TArray<FName> SocketNames = Component->GetAllSocketNames();
 
 		FString GripIdentifier = SlotType.ToString();
 
@@ -62,8 +229,7 @@ void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName(FName SlotType, A
 		{
 			if (SocketNames[i].ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
 			{
-			
-				float vecLen = FVector::DistSquared(RelativeWorldLocation, rootComp->GetSocketTransform(SocketNames[i], ERelativeTransformSpace::RTS_Component).GetLocation());
+				float vecLen = FVector::DistSquared(RelativeWorldLocation, Component->GetSocketTransform(SocketNames[i], ERelativeTransformSpace::RTS_Component).GetLocation());
 
 				if (MaxRange >= vecLen && (ClosestSlotDistance < 0.0f || vecLen < ClosestSlotDistance))
 				{
@@ -76,12 +242,73 @@ void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName(FName SlotType, A
 
 		if (bHadSlotInRange)
 		{
-			SlotWorldTransform = rootComp->GetSocketTransform(SocketNames[foundIndex]);
+			SlotWorldTransform = Component->GetSocketTransform(SocketNames[foundIndex]);
+			SlotWorldTransform.SetScale3D(FVector(1.0f));
+		}
+	}
+
+	static void FindClosestSlot(FName SlotType, USceneComponent * Component, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform)
+	{
+		const FSlotTable * Table = FindSlotTable(Component, SlotType);
+
+		if (!Table)
+		{
+			FindClosestSlotUncached(SlotType, Component, WorldLocation, MaxRange, bHadSlotInRange, SlotWorldTransform);
+			return;
+		}
+
+		const FVector RelativeWorldLocation = Component->GetComponentTransform().InverseTransformPosition(WorldLocation);
+		const float MaxRangeSquared = FMath::Square(MaxRange);
+
+		float ClosestSlotDistance = -0.1f;
+		int32 FoundIndex = INDEX_NONE;
+
+		for (int32 i = 0; i < Table->Names.Num(); ++i)
+		{
+			float DistSquared;
+
+			if (Table->bHasLocations)
+			{
+				const float DX = Table->X[i] - RelativeWorldLocation.X;
+				const float DY = Table->Y[i] - RelativeWorldLocation.Y;
+				const float DZ = Table->Z[i] - RelativeWorldLocation.Z;
+				DistSquared = DX * DX + DY * DY + DZ * DZ;
+			}
+			else
+			{
+				DistSquared = FVector::DistSquared(RelativeWorldLocation, Component->GetSocketTransform(Table->Names[i], ERelativeTransformSpace::RTS_Component).GetLocation());
+			}
+
+			if (MaxRangeSquared >= DistSquared && (ClosestSlotDistance < 0.0f || DistSquared < ClosestSlotDistance))
+			{
+				ClosestSlotDistance = DistSquared;
+				FoundIndex = i;
+			}
+		}
+
+		if (FoundIndex != INDEX_NONE)
+		{
+			bHadSlotInRange = true;
+			SlotWorldTransform = Component->GetSocketTransform(Table->Names[FoundIndex]);
 			SlotWorldTransform.SetScale3D(FVector(1.0f));
 		}
 	}
 }
 
+void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName(FName SlotType, AActor * Actor, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform)
+{
+	bHadSlotInRange = false;
+	SlotWorldTransform = FTransform::Identity;
+
+	if (!Actor)
+		return;
+
+	if (USceneComponent *rootComp = Actor->GetRootComponent())
+	{
+		VRGripSlotCache::FindClosestSlot(SlotType, rootComp, WorldLocation, MaxRange, bHadSlotInRange, SlotWorldTransform);
+	}
+}
+
 void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName_Component(FName SlotType, UPrimitiveComponent * Component, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform)
 {
 	bHadSlotInRange = false;
@@ -90,38 +317,146 @@ void UVRExpansionFunctionLibrary::GetGripSlotInRangeByTypeName_Component(FName S
 	if (!Component)
 		return;
 
-	FVector RelativeWorldLocation = Component->GetComponentTransform().InverseTransformPosition(WorldLocation);
-	MaxRange = FMath::Square(MaxRange);
+	VRGripSlotCache::FindClosestSlot(SlotType, Component, WorldLocation, MaxRange, bHadSlotInRange, SlotWorldTransform);
+}
 
-	float ClosestSlotDistance = -0.1f;
+void UVRExpansionFunctionLibrary::FindGrippablesNearLocation(UObject * WorldContextObject, FVector WorldLocation, float Radius, int32 MaxResults, bool bIncludeHeld, TArray<FGrippableQueryCandidate> & Candidates)
+{
+	Candidates.Reset();
 
-	TArray<FName> SocketNames = Component->GetAllSocketNames();
+	UWorld * World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(World, false);
 
-	FString GripIdentifier = SlotType.ToString();
+	if (!SpatialIndex)
+		return;
 
-	int foundIndex = 0;
+	TArray<FGrippableQuery> Queries;
+	Queries.Add(FGrippableQuery(WorldLocation, Radius, MaxResults, bIncludeHeld));
+
+	TArray<TArray<FGrippableQueryCandidate>> Results;
+	SpatialIndex->QueryNearest(Queries, Results);
+	Candidates = MoveTemp(Results[0]);
+}
 
-	for (int i = 0; i < SocketNames.Num(); ++i)
+void UVRExpansionFunctionLibrary::FindGrippablesNearPlayerHands(UObject * WorldContextObject, float Radius, int32 MaxResults, bool bIncludeHeld, TArray<FGrippableHandCandidates> & Hands)
+{
+	Hands.Reset();
+
+	UWorld * World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(World, false))
 	{
-		if (SocketNames[i].ToString().Contains(GripIdentifier, ESearchCase::IgnoreCase, ESearchDir::FromStart))
-		{
-			float vecLen = FVector::DistSquared(RelativeWorldLocation, Component->GetSocketTransform(SocketNames[i], ERelativeTransformSpace::RTS_Component).GetLocation());
+		SpatialIndex->QueryPlayerHands(Radius, MaxResults, bIncludeHeld, Hands);
+	}
+}
 
-			if (MaxRange >= vecLen && (ClosestSlotDistance < 0.0f || vecLen < ClosestSlotDistance))
-			{
-				ClosestSlotDistance = vecLen;
-				bHadSlotInRange = true;
-				foundIndex = i;
-			}
-		}
+void UVRExpansionFunctionLibrary::RegisterGrippableForQueries(UObject * Grippable, USceneComponent * TrackedComponent)
+{
+	if (!Grippable || !TrackedComponent)
+		return;
+
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(TrackedComponent->GetWorld()))
+	{
+		SpatialIndex->Register(Grippable, TrackedComponent);
 	}
+}
 
-	if (bHadSlotInRange)
+void UVRExpansionFunctionLibrary::UnregisterGrippableForQueries(UObject * Grippable)
+{
+	if (!Grippable)
+		return;
+
+	if (FGrippableSpatialIndex * SpatialIndex = FGrippableSpatialIndex::Get(Grippable->GetWorld(), false))
 	{
-		SlotWorldTransform = Component->GetSocketTransform(SocketNames[foundIndex]);
-		SlotWorldTransform.SetScale3D(FVector(1.0f));
+		SpatialIndex->Unregister(Grippable);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace VRGripSlotBenchmark
+{
+	// Builds a transient static mesh with a mix of grip slot and other sockets, then times the cached lookup against the string scan
+	// and checks that both find the same slots
+	static void RunBenchmark(const TArray<FString> & Args)
+	{
+		const int32 NumSockets = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 48;
+		const int32 NumQueries = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100000;
+		const float SlotRange = 20.0f;
+		const FName SlotTypes[] = { FName(TEXT("VRGripP")), FName(TEXT("VRGripS")) };
+
+		FRandomStream Stream(0x5107);
+
+		UStaticMesh * Mesh = NewObject<UStaticMesh>(GetTransientPackage());
+		for (int32 i = 0; i < NumSockets; ++i)
+		{
+			UStaticMeshSocket * Socket = NewObject<UStaticMeshSocket>(Mesh);
+
+			// Half primary slots, a quarter secondary slots and the rest attachment points
+			const TCHAR * Prefix = (i % 4) < 2 ? TEXT("VRGripP") : ((i % 4) == 2 ? TEXT("VRGripS") : TEXT("Attach"));
+			Socket->SocketName = FName(*FString::Printf(TEXT("%s_%d"), Prefix, i));
+			Socket->RelativeLocation = Stream.GetUnitVector() * Stream.FRandRange(0.0f, 60.0f);
+			Socket->RelativeRotation = FRotator(Stream.FRandRange(-180.0f, 180.0f), Stream.FRandRange(-180.0f, 180.0f), 0.0f);
+			Mesh->Sockets.Add(Socket);
+		}
+
+		UStaticMeshComponent * Component = NewObject<UStaticMeshComponent>(GetTransientPackage());
+		Component->SetStaticMesh(Mesh);
+		Component->SetWorldTransform(FTransform(FRotator(0.0f, 30.0f, 10.0f), FVector(100.0f, -50.0f, 25.0f)));
+
+		TArray<FVector> QueryLocations;
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			QueryLocations.Add(Component->GetComponentTransform().TransformPosition(Stream.GetUnitVector() * Stream.FRandRange(0.0f, 70.0f)));
+		}
+
+		// First lookup builds the tables, keep it out of the timing
+		bool bHadSlot = false;
+		FTransform SlotTransform;
+		VRGripSlotCache::FindClosestSlot(SlotTypes[0], Component, FVector::ZeroVector, SlotRange, bHadSlot, SlotTransform);
+		VRGripSlotCache::FindClosestSlot(SlotTypes[1], Component, FVector::ZeroVector, SlotRange, bHadSlot, SlotTransform);
+
+		double CachedTime = 0.0;
+		double UncachedTime = 0.0;
+		int32 Found = 0;
+		int32 Mismatches = 0;
+
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			const FName SlotType = SlotTypes[i & 1];
+
+			bool bCachedHadSlot = false;
+			FTransform CachedTransform = FTransform::Identity;
+			double StartTime = FPlatformTime::Seconds();
+			VRGripSlotCache::FindClosestSlot(SlotType, Component, QueryLocations[i], SlotRange, bCachedHadSlot, CachedTransform);
+			CachedTime += FPlatformTime::Seconds() - StartTime;
+
+			bool bUncachedHadSlot = false;
+			FTransform UncachedTransform = FTransform::Identity;
+			StartTime = FPlatformTime::Seconds();
+			VRGripSlotCache::FindClosestSlotUncached(SlotType, Component, QueryLocations[i], SlotRange, bUncachedHadSlot, UncachedTransform);
+			UncachedTime += FPlatformTime::Seconds() - StartTime;
+
+			if (bCachedHadSlot != bUncachedHadSlot || (bCachedHadSlot && !CachedTransform.Equals(UncachedTransform)))
+				++Mismatches;
+
+			if (bCachedHadSlot)
+				++Found;
+		}
+
+		UE_LOG(VRExpansionFunctionLibraryLog, Log, TEXT("Grip slot benchmark: %d sockets, %d queries (%d in range), cached %.3fus, string scan %.3fus per query, %d mismatches"),
+			NumSockets, NumQueries, Found, CachedTime * 1000000.0 / NumQueries, UncachedTime * 1000000.0 / NumQueries, Mismatches);
+
+		VRGripSlotCache::MeshSlots.Remove(FObjectKey(Mesh));
+		Component->MarkPendingKill();
+		Mesh->MarkPendingKill();
 	}
+
+	static FAutoConsoleCommandWithArgs BenchmarkCommand(
+		TEXT("vr.GripSlots.Benchmark"),
+		TEXT("Times the cached grip slot lookup against scanning the socket names and checks that they agree.\n")
+		TEXT("Usage: vr.GripSlots.Benchmark [Sockets=48] [Queries=100000]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
 }
+#endif
 
 FRotator UVRExpansionFunctionLibrary::GetHMDPureYaw(FRotator HMDRotation)
 {
@@ -1,7 +1,13 @@
 #include "VRGestureComponent.h"
 #include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/Package.h"
+#include "Async/ParallelFor.h"
+
+DEFINE_LOG_CATEGORY(LogVRGestures);
 
 DECLARE_CYCLE_STAT(TEXT("TickGesture ~ TickingGesture"), STAT_TickGesture, STATGROUP_TickGesture);
+DECLARE_CYCLE_STAT(TEXT("TickGesture ~ RecognizeGesture"), STAT_RecognizeGesture, STATGROUP_TickGesture);
 
 UVRGestureComponent::UVRGestureComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -18,6 +24,32 @@ UVRGestureComponent::UVRGestureComponent(const FObjectInitializer& ObjectInitial
 	MirroringHand = EVRGestureMirrorMode::GES_NoMirror;
 	bDrawSplinesCurved = true;
 	bGetGestureInWorldSpace = true;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		bPreparedInputValid[i] = false;
+	}
+
+	TemplateCacheDB = nullptr;
+	bTemplateCacheDirty = true;
+	LastDTWEvaluatedCount = 0;
+	LastDTWPrunedCount = 0;
+
+	bIncrementalRecognition = false;
+	IncrementalRescaleTolerance = 0.05f;
+
+	bAsyncRecognition = false;
+	AsyncRecognitionMaxBatches = 0;
+	AsyncRecognitionDB = nullptr;
+	AsyncGestureIndex = -1;
+	AsyncGestureDistance = MAX_FLT;
+	bAsyncResultPending = false;
+	StreamingDB = nullptr;
+	StreamingMirroringHand = EVRGestureMirrorMode::GES_NoMirror;
+	StreamingScaler = 1.f;
+	StreamingSamplesAdded = 0;
+	StreamingSamplesProcessed = 0;
+	bStreamingNeedsRebuild = true;
 }
 
 void UGesturesDatabase::FillSplineWithGesture(FVRGesture &Gesture, USplineComponent * SplineComponent, bool bCenterPointsOnSpline, bool bScaleToBounds, float OptionalBounds, bool bUseCurvedPoints, bool bFillInSplineMeshComponents, UStaticMesh * Mesh, UMaterial * MeshMat)
@@ -143,7 +175,9 @@ void UVRGestureComponent::BeginRecording(bool bRunDetection, bool bFlattenGestur
 	}
 
 	// Reset does the reserve already
+	CancelAsyncRecognition();
 	GestureLog.Samples.Reset(RecordingBufferSize);
+	bStreamingNeedsRebuild = true;
 
 	CurrentState = bRunDetection ? EVRGestureState::GES_Detecting : EVRGestureState::GES_Recording;
 
@@ -183,21 +217,8 @@ void UVRGestureComponent::CaptureGestureFrame()
 	// Add in newest sample at beginning (reverse order)
 	if (NewSample != FVector::ZeroVector && (GestureLog.Samples.Num() < 1 || !GestureLog.Samples[0].Equals(NewSample, SameSampleTolerance)))
 	{
-		bool bClearLatestSpline = false;
-		// Pop off oldest sample
-		if (GestureLog.Samples.Num() >= RecordingBufferSize)
-		{
-			GestureLog.Samples.Pop(false);
-			bClearLatestSpline = true;
-		}
-		
-		GestureLog.GestureSize.Max.X = FMath::Max(NewSample.X, GestureLog.GestureSize.Max.X);
-		GestureLog.GestureSize.Max.Y = FMath::Max(NewSample.Y, GestureLog.GestureSize.Max.Y);
-		GestureLog.GestureSize.Max.Z = FMath::Max(NewSample.Z, GestureLog.GestureSize.Max.Z);
-
-		GestureLog.GestureSize.Min.X = FMath::Min(NewSample.X, GestureLog.GestureSize.Min.X);
-		GestureLog.GestureSize.Min.Y = FMath::Min(NewSample.Y, GestureLog.GestureSize.Min.Y);
-		GestureLog.GestureSize.Min.Z = FMath::Min(NewSample.Z, GestureLog.GestureSize.Min.Z);
+		// The oldest sample gets popped off in AddSampleToGestureLog
+		bool bClearLatestSpline = GestureLog.Samples.Num() >= RecordingBufferSize;
 
 
 		if (bDrawRecordingGesture && bDrawRecordingGestureAsSpline && SplineMesh != nullptr && SplineMaterial != nullptr)
@@ -277,9 +298,29 @@ void UVRGestureComponent::CaptureGestureFrame()
 		
 		}
 
-		GestureLog.Samples.Insert(NewSample, 0);
-		bGestureChanged = true;
+		AddSampleToGestureLog(NewSample);
+	}
+}
+
+void UVRGestureComponent::AddSampleToGestureLog(const FVector & NewSample)
+{
+	// Pop off oldest sample
+	if (GestureLog.Samples.Num() >= RecordingBufferSize)
+	{
+		GestureLog.Samples.Pop(false);
 	}
+
+	GestureLog.GestureSize.Max.X = FMath::Max(NewSample.X, GestureLog.GestureSize.Max.X);
+	GestureLog.GestureSize.Max.Y = FMath::Max(NewSample.Y, GestureLog.GestureSize.Max.Y);
+	GestureLog.GestureSize.Max.Z = FMath::Max(NewSample.Z, GestureLog.GestureSize.Max.Z);
+
+	GestureLog.GestureSize.Min.X = FMath::Min(NewSample.X, GestureLog.GestureSize.Min.X);
+	GestureLog.GestureSize.Min.Y = FMath::Min(NewSample.Y, GestureLog.GestureSize.Min.Y);
+	GestureLog.GestureSize.Min.Z = FMath::Min(NewSample.Z, GestureLog.GestureSize.Min.Z);
+
+	GestureLog.Samples.Insert(NewSample, 0);
+	bGestureChanged = true;
+	++StreamingSamplesAdded;
 }
 
 void UVRGestureComponent::TickGesture()
@@ -290,8 +331,18 @@ void UVRGestureComponent::TickGesture()
 	{
 	case EVRGestureState::GES_Detecting:
 	{
-		CaptureGestureFrame();
-		RecognizeGesture(GestureLog);
+		if (bAsyncRecognition && !bIncrementalRecognition)
+		{
+			// Last ticks result first, a detection clears the recording before the new sample goes in
+			ApplyAsyncRecognition();
+			CaptureGestureFrame();
+			DispatchAsyncRecognition(GestureLog);
+		}
+		else
+		{
+			CaptureGestureFrame();
+			RecognizeGesture(GestureLog);
+		}
 		bGestureChanged = false;
 	}break;
 
@@ -315,80 +366,457 @@ void UVRGestureComponent::TickGesture()
 	}
 }
 
-void UVRGestureComponent::RecognizeGesture(FVRGesture inputGesture)
+void UVRGestureComponent::RecognizeGesture(const FVRGesture & inputGesture)
 {
 	if (!GesturesDB || inputGesture.Samples.Num() < 1 || !bGestureChanged)
 		return;
 
 	float minDist = MAX_FLT;
+	int OutGestureIndex = bIncrementalRecognition ? FindBestGestureIncremental(inputGesture, minDist) : FindBestGesture(inputGesture, minDist);
 
-	int OutGestureIndex = -1;
-	bool bMirrorGesture = false;
+	if (/*minDist < FMath::Square(globalThreshold) && */OutGestureIndex != -1)
+	{
+		BroadcastGestureDetected(OutGestureIndex);
+	}
+}
+
+void UVRGestureComponent::BroadcastGestureDetected(int GestureIndex)
+{
+	OnGestureDetected(GesturesDB->Gestures[GestureIndex].GestureType, /*minDist,*/ GesturesDB->Gestures[GestureIndex].Name, GestureIndex, GesturesDB);
+	OnGestureDetected_Bind.Broadcast(GesturesDB->Gestures[GestureIndex].GestureType, /*minDist,*/ GesturesDB->Gestures[GestureIndex].Name, GestureIndex, GesturesDB);
+	ClearRecording(); // Clear the recording out, we don't want to detect this gesture again with the same data
+	RecordingGestureDraw.Reset();
+}
+
+int UVRGestureComponent::FindBestGesture(const FVRGesture & inputGesture, float & OutDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RecognizeGesture);
+
+	// The pass shares the prepared input and the template cache with the async task
+	WaitForAsyncRecognition();
+
+	OutDistance = MAX_FLT;
+
+	if (!GesturesDB || inputGesture.Samples.Num() < 1)
+		return -1;
+
+	const float Scaler = PrepareRecognitionPass(inputGesture);
+
+	LastDTWEvaluatedCount = 0;
+	LastDTWPrunedCount = 0;
+	return FindBestGestureInRange(0, TemplateCache.Num(), inputGesture.Samples.Num(), Scaler, DTWScratch, OutDistance, LastDTWEvaluatedCount, LastDTWPrunedCount);
+}
 
+float UVRGestureComponent::PrepareRecognitionPass(const FVRGesture & inputGesture)
+{
 	FVector Size = inputGesture.GestureSize.GetSize();
 	float Scaler = GesturesDB->TargetGestureScale / Size.GetMax();
-	float FinalScaler = Scaler;
 
-	for (int i = 0; i < GesturesDB->Gestures.Num(); i++)
+	// New input, the prepared copies are from the last pass
+	for (int i = 0; i < 4; ++i)
 	{
-		FVRGesture &exampleGesture = GesturesDB->Gestures[i];
+		bPreparedInputValid[i] = false;
+	}
+
+	// Built up front instead of as gestures need them so the pass doesn't write to the component
+	for (int Mirror = 0; Mirror < 2; ++Mirror)
+	{
+		GetPreparedInput(inputGesture, Scaler, Mirror != 0);
+		GetPreparedInput(inputGesture, 1.f, Mirror != 0);
+	}
+
+	RefreshTemplateCache();
+	return Scaler;
+}
+
+int UVRGestureComponent::FindBestGestureInRange(int StartIndex, int EndIndex, int InputSampleCount, float Scaler, FVRGestureDTWScratch & Scratch, float & OutDistance, int & OutDTWEvaluatedCount, int & OutDTWPrunedCount) const
+{
+	float minDist = MAX_FLT;
+	int OutGestureIndex = -1;
 
-		if (!exampleGesture.GestureSettings.bEnabled || exampleGesture.Samples.Num() < 1 || inputGesture.Samples.Num() < exampleGesture.GestureSettings.Minimum_Gesture_Length)
+	for (int i = StartIndex; i < EndIndex; i++)
+	{
+		const FVRGestureTemplateCache & Template = TemplateCache[i];
+		const FVRGestureSettings & Settings = Template.Settings;
+
+		if (!Settings.bEnabled || Template.SampleCount < 1 || InputSampleCount < Settings.Minimum_Gesture_Length)
 			continue;
 
-		FinalScaler = exampleGesture.GestureSettings.bEnableScaling ? Scaler : 1.f;
+		const float FinalScaler = Settings.bEnableScaling ? Scaler : 1.f;
 
-		bMirrorGesture = (MirroringHand != EVRGestureMirrorMode::GES_NoMirror && MirroringHand != EVRGestureMirrorMode::GES_MirrorBoth && MirroringHand == exampleGesture.GestureSettings.MirrorMode);
+		// Mirroring the input instead of the template gives the same distances
+		int PreparedIndex = GetPreparedInputIndex(FinalScaler, UsesMirroredInput(Settings));
 
-		if (GetGestureDistance(inputGesture.Samples[0] * FinalScaler, exampleGesture.Samples[0], bMirrorGesture) < FMath::Square(exampleGesture.GestureSettings.firstThreshold))
+		if (FVector::DistSquared(PreparedInputSamples[PreparedIndex][0], Template.GetSample(0)) >= FMath::Square(Settings.firstThreshold))
 		{
-			float d = dtw(inputGesture, exampleGesture, bMirrorGesture, FinalScaler) / (exampleGesture.Samples.Num());
-			if (d < minDist && d < FMath::Square(exampleGesture.GestureSettings.FullThreshold))
-			{
-				minDist = d;
-				OutGestureIndex = i;
-			}
+			if (Settings.MirrorMode != EVRGestureMirrorMode::GES_MirrorBoth)
+				continue;
+
+			PreparedIndex = GetPreparedInputIndex(FinalScaler, true);
+
+			if (FVector::DistSquared(PreparedInputSamples[PreparedIndex][0], Template.GetSample(0)) >= FMath::Square(Settings.firstThreshold))
+				continue;
 		}
-		else if (exampleGesture.GestureSettings.MirrorMode == EVRGestureMirrorMode::GES_MirrorBoth)
+
+		// Anything at or over either of these gets thrown out, so the DTW can stop as soon as it can't get below them
+		const float RejectDistance = FMath::Min(minDist, FMath::Square(Settings.FullThreshold));
+
+		if (ExceedsLowerBound(PreparedInputPrefixBounds[PreparedIndex], Template, RejectDistance))
 		{
-			bMirrorGesture = true;
-			if (GetGestureDistance(inputGesture.Samples[0] * FinalScaler, exampleGesture.Samples[0], bMirrorGesture) < FMath::Square(exampleGesture.GestureSettings.firstThreshold))
-			{
-				float d = dtw(inputGesture, exampleGesture, bMirrorGesture, FinalScaler) / (exampleGesture.Samples.Num());
-				if (d < minDist && d < FMath::Square(exampleGesture.GestureSettings.FullThreshold))
-				{
-					minDist = d;
-					OutGestureIndex = i;
-				}
-			}
+			++OutDTWPrunedCount;
+			continue;
 		}
 
-		/*if (exampleGesture.MirrorMode == EVRGestureMirrorMode::GES_MirrorBoth)
+		++OutDTWEvaluatedCount;
+		float d = DTWTwoRow(PreparedInputSamples[PreparedIndex], Template, Scratch, RejectDistance) / (Template.SampleCount);
+		if (d < minDist && d < FMath::Square(Settings.FullThreshold))
 		{
-			bMirrorGesture = true;
+			minDist = d;
+			OutGestureIndex = i;
+		}
+	}
 
-			if (GetGestureDistance(inputGesture.Samples[0], exampleGesture.Samples[0], bMirrorGesture) < FMath::Square(exampleGesture.GestureSettings.firstThreshold))
-			{
-				float d = dtw(inputGesture, exampleGesture, bMirrorGesture) / (exampleGesture.Samples.Num());
-				if (d < minDist && d < FMath::Square(exampleGesture.GestureSettings.FullThreshold))
-				{
-					minDist = d;
-					OutGestureIndex = i;
-				}
-			}
-		}*/
+	OutDistance = minDist;
+	return OutGestureIndex;
+}
+
+int UVRGestureComponent::FindBestGestureParallel(const FVRGesture & inputGesture, float & OutDistance, int MaxBatches)
+{
+	WaitForAsyncRecognition();
+
+	OutDistance = MAX_FLT;
+
+	if (!GesturesDB || inputGesture.Samples.Num() < 1)
+		return -1;
+
+	const float Scaler = PrepareRecognitionPass(inputGesture);
+	return FindBestGestureInBatches(inputGesture.Samples.Num(), Scaler, MaxBatches, OutDistance);
+}
+
+int UVRGestureComponent::FindBestGestureInBatches(int InputSampleCount, float Scaler, int MaxBatches, float & OutDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RecognizeGesture);
+
+	const int GestureCount = TemplateCache.Num();
+	const int BatchCount = FMath::Clamp(MaxBatches > 0 ? MaxBatches : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, FMath::Max(GestureCount, 1));
+	const int BatchSize = FMath::DivideAndRoundUp(GestureCount, BatchCount);
+
+	RecognitionBatches.SetNum(BatchCount, false);
+
+	// Each batch prunes against its own best match only, so contiguous slices (rather than interleaved) keep the batches
+	// close to the serial pruning when similar gestures are next to each other in the database
+	ParallelFor(BatchCount, [&](int32 BatchIndex)
+	{
+		FVRGestureRecognitionBatch & Batch = RecognitionBatches[BatchIndex];
+		const int StartIndex = FMath::Min(BatchIndex * BatchSize, GestureCount);
+
+		Batch.DTWEvaluatedCount = 0;
+		Batch.DTWPrunedCount = 0;
+		Batch.GestureIndex = FindBestGestureInRange(StartIndex, FMath::Min(StartIndex + BatchSize, GestureCount), InputSampleCount, Scaler, Batch.Scratch, Batch.Distance, Batch.DTWEvaluatedCount, Batch.DTWPrunedCount);
+	}, BatchCount == 1);
+
+	// Batches are in database order and only replaced on a strictly lower distance, same as the serial loop
+	int OutGestureIndex = -1;
+	OutDistance = MAX_FLT;
+	LastDTWEvaluatedCount = 0;
+	LastDTWPrunedCount = 0;
+
+	for (const FVRGestureRecognitionBatch & Batch : RecognitionBatches)
+	{
+		if (Batch.GestureIndex != -1 && Batch.Distance < OutDistance)
+		{
+			OutDistance = Batch.Distance;
+			OutGestureIndex = Batch.GestureIndex;
+		}
+
+		LastDTWEvaluatedCount += Batch.DTWEvaluatedCount;
+		LastDTWPrunedCount += Batch.DTWPrunedCount;
 	}
 
-	if (/*minDist < FMath::Square(globalThreshold) && */OutGestureIndex != -1)
+	return OutGestureIndex;
+}
+
+void UVRGestureComponent::DispatchAsyncRecognition(const FVRGesture & inputGesture)
+{
+	WaitForAsyncRecognition();
+
+	if (!GesturesDB || inputGesture.Samples.Num() < 1 || !bGestureChanged)
+		return;
+
+	// Everything the task needs is copied out here, the database and the recording can change while it runs
+	const float Scaler = PrepareRecognitionPass(inputGesture);
+	const int InputSampleCount = inputGesture.Samples.Num();
+	const int MaxBatches = AsyncRecognitionMaxBatches;
+
+	AsyncRecognitionDB = GesturesDB;
+	AsyncGestureIndex = -1;
+	AsyncGestureDistance = MAX_FLT;
+	bAsyncResultPending = true;
+
+	AsyncRecognitionTask = FFunctionGraphTask::CreateAndDispatchWhenReady([this, InputSampleCount, Scaler, MaxBatches]()
+	{
+		AsyncGestureIndex = FindBestGestureInBatches(InputSampleCount, Scaler, MaxBatches, AsyncGestureDistance);
+	}, TStatId(), nullptr, ENamedThreads::AnyThread);
+}
+
+void UVRGestureComponent::WaitForAsyncRecognition()
+{
+	if (AsyncRecognitionTask.IsValid())
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(AsyncRecognitionTask, ENamedThreads::GameThread);
+		AsyncRecognitionTask = nullptr;
+	}
+}
+
+void UVRGestureComponent::ApplyAsyncRecognition()
+{
+	WaitForAsyncRecognition();
+
+	if (!bAsyncResultPending)
+		return;
+
+	bAsyncResultPending = false;
+
+	// The indices are only valid for the database the task ran against
+	if (AsyncGestureIndex != -1 && GesturesDB && GesturesDB == AsyncRecognitionDB && GesturesDB->Gestures.IsValidIndex(AsyncGestureIndex))
+	{
+		BroadcastGestureDetected(AsyncGestureIndex);
+	}
+}
+
+void UVRGestureComponent::CancelAsyncRecognition()
+{
+	WaitForAsyncRecognition();
+	bAsyncResultPending = false;
+}
+
+const TArray<FVector> & UVRGestureComponent::GetPreparedInput(const FVRGesture & inputGesture, float Scaler, bool bMirrorGesture)
+{
+	const int Index = GetPreparedInputIndex(Scaler, bMirrorGesture);
+	TArray<FVector> & Prepared = PreparedInputSamples[Index];
+	TArray<FBox> & PrefixBounds = PreparedInputPrefixBounds[Index];
+
+	if (!bPreparedInputValid[Index])
+	{
+		const int SampleCount = inputGesture.Samples.Num();
+		Prepared.SetNumUninitialized(SampleCount, false);
+		PrefixBounds.SetNumUninitialized(SampleCount, false);
+
+		FBox Bounds(ForceInit);
+		for (int i = 0; i < SampleCount; ++i)
+		{
+			Prepared[i] = inputGesture.Samples[i] * Scaler;
+
+			// Only mirroring on Y axis to flip Left/Right
+			if (bMirrorGesture)
+				Prepared[i].Y = -Prepared[i].Y;
+
+			Bounds += Prepared[i];
+			PrefixBounds[i] = Bounds;
+		}
+
+		bPreparedInputValid[Index] = true;
+	}
+
+	return Prepared;
+}
+
+bool UVRGestureComponent::ExceedsLowerBound(const TArray<FBox> & InputPrefixBounds, const FVRGestureTemplateCache & Template, float RejectDistance) const
+{
+	const int InputCount = InputPrefixBounds.Num();
+	const int TemplateCount = Template.SampleCount;
+
+	if (InputCount < 1 || TemplateCount < 1 || RejectDistance >= MAX_FLT)
+		return false;
+
+	// Small margin so that float summation order can never throw out a gesture that the DTW would have accepted
+	const float RejectCost = RejectDistance * TemplateCount * 1.0001f;
+
+	// Coarsest first, every template sample is at least as far from the whole input as the two envelopes are from each other
+	const FBox & InputBounds = InputPrefixBounds[InputCount - 1];
+	const FVector Gap = (Template.Bounds.Min - InputBounds.Max).ComponentMax(InputBounds.Min - Template.Bounds.Max).ComponentMax(FVector::ZeroVector);
+	if (Gap.SizeSquared() * TemplateCount >= RejectCost)
+		return true;
+
+	// Each step in the table advances the template, or the input at most maxSlope times in a row, so template sample j (from
+	// the end) can't be matched past input sample j * (maxSlope + 1)
+	const int InputStep = FMath::Max(maxSlope, 0) + 1;
+	float LowerBound = 0.f;
+
+	for (int j = 0; j < TemplateCount; ++j)
 	{
-		OnGestureDetected(GesturesDB->Gestures[OutGestureIndex].GestureType, /*minDist,*/ GesturesDB->Gestures[OutGestureIndex].Name, OutGestureIndex, GesturesDB);
-		OnGestureDetected_Bind.Broadcast(GesturesDB->Gestures[OutGestureIndex].GestureType, /*minDist,*/ GesturesDB->Gestures[OutGestureIndex].Name, OutGestureIndex, GesturesDB);
-		ClearRecording(); // Clear the recording out, we don't want to detect this gesture again with the same data
-		RecordingGestureDraw.Reset();
+		const FBox & Envelope = InputPrefixBounds[FMath::Min((j + 1) * InputStep, InputCount) - 1];
+		LowerBound += Envelope.ComputeSquaredDistanceToPoint(FVector(Template.X[j], Template.Y[j], Template.Z[j]));
+
+		if (LowerBound >= RejectCost)
+			return true;
 	}
+
+	return false;
 }
 
-float UVRGestureComponent::dtw(FVRGesture seq1, FVRGesture seq2, bool bMirrorGesture, float Scaler)
+void FVRGestureTemplateCache::Build(const FVRGesture & Gesture)
+{
+	SampleCount = Gesture.Samples.Num();
+	const int PaddedCount = Align(SampleCount, 4);
+
+	X.SetNumZeroed(PaddedCount, false);
+	Y.SetNumZeroed(PaddedCount, false);
+	Z.SetNumZeroed(PaddedCount, false);
+	Bounds.Init();
+	Settings = Gesture.GestureSettings;
+
+	for (int i = 0; i < SampleCount; ++i)
+	{
+		const FVector & Sample = Gesture.Samples[i];
+		X[i] = Sample.X;
+		Y[i] = Sample.Y;
+		Z[i] = Sample.Z;
+		Bounds += Sample;
+	}
+}
+
+void FVRGestureTemplateCache::GetDistances(const FVector & Sample, float * OutDistances) const
+{
+	const VectorRegister SampleX = VectorSetFloat1(Sample.X);
+	const VectorRegister SampleY = VectorSetFloat1(Sample.Y);
+	const VectorRegister SampleZ = VectorSetFloat1(Sample.Z);
+
+	const int PaddedCount = X.Num();
+	for (int j = 0; j < PaddedCount; j += 4)
+	{
+		const VectorRegister DeltaX = VectorSubtract(VectorLoad(&X[j]), SampleX);
+		const VectorRegister DeltaY = VectorSubtract(VectorLoad(&Y[j]), SampleY);
+		const VectorRegister DeltaZ = VectorSubtract(VectorLoad(&Z[j]), SampleZ);
+
+		// Separate multiplies and adds in the same order as FVector::DistSquared, a fused multiply add would round differently
+		const VectorRegister Distance = VectorAdd(VectorAdd(VectorMultiply(DeltaX, DeltaX), VectorMultiply(DeltaY, DeltaY)), VectorMultiply(DeltaZ, DeltaZ));
+		VectorStore(Distance, &OutDistances[j]);
+	}
+}
+
+void UVRGestureComponent::RefreshTemplateCache()
+{
+	const int GestureCount = GesturesDB ? GesturesDB->Gestures.Num() : 0;
+	bool bNeedsRebuild = bTemplateCacheDirty || TemplateCacheDB != GesturesDB || TemplateCache.Num() != GestureCount;
+
+	for (int i = 0; !bNeedsRebuild && i < GestureCount; ++i)
+	{
+		bNeedsRebuild = TemplateCache[i].SampleCount != GesturesDB->Gestures[i].Samples.Num();
+		TemplateCache[i].Settings = GesturesDB->Gestures[i].GestureSettings;
+	}
+
+	if (!bNeedsRebuild)
+		return;
+
+	TemplateCacheDB = GesturesDB;
+	bTemplateCacheDirty = false;
+	TemplateCache.SetNum(GestureCount, false);
+
+	for (int i = 0; i < GestureCount; ++i)
+	{
+		TemplateCache[i].Build(GesturesDB->Gestures[i]);
+	}
+}
+
+void UVRGestureComponent::InvalidateGestureCache()
+{
+	bTemplateCacheDirty = true;
+	bStreamingNeedsRebuild = true;
+}
+
+float UVRGestureComponent::DTWTwoRow(const TArray<FVector> & InputSamples, const FVRGestureTemplateCache & Template, float RejectDistance)
+{
+	return DTWTwoRow(InputSamples, Template, DTWScratch, RejectDistance);
+}
+
+float UVRGestureComponent::DTWTwoRow(const TArray<FVector> & InputSamples, const FVRGestureTemplateCache & Template, FVRGestureDTWScratch & Scratch, float RejectDistance) const
+{
+	const int RowCount = InputSamples.Num() + 1;
+	const int ColumnCount = Template.SampleCount + 1;
+	const int TemplateCount = Template.SampleCount;
+
+	if (TemplateCount < 1)
+		return FLT_MAX;
+
+	Scratch.CostRows.SetNumUninitialized(ColumnCount * 2, false);
+	Scratch.SlopeJRows.SetNumUninitialized(ColumnCount * 2, false);
+	Scratch.RowDistances.SetNumUninitialized(Template.GetPaddedCount(), false);
+
+	float * PrevCost = Scratch.CostRows.GetData();
+	float * CurCost = PrevCost + ColumnCount;
+	int * PrevSlopeJ = Scratch.SlopeJRows.GetData();
+	int * CurSlopeJ = PrevSlopeJ + ColumnCount;
+
+	// Row zero, only [0, 0] is reachable
+	PrevCost[0] = 0.f;
+	PrevSlopeJ[0] = 0;
+	for (int j = 1; j < ColumnCount; j++)
+	{
+		PrevCost[j] = MAX_FLT;
+		PrevSlopeJ[j] = 0;
+	}
+
+	float * RowDistances = Scratch.RowDistances.GetData();
+	float bestMatch = FLT_MAX;
+
+	for (int i = 1; i < RowCount; i++)
+	{
+		// The distances don't depend on the path, get the whole row at once
+		Template.GetDistances(InputSamples[i - 1], RowDistances);
+
+		CurCost[0] = MAX_FLT;
+		CurSlopeJ[0] = 0;
+
+		// Horizontal slope count of the cell to the left, the only one that is ever read
+		int LeftSlopeI = 0;
+		float RowMin = MAX_FLT;
+
+		for (int j = 1; j < ColumnCount; j++)
+		{
+			const float Left = CurCost[j - 1];
+			const float Diagonal = PrevCost[j - 1];
+			const float Up = PrevCost[j];
+			const float Distance = RowDistances[j - 1];
+
+			if (Left < Diagonal && Left < Up && LeftSlopeI < maxSlope)
+			{
+				CurCost[j] = Distance + Left;
+				LeftSlopeI = CurSlopeJ[j - 1] + 1;
+				CurSlopeJ[j] = 0;
+			}
+			else if (Up < Diagonal && Up < Left && PrevSlopeJ[j] < maxSlope)
+			{
+				CurCost[j] = Distance + Up;
+				LeftSlopeI = 0;
+				CurSlopeJ[j] = PrevSlopeJ[j] + 1;
+			}
+			else
+			{
+				CurCost[j] = Distance + Diagonal;
+				LeftSlopeI = 0;
+				CurSlopeJ[j] = 0;
+			}
+
+			RowMin = FMath::Min(RowMin, CurCost[j]);
+		}
+
+		// Find best between seq2 and an ending (postfix) of seq1.
+		if (CurCost[TemplateCount] < bestMatch)
+			bestMatch = CurCost[TemplateCount];
+
+		// Every path through the rest of the table passes through this row and distances are never negative
+		if (RowMin / TemplateCount >= RejectDistance)
+			return bestMatch;
+
+		Swap(PrevCost, CurCost);
+		Swap(PrevSlopeJ, CurSlopeJ);
+	}
+
+	return bestMatch;
+}
+
+float UVRGestureComponent::dtw(const FVRGesture & seq1, const FVRGesture & seq2, bool bMirrorGesture, float Scaler)
 {
 
 	// #TODO: Skip copying the array and reversing it in the future, we only ever use the reversed value.
@@ -466,6 +894,195 @@ float UVRGestureComponent::dtw(FVRGesture seq1, FVRGesture seq2, bool bMirrorGes
 	return bestMatch;
 }
 
+int UVRGestureComponent::FindBestGestureIncremental(const FVRGesture & inputGesture, float & OutDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RecognizeGesture);
+
+	// The pass shares the template cache with the async task
+	WaitForAsyncRecognition();
+
+	OutDistance = MAX_FLT;
+
+	if (!GesturesDB || inputGesture.Samples.Num() < 1)
+		return -1;
+
+	// Same scaler as PrepareRecognitionPass, without preparing copies of the whole buffer
+	const float Scaler = GesturesDB->TargetGestureScale / inputGesture.GestureSize.GetSize().GetMax();
+
+	// Nothing to scale by yet (a single point), run the full pass and leave the samples pending
+	if (!FMath::IsFinite(Scaler))
+		return FindBestGesture(inputGesture, OutDistance);
+
+	bool bNeedsRebuild = bStreamingNeedsRebuild || StreamingDB != GesturesDB || StreamingMirroringHand != MirroringHand ||
+		StreamingColumns.Num() != GesturesDB->Gestures.Num() * 2 ||
+		StreamingSamplesAdded - StreamingSamplesProcessed > inputGesture.Samples.Num() ||
+		FMath::Abs(Scaler - StreamingScaler) > StreamingScaler * IncrementalRescaleTolerance;
+
+	for (int i = 0; !bNeedsRebuild && i < GesturesDB->Gestures.Num(); i++)
+	{
+		bNeedsRebuild = StreamingColumns[i * 2].Cost.Num() != GesturesDB->Gestures[i].Samples.Num() + 1;
+	}
+
+	// Replaying the buffer is as expensive as the full pass anyway, so that tick gets the full DTW result
+	if (bNeedsRebuild)
+	{
+		RebuildStreamingColumns(inputGesture, Scaler);
+		return FindBestGesture(inputGesture, OutDistance);
+	}
+
+	// Samples that came in since the last pass, oldest first
+	for (int k = StreamingSamplesAdded - StreamingSamplesProcessed - 1; k >= 0; --k)
+	{
+		AdvanceStreamingColumns(inputGesture.Samples[k]);
+	}
+
+	StreamingSamplesProcessed = StreamingSamplesAdded;
+
+	RefreshTemplateCache();
+
+	LastDTWEvaluatedCount = 0;
+	LastDTWPrunedCount = 0;
+
+	// The same checks as FindBestGestureInRange, with the match cost read from the running column instead of a DTW over the buffer
+	const FVector MirrorVector = FVector(1.f, -1.f, 1.f); // Only mirroring on Y axis to flip Left/Right
+	const int InputSampleCount = inputGesture.Samples.Num();
+	float minDist = MAX_FLT;
+	int OutGestureIndex = -1;
+
+	for (int i = 0; i < TemplateCache.Num(); i++)
+	{
+		const FVRGestureTemplateCache & Template = TemplateCache[i];
+		const FVRGestureSettings & Settings = Template.Settings;
+
+		if (!Settings.bEnabled || Template.SampleCount < 1 || InputSampleCount < Settings.Minimum_Gesture_Length)
+			continue;
+
+		const FVector NewestSample = inputGesture.Samples[0] * (Settings.bEnableScaling ? Scaler : 1.f);
+		int ColumnIndex = i * 2;
+
+		if (FVector::DistSquared(UsesMirroredInput(Settings) ? NewestSample * MirrorVector : NewestSample, Template.GetSample(0)) >= FMath::Square(Settings.firstThreshold))
+		{
+			if (Settings.MirrorMode != EVRGestureMirrorMode::GES_MirrorBoth)
+				continue;
+
+			ColumnIndex = i * 2 + 1;
+
+			if (FVector::DistSquared(NewestSample * MirrorVector, Template.GetSample(0)) >= FMath::Square(Settings.firstThreshold))
+				continue;
+		}
+
+		const float d = StreamingColumns[ColumnIndex].Cost[Template.SampleCount] / (Template.SampleCount);
+		if (d < minDist && d < FMath::Square(Settings.FullThreshold))
+		{
+			minDist = d;
+			OutGestureIndex = i;
+		}
+	}
+
+	OutDistance = minDist;
+	return OutGestureIndex;
+}
+
+void UVRGestureComponent::RebuildStreamingColumns(const FVRGesture & inputGesture, float Scaler)
+{
+	StreamingDB = GesturesDB;
+	StreamingMirroringHand = MirroringHand;
+	StreamingScaler = Scaler;
+	bStreamingNeedsRebuild = false;
+
+	const int GestureCount = GesturesDB ? GesturesDB->Gestures.Num() : 0;
+	StreamingColumns.SetNum(GestureCount * 2, false);
+
+	for (int i = 0; i < GestureCount; i++)
+	{
+		const FVRGesture & Gesture = GesturesDB->Gestures[i];
+		StreamingColumns[i * 2].Reset(Gesture.Samples.Num());
+
+		// Only GES_MirrorBoth gestures ever check the mirrored input as a second pass
+		if (Gesture.GestureSettings.MirrorMode == EVRGestureMirrorMode::GES_MirrorBoth)
+			StreamingColumns[i * 2 + 1].Reset(Gesture.Samples.Num());
+		else
+			StreamingColumns[i * 2 + 1].Empty();
+	}
+
+	// Replay the buffer, oldest first
+	for (int k = inputGesture.Samples.Num() - 1; k >= 0; --k)
+	{
+		AdvanceStreamingColumns(inputGesture.Samples[k]);
+	}
+
+	StreamingSamplesProcessed = StreamingSamplesAdded;
+}
+
+void UVRGestureComponent::AdvanceStreamingColumns(const FVector & InputSample)
+{
+	const FVector ScaledSample = InputSample * StreamingScaler;
+	const FVector MirrorVector = FVector(1.f, -1.f, 1.f); // Only mirroring on Y axis to flip Left/Right
+
+	for (int i = 0; i < GesturesDB->Gestures.Num(); i++)
+	{
+		const FVRGesture & Gesture = GesturesDB->Gestures[i];
+
+		// Disabled gestures are still kept up to date so that they are correct if they get enabled again
+		if (Gesture.Samples.Num() < 1)
+			continue;
+
+		const FVector Sample = Gesture.GestureSettings.bEnableScaling ? ScaledSample : InputSample;
+
+		AdvanceStreamingColumn(StreamingColumns[i * 2], Gesture.Samples, UsesMirroredInput(Gesture.GestureSettings) ? Sample * MirrorVector : Sample);
+
+		if (StreamingColumns[i * 2 + 1].Cost.Num())
+			AdvanceStreamingColumn(StreamingColumns[i * 2 + 1], Gesture.Samples, Sample * MirrorVector);
+	}
+}
+
+void UVRGestureComponent::AdvanceStreamingColumn(FVRGestureStreamingColumn & Column, const TArray<FVector> & TemplateSamples, const FVector & InputSample)
+{
+	// Subsequence DTW run forward in time, one input sample per call, with the same step rules and maxSlope limits as DTWTwoRow.
+	// The column is updated in place, so the previous samples value is carried along as the diagonal.
+	// Entry 0 is always zero so that a match can start on any sample. Templates are stored newest first, walk them backwards.
+	const int TemplateCount = TemplateSamples.Num();
+	const FVector * Template = TemplateSamples.GetData();
+	float * Cost = Column.Cost.GetData();
+	int * SlopeJ = Column.SlopeJ.GetData();
+
+	float Diagonal = 0.f;
+	float Left = 0.f;
+
+	// Template steps in a row on this input sample, the vertical run of each entry is kept in SlopeJ
+	int LeftSlopeI = 0;
+
+	for (int j = 1; j <= TemplateCount; j++)
+	{
+		const float Up = Cost[j];
+		const float Distance = FVector::DistSquared(InputSample, Template[TemplateCount - j]);
+		float NewCost;
+
+		if (Left < Diagonal && Left < Up && LeftSlopeI < maxSlope)
+		{
+			NewCost = Distance + Left;
+			++LeftSlopeI;
+			SlopeJ[j] = 0;
+		}
+		else if (Up < Diagonal && Up < Left && SlopeJ[j] < maxSlope)
+		{
+			NewCost = Distance + Up;
+			LeftSlopeI = 0;
+			++SlopeJ[j];
+		}
+		else
+		{
+			NewCost = Distance + Diagonal;
+			LeftSlopeI = 0;
+			SlopeJ[j] = 0;
+		}
+
+		Diagonal = Up;
+		Cost[j] = NewCost;
+		Left = NewCost;
+	}
+}
+
 void UVRGestureComponent::DrawDebugGesture(UObject* WorldContextObject, FTransform &StartTransform, FVRGesture GestureToDraw, FColor const& Color, bool bPersistentLines, uint8 DepthPriority, float LifeTime, float Thickness)
 {
 #if ENABLE_DRAW_DEBUG
@@ -680,6 +1297,7 @@ FVRGestureSplineDraw::~FVRGestureSplineDraw()
 
 void UVRGestureComponent::BeginDestroy()
 {
+	CancelAsyncRecognition();
 	Super::BeginDestroy();
 	RecordingGestureDraw.Clear();
 	if (TickGestureTimer_Handle.IsValid())
@@ -698,6 +1316,8 @@ void UVRGestureComponent::RecalculateGestureSize(FVRGesture & InputGesture, UGes
 
 FVRGesture UVRGestureComponent::EndRecording()
 {
+	CancelAsyncRecognition();
+
 	if (TickGestureTimer_Handle.IsValid())
 	{
 		GetWorld()->GetTimerManager().ClearTimer(TickGestureTimer_Handle);
@@ -714,7 +1334,9 @@ FVRGesture UVRGestureComponent::EndRecording()
 
 void UVRGestureComponent::ClearRecording()
 {
+	CancelAsyncRecognition();
 	GestureLog.Samples.Reset(RecordingBufferSize);
+	bStreamingNeedsRebuild = true;
 }
 
 void UVRGestureComponent::SaveRecording(FVRGesture &Recording, FString RecordingName, bool bScaleRecordingToDatabase)
@@ -724,5 +1346,349 @@ void UVRGestureComponent::SaveRecording(FVRGesture &Recording, FString Recording
 		Recording.CalculateSizeOfGesture(bScaleRecordingToDatabase, GesturesDB->TargetGestureScale);
 		Recording.Name = RecordingName;
 		GesturesDB->Gestures.Add(Recording);
+		InvalidateGestureCache();
 	}
 }
+
+#if !UE_BUILD_SHIPPING
+namespace VRGestureBenchmark
+{
+	// Subsequence DTW over the whole input as a full table run forward in time (oldest sample first), what the running columns
+	// of incremental recognition have to hold for the newest sample if no sample has left the buffer since they were built
+	static float ReferenceStreamingDtw(UVRGestureComponent * Component, const FVRGesture & seq1, const FVRGesture & seq2, bool bMirrorGesture, float Scaler)
+	{
+		const FVector MirrorVector = FVector(1.f, -1.f, 1.f);
+		const int RowCount = seq1.Samples.Num() + 1;
+		const int ColumnCount = seq2.Samples.Num() + 1;
+
+		TArray<float> LookupTable;
+		LookupTable.Init(MAX_FLT, ColumnCount * RowCount);
+		TArray<int> SlopeI;
+		SlopeI.AddZeroed(ColumnCount * RowCount);
+		TArray<int> SlopeJ;
+		SlopeJ.AddZeroed(ColumnCount * RowCount);
+
+		// Every row can start a match
+		for (int i = 0; i < RowCount; i++)
+		{
+			LookupTable[i * ColumnCount] = 0.f;
+		}
+
+		for (int i = 1; i < RowCount; i++)
+		{
+			const FVector Sample = seq1.Samples[RowCount - 1 - i] * Scaler;
+			const FVector InputSample = bMirrorGesture ? Sample * MirrorVector : Sample;
+
+			for (int j = 1; j < ColumnCount; j++)
+			{
+				const int Cell = i * ColumnCount + j;
+				const float Left = LookupTable[Cell - 1];
+				const float Up = LookupTable[Cell - ColumnCount];
+				const float Diagonal = LookupTable[Cell - ColumnCount - 1];
+				const float Distance = FVector::DistSquared(InputSample, seq2.Samples[ColumnCount - 1 - j]);
+
+				if (Left < Diagonal && Left < Up && SlopeI[Cell - 1] < Component->maxSlope)
+				{
+					LookupTable[Cell] = Distance + Left;
+					SlopeI[Cell] = SlopeI[Cell - 1] + 1;
+				}
+				else if (Up < Diagonal && Up < Left && SlopeJ[Cell - ColumnCount] < Component->maxSlope)
+				{
+					LookupTable[Cell] = Distance + Up;
+					SlopeJ[Cell] = SlopeJ[Cell - ColumnCount] + 1;
+				}
+				else
+				{
+					LookupTable[Cell] = Distance + Diagonal;
+				}
+			}
+		}
+
+		return LookupTable[RowCount * ColumnCount - 1];
+	}
+
+	// The original recognition loop on top of the full table dtw(), what FindBestGesture has to match
+	// With bStreaming it runs on top of ReferenceStreamingDtw instead, what incremental recognition has to match
+	static int ReferenceFindBestGesture(UVRGestureComponent * Component, const FVRGesture & inputGesture, float & OutDistance, bool bStreaming = false)
+	{
+		UGesturesDatabase * GesturesDB = Component->GesturesDB;
+		float minDist = MAX_FLT;
+		int OutGestureIndex = -1;
+
+		FVector Size = inputGesture.GestureSize.GetSize();
+		float Scaler = GesturesDB->TargetGestureScale / Size.GetMax();
+
+		for (int i = 0; i < GesturesDB->Gestures.Num(); i++)
+		{
+			FVRGesture &exampleGesture = GesturesDB->Gestures[i];
+
+			if (!exampleGesture.GestureSettings.bEnabled || exampleGesture.Samples.Num() < 1 || inputGesture.Samples.Num() < exampleGesture.GestureSettings.Minimum_Gesture_Length)
+				continue;
+
+			float FinalScaler = exampleGesture.GestureSettings.bEnableScaling ? Scaler : 1.f;
+			bool bMirrorGesture = (Component->MirroringHand != EVRGestureMirrorMode::GES_NoMirror && Component->MirroringHand != EVRGestureMirrorMode::GES_MirrorBoth && Component->MirroringHand == exampleGesture.GestureSettings.MirrorMode);
+
+			if (Component->GetGestureDistance(inputGesture.Samples[0] * FinalScaler, exampleGesture.Samples[0], bMirrorGesture) >= FMath::Square(exampleGesture.GestureSettings.firstThreshold))
+			{
+				if (exampleGesture.GestureSettings.MirrorMode != EVRGestureMirrorMode::GES_MirrorBoth)
+					continue;
+
+				bMirrorGesture = true;
+				if (Component->GetGestureDistance(inputGesture.Samples[0] * FinalScaler, exampleGesture.Samples[0], bMirrorGesture) >= FMath::Square(exampleGesture.GestureSettings.firstThreshold))
+					continue;
+			}
+
+			const float Cost = bStreaming ? ReferenceStreamingDtw(Component, inputGesture, exampleGesture, bMirrorGesture, FinalScaler) : Component->dtw(inputGesture, exampleGesture, bMirrorGesture, FinalScaler);
+			float d = Cost / (exampleGesture.Samples.Num());
+			if (d < minDist && d < FMath::Square(exampleGesture.GestureSettings.FullThreshold))
+			{
+				minDist = d;
+				OutGestureIndex = i;
+			}
+		}
+
+		OutDistance = minDist;
+		return OutGestureIndex;
+	}
+
+	// Random smooth stroke, stored newest first like recorded gestures
+	static void MakeRandomGesture(FRandomStream & Stream, int SampleCount, FVRGesture & OutGesture)
+	{
+		OutGesture.Samples.Reset(SampleCount);
+		OutGesture.GestureSize.Init();
+
+		FVector Position = FVector::ZeroVector;
+		FVector Direction = FVector(0.f, Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f)).GetSafeNormal();
+
+		for (int i = 0; i < SampleCount; ++i)
+		{
+			Direction = (Direction + FVector(0.f, Stream.FRandRange(-0.5f, 0.5f), Stream.FRandRange(-0.5f, 0.5f))).GetSafeNormal();
+			Position += Direction * 2.f;
+			OutGesture.Samples.Insert(Position, 0);
+		}
+	}
+
+	// Transient component with a database of random templates
+	static UVRGestureComponent * MakeRandomComponent(FRandomStream & Stream, int TemplateCount)
+	{
+		UGesturesDatabase * Database = NewObject<UGesturesDatabase>(GetTransientPackage());
+		UVRGestureComponent * Component = NewObject<UVRGestureComponent>(GetTransientPackage());
+		Component->GesturesDB = Database;
+		Component->MirroringHand = EVRGestureMirrorMode::GES_MirrorLeft;
+
+		Database->Gestures.SetNum(TemplateCount);
+		for (int i = 0; i < TemplateCount; ++i)
+		{
+			FVRGesture & Gesture = Database->Gestures[i];
+			MakeRandomGesture(Stream, Stream.RandRange(20, 60), Gesture);
+			Gesture.GestureSettings.MirrorMode = (EVRGestureMirrorMode)Stream.RandRange(0, 3);
+			Gesture.GestureSettings.firstThreshold = 60.f;
+			Gesture.GestureSettings.FullThreshold = 30.f;
+			Gesture.CalculateSizeOfGesture(true, Database->TargetGestureScale);
+		}
+
+		return Component;
+	}
+
+	// Input is a noisy copy of a random template so that something gets detected
+	static void MakeRandomInput(FRandomStream & Stream, const UGesturesDatabase * Database, int InputLength, FVRGesture & OutInput)
+	{
+		OutInput.Samples.Reset(InputLength);
+		OutInput.GestureSize.Init();
+		const FVRGesture & Source = Database->Gestures[Stream.RandHelper(Database->Gestures.Num())];
+		for (int i = 0; i < InputLength; ++i)
+		{
+			const FVector Noise(0.f, Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f));
+			OutInput.Samples.Add(Source.Samples[FMath::Min(i * Source.Samples.Num() / InputLength, Source.Samples.Num() - 1)] * 0.3f + Noise);
+		}
+		OutInput.CalculateSizeOfGesture();
+	}
+
+	// Times the parallel recognition from one batch up to one per thread, it has to pick the same gesture at the same distance as the serial pass
+	static void RunParallelBenchmark(FRandomStream & Stream, int Iterations, int InputLength, int TemplateCount)
+	{
+		UVRGestureComponent * Component = MakeRandomComponent(Stream, TemplateCount);
+		UGesturesDatabase * Database = Component->GesturesDB;
+
+		FVRGesture Input;
+		MakeRandomInput(Stream, Database, InputLength, Input);
+
+		float Distance = 0.f;
+		const int Index = Component->FindBestGesture(Input, Distance);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int i = 0; i < Iterations; ++i)
+		{
+			Component->FindBestGesture(Input, Distance);
+		}
+		const double SerialTime = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+		const int ThreadCount = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		TArray<int> BatchCounts;
+		for (int Batches = 1; Batches < ThreadCount; Batches *= 2)
+		{
+			BatchCounts.Add(Batches);
+		}
+		BatchCounts.Add(ThreadCount);
+
+		for (int Batches : BatchCounts)
+		{
+			float ParallelDistance = 0.f;
+			const int ParallelIndex = Component->FindBestGestureParallel(Input, ParallelDistance, Batches);
+
+			StartTime = FPlatformTime::Seconds();
+			for (int i = 0; i < Iterations; ++i)
+			{
+				Component->FindBestGestureParallel(Input, ParallelDistance, Batches);
+			}
+			const double ParallelTime = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+			UE_LOG(LogVRGestures, Log, TEXT("Gesture benchmark: %d templates, %d batches %.3fms, serial %.3fms (%.2fx), %d through DTW, %s"),
+				TemplateCount, Batches, ParallelTime * 1000.0, SerialTime * 1000.0, ParallelTime > 0.0 ? SerialTime / ParallelTime : 0.0,
+				Component->LastDTWEvaluatedCount, (ParallelIndex == Index && ParallelDistance == Distance) ? TEXT("matches serial") : TEXT("MISMATCH"));
+		}
+
+		Component->MarkPendingKill();
+		Database->MarkPendingKill();
+	}
+
+	static void RunBenchmark(const TArray<FString> & Args)
+	{
+		const int Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+		const int InputLength = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 2) : 60;
+		const int ParallelTemplateCount = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 10000;
+		const int TemplateCounts[] = { 50, 200, 1000 };
+
+		FRandomStream Stream(0x5EED);
+
+		for (int TemplateCount : TemplateCounts)
+		{
+			UVRGestureComponent * Component = MakeRandomComponent(Stream, TemplateCount);
+			UGesturesDatabase * Database = Component->GesturesDB;
+
+			FVRGesture Input;
+			MakeRandomInput(Stream, Database, InputLength, Input);
+
+			// Every template, both mirror states, without early outs has to be bit exact with the full table
+			int Mismatches = 0;
+			const float Scaler = Database->TargetGestureScale / Input.GestureSize.GetSize().GetMax();
+			float ReferenceDistance = 0.f;
+			float Distance = 0.f;
+			Component->FindBestGesture(Input, Distance); // Resets the prepared input
+			FVRGestureTemplateCache Template;
+			for (const FVRGesture & Gesture : Database->Gestures)
+			{
+				Template.Build(Gesture);
+				for (int Mirror = 0; Mirror < 2; ++Mirror)
+				{
+					if (Component->dtw(Input, Gesture, Mirror != 0, Scaler) != Component->DTWTwoRow(Component->GetPreparedInput(Input, Scaler, Mirror != 0), Template))
+						++Mismatches;
+				}
+			}
+
+			const int ReferenceIndex = ReferenceFindBestGesture(Component, Input, ReferenceDistance);
+			const int Index = Component->FindBestGesture(Input, Distance);
+			if (ReferenceIndex != Index || ReferenceDistance != Distance)
+				++Mismatches;
+
+			double StartTime = FPlatformTime::Seconds();
+			for (int i = 0; i < Iterations; ++i)
+			{
+				ReferenceFindBestGesture(Component, Input, ReferenceDistance);
+			}
+			const double ReferenceTime = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+			StartTime = FPlatformTime::Seconds();
+			for (int i = 0; i < Iterations; ++i)
+			{
+				Component->FindBestGesture(Input, Distance);
+			}
+			const double Time = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+			UE_LOG(LogVRGestures, Log, TEXT("Gesture benchmark: %d templates, %d input samples, full table %.3fms, two row %.3fms (%.2fx), best match %d / %d, %d mismatches"),
+				TemplateCount, InputLength, ReferenceTime * 1000.0, Time * 1000.0, Time > 0.0 ? ReferenceTime / Time : 0.0, Index, ReferenceIndex, Mismatches);
+			UE_LOG(LogVRGestures, Log, TEXT("Gesture benchmark: %d templates, %d went through DTW, %d pruned by the lower bounds, %s the 0.1ms per tick budget"),
+				TemplateCount, Component->LastDTWEvaluatedCount, Component->LastDTWPrunedCount, Time * 1000.0 < 0.1 ? TEXT("within") : TEXT("over"));
+
+			// Streaming, feed strokes in one sample at a time and check every step of incremental recognition. With no rescale
+			// tolerance and a buffer that holds every stroke, a step either rebuilt the columns (and matches the full recognition)
+			// or has to match the streaming reference over the whole buffer
+			const int StrokeCount = 4;
+			int StrokeSources[StrokeCount];
+			int TotalStrokeSamples = 0;
+			for (int Stroke = 0; Stroke < StrokeCount; ++Stroke)
+			{
+				StrokeSources[Stroke] = Stream.RandHelper(TemplateCount);
+				TotalStrokeSamples += Database->Gestures[StrokeSources[Stroke]].Samples.Num();
+			}
+
+			Component->RecordingBufferSize = TotalStrokeSamples;
+			Component->IncrementalRescaleTolerance = 0.f;
+			Component->GestureLog.GestureSize.Init();
+			Component->ClearRecording();
+
+			int Steps = 0;
+			int Disagreements = 0;
+			int SameAsFull = 0;
+			double FullStepTime = 0.0;
+			double IncrementalStepTime = 0.0;
+
+			for (int Stroke = 0; Stroke < StrokeCount; ++Stroke)
+			{
+				const FVRGesture & StrokeSource = Database->Gestures[StrokeSources[Stroke]];
+				const FVector StrokeOffset(0.f, Stream.FRandRange(-20.f, 20.f), Stream.FRandRange(-20.f, 20.f));
+
+				for (int k = StrokeSource.Samples.Num() - 1; k >= 0; --k)
+				{
+					const FVector Noise(0.f, Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f));
+					Component->AddSampleToGestureLog(StrokeSource.Samples[k] * 0.3f + StrokeOffset + Noise);
+
+					double StepStart = FPlatformTime::Seconds();
+					const int FullIndex = Component->FindBestGesture(Component->GestureLog, Distance);
+					FullStepTime += FPlatformTime::Seconds() - StepStart;
+
+					float IncrementalDistance = 0.f;
+					StepStart = FPlatformTime::Seconds();
+					const int IncrementalIndex = Component->FindBestGestureIncremental(Component->GestureLog, IncrementalDistance);
+					IncrementalStepTime += FPlatformTime::Seconds() - StepStart;
+
+					float StreamingDistance = 0.f;
+					const int StreamingIndex = ReferenceFindBestGesture(Component, Component->GestureLog, StreamingDistance, true);
+
+					++Steps;
+					const bool bSameAsFull = FullIndex == IncrementalIndex && Distance == IncrementalDistance;
+					SameAsFull += bSameAsFull ? 1 : 0;
+					if (!bSameAsFull && (StreamingIndex != IncrementalIndex || StreamingDistance != IncrementalDistance))
+						++Disagreements;
+				}
+			}
+
+			UE_LOG(LogVRGestures, Log, TEXT("Gesture benchmark: %d templates, streaming %d steps, full %.3fms per step, incremental %.3fms per step, %d steps picked the same as the full recognition"),
+				TemplateCount, Steps, Steps ? FullStepTime * 1000.0 / Steps : 0.0, Steps ? IncrementalStepTime * 1000.0 / Steps : 0.0, SameAsFull);
+
+			if (Disagreements)
+			{
+				UE_LOG(LogVRGestures, Error, TEXT("Gesture benchmark FAILED: incremental recognition disagreed with the streaming reference on %d / %d steps"), Disagreements, Steps);
+			}
+
+			if (Mismatches)
+			{
+				UE_LOG(LogVRGestures, Error, TEXT("Gesture benchmark FAILED: %d mismatches against the full table"), Mismatches);
+			}
+
+			Component->MarkPendingKill();
+			Database->MarkPendingKill();
+		}
+
+		RunParallelBenchmark(Stream, Iterations, InputLength, ParallelTemplateCount);
+	}
+
+	static FAutoConsoleCommandWithArgs BenchmarkCommand(
+		TEXT("vr.Gestures.Benchmark"),
+		TEXT("Checks gesture recognition against the full table DTW and times both at 50, 200 and 1000 random templates.\n")
+		TEXT("Also streams strokes in a sample at a time and checks incremental recognition against a full table streaming reference.\n")
+		TEXT("Then times parallel recognition of a large database from one batch up to one per thread.\n")
+		TEXT("Usage: vr.Gestures.Benchmark [Iterations=100] [InputSamples=60] [ParallelTemplates=10000]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
+#endif
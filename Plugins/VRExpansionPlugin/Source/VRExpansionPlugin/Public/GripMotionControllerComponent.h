@@ -42,8 +42,134 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FVRGripControllerOnGripOutOfRange,
 /** Delegate for notification when the controller profile transform changes. */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FVRGripControllerOnProfileTransformChanged, const FTransform &, NewRelTransForProcComps, const FTransform &, NewProfileTransform);
 
+struct FGripTickCache;
+
+// A primitive to late update and its scene index when it was gathered
+struct VREXPANSIONPLUGIN_API FLateUpdatePrimitiveInfo
+{
+	FPrimitiveSceneInfo* SceneInfo;
+
+	// Set to INDEX_NONE by the render thread once the primitive has been late updated
+	int32 Index;
+
+	FLateUpdatePrimitiveInfo(FPrimitiveSceneInfo* InSceneInfo, int32 InIndex) :
+		SceneInfo(InSceneInfo),
+		Index(InIndex)
+	{}
+
+	FORCEINLINE bool operator<(const FLateUpdatePrimitiveInfo & Other) const
+	{
+		return (UPTRINT)SceneInfo < (UPTRINT)Other.SceneInfo;
+	}
+};
+
+// Everything the render thread needs to late update one frame
+struct VREXPANSIONPLUGIN_API FLateUpdateSlot
+{
+	/** Parent world transform used to reconstruct new world transforms for late update scene proxies */
+	FTransform ParentToWorld;
+
+	/** Primitives that need late update before rendering, sorted by scene info and without duplicates */
+	TArray<FLateUpdatePrimitiveInfo> Primitives;
+
+	/** Late Update Info Stale, if this is found true do not late update */
+	bool bSkipLateUpdate;
+
+	/** Set by the render thread once the slot was applied, later view families of the same frame don't apply it again */
+	bool bApplied;
+
+	FLateUpdateSlot() :
+		ParentToWorld(FTransform::Identity),
+		bSkipLateUpdate(false),
+		bApplied(false)
+	{}
+
+	// Sorts the primitives and removes the ones that were added more than once
+	void Finalize();
+
+	// Returns the primitive entry for the scene info or nullptr if it isn't in this slot
+	FLateUpdatePrimitiveInfo * FindPrimitive(const FPrimitiveSceneInfo* SceneInfo);
+};
+
+/**
+* Lock free buffer that hands late update slots from the game thread to the render thread, paired by game frame.
+* Every published slot is tagged with the game frame that set it up and the render thread acquires the slot of the frame that it is
+* rendering, so a frame is always late updated with its own primitives and transforms and never with those of a later frame.
+* The writer never reuses the slot that the reader holds, with the game thread at most a frame ahead there are always enough free slots.
+*/
+class VREXPANSIONPLUGIN_API FLateUpdateFrameBuffer
+{
+public:
+	FLateUpdateFrameBuffer();
+
+	/** Claims a slot that the reader doesn't hold for the game frame and returns it for the writer to fill before calling Publish() */
+	FLateUpdateSlot & BeginWrite(uint32 FrameNumber);
+
+	/** Slot that the writer claimed last */
+	FLateUpdateSlot & GetWriteSlot()
+	{
+		return Slots[WriteSlot];
+	}
+
+	/** Tags the write slot with its game frame, it replaces anything that was published for the same frame earlier */
+	void Publish();
+
+	/** Holds the newest slot published for the game frame, returns false if nothing was published for it */
+	bool AcquireFrame(uint32 FrameNumber);
+
+	/** Lets the writer reuse the held slot */
+	void Release();
+
+	/** Slot that the reader acquired last */
+	FLateUpdateSlot & GetReadSlot()
+	{
+		return Slots[ReadSlot];
+	}
+
+	const FLateUpdateSlot & GetReadSlot() const
+	{
+		return Slots[ReadSlot];
+	}
+
+	enum
+	{
+		// One being rendered, one published for the next frame, one being written and a spare for frames that set up more than once
+		NumSlots = 4,
+		// Frame tag of a slot that is being written
+		InvalidFrame = -1
+	};
+
+private:
+
+	static FORCEINLINE int32 GetFrameTag(uint32 FrameNumber)
+	{
+		return (int32)(FrameNumber & 0x7FFFFFFF);
+	}
+
+	// Returns if the slot is unused or a newer slot was published for the same frame, only called by the writer
+	bool IsSlotSuperseded(int32 Slot) const;
+
+	FLateUpdateSlot Slots[NumSlots];
+
+	// Frame that each slot was published for and the order they were published in, only changed with atomic exchanges
+	volatile int32 SlotFrames[NumSlots];
+	volatile int32 SlotSequences[NumSlots];
+
+	// Slot held by the reader or INDEX_NONE, only the reader changes it
+	volatile int32 HeldSlot;
+
+	// Only touched by the writer and the reader respectively
+	int32 WriteSlot;
+	int32 WriteFrame;
+	int32 NextSequence;
+	int32 ReadSlot;
+};
+
 /**
 * Utility class for applying an offset to a hierarchy of components in the renderer thread.
+* The component hierarchies that can late update are cached and only gathered again when grips are added or dropped or when
+* something in them is attached or detached, per frame only the grip late update settings are checked and the primitives
+* scene infos copied into the write slot.
 */
 class VREXPANSIONPLUGIN_API FExpandedLateUpdateManager
 {
@@ -60,28 +186,156 @@ public:
 	/** Returns true if the LateUpdateSetup data is stale. */
 	bool GetSkipLateUpdate_RenderThread() const;
 
-	/** Increments the double buffered read index, etc. - in prep for the next render frame (read: MUST be called for each frame Setup() was called on). */
+	/** Releases the slot that was applied this frame back to the game thread */
 	void PostRender_RenderThread();
 
+	/** Forces the cached late update hierarchies to be gathered again on the next Setup() */
+	FORCEINLINE void MarkPrimitivesDirty()
+	{
+		bPrimitivesDirty = true;
+	}
+
 public:
 
 	/** A utility method that calls CacheSceneInfo on ParentComponent and all of its descendants */
 	void GatherLateUpdatePrimitives(USceneComponent* ParentComponent, TArray<USceneComponent*> *SkipComponentList = nullptr);
-	void ProcessGripArrayLateUpdatePrimitives(UGripMotionControllerComponent* MotionController, TArray<FBPActorGripInformation> & GripArray, TArray<USceneComponent*> &SkipComponentList);
 
-	/** Generates a LateUpdatePrimitiveInfo for the given component if it has a SceneProxy and appends it to the current LateUpdatePrimitives array */
+	/** Returns if the grip should currently be late updated, Index is the grips index in GripArray */
+	bool ShouldLateUpdateGrip(UGripMotionControllerComponent* MotionController, const FBPActorGripInformation & Grip, int32 Index, const FGripTickCache & TickCache) const;
+
+	/** Generates a LateUpdatePrimitiveInfo for the given component if it has a SceneProxy and appends it to the current write slot */
 	void CacheSceneInfo(USceneComponent* Component);
 
-	/** Parent world transform used to reconstruct new world transforms for late update scene proxies */
-	FTransform LateUpdateParentToWorld[2];
-	/** Primitives that need late update before rendering */
-	TMap<FPrimitiveSceneInfo*, int32> LateUpdatePrimitives[2];
-	/** Late Update Info Stale, if this is found true do not late update */
-	bool SkipLateUpdate[2];
+	/** Slots handed from Setup() on the game thread to Apply_RenderThread() of the same frame */
+	FLateUpdateFrameBuffer LateUpdateSlots;
 
-	int32 LateUpdateGameWriteIndex;
-	int32 LateUpdateRenderReadIndex;
+private:
+
+	// The components of a hierarchy that late updates as one, gathered once and reused until something in it changes
+	struct FLateUpdateHierarchy
+	{
+		// Every scene component in the hierarchy and its attach children when it was gathered, the children of all of the components
+		// are stored back to back. Only compared against, a detach and an attach in the same frame changes the pointers even when the
+		// count stays the same
+		TArray<TWeakObjectPtr<USceneComponent>> Components;
+		TArray<int32> NumAttachChildren;
+		TArray<const USceneComponent*> AttachChildren;
+
+		TArray<TWeakObjectPtr<UPrimitiveComponent>> Primitives;
+
+		void Gather(USceneComponent* Root, const TArray<USceneComponent*> *SkipComponentList = nullptr);
+		bool IsValid() const;
+
+		void Reset()
+		{
+			Components.Reset();
+			NumAttachChildren.Reset();
+			AttachChildren.Reset();
+			Primitives.Reset();
+		}
+	};
+
+	// Hierarchies of the grips in a grip array, lines up with the grip array the same way that FGripTickCache does
+	struct FLateUpdateGripArray
+	{
+		TArray<uint8> GripIDs;
+		TArray<UObject*> GrippedObjects;
+		TArray<EGripCollisionType> CollisionTypes;
+		TArray<FLateUpdateHierarchy> Hierarchies;
+
+		void Gather(const TArray<FBPActorGripInformation> & GripArray, TArray<USceneComponent*> &SkipComponentList);
+		bool IsValid(const TArray<FBPActorGripInformation> & GripArray) const;
+	};
+
+	// Returns if nothing was gripped, dropped, attached or detached since the hierarchies were gathered
+	bool AreHierarchiesValid(UGripMotionControllerComponent* Component) const;
+	void RebuildHierarchies(UGripMotionControllerComponent* Component);
+
+	// Copies the scene infos of the hierarchy into the write slot
+	void AddHierarchy(const FLateUpdateHierarchy & Hierarchy);
+	void AddGripArray(UGripMotionControllerComponent* Component, const TArray<FBPActorGripInformation> & GripArray, const FLateUpdateGripArray & CachedArray, const FGripTickCache & TickCache);
 
+	FLateUpdateHierarchy ControllerHierarchy;
+	TArray<FLateUpdateHierarchy> AdditionalHierarchies;
+	TArray<UPrimitiveComponent*> CachedAdditionalComponents;
+	FLateUpdateGripArray CachedGrippedObjects;
+	FLateUpdateGripArray CachedLocallyGrippedObjects;
+
+	bool bPrimitivesDirty;
+};
+
+/**
+* Per grip array cache of the values that TickGrip needs every frame, stored as a structure of arrays.
+* Each index lines up with the grip at the same index in the owning grip array, it is rebuilt when grips are
+* added, dropped or replicated so that HandleGripArray doesn't need to resolve interfaces and scripts each frame.
+*/
+struct VREXPANSIONPLUGIN_API FGripTickCache
+{
+	enum EGripInterfaceFlags : uint8
+	{
+		RootHasInterface = 0x01,
+		ActorHasInterface = 0x02,
+		IsResolved = 0x04
+	};
+
+	// Values used to verify that an entry still belongs to the grip at the same index
+	TArray<uint8> GripIDs;
+	TArray<UObject*> GrippedObjects;
+	TArray<EGripCollisionType> CollisionTypes;
+
+	// Resolved per grip values
+	TArray<uint8> InterfaceFlags;
+	TArray<UPrimitiveComponent*> Roots;
+	TArray<AActor*> Actors;
+	TArray<TArray<UVRGripScriptBase*>> GripScripts;
+
+	// The GripLogicScripts array that the scripts were copied from, if the owner has one, so replaced scripts are noticed without calling into the interface
+	TArray<const TArray<UVRGripScriptBase*>*> ScriptSources;
+
+	bool bIsDirty;
+
+	FGripTickCache() :
+		bIsDirty(true)
+	{}
+
+	FORCEINLINE void MarkDirty()
+	{
+		bIsDirty = true;
+	}
+
+	// Returns true if the entry at Index was built from this grip and what it resolved to hasn't changed since
+	FORCEINLINE bool IsEntryValid(int32 Index, const FBPActorGripInformation & Grip) const
+	{
+		if (bIsDirty || !GripIDs.IsValidIndex(Index) ||
+			GripIDs[Index] != Grip.GripID ||
+			GrippedObjects[Index] != Grip.GrippedObject ||
+			CollisionTypes[Index] != Grip.GripCollisionType)
+			return false;
+
+		return !(InterfaceFlags[Index] & IsResolved) || IsResolvedEntryValid(Index);
+	}
+
+	// Catches roots and scripts that were destroyed (the GC clears them through AddReferencedObjects) or replaced since the rebuild
+	bool IsResolvedEntryValid(int32 Index) const;
+
+	// Re-resolves every entry from the grip array, only called when the array has changed
+	void Rebuild(const TArray<FBPActorGripInformation> & GripArray);
+
+	// Called from the owning controllers AddReferencedObjects so that the GC sees and clears the cached objects
+	void AddReferencedObjects(FReferenceCollector & Collector);
+
+	void Empty()
+	{
+		GripIDs.Empty();
+		GrippedObjects.Empty();
+		CollisionTypes.Empty();
+		InterfaceFlags.Empty();
+		Roots.Empty();
+		Actors.Empty();
+		GripScripts.Empty();
+		ScriptSources.Empty();
+		bIsDirty = true;
+	}
 };
 
 /**
@@ -142,9 +396,12 @@ public:
 	void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
 	virtual void InitializeComponent() override;
 	virtual void OnUnregister() override;
+	virtual void OnChildAttached(USceneComponent* ChildComponent) override;
+	virtual void OnChildDetached(USceneComponent* ChildComponent) override;
 	virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker) override;
 	virtual void Deactivate() override;
 	virtual void BeginDestroy() override;
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 	virtual void BeginPlay() override;
 
 protected:
@@ -444,6 +701,8 @@ public:
 		{
 			HandleGripReplication(GrippedObjects[i], OriginalArrayState.FindByKey(GrippedObjects[i].GripID));
 		}
+
+		GrippedObjectsTickCache.MarkDirty();
 	}
 
 	UFUNCTION()
@@ -453,6 +712,8 @@ public:
 		{
 			HandleGripReplication(LocallyGrippedObjects[i], OriginalArrayState.FindByKey(LocallyGrippedObjects[i].GripID));
 		}
+
+		LocallyGrippedObjectsTickCache.MarkDirty();
 	}
 
 	UPROPERTY(BlueprintReadWrite, Category = "GripMotionController")
@@ -464,6 +725,13 @@ public:
 	UPROPERTY(EditDefaultsOnly, ReplicatedUsing = OnRep_ReplicatedControllerTransform, Category = "GripMotionController|Networking")
 	FBPVRComponentPosRep ReplicatedControllerTransform;
 
+	// Keyframe history for when ReplicatedControllerTransform.bDeltaCompressToServer is enabled
+	FBPVRPosRepDeltaState ControllerTransformDeltaState;
+
+	// Last delta keyframe that the server received, replicated back to the owner so it knows what it can delta against
+	UPROPERTY(Replicated)
+	uint8 ControllerTransformAckedKeyframe;
+
 	FVector LastUpdatesRelativePosition;
 	FRotator LastUpdatesRelativeRotation;
 
@@ -477,7 +745,12 @@ public:
 
 		if (bSmoothReplicatedMotion)
 		{
-			if (bReppedOnce)
+			if (bUsePoseInterpolationBuffer && ReplicatedControllerTransform.bHasSendTimeStamp)
+			{
+				ReplicatedPoseBuffer.AddSample(ReplicatedControllerTransform.Position, ReplicatedControllerTransform.Rotation, ReplicatedControllerTransform.SendTimeStamp, FPlatformTime::Seconds());
+				bLerpingPosition = true;
+			}
+			else if (bReppedOnce)
 			{
 				bLerpingPosition = true;
 				ControllerNetUpdateCount = 0.0f;
@@ -505,6 +778,15 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "GripMotionController|Networking")
 		bool bSmoothReplicatedMotion;
 
+	// Whether to play remote motion back through ReplicatedPoseBuffer instead of lerping towards the newest update, requires bSmoothReplicatedMotion
+	// Adds the buffers PlayoutDelay in latency but rides out jitter and late or lost updates without hitching
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GripMotionController|Networking")
+		bool bUsePoseInterpolationBuffer;
+
+	// Playout buffer settings and stats for remote motion when bUsePoseInterpolationBuffer is enabled
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GripMotionController|Networking")
+		FBPVRPoseInterpolationBuffer ReplicatedPoseBuffer;
+
 	// Whether to replicate even if no tracking (FPS or test characters)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "GripMotionController|Networking")
 		bool bReplicateWithoutTracking;
@@ -827,6 +1109,22 @@ public:
 	// Running the gripping logic in its own function as the main tick was getting bloated
 	void TickGrip(float DeltaTime);
 
+	// Cached per grip tick data for the GrippedObjects and LocallyGrippedObjects arrays
+	FGripTickCache GrippedObjectsTickCache;
+	FGripTickCache LocallyGrippedObjectsTickCache;
+
+	// Forces the grip tick caches to rebuild next tick, changes to a held objects GripLogicScripts are picked up on their own
+	// Call this if a held object returns grip scripts from somewhere else and they change
+	UFUNCTION(BlueprintCallable, Category = "GripMotionController")
+	void InvalidateGripTickCache()
+	{
+		GrippedObjectsTickCache.MarkDirty();
+		LocallyGrippedObjectsTickCache.MarkDirty();
+
+		if (GripViewExtension.IsValid())
+			GripViewExtension->LateUpdate.MarkPrimitivesDirty();
+	}
+
 	// Splitting logic into separate function
 	void HandleGripArray(TArray<FBPActorGripInformation> &GrippedObjectsArray, const FTransform & ParentTransform, float DeltaTime, bool bReplicatedArray = false);
 
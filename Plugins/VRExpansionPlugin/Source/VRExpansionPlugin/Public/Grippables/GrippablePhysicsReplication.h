@@ -38,104 +38,42 @@ public:
 	FPhysicsReplicationVR(FPhysScene* PhysScene);
 	static bool IsInitialized();
 
-	virtual void OnTick(float DeltaSeconds, TMap<TWeakObjectPtr<UPrimitiveComponent>, FReplicatedPhysicsTarget>& ComponentsToTargets) override
-	{
-		// Skip all of the custom logic if we aren't the server
-		if (const UWorld* World = GetOwningWorld())
-		{
-			if (World->GetNetMode() == ENetMode::NM_Client)
-			{
-				return FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
-			}
-		}
-
-		const FRigidBodyErrorCorrection& PhysicErrorCorrection = UPhysicsSettings::Get()->PhysicErrorCorrection;
+	virtual void OnTick(float DeltaSeconds, TMap<TWeakObjectPtr<UPrimitiveComponent>, FReplicatedPhysicsTarget>& ComponentsToTargets) override;
 
-		// Get the ping between this PC & the server
-		const float LocalPing = 0.0f;//GetLocalPing();
+private:
 
-		float CurrentTimeSeconds = 0.0f;
-
-		if (UWorld* OwningWorld = GetOwningWorld())
-		{
-			CurrentTimeSeconds = OwningWorld->GetTimeSeconds();
-		}
+	// Resolved body of a replicated target, kept between ticks so that we don't have to look up the bone every frame
+	struct FCachedPhysicsTarget
+	{
+		// Bone that the target asked for and the bone of the body that it resolved to
+		FName BoneName;
+		FName ResolvedBoneName;
+		// Index into the skeletal mesh bodies, INDEX_NONE for anything that isn't a skeletal mesh
+		int32 BodyIndex;
+		bool bIsSkeletal;
+		bool bIsResolved;
+
+		FCachedPhysicsTarget() :
+			BoneName(NAME_None),
+			ResolvedBoneName(NAME_None),
+			BodyIndex(INDEX_NONE),
+			bIsSkeletal(false),
+			bIsResolved(false)
+		{}
+	};
 
-		for (auto Itr = ComponentsToTargets.CreateIterator(); Itr; ++Itr)
-		{
+	// Returns the body instance for the target, re-resolving it only if the cached one is no longer valid
+	FBodyInstance * GetTargetBodyInstance(UPrimitiveComponent * PrimComp, const FReplicatedPhysicsTarget & PhysicsTarget, FCachedPhysicsTarget & CachedTarget);
 
-			// Its been more than half a second since the last update, lets cease using the target as a failsafe
-			// Clients will never update with that much latency, and if they somehow are, then they are dropping so many
-			// packets that it will be useless to use their data anyway
-			if ((CurrentTimeSeconds - Itr.Value().ArrivedTimeSeconds) > 0.5f)
-			{
-				OnTargetRestored(Itr.Key().Get(), Itr.Value());
-				Itr.RemoveCurrent();
-			}
-			else if (UPrimitiveComponent* PrimComp = Itr.Key().Get())
-			{
-				bool bRemoveItr = false;
+	// Returns the one way ping in seconds of the player that owns the actor, cached for the frame
+	float GetOwnerPingSecondsOneWay(AActor * OwningActor);
 
-				if (FBodyInstance* BI = PrimComp->GetBodyInstance(Itr.Value().BoneName))
-				{
-					FReplicatedPhysicsTarget& PhysicsTarget = Itr.Value();
-					FRigidBodyState& UpdatedState = PhysicsTarget.TargetState;
-					bool bUpdated = false;
-					if (AActor* OwningActor = PrimComp->GetOwner())
-					{
-						// Deleted everything here, we will always be the server, I already filtered out clients to default logic
-						{
-							/*const*/ float OwnerPing = 0.0f;// GetOwnerPing(OwningActor, PhysicsTarget);
-					
-							/*if (UPlayer* OwningPlayer = OwningActor->GetNetOwningPlayer())
-							{
-								if (APlayerController* PlayerController = OwningPlayer->GetPlayerController(nullptr))
-								{
-									if (APlayerState* PlayerState = PlayerController->PlayerState)
-									{
-										OwnerPing = PlayerState->ExactPing;
-									}
-								}
-							}*/
-
-							// Get the total ping - this approximates the time since the update was
-							// actually generated on the machine that is doing the authoritative sim.
-							// NOTE: We divide by 2 to approximate 1-way ping from 2-way ping.
-							const float PingSecondsOneWay = 0.0f;// (LocalPing + OwnerPing) * 0.5f * 0.001f;
-
-
-							if (UpdatedState.Flags & ERigidBodyFlags::NeedsUpdate)
-							{
-								const bool bRestoredState = ApplyRigidBodyState(DeltaSeconds, BI, PhysicsTarget, PhysicErrorCorrection, PingSecondsOneWay);
-
-								// Need to update the component to match new position.
-								static const auto CVarSkipSkeletalRepOptimization = IConsoleManager::Get().FindConsoleVariable(TEXT("p.SkipSkeletalRepOptimization"));
-								if (/*PhysicsReplicationCVars::SkipSkeletalRepOptimization*/CVarSkipSkeletalRepOptimization->GetInt() == 0 || Cast<USkeletalMeshComponent>(PrimComp) == nullptr)	//simulated skeletal mesh does its own polling of physics results so we don't need to call this as it'll happen at the end of the physics sim
-								{
-									PrimComp->SyncComponentToRBPhysics();
-								}
-
-								// Added a sleeping check from the input state as well, we always want to cease activity on sleep
-								if (bRestoredState || ((UpdatedState.Flags & ERigidBodyFlags::Sleeping) != 0))
-								{
-									bRemoveItr = true;
-								}
-							}
-						}
-					}
-				}
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FCachedPhysicsTarget> CachedTargets;
 
-				if (bRemoveItr)
-				{
-					OnTargetRestored(Itr.Key().Get(), Itr.Value());
-					Itr.RemoveCurrent();
-				}
-			}
-		}
+	// Owning players one way ping, rebuilt every tick
+	TMap<const UPlayer*, float> OwnerPingCache;
 
-		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Phys Rep Tick!"));
-		//FPhysicsReplication::OnTick(DeltaSeconds, ComponentsToTargets);
-	}
+	IConsoleVariable * CVarSkipSkeletalRepOptimization;
 };
 
 class IPhysicsReplicationFactoryVR : public IPhysicsReplicationFactory
@@ -274,13 +212,34 @@ public:
 	float TimeAtInitialThrow;
 	bool bIsCurrentlyClientAuth;
 
+	// If we turned on the physics sleep / wake events of the body for the throw
+	bool bEnabledSleepEvents;
+
+	// Polls in a row that the body was at rest, a single one happens at the top of any vertical throw
+	int32 RestPolls;
+
 	FVRClientAuthReplicationData() :
 		bUseClientAuthThrowing(false),
 		UpdateRate(30),
 		LastActorTransform(FTransform::Identity),
 		TimeAtInitialThrow(0.0f),
-		bIsCurrentlyClientAuth(false)
+		bIsCurrentlyClientAuth(false),
+		bEnabledSleepEvents(false),
+		RestPolls(0)
 	{
 
 	}
+
+	// Turns on the physics sleep / wake events for the bodies of the component if they aren't already
+	void EnableSleepEvents(UPrimitiveComponent * PrimComp);
+
+	// Turns the sleep / wake events back off if we were the ones that turned them on
+	void RestoreSleepEvents(UPrimitiveComponent * PrimComp);
+
+	// Returns true if both velocities quantize to zero at vr.ClientAuthThrow.RestVelocityQuantization
+	static bool IsAtRest(const FRepMovement & Movement);
+
+	// Call once per poll, returns true once the body has been at rest for vr.ClientAuthThrow.RestPollsBeforeSleep polls in a row
+	// and can be put to sleep early, otherwise sleeping is left to physics
+	bool ShouldForceSleep(const FRepMovement & Movement);
 };
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Containers/BitArray.h"
+
+class AActor;
+class UWorld;
+struct FBPInterfaceProperties;
+struct FVRClientAuthReplicationData;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGrippableReplicationBudget, Log, All);
+
+// Snapshot of a grippable that the budget ranks, gathered once per frame
+struct VREXPANSIONPLUGIN_API FGrippableReplicationCandidate
+{
+	FVector Location;
+	float Speed;
+
+	// Bytes per second that replicating this grippable costs, 0 if it has nothing to send
+	float BytesPerSecond;
+
+	bool bIsHeld;
+	bool bRecentlyThrown;
+
+	FGrippableReplicationCandidate() :
+		Location(FVector::ZeroVector),
+		Speed(0.0f),
+		BytesPerSecond(0.0f),
+		bIsHeld(false),
+		bRecentlyThrown(false)
+	{}
+};
+
+/**
+* Spends a fixed per connection byte budget on grippable movement replication in priority order.
+* Grippables are ranked per connection by distance to the connections HMD, by velocity and by being held or recently thrown.
+* On the server the result drives the grippables net priority, grippables outside of the budget are pushed behind everything else
+* so that they only go out when the connection has bandwidth to spare. On clients it limits the client auth throw updates sent to the server.
+* One budget exists per world, grippables register themselves on BeginPlay in networked games.
+*/
+class VREXPANSIONPLUGIN_API FGrippableReplicationBudget
+{
+public:
+
+	FGrippableReplicationBudget(UWorld * InWorld);
+
+	// Returns the budget for the world, creates it if it doesn't exist yet and bCreateIfMissing is set
+	static FGrippableReplicationBudget * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	// The settings and replication data are read every frame and have to stay valid until the actor is unregistered
+	void RegisterActor(AActor * Actor, const FBPInterfaceProperties * GripSettings, const FVRClientAuthReplicationData * ClientAuthData);
+	void UnregisterActor(AActor * Actor);
+
+	// Scales the engine priority of a grippable for the connection owned by Viewer
+	float GetNetPriority(AActor * Actor, AActor * Viewer, AActor * ViewTarget, const FVector & ViewPos, float BasePriority);
+
+	// Returns if a client auth throw update for the actor fits in this frames upload budget
+	bool AllowClientAuthUpdate(AActor * Actor);
+
+	// Higher is more important
+	static float GetScore(const FGrippableReplicationCandidate & Candidate, const FVector & ViewPos);
+
+	// Ranks the candidates for a viewer and marks the ones that fit in BytesPerSecondBudget, Scores and SortedIndices are scratch space
+	static void SpendBudget(const TArray<FGrippableReplicationCandidate> & Candidates, const FVector & ViewPos, float BytesPerSecondBudget, TArray<float> & Scores, TArray<int32> & SortedIndices, TBitArray<> & OutInBudget);
+
+private:
+
+	struct FRegisteredActor
+	{
+		FObjectKey Key;
+		TWeakObjectPtr<AActor> Actor;
+		const FBPInterfaceProperties * GripSettings;
+		const FVRClientAuthReplicationData * ClientAuthData;
+		float ReleaseTime;
+		bool bWasHeld;
+		bool bWasMoving;
+
+		// Last replicated movement seen, used to measure how often movement updates actually go out
+		FVector LastRepLocation;
+		FRotator LastRepRotation;
+
+		// Movement updates per second over the last full window, negative until a window has been measured
+		float MeasuredSendRate;
+		float RateWindowStart;
+		int32 RateWindowSends;
+	};
+
+	struct FViewerBudget
+	{
+		TBitArray<> InBudget;
+		uint32 RankedSerial;
+		uint64 LastUsedFrame;
+
+		FViewerBudget() :
+			RankedSerial(0),
+			LastUsedFrame(0)
+		{}
+	};
+
+	void RemoveActorAt(int32 Index);
+
+	// Refreshes the candidates if they are from an earlier frame or the registered actors changed
+	void GatherCandidates();
+
+	// Movement updates per second the server sends for the actor, measured from its replicated movement and capped by its net update
+	// frequency and the net drivers tick rate
+	static float GetServerSendRate(FRegisteredActor & Registered, AActor * Actor, float NetTickRate, float RealTime, bool bStartedMoving);
+
+	// Ranks the candidates for the viewer if it hasn't been for the current candidates yet
+	const TBitArray<> & RankForViewer(const FObjectKey & ViewerKey, const FVector & ViewPos, float BytesPerSecondBudget);
+
+	TWeakObjectPtr<UWorld> World;
+
+	TArray<FRegisteredActor> Actors;
+	TMap<FObjectKey, int32> ActorIndices;
+
+	TArray<FGrippableReplicationCandidate> Candidates;
+	uint64 GatheredFrame;
+	uint32 GatherSerial;
+	bool bCandidatesDirty;
+
+	TMap<FObjectKey, FViewerBudget> ViewerBudgets;
+
+	TArray<float> ScoreScratch;
+	TArray<int32> SortScratch;
+};
@@ -14,6 +14,8 @@
 #include "Engine/ActorChannel.h"
 #include "DrawDebugHelpers.h"
 #include "Grippables/GrippablePhysicsReplication.h"
+#include "Grippables/GrippableReplicationBudget.h"
+#include "Grippables/GrippableSpatialIndex.h"
 #include "Misc/BucketUpdateSubsystem.h"
 #include "GrippableSkeletalMeshActor.generated.h"
 
@@ -85,6 +87,16 @@ public:
 	UFUNCTION(Category = "Networking")
 		void CeaseReplicationBlocking();
 
+	// Stops client auth replication after the owners ping has passed, so that the servers movement catches up first
+	void QueueCeaseReplicationBlocking();
+
+	// Physics sleep / wake events of the root body while we are client auth throwing
+	UFUNCTION()
+		void OnClientAuthBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	UFUNCTION()
+		void OnClientAuthBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
 	// Notify the server that we locally gripped something
 	UFUNCTION(UnReliable, Server, WithValidation, Category = "Networking")
 		void Server_GetClientAuthReplication(const FRepMovementVR & newMovement);
@@ -109,6 +121,9 @@ public:
 
 	virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker) override;
 
+	// Ranks us against the other grippables in the replication budget of the viewing connection
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
 	// Skips the attachment replication if we are locally owned and our grip settings say that we are a client authed grip.
 	UPROPERTY(EditAnywhere, Replicated, BlueprintReadWrite, Category = "Replication")
 		bool bAllowIgnoringAttachOnOwner;
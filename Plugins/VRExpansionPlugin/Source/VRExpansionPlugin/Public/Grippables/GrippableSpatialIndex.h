@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Components/SceneComponent.h"
+#include "GrippableSpatialIndex.generated.h"
+
+class UGripMotionControllerComponent;
+class UWorld;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGrippableSpatialIndex, Log, All);
+
+// A grippable found near a query location
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FGrippableQueryCandidate
+{
+	GENERATED_BODY()
+public:
+
+	// The actor or component that implements the grip interface
+	UPROPERTY(BlueprintReadOnly, Category = "GrippableQuery")
+		UObject * Grippable;
+
+	// Component that the grippable is tracked by, the root component for grippable actors
+	UPROPERTY(BlueprintReadOnly, Category = "GrippableQuery")
+		USceneComponent * Component;
+
+	// Distance from the query location to the grippables bounding sphere, 0 if the location is inside of it
+	UPROPERTY(BlueprintReadOnly, Category = "GrippableQuery")
+		float Distance;
+
+	FGrippableQueryCandidate() :
+		Grippable(nullptr),
+		Component(nullptr),
+		Distance(0.0f)
+	{}
+};
+
+// The grippables near one of a players hands, closest first
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FGrippableHandCandidates
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "GrippableQuery")
+		UGripMotionControllerComponent * Controller;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GrippableQuery")
+		TArray<FGrippableQueryCandidate> Candidates;
+
+	FGrippableHandCandidates() :
+		Controller(nullptr)
+	{}
+};
+
+// A single nearest grippables query, see FGrippableSpatialIndex::QueryNearest()
+struct VREXPANSIONPLUGIN_API FGrippableQuery
+{
+	FVector Location;
+	float Radius;
+
+	// 0 or less returns everything in range
+	int32 MaxResults;
+
+	// Held grippables are skipped unless this is set
+	bool bIncludeHeld;
+
+	FGrippableQuery() :
+		Location(FVector::ZeroVector),
+		Radius(0.0f),
+		MaxResults(0),
+		bIncludeHeld(false)
+	{}
+
+	FGrippableQuery(const FVector & InLocation, float InRadius, int32 InMaxResults, bool bInIncludeHeld) :
+		Location(InLocation),
+		Radius(InRadius),
+		MaxResults(InMaxResults),
+		bIncludeHeld(bInIncludeHeld)
+	{}
+};
+
+struct VREXPANSIONPLUGIN_API FGrippableSpatialHit
+{
+	int32 Id;
+	float Distance;
+
+	FGrippableSpatialHit(int32 InId, float InDistance) :
+		Id(InId),
+		Distance(InDistance)
+	{}
+};
+
+/**
+* Loose spatial hash of bounding spheres. Entries are stored in the cell of their center and queries look one cell further out,
+* spheres larger than a cell are kept in a separate list that every query checks.
+* Ids are pooled and stay valid until the entry is removed.
+*/
+class VREXPANSIONPLUGIN_API FGrippableSpatialHash
+{
+public:
+
+	FGrippableSpatialHash(float InCellSize);
+
+	int32 Add(const FVector & Location, float Radius);
+	void Update(int32 Id, const FVector & Location, float Radius);
+	void Remove(int32 Id);
+
+	// Re-buckets every entry if the size changed
+	void SetCellSize(float InCellSize);
+
+	float GetCellSize() const
+	{
+		return CellSize;
+	}
+
+	int32 Num() const
+	{
+		return NumUsedEntries;
+	}
+
+	// Appends the entries whose bounding sphere is within Radius of Location, unsorted
+	void Query(const FVector & Location, float Radius, TArray<FGrippableSpatialHit> & OutHits) const;
+
+private:
+
+	struct FEntry
+	{
+		FVector Location;
+		float Radius;
+		FIntVector Cell;
+
+		// Slot in the cell (or the oversized list) that holds this entry
+		int32 SlotInCell;
+		int32 NextFree;
+		bool bInUse;
+		bool bOversized;
+
+		FEntry() :
+			Location(FVector::ZeroVector),
+			Radius(0.0f),
+			Cell(FIntVector::ZeroValue),
+			SlotInCell(INDEX_NONE),
+			NextFree(INDEX_NONE),
+			bInUse(false),
+			bOversized(false)
+		{}
+	};
+
+	FIntVector GetCell(const FVector & Location) const;
+	void Link(int32 Id);
+	void Unlink(int32 Id);
+	void TestEntry(int32 Id, const FVector & Location, float Radius, TArray<FGrippableSpatialHit> & OutHits) const;
+
+	float CellSize;
+	float InvCellSize;
+
+	TArray<FEntry> Entries;
+	int32 FirstFreeEntry;
+	int32 NumUsedEntries;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+	TArray<int32> Oversized;
+};
+
+/**
+* Per world index of every registered grippable, answers "nearest grippables around this hand" without physics overlaps.
+* Grippables are kept in a FGrippableSpatialHash and moved in it when their tracked component updates its transform.
+* The plugins grippable actors and components register themselves on BeginPlay, blueprint grippables can register with
+* UVRExpansionFunctionLibrary::RegisterGrippableForQueries().
+*/
+class VREXPANSIONPLUGIN_API FGrippableSpatialIndex
+{
+public:
+
+	FGrippableSpatialIndex(UWorld * InWorld);
+	~FGrippableSpatialIndex();
+
+	// Returns the index for the world, creates it if it doesn't exist yet and bCreateIfMissing is set
+	static FGrippableSpatialIndex * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	// Grippable has to implement the grip interface, it is tracked at the location of TrackedComponent
+	// Registering an already registered grippable replaces its entry
+	void Register(UObject * Grippable, USceneComponent * TrackedComponent);
+	void Unregister(UObject * Grippable);
+
+	// Runs all of the queries in one go, OutCandidates[i] holds the grippables for Queries[i] closest first
+	// Grippables that deny gripping are always skipped
+	void QueryNearest(const TArray<FGrippableQuery> & Queries, TArray<TArray<FGrippableQueryCandidate>> & OutCandidates);
+
+	// Queries both hands of every VR character that is controlled by a player controller in this world
+	void QueryPlayerHands(float Radius, int32 MaxResults, bool bIncludeHeld, TArray<FGrippableHandCandidates> & OutHands);
+
+	int32 Num() const
+	{
+		return Hash.Num();
+	}
+
+private:
+
+	struct FTrackedGrippable
+	{
+		TWeakObjectPtr<UObject> Grippable;
+		TWeakObjectPtr<USceneComponent> Component;
+		FObjectKey GrippableKey;
+		FObjectKey ComponentKey;
+		FDelegateHandle TransformUpdatedHandle;
+
+		// Actors use the radius from registration, components refresh theirs from their bounds as they move
+		float ActorRadius;
+		bool bIsActor;
+
+		FTrackedGrippable() :
+			ActorRadius(0.0f),
+			bIsActor(false)
+		{}
+	};
+
+	void RemoveTracked(int32 Id);
+	void RunQuery(const FGrippableQuery & Query, TArray<FGrippableQueryCandidate> & OutCandidates);
+	void OnTransformUpdated(USceneComponent * UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	// Radius around the components location that covers the component bounds
+	static float GetComponentRadius(USceneComponent * Component);
+
+	// Radius around the root components location that covers all of the actors components
+	static float GetActorRadius(AActor * Actor);
+
+	static bool PassesFilters(UObject * Grippable, bool bIncludeHeld);
+
+	TWeakObjectPtr<UWorld> World;
+
+	FGrippableSpatialHash Hash;
+
+	// Indexed by hash id
+	TArray<FTrackedGrippable> Tracked;
+	TMap<FObjectKey, int32> GrippableIds;
+	TMultiMap<FObjectKey, int32> ComponentIds;
+
+	TArray<FGrippableSpatialHit> HitScratch;
+	TArray<FGrippableQuery> QueryScratch;
+};
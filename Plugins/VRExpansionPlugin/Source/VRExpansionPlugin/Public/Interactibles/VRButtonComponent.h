@@ -61,6 +61,8 @@ public:
 	void OnOverlapEnd(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
+	virtual bool IsComponentTickEnabled() const override;
 	virtual void BeginPlay() override;
 
 	UFUNCTION(BlueprintPure, Category = "VRButtonComponent")
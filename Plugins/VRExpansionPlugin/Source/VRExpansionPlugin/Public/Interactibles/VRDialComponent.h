@@ -157,6 +157,8 @@ public:
 		bool bReplicateMovement;
 
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
+	virtual bool IsComponentTickEnabled() const override;
 	virtual void BeginPlay() override;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRGripInterface")
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Engine/EngineBaseTypes.h"
+#include "VRInteractibleTickManager.generated.h"
+
+class FVRInteractibleTickManager;
+class UActorComponent;
+class UWorld;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogVRInteractibleTickManager, Log, All);
+
+// Tick function of a worlds interactible tick manager, only enabled while an interactible is awake
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRInteractibleTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	FVRInteractibleTickManager * Manager;
+
+	FVRInteractibleTickFunction() :
+		Manager(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRInteractibleTickFunction> : public TStructOpsTypeTraitsBase2<FVRInteractibleTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+* Ticks every awake interactible (button, dial, lever, slider, mount) of a world from one tick function instead of one each.
+* The interactibles route SetComponentTickEnabled here, so waking them from grips, overlaps or replication works the same as before,
+* they are ticked in batches of the same class and dropped from the manager when they go back to sleep.
+* With nothing awake the tick function is disabled and idle interactibles cost nothing.
+*/
+class VREXPANSIONPLUGIN_API FVRInteractibleTickManager
+{
+public:
+
+	FVRInteractibleTickManager(UWorld * InWorld);
+	~FVRInteractibleTickManager();
+
+	// Returns the manager for the world, creates it if it doesn't exist yet and bCreateIfMissing is set
+	static FVRInteractibleTickManager * Get(UWorld * World, bool bCreateIfMissing = true);
+
+	// Called from the interactibles SetComponentTickEnabled, returns true if the manager ticks the component while it is awake
+	// Components that return false keep using their own tick function
+	static bool SetAwake(UActorComponent * Component, bool bAwake);
+
+	// Returns if the component is currently ticked by its worlds manager
+	static bool IsAwake(const UActorComponent * Component);
+
+	// Returns if the shared tick can stand in for the components own tick function
+	// Components with tick prerequisites, another tick group or that tick while paused keep their own tick function
+	static bool CanShareTick(UActorComponent * Component);
+
+	void Wake(UActorComponent * Component);
+	void Sleep(UActorComponent * Component);
+	bool IsComponentAwake(const UActorComponent * Component) const;
+
+	int32 NumAwake() const
+	{
+		return AwakeIndices.Num();
+	}
+
+	void Tick(float DeltaTime, ELevelTick TickType);
+
+private:
+
+	struct FAwakeInteractible
+	{
+		TWeakObjectPtr<UActorComponent> Component;
+		FObjectKey Key;
+
+		// Awake interactibles are sorted by class so that the same tick code runs back to back
+		UClass * Class;
+
+		// Time since the interactible was last ticked, used to honor its TickInterval
+		float TimeSinceTick;
+
+		// Cleared when the interactible goes to sleep, the entry is removed the next time the list is compacted
+		bool bAwake;
+	};
+
+	// Removes the sleeping entries and restores the class order
+	void Compact();
+
+	// Drops the entry and hands the still awake component back to its own tick function
+	// The tick function keeps its enabled state while unregistered, so a component that is re-registered picks up ticking again
+	void FallBackToOwnTick(int32 Index, UActorComponent * Component);
+
+	TWeakObjectPtr<UWorld> World;
+
+	FVRInteractibleTickFunction TickFunction;
+
+	TArray<FAwakeInteractible> Awake;
+	TMap<FObjectKey, int32> AwakeIndices;
+
+	bool bNeedsCompact;
+	bool bNeedsSort;
+};
@@ -36,6 +36,56 @@ enum class EVRInteractibleSliderDropBehavior : uint8
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVRSliderHitPointSignature, float, SliderProgressPoint);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVRSliderFinishedLerpingSignature, float, FinalProgress);
 
+/**
+* Arc length table of the spline that a slider follows, sampled at an even distance along the spline.
+* Closest key lookups search outwards from the sample found by the last lookup and then refine on the spline itself,
+* so a gripped slider doesn't search every segment of a long spline each tick.
+*/
+struct VREXPANSIONPLUGIN_API FVRSliderSplineLookup
+{
+	// Spline local space locations and input keys of the samples
+	TArray<FVector> Locations;
+	TArray<float> Keys;
+	float SampleDistance;
+
+	// What the table was built from, compared against the spline to catch changes to it
+	TWeakObjectPtr<USplineComponent> Spline;
+	float SplineLength;
+	int32 NumPoints;
+	FVector FirstPoint;
+	FVector LastPoint;
+	bool bClosedLoop;
+
+	// Sample closest to the last lookup, INDEX_NONE searches every sample
+	int32 LastSample;
+
+	FVRSliderSplineLookup() :
+		SampleDistance(0.0f),
+		SplineLength(0.0f),
+		NumPoints(0),
+		FirstPoint(FVector::ZeroVector),
+		LastPoint(FVector::ZeroVector),
+		bClosedLoop(false),
+		LastSample(INDEX_NONE)
+	{}
+
+	bool IsBuiltFor(const USplineComponent * InSpline) const;
+	void Build(USplineComponent * InSpline);
+	void Reset();
+
+	// Forgets the last lookup, the next one searches the whole table
+	void ResetSeed()
+	{
+		LastSample = INDEX_NONE;
+	}
+
+	// Has to be built for the spline, searches outwards from the last result and refines between the neighbouring samples
+	// Unlike USplineComponent::FindInputKeyClosestToWorldLocation it tracks the closest point near the last one, so it can return a different key where the spline passes close to itself
+	float FindInputKeyClosestToWorldLocation(const USplineComponent * InSpline, const FVector & WorldLocation);
+
+	float GetInputKeyAtDistance(float Distance) const;
+};
+
 /**
 * A slider component, can act like a scroll bar, or gun bolt, or spline following component
 */
@@ -195,6 +245,11 @@ public:
 	void ResetToParentSplineLocation();
 
 	void GetLerpedKey(float &ClosestKey, float DeltaTime);
+
+	// Uses the spline lookup table, rebuilding it first if the spline changed
+	float FindSplineInputKeyClosestToWorldLocation(const FVector & WorldLocation);
+	FVRSliderSplineLookup SplineLookup;
+
 	float GetCurrentSliderProgress(FVector CurLocation, bool bUseKeyInstead = false, float CurKey = 0.f);
 	FVector ClampSlideVector(FVector ValueToClamp);
 
@@ -226,6 +281,8 @@ public:
 		bool bReplicateMovement;
 
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
+	virtual bool IsComponentTickEnabled() const override;
 	virtual void BeginPlay() override;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRGripInterface")
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Subsystems/EngineSubsystem.h"
 #include "Tickable.h"
+#include "UObject/ObjectKey.h"
 #include "BucketUpdateSubsystem.generated.h"
 //#include "GrippablePhysicsReplication.generated.h"
 
@@ -42,6 +43,107 @@ public:
 };
 
 
+USTRUCT(BlueprintType, Category = "BucketUpdateSubsystem")
+struct VREXPANSIONPLUGIN_API FUpdateBucketStats
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "BucketUpdateSubsystem")
+		int32 UpdateHTZ;
+
+	UPROPERTY(BlueprintReadOnly, Category = "BucketUpdateSubsystem")
+		int32 NumEntries;
+
+	// Callbacks that ran on the last update
+	UPROPERTY(BlueprintReadOnly, Category = "BucketUpdateSubsystem")
+		int32 LastFrameCalls;
+
+	// Smoothed over recent updates
+	UPROPERTY(BlueprintReadOnly, Category = "BucketUpdateSubsystem")
+		float AverageCallsPerFrame;
+
+	// Time spent in the callbacks on the last update, in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "BucketUpdateSubsystem")
+		float LastFrameTimeMs;
+
+	// Smoothed over recent updates, in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "BucketUpdateSubsystem")
+		float AverageFrameTimeMs;
+
+	FUpdateBucketStats() :
+		UpdateHTZ(0),
+		NumEntries(0),
+		LastFrameCalls(0),
+		AverageCallsPerFrame(0.0f),
+		LastFrameTimeMs(0.0f),
+		AverageFrameTimeMs(0.0f)
+	{
+	}
+};
+
+// Stable reference to a bucket entry, stays valid until that entry is removed (a re-added entry gets a new handle)
+USTRUCT(BlueprintType, Category = "BucketUpdateSubsystem")
+struct VREXPANSIONPLUGIN_API FUpdateBucketHandle
+{
+	GENERATED_BODY()
+public:
+
+	int32 Index;
+	int32 Serial;
+
+	FUpdateBucketHandle() :
+		Index(INDEX_NONE),
+		Serial(0)
+	{}
+
+	FUpdateBucketHandle(int32 InIndex, int32 InSerial) :
+		Index(InIndex),
+		Serial(InSerial)
+	{}
+
+	bool IsSet() const
+	{
+		return Index != INDEX_NONE;
+	}
+
+	void Invalidate()
+	{
+		Index = INDEX_NONE;
+		Serial = 0;
+	}
+};
+
+// Object and UFUNCTION name that an entry is looked up by
+typedef TPair<FObjectKey, FName> FUpdateBucketEntryKey;
+
+// A callback in the container, entries are pooled and reused through a free list
+struct VREXPANSIONPLUGIN_API FUpdateBucketEntry
+{
+	FUpdateBucketDrop Drop;
+
+	// Lookup keys, the function is NAME_None for dynamic delegates that aren't bound to a UFUNCTION name
+	FObjectKey Object;
+	FName FunctionName;
+	bool bIsDynamic;
+
+	uint32 BucketKey;
+	int32 SlotInBucket;
+
+	// Zero while the entry is free
+	int32 Serial;
+	int32 NextFree;
+
+	FUpdateBucketEntry() :
+		FunctionName(NAME_None),
+		bIsDynamic(false),
+		BucketKey(0),
+		SlotInBucket(INDEX_NONE),
+		Serial(0),
+		NextFree(INDEX_NONE)
+	{}
+};
+
 USTRUCT()
 struct VREXPANSIONPLUGIN_API FUpdateBucket
 {
@@ -50,18 +152,30 @@ struct VREXPANSIONPLUGIN_API FUpdateBucket
 public:
 
 	float nUpdateRate;
-	float nUpdateCount;
 
-	TArray<FUpdateBucketDrop> Callbacks;
+	// Fraction of a callback owed from previous updates, carried over so that the rate doesn't drift with the frame time
+	float PendingCalls;
+
+	// Slot that gets the next turn, each entries phase in the period is its slot in the bucket
+	int32 NextCallback;
 
-	bool Update(float DeltaTime);
+	// Entries in the containers pool, each entry knows its own slot in here
+	TArray<int32> EntryIndices;
 
-	FUpdateBucket() {}
+	FUpdateBucketStats Stats;
+
+	FUpdateBucket() :
+		nUpdateRate(0.0f),
+		PendingCalls(0.0f),
+		NextCallback(0)
+	{}
 
 	FUpdateBucket(uint32 UpdateHTZ) :
 		nUpdateRate(1.0f / UpdateHTZ),
-		nUpdateCount(0.0f)
+		PendingCalls(0.0f),
+		NextCallback(0)
 	{
+		Stats.UpdateHTZ = UpdateHTZ;
 	}
 };
 
@@ -77,8 +191,10 @@ public:
 
 	void UpdateBuckets(float DeltaTime);
 
-	bool AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName);
-	bool AddBucketObject(uint32 UpdateHTZ, FDynamicBucketUpdateTickSignature &Delegate);
+	// Adding, removing and lookups are constant time, if the object / function (or event) is already in a bucket it is replaced
+	// OutHandle can be used to remove the entry later without looking it up
+	bool AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle * OutHandle = nullptr);
+	bool AddBucketObject(uint32 UpdateHTZ, FDynamicBucketUpdateTickSignature &Delegate, FUpdateBucketHandle * OutHandle = nullptr);
 
 	/*
 	template<typename classType>
@@ -89,37 +205,186 @@ public:
 
 	bool RemoveBucketObject(UObject * ObjectToRemove, FName FunctionName);
 	bool RemoveBucketObject(FDynamicBucketUpdateTickSignature &DynEvent);
+	bool RemoveBucketEntry(const FUpdateBucketHandle & Handle);
 	bool RemoveObjectFromAllBuckets(UObject * ObjectToRemove);
 
 	bool IsObjectInBucket(UObject * ObjectToRemove);
 	bool IsObjectFunctionInBucket(UObject * ObjectToRemove, FName FunctionName);
 	bool IsObjectDelegateInBucket(FDynamicBucketUpdateTickSignature &DynEvent);
+	bool IsBucketEntryValid(const FUpdateBucketHandle & Handle) const;
+
+	void GetBucketStats(TArray<FUpdateBucketStats> & OutStats) const;
+
+	int32 GetNumEntries() const
+	{
+		return NumUsedEntries;
+	}
 
 	FUpdateBucketContainer()
 	{
 		bNeedsUpdate = false;
+		FirstFreeEntry = INDEX_NONE;
+		NumUsedEntries = 0;
+		NextSerial = 1;
 	};
 
+private:
+
+	TArray<FUpdateBucketEntry> Entries;
+	int32 FirstFreeEntry;
+	int32 NumUsedEntries;
+	int32 NextSerial;
+
+	TMap<FUpdateBucketEntryKey, int32> NativeEntryLookup;
+	TMap<FUpdateBucketEntryKey, int32> DynamicEntryLookup;
+	TMultiMap<FObjectKey, int32> ObjectEntryLookup;
+
+	FUpdateBucketHandle AddEntry(uint32 UpdateHTZ, FUpdateBucketDrop && Drop, const FObjectKey & Object, FName FunctionName, bool bIsDynamic);
+	void RemoveEntry(int32 EntryIndex);
+	int32 FindEntry(const FObjectKey & Object, FName FunctionName, bool bIsDynamic) const;
+
+	// Every callback runs once per nUpdateRate, spread evenly across the frames of that period instead of all on one frame
+	bool UpdateBucket(uint32 BucketKey, float DeltaTime);
 };
 
-UCLASS()
-class VREXPANSIONPLUGIN_API UBucketUpdateSubsystem : public UEngineSubsystem, public FTickableGameObject
+/**
+* The bucket API shared by UBucketUpdateSubsystem and UBucketUpdateWorldSubsystem, both own one of these and their
+* blueprint functions forward to it. Null objects, unbound events and invalid rates are rejected here.
+*/
+class VREXPANSIONPLUGIN_API FBucketUpdateSubsystemBase
+{
+public:
+
+	FUpdateBucketContainer BucketContainer;
+
+	// Adds an object to an update bucket with the set HTZ, calls the passed in UFUNCTION name
+	// If one of the bucket contains an entry with the function already then the existing one is removed and the new one is added
+	// OutHandle can be used to remove the entry later without looking it up
+	bool AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle * OutHandle = nullptr);
+	bool AddObjectEventToBucket(FDynamicBucketUpdateTickSignature & Delegate, int32 UpdateHTZ, FUpdateBucketHandle * OutHandle = nullptr);
+
+	// Clears the handle
+	bool RemoveBucketEntry(FUpdateBucketHandle & Handle);
+	bool IsBucketEntryValid(const FUpdateBucketHandle & Handle) const;
+
+	bool RemoveObjectFromBucketByFunctionName(UObject* InObject, FName FunctionName);
+	bool RemoveObjectFromBucketByEvent(FDynamicBucketUpdateTickSignature & Delegate);
+	bool RemoveObjectFromAllBuckets(UObject* InObject);
+	bool IsObjectFunctionInBucket(UObject* InObject, FName FunctionName);
+
+	bool IsActive() const
+	{
+		return BucketContainer.bNeedsUpdate;
+	}
+
+	void GetBucketStats(TArray<FUpdateBucketStats> & OutStats) const
+	{
+		BucketContainer.GetBucketStats(OutStats);
+	}
+};
+
+/**
+* Per world version of the bucket update subsystem, it has the same API but only holds the entries of its own world and
+* ticks along with that world, so the buckets of one world never wait on (or get time dilated by) another.
+* Get it with UBucketUpdateWorldSubsystem::Get(), instances are owned by the UBucketUpdateSubsystem and are cleaned up along with their world.
+*/
+UCLASS(BlueprintType)
+class VREXPANSIONPLUGIN_API UBucketUpdateWorldSubsystem : public UObject, public FTickableGameObject, public FBucketUpdateSubsystemBase
 {
 	GENERATED_BODY()
 
 public:
-	UBucketUpdateSubsystem() :
+	UBucketUpdateWorldSubsystem() :
 		Super()
 	{
 
 	}
 
-	//UPROPERTY()
-	FUpdateBucketContainer BucketContainer;
+	// Returns the instance for the world of the passed in object, creates it if it doesn't exist yet and bCreateIfMissing is set
+	static UBucketUpdateWorldSubsystem * Get(const UObject * WorldContextObject, bool bCreateIfMissing = true);
+
+	// Returns the instance for the world of the passed in object, creating it if needed
+	UFUNCTION(BlueprintPure, meta = (WorldContext = "WorldContextObject", DisplayName = "Get Bucket Update World Subsystem", ScriptName = "GetBucketUpdateWorldSubsystem"), Category = "BucketUpdateSubsystem")
+		static UBucketUpdateWorldSubsystem * K2_Get(UObject * WorldContextObject);
+
+	// The native AddObjectToBucket (with an optional handle) and BucketContainer come from FBucketUpdateSubsystemBase
 
 	// Adds an object to an update bucket with the set HTZ, calls the passed in UFUNCTION name
 	// If one of the bucket contains an entry with the function already then the existing one is removed and the new one is added
-	bool AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName);
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates", ScriptName = "AddObjectToBucket"), Category = "BucketUpdateSubsystem")
+		bool K2_AddObjectToBucket(int32 UpdateHTZ = 100, UObject* InObject = nullptr, FName FunctionName = NAME_None);
+
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates by Event", ScriptName = "AddBucketObjectEvent"), Category = "BucketUpdateSubsystem")
+		bool K2_AddObjectEventToBucket(UPARAM(DisplayName = "Event") FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ = 100);
+
+	// Same as Add Object to Bucket Updates, also returns a handle that can remove the entry later without looking it up
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates With Handle", ScriptName = "AddObjectToBucketWithHandle"), Category = "BucketUpdateSubsystem")
+		bool K2_AddObjectToBucketWithHandle(int32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle & OutHandle);
+
+	// Same as Add Object to Bucket Updates by Event, also returns a handle that can remove the entry later without looking it up
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates by Event With Handle", ScriptName = "AddBucketObjectEventWithHandle"), Category = "BucketUpdateSubsystem")
+		bool K2_AddObjectEventToBucketWithHandle(UPARAM(DisplayName = "Event") FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ, FUpdateBucketHandle & OutHandle);
+
+	// Removes the entry that the handle was returned for, the handle is cleared
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Remove Bucket Entry By Handle", ScriptName = "RemoveBucketEntry"), Category = "BucketUpdateSubsystem")
+		bool RemoveBucketEntry(UPARAM(ref) FUpdateBucketHandle & Handle);
+
+	// Returns if the entry that the handle was returned for is still in a bucket
+	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
+		bool IsBucketEntryValid(const FUpdateBucketHandle & Handle);
+
+	// Remove the entry in the bucket updates with the passed in UFUNCTION name
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Remove Object From Bucket Updates By Function", ScriptName = "RemoveObjectFromBucketByFunction"), Category = "BucketUpdateSubsystem")
+		bool RemoveObjectFromBucketByFunctionName(UObject* InObject = nullptr, FName FunctionName = NAME_None);
+
+	// Remove the entry in the bucket updates with the passed in UFUNCTION name
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Remove Object From Bucket Updates By Event", ScriptName = "RemoveObjectFromBucketByEvent"), Category = "BucketUpdateSubsystem")
+		bool RemoveObjectFromBucketByEvent(UPARAM(DisplayName = "Event") FDynamicBucketUpdateTickSignature Delegate);
+
+	// Removes ALL entries in the bucket update system with the specified object
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Remove Object From All Bucket Updates", ScriptName = "RemoveObjectFromAllBuckets"), Category = "BucketUpdateSubsystem")
+		bool RemoveObjectFromAllBuckets(UObject* InObject = nullptr);
+
+	// Returns if an update bucket contains an entry with the passed in function
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Is Object In Bucket", ScriptName = "IsObjectInBucket"), Category = "BucketUpdateSubsystem")
+		bool IsObjectFunctionInBucket(UObject* InObject = nullptr, FName FunctionName = NAME_None);
+
+	// Returns if an update bucket contains an entry with the passed in function
+	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
+		bool IsActive();
+
+	// Gets the entry count, calls per frame and time spent of every active bucket
+	UFUNCTION(BlueprintCallable, Category = "BucketUpdateSubsystem")
+		void GetBucketStats(TArray<FUpdateBucketStats> & OutStats);
+
+	// FTickableGameObject functions
+	// Ticked by the owning worlds tick with its (dilated) delta time
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual bool IsTickableInEditor() const;
+	virtual bool IsTickableWhenPaused() const override;
+	virtual ETickableTickType GetTickableTickType() const;
+	virtual TStatId GetStatId() const override;
+
+	// End tickable object information
+
+};
+
+UCLASS()
+class VREXPANSIONPLUGIN_API UBucketUpdateSubsystem : public UEngineSubsystem, public FTickableGameObject, public FBucketUpdateSubsystemBase
+{
+	GENERATED_BODY()
+
+public:
+	UBucketUpdateSubsystem() :
+		Super()
+	{
+
+	}
+
+	// The native AddObjectToBucket (with an optional handle) and BucketContainer come from FBucketUpdateSubsystemBase
 
 	// Adds an object to an update bucket with the set HTZ, calls the passed in UFUNCTION name
 	// If one of the bucket contains an entry with the function already then the existing one is removed and the new one is added
@@ -129,6 +394,22 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates by Event", ScriptName = "AddBucketObjectEvent"), Category = "BucketUpdateSubsystem")
 		bool K2_AddObjectEventToBucket(UPARAM(DisplayName = "Event") FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ = 100);
 
+	// Same as Add Object to Bucket Updates, also returns a handle that can remove the entry later without looking it up
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates With Handle", ScriptName = "AddObjectToBucketWithHandle"), Category = "BucketUpdateSubsystem")
+		bool K2_AddObjectToBucketWithHandle(int32 UpdateHTZ, UObject* InObject, FName FunctionName, FUpdateBucketHandle & OutHandle);
+
+	// Same as Add Object to Bucket Updates by Event, also returns a handle that can remove the entry later without looking it up
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates by Event With Handle", ScriptName = "AddBucketObjectEventWithHandle"), Category = "BucketUpdateSubsystem")
+		bool K2_AddObjectEventToBucketWithHandle(UPARAM(DisplayName = "Event") FDynamicBucketUpdateTickSignature Delegate, int32 UpdateHTZ, FUpdateBucketHandle & OutHandle);
+
+	// Removes the entry that the handle was returned for, the handle is cleared
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Remove Bucket Entry By Handle", ScriptName = "RemoveBucketEntry"), Category = "BucketUpdateSubsystem")
+		bool RemoveBucketEntry(UPARAM(ref) FUpdateBucketHandle & Handle);
+
+	// Returns if the entry that the handle was returned for is still in a bucket
+	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
+		bool IsBucketEntryValid(const FUpdateBucketHandle & Handle);
+
 	// Remove the entry in the bucket updates with the passed in UFUNCTION name
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Remove Object From Bucket Updates By Function", ScriptName = "RemoveObjectFromBucketByFunction"), Category = "BucketUpdateSubsystem")
 		bool RemoveObjectFromBucketByFunctionName(UObject* InObject = nullptr, FName FunctionName = NAME_None);
@@ -149,6 +430,22 @@ public:
 	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
 		bool IsActive();
 
+	// Gets the entry count, calls per frame and time spent of every active bucket
+	UFUNCTION(BlueprintCallable, Category = "BucketUpdateSubsystem")
+		void GetBucketStats(TArray<FUpdateBucketStats> & OutStats);
+
+	// Gets the per world instance for InWorld, see UBucketUpdateWorldSubsystem::Get()
+	UBucketUpdateWorldSubsystem * GetWorldSubsystem(UWorld * InWorld, bool bCreateIfMissing = true);
+
+	// Returns all of the currently existing per world instances
+	const TArray<UBucketUpdateWorldSubsystem*> & GetWorldSubsystems() const
+	{
+		return WorldSubsystems;
+	}
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
 	// FTickableGameObject functions
 	/**
 	 * Function called every frame on this GripScript. Override this function to implement custom logic to be executed every frame.
@@ -167,4 +464,12 @@ public:
 
 	// End tickable object information
 
+private:
+
+	void OnWorldCleanup(UWorld * World, bool bSessionEnded, bool bCleanupResources);
+
+	UPROPERTY()
+		TArray<UBucketUpdateWorldSubsystem*> WorldSubsystems;
+
+	FDelegateHandle OnWorldCleanupHandle;
 };
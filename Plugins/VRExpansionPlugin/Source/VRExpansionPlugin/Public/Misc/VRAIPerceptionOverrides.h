@@ -7,6 +7,7 @@
 #include "AIModule/Classes/GenericTeamAgentInterface.h"
 #include "AIModule/Classes/Perception/AISense.h"
 #include "AIModule/Classes/Perception/AISenseConfig.h"
+#include "WorldCollision.h"
 
 #include "VRAIPerceptionOverrides.generated.h"
 
@@ -48,6 +49,18 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Sense", config, meta = (UIMin = 0.0, ClampMin = 0.0))
 		float AutoSuccessRangeFromLastSeenLocation;
 
+	/** Trace to the VR characters body (the HMD offset capsule location), if none of the VR points are enabled only the body is traced to. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Sense|VR", config)
+		bool bTraceToVRBody;
+
+	/** Trace to the VR characters HMD, a VR character is seen if any of its enabled points is visible. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Sense|VR", config)
+		bool bTraceToVRHead;
+
+	/** Trace to both of the VR characters motion controllers. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Sense|VR", config)
+		bool bTraceToVRHands;
+
 	virtual TSubclassOf<UAISense> GetSenseImplementation() const override;
 
 #if WITH_GAMEPLAY_DEBUGGER
@@ -113,6 +126,19 @@ struct FAISightTargetVR
 	FORCEINLINE const AActor* GetTargetActor() const { return Target.Get(); }
 };
 
+// Points on VR characters that sight traces to, the body is the only point of other targets
+namespace EVRSightTargetPoint
+{
+	enum Type
+	{
+		Body,
+		Head,
+		LeftHand,
+		RightHand,
+		Count
+	};
+}
+
 struct FAISightQueryVR
 {
 	FPerceptionListenerID ObserverId;
@@ -124,13 +150,54 @@ struct FAISightQueryVR
 
 	FVector LastSeenLocation;
 
+	// Async line of sight traces that were issued for this query and haven't been consumed yet, per target point, with the locations they were traced to
+	FTraceHandle TraceHandles[EVRSightTargetPoint::Count];
+	FVector TraceTargetLocations[EVRSightTargetPoint::Count];
+
+	// Occlusion cache, the point that was visible on the last check is traced first and a target that stays visible costs a single trace
+	uint8 LastVisiblePoint;
+
+	// EVRSightTargetPoint bits of the follow up traces that didn't fit in an earlier updates trace budget yet
+	uint8 PendingPointMask;
+
 	uint32 bLastResult : 1;
 
+	// The in flight traces are to the points that weren't traced first
+	uint32 bTracingOtherPoints : 1;
+
 	FAISightQueryVR(FPerceptionListenerID ListenerId = FPerceptionListenerID::InvalidID(), FAISightTargetVR::FTargetId Target = FAISightTargetVR::InvalidTargetId)
-		: ObserverId(ListenerId), TargetId(Target), Age(0), Score(0), Importance(0), LastSeenLocation(FAISystem::InvalidLocation), bLastResult(false)
+		: ObserverId(ListenerId), TargetId(Target), Age(0), Score(0), Importance(0), LastSeenLocation(FAISystem::InvalidLocation), LastVisiblePoint(EVRSightTargetPoint::Body), PendingPointMask(0), bLastResult(false), bTracingOtherPoints(false)
 	{
 	}
 
+	bool HasTracesInFlight() const
+	{
+		for (const FTraceHandle& Handle : TraceHandles)
+		{
+			if (Handle.IsValid())
+				return true;
+		}
+
+		return false;
+	}
+
+	// Waiting on traces in flight or on follow up traces that still have to be issued
+	bool HasPendingTraces() const
+	{
+		return PendingPointMask != 0 || HasTracesInFlight();
+	}
+
+	void ClearTraces()
+	{
+		for (FTraceHandle& Handle : TraceHandles)
+		{
+			Handle = FTraceHandle();
+		}
+
+		PendingPointMask = 0;
+		bTracingOtherPoints = false;
+	}
+
 	void RecalcScore()
 	{
 		Score = Age + Importance;
@@ -169,6 +236,9 @@ public:
 		float LoseSightRadiusSq;
 		uint8 AffiliationFlags;
 
+		// Bits of the EVRSightTargetPoint values to trace to on VR characters
+		uint8 VRSightPointMask;
+
 		FDigestedSightProperties();
 		FDigestedSightProperties(const UAISenseConfig_Sight_VR& SenseConfig);
 	};
@@ -189,6 +259,14 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "AI Perception", config)
 		double MaxTimeSlicePerTick;
 
+	/** Issue the line of sight traces of targets without a sight target interface through the async trace API, their results are consumed on the next update */
+	UPROPERTY(EditDefaultsOnly, Category = "AI Perception", config)
+		bool bUseAsyncTraces;
+
+	/** Async traces are only issued on the game thread, so many more of them fit in a tick than synchronous ones */
+	UPROPERTY(EditDefaultsOnly, Category = "AI Perception", config, meta = (EditCondition = "bUseAsyncTraces"))
+		int32 MaxAsyncTracesPerTick;
+
 	UPROPERTY(EditDefaultsOnly, Category = "AI Perception", config)
 		float HighImportanceQueryDistanceThreshold;
 
@@ -213,6 +291,10 @@ public:
 	virtual void CleanseInvalidSources() override;
 
 	virtual void OnListenerForgetsActor(const FPerceptionListener& Listener, AActor& ActorToForget) override;
+
+	/** Switches between async and synchronous line of sight traces, traces already in flight are still consumed */
+	void SetUseAsyncTraces(bool bNewUseAsyncTraces) { bUseAsyncTraces = bNewUseAsyncTraces; }
+	bool GetUseAsyncTraces() const { return bUseAsyncTraces; }
 	virtual void OnListenerForgetsAll(const FPerceptionListener& Listener) override;
 
 protected:
@@ -240,4 +322,12 @@ protected:
 	FORCEINLINE void SortQueries() { SightQueryQueue.Sort(FAISightQueryVR::FSortPredicate()); }
 
 	float CalcQueryImportance(const FPerceptionListener& Listener, const FVector& TargetLocation, const float SightRadiusSq) const;
+
+	/** Registers the stimulus for a line of sight check, SeenLocation is the target point that was visible (or the targets location if none were) */
+	void RegisterLineOfSightResult(FPerceptionListener& Listener, FAISightQueryVR& SightQuery, AActor* TargetActor, const FVector& SeenLocation, bool bVisible);
+
+	/** Applies the results of the queries async traces if they are ready, returns false if they are still in flight.
+	*	If the first point turned out to be blocked this issues the traces to the rest of the targets points and returns false.
+	*	Those count against MaxAsyncTracesPerTick, the ones that don't fit stay pending and are issued on a later update. */
+	bool ConsumeAsyncTrace(UWorld* World, AIPerception::FListenerMap& ListenersMap, FAISightQueryVR& SightQuery, int32& AsyncTracesCount);
 };
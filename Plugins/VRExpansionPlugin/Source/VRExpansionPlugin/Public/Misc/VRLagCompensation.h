@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "VRLagCompensation.generated.h"
+
+class AVRBaseCharacter;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogVRLagCompensation, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("VRLagCompensation"), STATGROUP_VRLagCompensation, STATCAT_Advanced);
+
+// A single recorded frame of a characters hit shapes, everything is in world space
+struct VREXPANSIONPLUGIN_API FVRRewindFrame
+{
+	float ServerTime;
+
+	FVector CapsuleLocation;
+	FQuat CapsuleRotation;
+	float CapsuleRadius;
+	float CapsuleHalfHeight;
+
+	FTransform HeadTransform;
+	FTransform LeftHandTransform;
+	FTransform RightHandTransform;
+
+	// Interpolates all of the shapes between two frames
+	static void Blend(const FVRRewindFrame & From, const FVRRewindFrame & To, float Alpha, FVRRewindFrame & OutFrame);
+};
+
+/**
+* Fixed size ring of FVRRewindFrame, allocated once so that the memory per character is bounded.
+* Frames are recorded in ascending server time.
+*/
+struct VREXPANSIONPLUGIN_API FVRRewindHistory
+{
+	FVRRewindHistory() :
+		NewestIndex(INDEX_NONE),
+		NumFrames(0)
+	{}
+
+	void Init(int32 Capacity);
+	void Empty();
+
+	void Record(const FVRRewindFrame & Frame);
+
+	// Gets the interpolated frame at ServerTime, clamps to the oldest / newest frame if outside of the history
+	// Returns false if nothing has been recorded
+	bool GetFrameAtTime(float ServerTime, FVRRewindFrame & OutFrame) const;
+
+	int32 Num() const
+	{
+		return NumFrames;
+	}
+
+	bool IsInitialized() const
+	{
+		return Frames.Num() > 0;
+	}
+
+private:
+
+	const FVRRewindFrame & GetFrame(int32 Age) const
+	{
+		return Frames[(NewestIndex - Age + Frames.Num()) % Frames.Num()];
+	}
+
+	TArray<FVRRewindFrame> Frames;
+	int32 NewestIndex;
+	int32 NumFrames;
+};
+
+/**
+* Server side estimate of the offset between a clients move time stamps and server world time.
+* Fed from every move that passes VerifyClientTimeStamp, it keeps a smoothed minimum of (server time - time stamp) so
+* that it follows the least delayed moves, that is the clock offset plus the fastest upstream trip.
+*/
+struct VREXPANSIONPLUGIN_API FVRClientTimeStampOffset
+{
+	float Offset;
+	float NewestTimeStamp;
+	bool bIsValid;
+
+	FVRClientTimeStampOffset()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		Offset = 0.0f;
+		NewestTimeStamp = 0.0f;
+		bIsValid = false;
+	}
+
+	// A time stamp more than ResetThreshold behind the newest one is a client time stamp reset and restarts the estimate
+	void AddVerifiedTimeStamp(float ClientTimeStamp, float ServerTime, float ResetThreshold);
+
+	// Server time at which the client was at ClientTimeStamp. The offset includes the upstream trip, so the one way
+	// latency is taken back out of it. Never later than CurrentTime.
+	float GetServerTime(float ClientTimeStamp, float OneWayLatency, float CurrentTime) const;
+};
+
+UENUM(BlueprintType)
+enum class EVRRewindHitZone : uint8
+{
+	// Didn't hit anything
+	None,
+	// Hit the world (or anything that isn't a rewound character)
+	World,
+	// Hit a characters capsule
+	Body,
+	// Hit a characters HMD sphere
+	Head,
+	// Hit a characters left hand sphere
+	LeftHand,
+	// Hit a characters right hand sphere
+	RightHand
+};
+
+USTRUCT(BlueprintType, Category = "VRLagCompensation")
+struct VREXPANSIONPLUGIN_API FVRRewindTraceRequest
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRLagCompensation")
+		FVector Start;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRLagCompensation")
+		FVector End;
+
+	FVRRewindTraceRequest() :
+		Start(FVector::ZeroVector),
+		End(FVector::ZeroVector)
+	{}
+
+	FVRRewindTraceRequest(const FVector & InStart, const FVector & InEnd) :
+		Start(InStart),
+		End(InEnd)
+	{}
+};
+
+USTRUCT(BlueprintType, Category = "VRLagCompensation")
+struct VREXPANSIONPLUGIN_API FVRRewindTraceResult
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRLagCompensation")
+		EVRRewindHitZone HitZone;
+
+	// Character that was hit, null if the trace hit the world or nothing
+	UPROPERTY(BlueprintReadOnly, Category = "VRLagCompensation")
+		AVRBaseCharacter * HitCharacter;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRLagCompensation")
+		FVector Location;
+
+	UPROPERTY(BlueprintReadOnly, Category = "VRLagCompensation")
+		float Distance;
+
+	// Filled in if the world trace was the closest hit
+	UPROPERTY(BlueprintReadOnly, Category = "VRLagCompensation")
+		FHitResult WorldHit;
+
+	FVRRewindTraceResult() :
+		HitZone(EVRRewindHitZone::None),
+		HitCharacter(nullptr),
+		Location(FVector::ZeroVector),
+		Distance(0.0f)
+	{}
+};
+
+/**
+* Server side lag compensation for VR characters.
+* Characters with bRecordRewindHistory record their capsule, HMD and hand transforms every frame, these functions trace
+* against those shapes as they were at a past time (the world itself is traced in its current state).
+* All traces in a batch share one rewind of every character, so batch them when possible.
+*/
+UCLASS()
+class VREXPANSIONPLUGIN_API UVRLagCompensationLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	// Traces against the characters as the instigating client saw them when it sent the move with ClientTimeStamp.
+	// That is the server time of the time stamp, minus the instigators one way latency (what it was seeing was already
+	// that old when it arrived), minus InterpolationDelay for the instigators remote smoothing (the playout delay of the
+	// pose buffer for example). The rewind is limited to the instigators MaxRewindTime.
+	UFUNCTION(BlueprintCallable, Category = "VRLagCompensation", meta = (WorldContext = "WorldContextObject", AutoCreateRefTerm = "Traces"))
+		static void LagCompensatedTraces(UObject* WorldContextObject, AVRBaseCharacter * Instigator, float ClientTimeStamp, float InterpolationDelay, const TArray<FVRRewindTraceRequest> & Traces, TArray<FVRRewindTraceResult> & OutResults, TEnumAsByte<ECollisionChannel> WorldTraceChannel, bool bTraceWorld = true);
+
+	// Traces against the characters as they were at ServerTime (world time seconds on the server)
+	UFUNCTION(BlueprintCallable, Category = "VRLagCompensation", meta = (WorldContext = "WorldContextObject", AutoCreateRefTerm = "Traces"))
+		static void LagCompensatedTracesAtTime(UObject* WorldContextObject, AVRBaseCharacter * Instigator, float ServerTime, const TArray<FVRRewindTraceRequest> & Traces, TArray<FVRRewindTraceResult> & OutResults, TEnumAsByte<ECollisionChannel> WorldTraceChannel, bool bTraceWorld = true);
+};
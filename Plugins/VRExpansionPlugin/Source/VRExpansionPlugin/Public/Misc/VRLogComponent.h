@@ -8,6 +8,7 @@
 #include "Engine/Console.h"
 #include "Framework/Text/TextRange.h"
 #include "Core/Public/Misc/OutputDeviceHelper.h"
+#include "HAL/ThreadSafeBool.h"
 #include "VRLogComponent.generated.h"
 
 /**
@@ -22,171 +23,88 @@ enum class EBPVRConsoleDrawType : uint8
 };
 
 
-/**
-* A single log message for the output log, holding a message and
-* a style, for color and bolding of the message.
-*/
-struct FVRLogMessage
+// A single line of the output log history, copied out of the history for drawing
+struct FVRLogLine
 {
-	TSharedRef<FString> Message;
+	FString Text;
 	ELogVerbosity::Type Verbosity;
 	FName Category;
-	FName Style;
 
-	FVRLogMessage(const TSharedRef<FString>& NewMessage, FName NewCategory, FName NewStyle = NAME_None)
-		: Message(NewMessage)
-		, Verbosity(ELogVerbosity::Log)
-		, Category(NewCategory)
-		, Style(NewStyle)
-	{
-	}
+	// Only the first line of a message gets the verbosity / category prefix when drawn
+	bool bFirstLineInMessage;
 
-	FVRLogMessage(const TSharedRef<FString>& NewMessage, ELogVerbosity::Type NewVerbosity, FName NewCategory, FName NewStyle = NAME_None)
-		: Message(NewMessage)
-		, Verbosity(NewVerbosity)
-		, Category(NewCategory)
-		, Style(NewStyle)
+	FVRLogLine()
+		: Verbosity(ELogVerbosity::Log)
+		, bFirstLineInMessage(true)
 	{
 	}
 };
 
 // Custom Log output history class to hold the VR logs.
-/** This class is to capture all log output even if the log window is closed */
-class FVROutputLogHistory : public FOutputDevice
+/** This class is to capture all log output even if the log window is closed
+* Lines are kept in a fixed size ring with their text in a fixed size arena, so logging doesn't allocate and old lines are
+* dropped in constant time. Logging can come in from any thread, everything is behind a lock that is only held for the copy.
+* Lines are stored as they were logged, wrapping to MaxLineLength is left to drawing.
+*/
+class VREXPANSIONPLUGIN_API FVROutputLogHistory : public FOutputDevice
 {
 public:
 
-	int32 MaxStoredMessages;
-	bool bIsDirty;
+	FThreadSafeBool bIsDirty;
 	int32 MaxLineLength;
 
-	FVROutputLogHistory()
-	{
-		MaxLineLength = 130;
-		bIsDirty = false;
-		MaxStoredMessages = 1000;
-		GLog->AddOutputDevice(this);
-		GLog->SerializeBacklog(this);
-	}
+	FVROutputLogHistory();
+	~FVROutputLogHistory();
+
+	// Resizes the ring (and the text arena along with it), keeps the newest lines that still fit
+	void SetMaxStoredMessages(int32 NewMaxStoredMessages);
 
-	~FVROutputLogHistory()
+	int32 GetMaxStoredMessages() const
 	{
-		// At shutdown, GLog may already be null
-		if (GLog != NULL)
-		{
-			GLog->RemoveOutputDevice(this);
-		}
+		return MaxStoredMessages;
 	}
 
-	/** Gets all captured messages */
-	const TArray< TSharedPtr<FVRLogMessage> >& GetMessages() const
+	/** Number of lines currently stored */
+	int32 Num() const;
+
+	// Copies up to MaxLines lines out newest first, after skipping the newest SkipCount lines
+	void CopyRecentLines(int32 SkipCount, int32 MaxLines, TArray<FVRLogLine> & OutLines) const;
+
+	void Empty();
+
+	virtual bool CanBeUsedOnAnyThread() const override
 	{
-		return Messages;
+		return true;
 	}
 
 protected:
 
-	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category) override
-	{
-		// Capture all incoming messages and store them in history
-		CreateLogMessages(V, Verbosity, Category, Messages);
-	}
+	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category) override;
 
-	bool CreateLogMessages(const TCHAR* V, ELogVerbosity::Type Verbosity, const class FName& Category, TArray< TSharedPtr<FVRLogMessage> >& OutMessages)
+private:
+
+	struct FEntry
 	{
-		if (Verbosity == ELogVerbosity::SetColor)
-		{
-			// Skip Color Events
-			return false;
-		}
-		else
-		{
-			FName Style;
-			if (Category == NAME_Cmd)
-			{
-				Style = FName(TEXT("Log.Command"));
-			}
-			else if (Verbosity == ELogVerbosity::Error)
-			{
-				Style = FName(TEXT("Log.Error"));
-			}
-			else if (Verbosity == ELogVerbosity::Warning)
-			{
-				Style = FName(TEXT("Log.Warning"));
-			}
-			else
-			{
-				Style = FName(TEXT("Log.Normal"));
-			}
-
-			// Forget timestamps, I don't care about them and we have limited texture space to draw too
-			// Determine how to format timestamps
-			static ELogTimes::Type LogTimestampMode = ELogTimes::None;
-			/*if (UObjectInitialized() && !GExitPurge)
-			{
-			// Logging can happen very late during shutdown, even after the UObject system has been torn down, hence the init check above
-			LogTimestampMode = GetDefault<UEditorStyleSettings>()->LogTimestampMode;
-			}*/
-
-			const int32 OldNumMessages = OutMessages.Num();
-
-			// handle multiline strings by breaking them apart by line
-			TArray<FTextRange> LineRanges;
-			FString CurrentLogDump = V;
-			FTextRange::CalculateLineRangesFromString(CurrentLogDump, LineRanges);
-
-			bool bIsFirstLineInMessage = true;
-			for (const FTextRange& LineRange : LineRanges)
-			{
-				if (!LineRange.IsEmpty())
-				{
-					FString Line = CurrentLogDump.Mid(LineRange.BeginIndex, LineRange.Len());
-					Line = Line.ConvertTabsToSpaces(4);
-
-					// Hard-wrap lines to avoid them being too long
-					/*static const */int32 HardWrapLen = MaxLineLength;
-					for (int32 CurrentStartIndex = 0; CurrentStartIndex < Line.Len();)
-					{
-						int32 HardWrapLineLen = 0;
-						if (bIsFirstLineInMessage)
-						{
-							FString MessagePrefix = FOutputDeviceHelper::FormatLogLine(Verbosity, Category, nullptr, LogTimestampMode);
-
-							HardWrapLineLen = FMath::Min(HardWrapLen - MessagePrefix.Len(), Line.Len() - CurrentStartIndex);
-							FString HardWrapLine = Line.Mid(CurrentStartIndex, HardWrapLineLen);
-
-							OutMessages.Add(MakeShareable(new FVRLogMessage(MakeShareable(new FString(MessagePrefix + HardWrapLine)), Verbosity, Category, Style)));
-						}
-						else
-						{
-							HardWrapLineLen = FMath::Min(HardWrapLen, Line.Len() - CurrentStartIndex);
-							FString HardWrapLine = Line.Mid(CurrentStartIndex, HardWrapLineLen);
-
-							OutMessages.Add(MakeShareable(new FVRLogMessage(MakeShareable(new FString(MoveTemp(HardWrapLine))), Verbosity, Category, Style)));
-						}
-
-						bIsFirstLineInMessage = false;
-						CurrentStartIndex += HardWrapLineLen;
-					}
-				}
-			}
-
-			int numMessages = OutMessages.Num();
-			if (numMessages > MaxStoredMessages)
-			{
-				OutMessages.RemoveAt(0, numMessages - MaxStoredMessages, true);
-			}
-			if (OldNumMessages != numMessages)
-				bIsDirty = true;
-
-			return OldNumMessages != numMessages;//OutMessages.Num();
-		}
-	}
+		// Position in the arena in characters written since it was created, wraps with the arena size
+		int64 TextStart;
+		int32 TextLength;
+		ELogVerbosity::Type Verbosity;
+		FName Category;
+		bool bFirstLineInMessage;
+	};
 
-private:
+	void AddLine_Locked(const TCHAR* Text, int32 Length, ELogVerbosity::Type Verbosity, const FName& Category, bool bFirstLineInMessage);
+
+	mutable FCriticalSection CriticalSection;
+
+	TArray<FEntry> Entries;
+	int32 OldestEntry;
+	int32 NumEntries;
 
-	/** All log messages since this module has been started */
-	TArray< TSharedPtr<FVRLogMessage> > Messages;
+	TArray<TCHAR> TextArena;
+	int64 TextHead;
+
+	int32 MaxStoredMessages;
 };
 
 /**
@@ -209,7 +127,7 @@ public:
 	virtual void PostInitProperties() override
 	{
 		Super::PostInitProperties();
-		OutputLogHistory.MaxStoredMessages = FMath::Clamp(MaxStoredMessages, 100, 100000);
+		OutputLogHistory.SetMaxStoredMessages(FMath::Clamp(MaxStoredMessages, 100, 100000));
 		OutputLogHistory.MaxLineLength = FMath::Clamp(MaxLineLength, 50, 1000);
 	}
 
@@ -48,6 +48,13 @@ public:
 	UPROPERTY(EditDefaultsOnly, ReplicatedUsing = OnRep_ReplicatedCameraTransform, Category = "ReplicatedCamera|Networking")
 	FBPVRComponentPosRep ReplicatedCameraTransform;
 
+	// Keyframe history for when ReplicatedCameraTransform.bDeltaCompressToServer is enabled
+	FBPVRPosRepDeltaState CameraTransformDeltaState;
+
+	// Last delta keyframe that the server received, replicated back to the owner so it knows what it can delta against
+	UPROPERTY(Replicated)
+	uint8 CameraTransformAckedKeyframe;
+
 	FVector LastUpdatesRelativePosition;
 	FRotator LastUpdatesRelativeRotation;
 
@@ -57,13 +64,27 @@ public:
 	// Whether to smooth (lerp) between ticks for the replicated motion, DOES NOTHING if update rate is larger than FPS!
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "ReplicatedCamera|Networking")
 		bool bSmoothReplicatedMotion;
+
+	// Whether to play remote motion back through ReplicatedPoseBuffer instead of lerping towards the newest update, requires bSmoothReplicatedMotion
+	// Adds the buffers PlayoutDelay in latency but rides out jitter and late or lost updates without hitching
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplicatedCamera|Networking")
+		bool bUsePoseInterpolationBuffer;
+
+	// Playout buffer settings and stats for remote motion when bUsePoseInterpolationBuffer is enabled
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplicatedCamera|Networking")
+		FBPVRPoseInterpolationBuffer ReplicatedPoseBuffer;
 	
 	UFUNCTION()
 	virtual void OnRep_ReplicatedCameraTransform()
 	{
 		if (bSmoothReplicatedMotion)
 		{
-			if (bReppedOnce)
+			if (bUsePoseInterpolationBuffer && ReplicatedCameraTransform.bHasSendTimeStamp)
+			{
+				ReplicatedPoseBuffer.AddSample(ReplicatedCameraTransform.Position, ReplicatedCameraTransform.Rotation, ReplicatedCameraTransform.SendTimeStamp, FPlatformTime::Seconds());
+				bLerpingPosition = true;
+			}
+			else if (bReppedOnce)
 			{
 				bLerpingPosition = true;
 				NetUpdateCount = 0.0f;
@@ -494,6 +494,47 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = Replication, AdvancedDisplay)
 		EVRRotationQuantization RotationQuantizationLevel;
 
+	// If true then sends from the owning client to the server are delta encoded against the last keyframe that the
+	// server acknowledged, rotations are sent with smallest three instead of euler shorts.
+	// Replication from the server back out to other clients is always a full snapshot.
+	UPROPERTY(EditDefaultsOnly, Category = Replication, AdvancedDisplay)
+		bool bDeltaCompressToServer;
+
+	// Not editable, set by FBPVRPosRepDeltaState before a send and consumed by it on the server
+	// If true then the position is serialized relative to keyframe KeyframeID
+	bool bIsDeltaFrame;
+
+	// If true then this delta frame also defines keyframe KeyframeID (position is absolute)
+	bool bIsKeyframe;
+
+	// Keyframe this delta frame defines or references, 0 - (VRPOSREP_MAX_KEYFRAMES - 1)
+	uint8 KeyframeID;
+
+	// Sending side only, the net quantized position of the keyframe this delta frame references
+	FVector DeltaBaseline;
+
+	// Senders real time clock when the pose was sampled, in milliseconds wrapping every 65.536 seconds
+	// Only serialized if bHasSendTimeStamp is set, it is kept through the server so that remote FBPVRPoseInterpolationBuffers
+	// can place poses by when they were sampled instead of when they happened to arrive
+	uint16 SendTimeStamp;
+
+	// Not editable, set by SetSendTime and serialized as a single bit so that sends without a stamp don't pay for one
+	bool bHasSendTimeStamp;
+
+	// Stamps the pose with the senders clock, call whenever the position and rotation are updated for sending
+	void SetSendTime(double Seconds)
+	{
+		SendTimeStamp = (uint16)((uint64)(Seconds * 1000.0) & 0xFFFF);
+		bHasSendTimeStamp = true;
+	}
+
+	// Sends the pose without a time stamp, for when nothing plays it back through an interpolation buffer
+	void ClearSendTime()
+	{
+		SendTimeStamp = 0;
+		bHasSendTimeStamp = false;
+	}
+
 	FORCEINLINE uint16 CompressAxisTo10BitShort(float Angle)
 	{
 		// map [0->360) to [0->1024) and mask off any winding
@@ -509,13 +550,26 @@ public:
 
 	FBPVRComponentPosRep():
 		QuantizationLevel(EVRVectorQuantization::RoundTwoDecimals),
-		RotationQuantizationLevel(EVRRotationQuantization::RoundToShort)
+		RotationQuantizationLevel(EVRRotationQuantization::RoundToShort),
+		bDeltaCompressToServer(false),
+		bIsDeltaFrame(false),
+		bIsKeyframe(false),
+		KeyframeID(0),
+		SendTimeStamp(0),
+		bHasSendTimeStamp(false)
 	{
 		//QuantizationLevel = EVRVectorQuantization::RoundTwoDecimals;
 		Position = FVector::ZeroVector;
 		Rotation = FRotator::ZeroRotator;
+		DeltaBaseline = FVector::ZeroVector;
 	}
 
+	// Serializes the delta compressed version of this struct, position is relative to DeltaBaseline unless it is a keyframe
+	bool NetSerializeDelta(FArchive& Ar);
+
+	// Adds this send to the VRPoseNet stat counters, only measures the size when stats are being collected
+	void RecordSendStats() const;
+
 	/** Network serialization */
 	// Doing a custom NetSerialize here because this is sent via RPCs and should change on every update
 	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
@@ -527,6 +581,26 @@ public:
 		Ar.SerializeBits(&QuantizationLevel, 1); // Only two values 0:1
 		Ar.SerializeBits(&RotationQuantizationLevel, 1); // Only two values 0:1
 
+		uint8 bDeltaFrame = bIsDeltaFrame ? 1 : 0;
+		Ar.SerializeBits(&bDeltaFrame, 1);
+		bIsDeltaFrame = bDeltaFrame != 0;
+
+		// Both the full and the delta path carry the time stamp, if there is one
+		uint8 bTimeStamp = bHasSendTimeStamp ? 1 : 0;
+		Ar.SerializeBits(&bTimeStamp, 1);
+		bHasSendTimeStamp = bTimeStamp != 0;
+
+		if (bHasSendTimeStamp)
+			Ar << SendTimeStamp;
+		else
+			SendTimeStamp = 0;
+
+		if (bIsDeltaFrame)
+		{
+			bOutSuccess = NetSerializeDelta(Ar);
+			return bOutSuccess;
+		}
+
 		// No longer using their built in rotation rep, as controllers will rarely if ever be at 0 rot on an axis and 
 		// so the 1 bit overhead per axis is just that, overhead
 		//Rotation.SerializeCompressedShort(Ar);
@@ -623,6 +697,200 @@ struct TStructOpsTypeTraits< FBPVRComponentPosRep > : public TStructOpsTypeTrait
 	};
 };
 
+// Profiling counters for the tracked device pose sends to the server, use "stat VRPoseNet"
+// Bytes are the serialized pose payload only, the per RPC header overhead is what the RPC count is for
+DECLARE_STATS_GROUP(TEXT("VRPoseNet"), STATGROUP_VRPoseNet, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pose RPCs Sent"), STAT_VRPoseRPCsSent, STATGROUP_VRPoseNet, VREXPANSIONPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pose Bytes Sent"), STAT_VRPoseBytesSent, STATGROUP_VRPoseNet, VREXPANSIONPLUGIN_API);
+
+// Size of the keyframe ring for delta compressed position reps, KeyframeID is serialized with this many bits.
+// A slot is only reissued once the server has acknowledged a newer keyframe, so a slow acknowledgement stalls new keyframes
+// (sends keep delta encoding against the last acknowledged one) instead of naming a slot that was reissued under it.
+// More bits allow more keyframes in flight on slow connections at one bit per send each. Max 7 so that the invalid ID stays free.
+#define VRPOSREP_KEYFRAME_ID_BITS 4
+#define VRPOSREP_MAX_KEYFRAMES (1 << VRPOSREP_KEYFRAME_ID_BITS)
+#define VRPOSREP_INVALID_KEYFRAME 0xFF
+static_assert(VRPOSREP_KEYFRAME_ID_BITS > 0 && VRPOSREP_KEYFRAME_ID_BITS < 8, "VRPOSREP_KEYFRAME_ID_BITS has to be between 1 and 7");
+
+/**
+* Keyframe history for delta compressed FBPVRComponentPosRep sends, each replicated tracked component owns one.
+* The client side issues keyframes and delta encodes against the newest one the server has acknowledged (through
+* a replicated keyframe ID), the server side stores the keyframes it received and resolves deltas back into full poses.
+* A keyframe ID is only reused once the acknowledgement has moved past it, so an acknowledgement always names the keyframe it was sent for.
+*/
+struct VREXPANSIONPLUGIN_API FBPVRPosRepDeltaState
+{
+	// Net quantized keyframe positions, same contents on the client and the server for any acknowledged ID
+	FVector KeyframePositions[VRPOSREP_MAX_KEYFRAMES];
+	bool bKeyframeValid[VRPOSREP_MAX_KEYFRAMES];
+
+	// Client side, order each keyframe was issued in, and the newest one that the server has acknowledged
+	uint32 KeyframeSequences[VRPOSREP_MAX_KEYFRAMES];
+	uint32 NextKeyframeSequence;
+	uint32 AckedKeyframeSequence;
+
+	// Client side, next ID to try to issue and when the last keyframe was issued
+	uint8 NextKeyframeID;
+	float LastKeyframeTime;
+
+	// Issue a new keyframe when the position gets this far (in cm) from the acknowledged one
+	// Keeps the deltas within a small number of bits
+	float MaxKeyframeDistance;
+
+	// Minimum time between keyframes, also acts as the resend time if one was lost
+	// Together with VRPOSREP_MAX_KEYFRAMES this sets how long an acknowledgement can take before new keyframes have to wait for it
+	float KeyframeInterval;
+
+	FBPVRPosRepDeltaState()
+	{
+		Reset();
+		MaxKeyframeDistance = 25.0f;
+		KeyframeInterval = 0.1f;
+	}
+
+	void Reset()
+	{
+		for (int i = 0; i < VRPOSREP_MAX_KEYFRAMES; ++i)
+		{
+			KeyframePositions[i] = FVector::ZeroVector;
+			bKeyframeValid[i] = false;
+			KeyframeSequences[i] = 0;
+		}
+
+		NextKeyframeSequence = 1;
+		AckedKeyframeSequence = 0;
+		NextKeyframeID = 0;
+		LastKeyframeTime = -MAX_flt;
+	}
+
+	// Client side, sets up the delta fields on Rep before it is sent
+	void PrepareForSend(FBPVRComponentPosRep & Rep, uint8 AckedKeyframeID, float CurrentTime);
+
+	// Server side, converts a received rep back into a full pose
+	// Returns false if it references a keyframe that never arrived, the rep should be discarded in that case
+	bool ResolveReceived(FBPVRComponentPosRep & Rep, uint8 & OutAckedKeyframeID);
+
+	// Returns the position as it will be after being serialized with the given quantization level
+	static FVector GetNetQuantizedPosition(const FVector & Position, EVRVectorQuantization QuantizationLevel);
+};
+
+// Number of received poses kept by FBPVRPoseInterpolationBuffer
+#define VRPOSEBUFFER_MAX_SAMPLES 16
+
+struct FBPVRPoseBufferSample
+{
+	FVector Position;
+	FQuat Rotation;
+
+	// Unwrapped sender time of the pose, in seconds
+	double SenderTime;
+};
+
+/**
+* Playout (jitter) buffer for replicated tracked device poses on remote clients.
+* Received poses are placed on the senders timeline by their SendTimeStamp, so network jitter and reordering do not
+* distort the motion. The local clock is mapped on to that timeline with a smoothed minimum of (arrival - send time),
+* which tracks the fastest path through the network, and poses are played back PlayoutDelay seconds behind that,
+* interpolating between the two samples that bracket the playout time. If the next pose is late the newest motion is extrapolated with a damped
+* velocity for up to MaxExtrapolationTime, and then held, instead of hitching at the last received pose.
+*/
+USTRUCT(BlueprintType, Category = "VRExpansionLibrary")
+struct VREXPANSIONPLUGIN_API FBPVRPoseInterpolationBuffer
+{
+	GENERATED_BODY()
+public:
+
+	// How far behind the newest received pose to play back, in seconds.
+	// Should be a bit over the send interval (1 / NetUpdateRate) plus the expected jitter, higher values hide more loss but add latency
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseBuffer", meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float PlayoutDelay;
+
+	// Longest time to extrapolate past the newest pose when updates are late, the pose is held after that
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseBuffer", meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float MaxExtrapolationTime;
+
+	// How quickly the extrapolated velocity decays (1/seconds), 0 is constant velocity
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseBuffer", meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float ExtrapolationDamping;
+
+	// Number of received poses that are still ahead of the playout time
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "PoseBuffer|Stats")
+		int32 BufferDepth;
+
+	// Number of times the playout time ran past the newest pose and had to extrapolate
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "PoseBuffer|Stats")
+		int32 LatePackets;
+
+	// Total time spent extrapolating (or holding) past the newest pose, in seconds
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "PoseBuffer|Stats")
+		float ExtrapolationTime;
+
+	FBPVRPoseInterpolationBuffer() :
+		PlayoutDelay(0.05f),
+		MaxExtrapolationTime(0.1f),
+		ExtrapolationDamping(10.0f)
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		BufferDepth = 0;
+		LatePackets = 0;
+		ExtrapolationTime = 0.0f;
+		NewestIndex = 0;
+		NumSamples = 0;
+		LastPlayoutTime = 0.0;
+		bIsExtrapolating = false;
+		ClockOffset = 0.0;
+		NewestSenderTime = 0.0;
+		LastArrivalTime = 0.0;
+		NewestSendTimeStamp = 0;
+	}
+
+	bool HasSamples() const
+	{
+		return NumSamples > 0;
+	}
+
+	// Adds a received pose sampled at the senders SendTimeStamp, CurrentTime should be the same real time clock that is
+	// passed in to Sample(). Poses that arrive out of order are inserted in order, duplicates are dropped.
+	void AddSample(const FVector & Position, const FRotator & Rotation, uint16 SendTimeStamp, double CurrentTime);
+
+	// Gets the pose to display at CurrentTime, returns false if nothing has been received yet
+	bool Sample(double CurrentTime, FVector & OutPosition, FRotator & OutRotation);
+
+private:
+
+	const FBPVRPoseBufferSample & GetSample(int32 Age) const
+	{
+		return Samples[(NewestIndex - Age + VRPOSEBUFFER_MAX_SAMPLES) % VRPOSEBUFFER_MAX_SAMPLES];
+	}
+
+	FBPVRPoseBufferSample & GetSample(int32 Age)
+	{
+		return Samples[(NewestIndex - Age + VRPOSEBUFFER_MAX_SAMPLES) % VRPOSEBUFFER_MAX_SAMPLES];
+	}
+
+	// Unwraps a 16 bit millisecond stamp on to the senders timeline, using the local arrival time to resolve how many
+	// times the stamp wrapped during a long gap between sends
+	double UnwrapSendTime(uint16 SendTimeStamp, double CurrentTime) const;
+
+	FBPVRPoseBufferSample Samples[VRPOSEBUFFER_MAX_SAMPLES];
+	int32 NewestIndex;
+	int32 NumSamples;
+	double LastPlayoutTime;
+	bool bIsExtrapolating;
+
+	// Local time minus sender time, Sample() plays back at CurrentTime - ClockOffset - PlayoutDelay on the senders timeline
+	double ClockOffset;
+
+	// Sender time, stamp, and local arrival time of the newest pose by sender time
+	double NewestSenderTime;
+	double LastArrivalTime;
+	uint16 NewestSendTimeStamp;
+};
+
 UENUM(Blueprintable)
 enum class EGripCollisionType : uint8
 {
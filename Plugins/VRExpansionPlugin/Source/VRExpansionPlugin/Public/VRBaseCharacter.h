@@ -11,6 +11,7 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/Controller.h"
 #include "Components/CapsuleComponent.h"
+#include "Misc/VRLagCompensation.h"
 #include "VRBaseCharacter.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogBaseVRCharacter, Log, All);
@@ -162,6 +163,95 @@ struct TStructOpsTypeTraits< FVRReplicatedCapsuleHeight > : public TStructOpsTyp
 	};
 };
 
+// The HMD and controller poses that changed since the last combined send, sent as a single RPC
+USTRUCT()
+struct VREXPANSIONPLUGIN_API FVRCombinedPoseRep
+{
+	GENERATED_USTRUCT_BODY()
+public:
+
+	enum EVRCombinedPoseFlags : uint8
+	{
+		HasCamera = 0x01,
+		HasLeftController = 0x02,
+		HasRightController = 0x04
+	};
+
+	// Which of the poses are contained, only those are serialized
+	uint8 PoseFlags;
+
+	UPROPERTY(Transient)
+		FBPVRComponentPosRep CameraTransform;
+	UPROPERTY(Transient)
+		FBPVRComponentPosRep LeftControllerTransform;
+	UPROPERTY(Transient)
+		FBPVRComponentPosRep RightControllerTransform;
+
+	FVRCombinedPoseRep() :
+		PoseFlags(0)
+	{}
+
+	// Adds this send to the VRPoseNet stat counters as a single RPC
+	void RecordSendStats() const;
+
+	/** Network serialization */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		bOutSuccess = true;
+
+		Ar.SerializeBits(&PoseFlags, 3);
+
+		bool bPoseSuccess = true;
+
+		if (PoseFlags & HasCamera)
+			bOutSuccess &= CameraTransform.NetSerialize(Ar, Map, bPoseSuccess);
+
+		if (PoseFlags & HasLeftController)
+			bOutSuccess &= LeftControllerTransform.NetSerialize(Ar, Map, bPoseSuccess);
+
+		if (PoseFlags & HasRightController)
+			bOutSuccess &= RightControllerTransform.NetSerialize(Ar, Map, bPoseSuccess);
+
+		return bOutSuccess;
+	}
+};
+template<>
+struct TStructOpsTypeTraits< FVRCombinedPoseRep > : public TStructOpsTypeTraitsBase2<FVRCombinedPoseRep>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+class AVRBaseCharacter;
+
+// Post physics tick that sends the poses the tracked components queued up this frame
+struct FVRCombinedPoseSendTickFunction : public FTickFunction
+{
+	AVRBaseCharacter * Target;
+
+	FVRCombinedPoseSendTickFunction() :
+		Target(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+// Post physics tick that records the characters hit shapes for lag compensation on the server
+struct FVRRewindHistoryTickFunction : public FTickFunction
+{
+	AVRBaseCharacter * Target;
+
+	FVRRewindHistoryTickFunction() :
+		Target(nullptr)
+	{}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
 UCLASS()
 class VREXPANSIONPLUGIN_API AVRBaseCharacter : public ACharacter
 {
@@ -188,6 +278,74 @@ public:
 	UFUNCTION(Unreliable, Server, WithValidation)
 		void Server_SendTransformRightController(FBPVRComponentPosRep NewTransform);
 
+	// Sends the HMD and both controllers in one RPC, fans them back out to the components on the server
+	UFUNCTION(Unreliable, Server, WithValidation)
+		void Server_SendCombinedPose(FVRCombinedPoseRep NewPoses);
+
+	// The tracked components call these through their OverrideSendTransform, they either queue the pose for the
+	// combined send or call the matching Server_SendTransform RPC directly.
+	void SendTransformCamera(FBPVRComponentPosRep NewTransform);
+	void SendTransformLeftController(FBPVRComponentPosRep NewTransform);
+	void SendTransformRightController(FBPVRComponentPosRep NewTransform);
+
+	// If true the HMD and controller poses are gathered each frame and sent to the server in a single RPC at CombinedPoseNetUpdateRate
+	// Instead of each component sending its own. Saves the header overhead of two RPCs per update.
+	// The components still decide when their pose is dirty using their own update rates, keep those at or above this rate.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|Networking")
+		bool bCombinePoseSends;
+
+	// Rate to send the combined poses to the server, 100htz is default
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|Networking", meta = (ClampMin = "1", UIMin = "1"))
+		float CombinedPoseNetUpdateRate;
+
+	// Poses queued since the last combined send
+	FVRCombinedPoseRep PendingCombinedPoses;
+	float CombinedPoseNetUpdateCount;
+
+	FVRCombinedPoseSendTickFunction CombinedPoseSendTickFunction;
+
+	// Called from CombinedPoseSendTickFunction after the tracked components have ticked
+	void SendCombinedPoses(float DeltaTime);
+
+	// Sends whatever poses are queued right away
+	void FlushCombinedPoses();
+
+	// Queues a pose for the combined send, flushes first if it would replace a keyframe that hasn't gone out yet
+	void QueueCombinedPose(FBPVRComponentPosRep & PendingPose, uint8 PoseFlag, const FBPVRComponentPosRep & NewTransform);
+
+	// Registers the combined send tick on the owning client only, possession isn't known yet the first time the tick functions register
+	void UpdateCombinedPoseSendTick();
+	virtual void OnRep_Controller() override;
+
+	// If true the server records the capsule, HMD and hand transforms every frame so that UVRLagCompensationLibrary
+	// can trace against this character as it was in the past.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|LagCompensation")
+		bool bRecordRewindHistory;
+
+	// Number of frames to keep, memory is allocated once for this many. Should cover MaxRewindTime at the servers frame rate.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|LagCompensation", meta = (ClampMin = "2", UIMin = "2"))
+		int32 RewindHistoryFrames;
+
+	// Furthest back in time that traces instigated by this character are allowed to rewind to, in seconds
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|LagCompensation", meta = (ClampMin = "0", UIMin = "0"))
+		float MaxRewindTime;
+
+	// Radius of the sphere around the HMD that rewound traces test against
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|LagCompensation", meta = (ClampMin = "0", UIMin = "0"))
+		float RewindHeadRadius;
+
+	// Radius of the spheres around the motion controllers that rewound traces test against
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "VRBaseCharacter|LagCompensation", meta = (ClampMin = "0", UIMin = "0"))
+		float RewindHandRadius;
+
+	FVRRewindHistory RewindHistory;
+	FVRRewindHistoryTickFunction RewindHistoryTickFunction;
+
+	// Called from RewindHistoryTickFunction after movement and the tracked components have updated
+	void RecordRewindFrame();
+
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
+
 	virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker) override;
 
 	// If true will replicate the capsule height on to clients, allows for dynamic capsule height changes in multiplayer
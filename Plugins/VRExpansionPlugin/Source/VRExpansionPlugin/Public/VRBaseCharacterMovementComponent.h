@@ -9,8 +9,11 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Misc/VRLagCompensation.h"
 #include "VRBaseCharacterMovementComponent.generated.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogVRBaseCharacterMovement, Log, All);
+
 /** Delegate for notification when to handle a climbing step up, will override default step up logic if is bound to. */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVROnPerformClimbingStepUp, FVector, FinalStepUpLocation);
 
@@ -489,57 +492,8 @@ public:
 		return Result;
 	}
 
-	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* Character, float MaxDelta) const override
-	{
-		FSavedMove_VRBaseCharacter * nMove = (FSavedMove_VRBaseCharacter *)NewMove.Get();
-
-
-		if (!nMove || (VRReplicatedMovementMode != nMove->VRReplicatedMovementMode))
-			return false;
-
-		if (ConditionalValues.MoveActionArray.MoveActions.Num() > 0 || nMove->ConditionalValues.MoveActionArray.MoveActions.Num() > 0)
-			return false;
-
-		if (!ConditionalValues.CustomVRInputVector.IsZero() || !nMove->ConditionalValues.CustomVRInputVector.IsZero())
-			return false;
-
-		if (!ConditionalValues.RequestedVelocity.IsZero() || !nMove->ConditionalValues.RequestedVelocity.IsZero())
-			return false;
-
-		// Hate this but we really can't combine if I am sending a new capsule height
-		if (!FMath::IsNearlyEqual(LFDiff.Z, nMove->LFDiff.Z))
-			return false;
-
-		if (!LFDiff.IsZero() && !nMove->LFDiff.IsZero() && !FVector::Coincident(LFDiff.GetSafeNormal2D(), nMove->LFDiff.GetSafeNormal2D(), AccelDotThresholdCombine))
-			return false;
-
-		return FSavedMove_Character::CanCombineWith(NewMove, Character, MaxDelta);
-	}
-
-
-	virtual bool IsImportantMove(const FSavedMovePtr& LastAckedMove) const override
-	{
-		// Auto important if toggled climbing
-		if (VRReplicatedMovementMode != EVRConjoinedMovementModes::C_MOVE_MAX)//_None)
-			return true;
-
-		if (!ConditionalValues.CustomVRInputVector.IsZero())	
-			return true;
-
-		if (!ConditionalValues.RequestedVelocity.IsZero())
-			return true;
-
-		if (ConditionalValues.MoveActionArray.MoveActions.Num() > 0)
-			return true;
-
-		// #TODO: What to do here?
-		// This is debatable, however it will ALWAYS be non zero realistically and only really effects step ups for the most part
-		//if (!LFDiff.IsNearlyZero())
-		//return true;
-
-		// Else check parent class
-		return FSavedMove_Character::IsImportantMove(LastAckedMove);
-	}
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* Character, float MaxDelta) const override;
+	virtual bool IsImportantMove(const FSavedMovePtr& LastAckedMove) const override;
 
 	virtual void PrepMoveFor(ACharacter* Character) override;
 	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
@@ -685,6 +639,22 @@ public:
 
 	virtual bool VerifyClientTimeStamp(float TimeStamp, FNetworkPredictionData_Server_Character & ServerData) override;
 
+	// Client time stamp to server time offset, estimated from the moves that passed VerifyClientTimeStamp.
+	// Lets the server map a time stamp sent by the client (for a shot or other action) back to its own time line for lag compensation.
+	FVRClientTimeStampOffset ClientTimeStampOffset;
+
+	// Server side, converts a client move time stamp into the server world time at which the client was at it
+	UFUNCTION(BlueprintPure, Category = "VRMovement|LagCompensation")
+		float GetServerTimeForClientTimeStamp(float ClientTimeStamp) const;
+
+	// Server side, half of the owning players round trip time in seconds, 0 if there is no player state
+	UFUNCTION(BlueprintPure, Category = "VRMovement|LagCompensation")
+		float GetClientOneWayLatency() const;
+
+	// Client side, the time stamp of the current move, send this with actions that need lag compensation on the server
+	UFUNCTION(BlueprintPure, Category = "VRMovement|LagCompensation")
+		float GetCurrentClientTimeStamp() const;
+
 	inline void ApplyVRMotionToVelocity(float deltaTime)
 	{
 		if (AdditionalVRInputVector.IsNearlyZero())
@@ -875,6 +845,32 @@ public:
 
 	FVector RoundDirectMovement(FVector InMovement) const;
 
+	// Client side counters for vr.VRMovement.NetMoveStats, logged once a second while the cvar is set
+	// Toggle vr.VRMovement.TolerantMoveCombining to compare the move combining policies
+	struct FVRNetMoveStats
+	{
+		int32 MovesSent;
+		int32 MovesCombined;
+		int32 Corrections;
+		int32 TotalCorrections;
+		float WindowStartTime;
+
+		FVRNetMoveStats() :
+			MovesSent(0),
+			MovesCombined(0),
+			Corrections(0),
+			TotalCorrections(0),
+			WindowStartTime(-1.0f)
+		{}
+	};
+
+	FVRNetMoveStats NetMoveStats;
+
+	void RecordServerMoveSent();
+	void RecordServerMoveCombined();
+	void RecordServerCorrection();
+	void UpdateNetMoveStats();
+
 	// Setting this below 1.0 will change how fast you de-accelerate when touching a wall
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRMovement|LowGrav", meta = (ClampMin = "0.0", UIMin = "0", ClampMax = "5.0", UIMax = "5"))
 		float VRLowGravWallFrictionScaler;
@@ -890,6 +886,9 @@ public:
 	{
 		//this->CustomVRInputVector = FVector::ZeroVector;
 
+		// Very short adjustments end up here as well
+		RecordServerCorrection();
+
 		Super::ClientAdjustPosition_Implementation(TimeStamp, NewLoc, NewVel, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
 	}
 
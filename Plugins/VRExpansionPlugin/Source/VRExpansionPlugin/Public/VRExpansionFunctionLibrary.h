@@ -15,6 +15,7 @@
 #include "VRBPDatatypes.h"
 #include "GameplayTagContainer.h"
 #include "XRMotionControllerBase.h" // for GetHandEnumForSourceName()
+#include "Grippables/GrippableSpatialIndex.h"
 
 #include "VRExpansionFunctionLibrary.generated.h"
 
@@ -166,6 +167,24 @@ public:
 	UFUNCTION(BlueprintPure, Category = "VRGrip", meta = (bIgnoreSelf = "true", DisplayName = "GetGripSlotInRangeByTypeName_Component"))
 	static void GetGripSlotInRangeByTypeName_Component(FName SlotType, UPrimitiveComponent * Component, FVector WorldLocation, float MaxRange, bool & bHadSlotInRange, FTransform & SlotWorldTransform);
 
+	// Gets the grippables within Radius of a location from the worlds grippable index, closest first (no physics overlaps)
+	// Grippables that deny gripping are skipped, as are held ones unless bIncludeHeld is set. MaxResults of 0 returns all in range
+	UFUNCTION(BlueprintCallable, Category = "VRGrip", meta = (WorldContext = "WorldContextObject", DisplayName = "FindGrippablesNearLocation"))
+	static void FindGrippablesNearLocation(UObject * WorldContextObject, FVector WorldLocation, float Radius, int32 MaxResults, bool bIncludeHeld, TArray<FGrippableQueryCandidate> & Candidates);
+
+	// Runs FindGrippablesNearLocation for both hands of every VR character controlled by a player in one batch
+	UFUNCTION(BlueprintCallable, Category = "VRGrip", meta = (WorldContext = "WorldContextObject", DisplayName = "FindGrippablesNearPlayerHands"))
+	static void FindGrippablesNearPlayerHands(UObject * WorldContextObject, float Radius, int32 MaxResults, bool bIncludeHeld, TArray<FGrippableHandCandidates> & Hands);
+
+	// Adds an object implementing the grip interface to the grippable index, it is tracked at the location of TrackedComponent
+	// The plugins grippable actors and components are added automatically
+	UFUNCTION(BlueprintCallable, Category = "VRGrip", meta = (DisplayName = "RegisterGrippableForQueries"))
+	static void RegisterGrippableForQueries(UObject * Grippable, USceneComponent * TrackedComponent);
+
+	// Removes an object from the grippable index, call this in EndPlay for anything registered with RegisterGrippableForQueries
+	UFUNCTION(BlueprintCallable, Category = "VRGrip", meta = (DisplayName = "UnregisterGrippableForQueries"))
+	static void UnregisterGrippableForQueries(UObject * Grippable);
+
 	/* Returns true if the values are equal (A == B) */
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "Equal VR Grip", CompactNodeTitle = "==", Keywords = "== equal"), Category = "VRExpansionFunctions")
 	static bool EqualEqual_FBPActorGripInformation(const FBPActorGripInformation &A, const FBPActorGripInformation &B);
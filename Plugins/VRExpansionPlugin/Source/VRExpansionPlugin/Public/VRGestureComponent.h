@@ -14,8 +14,11 @@
 #include "Engine/EngineTypes.h"
 #include "Engine/EngineBaseTypes.h"
 #include "TimerManager.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "VRGestureComponent.generated.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogVRGestures, Log, All);
+
 DECLARE_STATS_GROUP(TEXT("TICKGesture"), STATGROUP_TickGesture, STATCAT_Advanced);
 
 
@@ -204,6 +207,98 @@ public:
 	~FVRGestureSplineDraw();
 };
 
+// DTW scratch, two rows each of costs and vertical slope counts plus the distances of one row, grown to the largest template and then reused
+// Every thread running DTW needs its own
+struct VREXPANSIONPLUGIN_API FVRGestureDTWScratch
+{
+	TArray<float> CostRows;
+	TArray<int> SlopeJRows;
+	TArray<float> RowDistances;
+};
+
+// Per gesture data that recognition precomputes, the component keeps one per gesture in its database
+// Recognition only reads these (never the database) so that it can run off of the game thread
+struct VREXPANSIONPLUGIN_API FVRGestureTemplateCache
+{
+	// Samples split into components and padded to a multiple of 4 so that distances can be evaluated 4 at a time
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	int SampleCount;
+
+	// Envelope of every sample, for the cheapest lower bound
+	FBox Bounds;
+
+	// Copied from the gesture every recognition pass
+	FVRGestureSettings Settings;
+
+	FVRGestureTemplateCache() :
+		SampleCount(0),
+		Bounds(ForceInit)
+	{}
+
+	void Build(const FVRGesture & Gesture);
+
+	// Writes the squared distance from Sample to every template sample in to OutDistances (needs GetPaddedCount() entries)
+	// Bit exact with FVector::DistSquared
+	void GetDistances(const FVector & Sample, float * OutDistances) const;
+
+	int GetPaddedCount() const
+	{
+		return X.Num();
+	}
+
+	FVector GetSample(int Index) const
+	{
+		return FVector(X[Index], Y[Index], Z[Index]);
+	}
+};
+
+// One slice of the database for parallel recognition, with its own scratch and best match
+struct VREXPANSIONPLUGIN_API FVRGestureRecognitionBatch
+{
+	FVRGestureDTWScratch Scratch;
+	int GestureIndex;
+	float Distance;
+	int DTWEvaluatedCount;
+	int DTWPrunedCount;
+
+	FVRGestureRecognitionBatch() :
+		GestureIndex(-1),
+		Distance(MAX_FLT),
+		DTWEvaluatedCount(0),
+		DTWPrunedCount(0)
+	{}
+};
+
+// Running subsequence DTW column for one template (and mirror state) in incremental recognition
+// Index 0 is the free starting row, the last entry is the cost of the best match that ends on the newest sample
+struct VREXPANSIONPLUGIN_API FVRGestureStreamingColumn
+{
+	TArray<float> Cost;
+
+	// Input steps in a row on each template sample, for the maxSlope limit
+	TArray<int> SlopeJ;
+
+	void Reset(int TemplateCount)
+	{
+		Cost.SetNumUninitialized(TemplateCount + 1, false);
+		SlopeJ.SetNumZeroed(TemplateCount + 1, false);
+
+		Cost[0] = 0.f;
+		for (int i = 1; i < Cost.Num(); ++i)
+		{
+			Cost[i] = MAX_FLT;
+		}
+	}
+
+	void Empty()
+	{
+		Cost.Reset();
+		SlopeJ.Reset();
+	}
+};
+
 /** Delegate for notification when the lever state changes. */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FVRGestureDetectedSignature, uint8, GestureType, FString, DetectedGestureName, int, DetectedGestureIndex, UGesturesDatabase *, GestureDataBase);
 
@@ -288,6 +383,28 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRGestures")
 	int maxSlope;
 
+	// If true detection keeps a running DTW column per gesture and only adds the newest sample to it each tick, the match cost
+	// is read straight from the column so the per tick cost doesn't depend on RecordingBufferSize.
+	// The columns run the DTW forward in time instead of back from the newest sample and can include samples that already left the buffer,
+	// so distances can differ slightly from the full recognition. Ticks that rebuild the columns use the full recognition.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRGestures")
+		bool bIncrementalRecognition;
+
+	// How far (as a fraction) the input scaler can drift as the recording grows before the running columns are rebuilt from the buffer
+	// Until then gestures with scaling enabled are matched at the scaler the columns were built with
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRGestures", meta = (ClampMin = "0.0", UIMin = "0.0"))
+		float IncrementalRescaleTolerance;
+
+	// If true detection splits the database across the task graph worker threads instead of matching it on the game thread.
+	// The result is applied (and OnGestureDetected broadcast) on the next gesture tick, so detection lags by one sample.
+	// Only worth it for large databases, it isn't used along with bIncrementalRecognition which is already cheap per tick.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRGestures")
+		bool bAsyncRecognition;
+
+	// Max number of batches the database is split into for async recognition, 0 uses one per worker thread (plus the calling thread)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRGestures", meta = (ClampMin = "0", UIMin = "0"))
+		int AsyncRecognitionMaxBatches;
+
 	UPROPERTY(BlueprintReadOnly, Category = "VRGestures")
 	EVRGestureState CurrentState;
 
@@ -353,11 +470,121 @@ public:
 	// Recognize gesture in the given sequence.
 	// It will always assume that the gesture ends on the last observation of that sequence.
 	// If the distance between the last observations of each sequence is too great, or if the overall DTW distance between the two sequences is too great, no gesture will be recognized.
-	void RecognizeGesture(FVRGesture inputGesture);
+	void RecognizeGesture(const FVRGesture & inputGesture);
+
+	// Finds the best matching gesture in GesturesDB without acting on it, returns -1 if none are within their thresholds
+	int FindBestGesture(const FVRGesture & inputGesture, float & OutDistance);
+
+	// Same checks as FindBestGesture with the match costs from the running columns of bIncrementalRecognition, inputGesture needs to be the GestureLog
+	int FindBestGestureIncremental(const FVRGesture & inputGesture, float & OutDistance);
+
+	// Same result as FindBestGesture, with the database split in to MaxBatches (0 for one per thread) run with ParallelFor
+	int FindBestGestureParallel(const FVRGesture & inputGesture, float & OutDistance, int MaxBatches = 0);
+
+	// Starts matching inputGesture on the task graph, the result is picked up by ApplyAsyncRecognition
+	void DispatchAsyncRecognition(const FVRGesture & inputGesture);
+
+	// Waits for the dispatched recognition if it is still running and acts on its result like RecognizeGesture does
+	void ApplyAsyncRecognition();
 
+	// Waits for the dispatched recognition and throws its result out, the recording it ran on is gone
+	void CancelAsyncRecognition();
+
+	// Adds a sample to the front of GestureLog, popping the oldest one if the buffer is full
+	void AddSampleToGestureLog(const FVector & NewSample);
 
 	// Compute the min DTW distance between seq2 and all possible endings of seq1.
-	float dtw(FVRGesture seq1, FVRGesture seq2, bool bMirrorGesture = false, float Scaler = 1.f);
+	// Full table reference version, recognition uses DTWTwoRow instead, this is kept to validate it against.
+	float dtw(const FVRGesture & seq1, const FVRGesture & seq2, bool bMirrorGesture = false, float Scaler = 1.f);
+
+	// Same result as dtw() but only keeps two rows of the table in the component scratch buffers so it doesn't allocate.
+	// InputSamples need the scaler and mirroring already applied (see GetPreparedInput).
+	// Stops early once every entry in a row is at or above RejectDistance (per template sample, the same as the thresholds), since
+	// later rows can't go lower. The result is then only exact if it is below RejectDistance, anything else should be thrown out.
+	float DTWTwoRow(const TArray<FVector> & InputSamples, const FVRGestureTemplateCache & Template, float RejectDistance = MAX_FLT);
+
+	// Thread safe version of the above, using the callers scratch
+	float DTWTwoRow(const TArray<FVector> & InputSamples, const FVRGestureTemplateCache & Template, FVRGestureDTWScratch & Scratch, float RejectDistance) const;
+
+	// Returns the input samples with the scaler and / or mirroring applied, these are cached for the current recognition pass
+	const TArray<FVector> & GetPreparedInput(const FVRGesture & inputGesture, float Scaler, bool bMirrorGesture);
+
+	// True if the DTW distance (per template sample) of the prepared input against Template is provably at or above RejectDistance.
+	// LB_Keogh style, every template sample has to be matched at least once and maxSlope limits how far in to the input
+	// template sample j can be matched, so each one costs at least its distance to the envelope of that much of the input.
+	bool ExceedsLowerBound(const TArray<FBox> & InputPrefixBounds, const FVRGestureTemplateCache & Template, float RejectDistance) const;
+
+	// Rebuilds the per gesture caches, call this if gesture samples in the database are edited in place at runtime.
+	// Adding / removing gestures or changing their sample counts is picked up automatically.
+	UFUNCTION(BlueprintCallable, Category = "VRGestures")
+		void InvalidateGestureCache();
+
+	// Counts from the last FindBestGesture, gestures that went through DTW and ones that the lower bounds threw out
+	int LastDTWEvaluatedCount;
+	int LastDTWPrunedCount;
+
+private:
+
+	FVRGestureDTWScratch DTWScratch;
+
+	// Input samples with the scaler / mirroring pre-applied, indexed by (Scaled ? 1 : 0) | (Mirrored ? 2 : 0)
+	TArray<FVector> PreparedInputSamples[4];
+	bool bPreparedInputValid[4];
+
+	// Envelope of the first N + 1 prepared input samples at index N, for the lower bounds
+	TArray<FBox> PreparedInputPrefixBounds[4];
+
+	TArray<FVRGestureTemplateCache> TemplateCache;
+	UGesturesDatabase * TemplateCacheDB;
+	bool bTemplateCacheDirty;
+
+	void RefreshTemplateCache();
+
+	// Builds every prepared input variant and refreshes the template cache so that the pass itself is read only, returns the input scaler
+	float PrepareRecognitionPass(const FVRGesture & inputGesture);
+
+	// Best match among TemplateCache[StartIndex, EndIndex), only reads component state so batches of it can run in parallel
+	int FindBestGestureInRange(int StartIndex, int EndIndex, int InputSampleCount, float Scaler, FVRGestureDTWScratch & Scratch, float & OutDistance, int & OutDTWEvaluatedCount, int & OutDTWPrunedCount) const;
+
+	// Runs FindBestGestureInRange over the whole cache in batches, needs PrepareRecognitionPass first
+	int FindBestGestureInBatches(int InputSampleCount, float Scaler, int MaxBatches, float & OutDistance);
+
+	void BroadcastGestureDetected(int GestureIndex);
+
+	// Async recognition state, everything the task touches belongs to it until it completes
+	TArray<FVRGestureRecognitionBatch> RecognitionBatches;
+	FGraphEventRef AsyncRecognitionTask;
+	UGesturesDatabase * AsyncRecognitionDB;
+	int AsyncGestureIndex;
+	float AsyncGestureDistance;
+	bool bAsyncResultPending;
+
+	void WaitForAsyncRecognition();
+
+	static int GetPreparedInputIndex(float Scaler, bool bMirrorGesture)
+	{
+		// Only two scalers are used in a pass, the database one and 1.0 for gestures that don't scale
+		return (Scaler != 1.f ? 1 : 0) | (bMirrorGesture ? 2 : 0);
+	}
+
+	// Incremental recognition state, two columns per gesture (as is / mirrored for GES_MirrorBoth)
+	TArray<FVRGestureStreamingColumn> StreamingColumns;
+	UGesturesDatabase * StreamingDB;
+	EVRGestureMirrorMode StreamingMirroringHand;
+	float StreamingScaler;
+	int StreamingSamplesAdded;
+	int StreamingSamplesProcessed;
+	bool bStreamingNeedsRebuild;
+
+	// Whether the gesture compares against the mirrored input first, the same rule FindBestGesture uses
+	bool UsesMirroredInput(const FVRGestureSettings & Settings) const
+	{
+		return (MirroringHand != EVRGestureMirrorMode::GES_NoMirror && MirroringHand != EVRGestureMirrorMode::GES_MirrorBoth && MirroringHand == Settings.MirrorMode);
+	}
+
+	void RebuildStreamingColumns(const FVRGesture & inputGesture, float Scaler);
+	void AdvanceStreamingColumns(const FVector & InputSample);
+	void AdvanceStreamingColumn(FVRGestureStreamingColumn & Column, const TArray<FVector> & TemplateSamples, const FVector & InputSample);
 
 };
 